@@ -22,6 +22,7 @@ SOURCES += \
     statsview.cpp \
     statsmode.cpp \
     routingxmlparser.cpp \
+    routingsnapshotparser.cpp \
     routingstatsscene.cpp \
     interfacestatsscene.cpp \
     flowmonxmlparser.cpp \
@@ -72,6 +73,7 @@ HEADERS += \
     statsmode.h \
     statisticsconstants.h \
     routingxmlparser.h \
+    routingsnapshotparser.h \
     routingstatsscene.h \
     interfacestatsscene.h \
     flowmonxmlparser.h \
@@ -0,0 +1,205 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "routingsnapshotparser.h"
+#include "routingstatsscene.h"
+#include "log.h"
+
+NS_LOG_COMPONENT_DEFINE ("RoutingSnapshotParser");
+
+namespace netanim
+{
+
+static const char SNAPSHOT_MAGIC[] = "NS3RSNAP";
+static const quint32 SNAPSHOT_VERSION = 1;
+static const quint32 SNAPSHOT_RECORD_SIZE = 20;
+
+RoutingSnapshotParser::RoutingSnapshotParser (QString traceFileName):
+  m_traceFileName (traceFileName),
+  m_traceFile (0),
+  m_fileIsValid (false),
+  m_maxSimulationTime (0),
+  m_minSimulationTime (0xFFFFFFFF)
+{
+  if (!isSnapshotFile (traceFileName))
+    return;
+  m_traceFile = new QFile (m_traceFileName);
+  if (!m_traceFile->open (QIODevice::ReadOnly))
+    return;
+  m_traceFile->seek (16);
+  m_fileIsValid = true;
+}
+
+RoutingSnapshotParser::~RoutingSnapshotParser ()
+{
+  if (m_traceFile)
+    delete m_traceFile;
+}
+
+bool
+RoutingSnapshotParser::isSnapshotFile (QString traceFileName)
+{
+  QFile f (traceFileName);
+  if (!f.open (QIODevice::ReadOnly))
+    return false;
+  QByteArray magic = f.read (8);
+  QDataStream in (&f);
+  in.setByteOrder (QDataStream::LittleEndian);
+  quint32 version = 0;
+  quint32 recordSize = 0;
+  in >> version >> recordSize;
+  f.close ();
+  return magic == QByteArray (SNAPSHOT_MAGIC, 8) && version == SNAPSHOT_VERSION && recordSize == SNAPSHOT_RECORD_SIZE;
+}
+
+bool
+RoutingSnapshotParser::isFileValid ()
+{
+  return m_fileIsValid;
+}
+
+uint64_t
+RoutingSnapshotParser::getRtCount ()
+{
+  // Number of snapshots, from their headers only.
+  uint64_t count = 0;
+  QFile f (m_traceFileName);
+  if (!f.open (QIODevice::ReadOnly))
+    return 0;
+  f.seek (16);
+  QDataStream in (&f);
+  in.setByteOrder (QDataStream::LittleEndian);
+  while (!in.atEnd ())
+    {
+      qint64 time;
+      quint32 n;
+      quint32 kind;
+      in >> time >> n >> kind;
+      if (in.status () != QDataStream::Ok || !f.seek (f.pos () + qint64 (n) * SNAPSHOT_RECORD_SIZE))
+        break;
+      ++count;
+    }
+  f.close ();
+  return count;
+}
+
+QString
+RoutingSnapshotParser::addressToString (uint32_t address)
+{
+  return QString::number ((address >> 24) & 0xff) + "." + QString::number ((address >> 16) & 0xff) + "." +
+         QString::number ((address >> 8) & 0xff) + "." + QString::number (address & 0xff);
+}
+
+QString
+RoutingSnapshotParser::renderTable (const RouteMap_t & routes)
+{
+  QString rt = "Destination\t\tNextHop\t\tInterface\tDistance\n";
+  for (RouteMap_t::const_iterator i = routes.begin ();
+       i != routes.end ();
+       ++i)
+    {
+      rt += addressToString (i->first.first);
+      if (i->first.second != 32)
+        rt += "/" + QString::number (i->first.second);
+      rt += "\t\t" + addressToString (i->second.nextHop) +
+            "\t\t" + QString::number (i->second.interface) +
+            "\t\t" + QString::number (i->second.distance) + "\t\n";
+    }
+  return rt;
+}
+
+void
+RoutingSnapshotParser::doParse ()
+{
+  if (!m_fileIsValid)
+    return;
+  QDataStream in (m_traceFile);
+  in.setByteOrder (QDataStream::LittleEndian);
+  while (!in.atEnd ())
+    {
+      qint64 timeNs;
+      quint32 n;
+      quint8 kind;
+      quint8 pad;
+      in >> timeNs >> n >> kind >> pad >> pad >> pad;
+      if (in.status () != QDataStream::Ok)
+        break;
+      std::set <uint32_t> changed;
+      if (kind == 0)
+        {
+          // A full snapshot replaces every table: nodes it does not list
+          // have no routes left, and their view is reset too.
+          for (NodeIdRouteMap_t::const_iterator i = m_tables.begin ();
+               i != m_tables.end ();
+               ++i)
+            {
+              changed.insert (i->first);
+            }
+          m_tables.clear ();
+        }
+      for (quint32 i = 0; i < n; ++i)
+        {
+          quint32 nodeId, destination, nextHop, interface;
+          quint16 distance;
+          quint8 prefixLength, op;
+          in >> nodeId >> destination >> nextHop >> interface >> distance >> prefixLength >> op;
+          if (in.status () != QDataStream::Ok)
+            break;
+          changed.insert (nodeId);
+          RouteMap_t & routes = m_tables[nodeId];
+          std::pair <uint32_t, uint8_t> key (destination, prefixLength);
+          if (op == 1)
+            {
+              routes.erase (key);
+              continue;
+            }
+          Route_t & route = routes[key];
+          route.nextHop = nextHop;
+          route.interface = interface;
+          route.distance = distance;
+        }
+      if (in.status () != QDataStream::Ok)
+        {
+          NS_LOG_DEBUG ("Truncated routing snapshot");
+          break;
+        }
+
+      double updateTime = timeNs / 1e9;
+      m_minSimulationTime = qMin (m_minSimulationTime, updateTime);
+      m_maxSimulationTime = std::max (m_maxSimulationTime, updateTime);
+      for (std::set <uint32_t>::const_iterator i = changed.begin ();
+           i != changed.end ();
+           ++i)
+        {
+          RoutingStatsScene::getInstance ()->add (*i, updateTime, renderTable (m_tables[*i]));
+        }
+    }
+  m_traceFile->close ();
+}
+
+double
+RoutingSnapshotParser::getMaxSimulationTime ()
+{
+  return m_maxSimulationTime;
+}
+
+double
+RoutingSnapshotParser::getMinSimulationTime ()
+{
+  return m_minSimulationTime;
+}
+
+} // namespace netanim
@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef ROUTINGSNAPSHOTPARSER_H
+#define ROUTINGSNAPSHOTPARSER_H
+
+#include "common.h"
+#include <map>
+#include <set>
+#include <QDataStream>
+
+namespace netanim
+{
+
+// Reads the binary routing snapshot files written by ns-3's
+// RoutingSnapshotWriter (abc/routing-snapshot.h in the ns-3 tree) and
+// feeds the routing statistics view with one text table per node and
+// snapshot, as the routing XML trace does.
+//
+// Layout, little-endian:
+//   file header:     "NS3RSNAP", version (u32), record size (u32)
+//   snapshot header: time in ns (i64), record count (u32), kind (u8,
+//                    0 full, 1 delta), 3 padding bytes
+//   record:          node (u32), destination (u32), next hop (u32),
+//                    interface (u32), distance (u16), prefix length (u8),
+//                    op (u8, 0 set, 1 remove)
+class RoutingSnapshotParser
+{
+public:
+  RoutingSnapshotParser (QString traceFileName);
+  ~RoutingSnapshotParser ();
+  static bool isSnapshotFile (QString traceFileName);
+  bool isFileValid ();
+  uint64_t getRtCount ();
+  void doParse ();
+  double getMaxSimulationTime ();
+  double getMinSimulationTime ();
+
+private:
+  typedef struct
+  {
+    uint32_t nextHop;
+    uint32_t interface;
+    uint16_t distance;
+  } Route_t;
+  // (destination, prefix length) -> route
+  typedef std::map <std::pair <uint32_t, uint8_t>, Route_t> RouteMap_t;
+  typedef std::map <uint32_t, RouteMap_t> NodeIdRouteMap_t;
+
+  QString renderTable (const RouteMap_t & routes);
+  static QString addressToString (uint32_t address);
+
+  QString m_traceFileName;
+  QFile * m_traceFile;
+  bool m_fileIsValid;
+  double m_maxSimulationTime;
+  double m_minSimulationTime;
+  NodeIdRouteMap_t m_tables;
+};
+
+} // namespace netanim
+
+#endif // ROUTINGSNAPSHOTPARSER_H
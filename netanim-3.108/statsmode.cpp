@@ -20,6 +20,7 @@
 #include "animatormode.h"
 #include "animnode.h"
 #include "routingxmlparser.h"
+#include "routingsnapshotparser.h"
 #include "statisticsconstants.h"
 #include "statsmode.h"
 #include "statsview.h"
@@ -132,7 +133,7 @@ StatsMode::initTopToolbar ()
   m_topToolbar->addWidget (m_statTypeComboBox);
   m_fileOpenButton = new QToolButton;
   m_fileOpenButton->setEnabled (false);
-  m_fileOpenButton->setToolTip ("Open Routing XML trace file");
+  m_fileOpenButton->setToolTip ("Open Routing XML trace file or routing snapshot file");
   m_fileOpenButton->setIcon (QIcon (":/resources/animator_fileopen.svg"));
   connect (m_fileOpenButton,SIGNAL (clicked ()), this, SLOT (clickRoutingTraceFileOpenSlot ()));
   m_topToolbar->addWidget (m_fileOpenButton);
@@ -362,6 +363,10 @@ bool
 StatsMode::parseRoutingXMLTraceFile (QString traceFileName)
 {
   m_rtCount = 0;
+  if (RoutingSnapshotParser::isSnapshotFile (traceFileName))
+    {
+      return parseRoutingSnapshotFile (traceFileName);
+    }
   RoutingXmlparser parser (traceFileName);
   if (!parser.isFileValid ())
     {
@@ -384,6 +389,31 @@ StatsMode::parseRoutingXMLTraceFile (QString traceFileName)
   return true;
 }
 
+bool
+StatsMode::parseRoutingSnapshotFile (QString traceFileName)
+{
+  RoutingSnapshotParser parser (traceFileName);
+  if (!parser.isFileValid ())
+    {
+      showPopup ("Routing snapshot file is invalid");
+      m_fileOpenButton->setEnabled (true);
+      return false;
+    }
+  routingPreParse ();
+
+  showParsingXmlDialog (true);
+  m_rtCount = parser.getRtCount ();
+  setProgressBarRange (m_rtCount);
+
+  parser.doParse ();
+  showParsingXmlDialog (false);
+  setMaxSimulationTime (parser.getMaxSimulationTime ());
+  setMinSimulationTime (parser.getMinSimulationTime ());
+
+  routingPostParse ();
+  return true;
+}
+
 bool
 StatsMode::parseFlowMonXMLTraceFile (QString traceFileName)
 {
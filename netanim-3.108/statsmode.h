@@ -137,6 +137,7 @@ private:
   void initBottomToolbar ();
   void addNodesToToolbar (bool zeroIndexed = true);
   bool parseRoutingXMLTraceFile (QString traceFileName);
+  bool parseRoutingSnapshotFile (QString traceFileName);
   bool parseFlowMonXMLTraceFile (QString traceFileName);
   void showParsingXmlDialog (bool show);
   void routingPreParse ();
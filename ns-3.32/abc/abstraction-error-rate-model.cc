@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "abstraction-error-rate-model.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "ns3/log.h"
+#include "ns3/object-factory.h"
+#include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AbstractionErrorRateModel");
+
+NS_OBJECT_ENSURE_REGISTERED (AbstractionErrorRateModel);
+
+TypeId
+AbstractionErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AbstractionErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<AbstractionErrorRateModel> ()
+    .AddAttribute ("Model",
+                   "The reference error-rate model the curves are fitted to; "
+                   "a NistErrorRateModel if not set.",
+                   PointerValue (),
+                   MakePointerAccessor (&AbstractionErrorRateModel::SetModel,
+                                        &AbstractionErrorRateModel::GetModel),
+                   MakePointerChecker<ErrorRateModel> ())
+    .AddAttribute ("ReferenceSize",
+                   "Size of the frames the curves are fitted on (bytes).",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&AbstractionErrorRateModel::SetReferenceSize),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+AbstractionErrorRateModel::AbstractionErrorRateModel ()
+  : m_referenceSize (1500),
+    m_lastKey (0),
+    m_lastCurve (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+AbstractionErrorRateModel::~AbstractionErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+AbstractionErrorRateModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_model = 0;
+  m_curves.clear ();
+  m_lastCurve = 0;
+  ErrorRateModel::DoDispose ();
+}
+
+void
+AbstractionErrorRateModel::SetModel (Ptr<ErrorRateModel> model)
+{
+  m_model = model;
+  m_curves.clear ();
+  m_lastCurve = 0;
+}
+
+Ptr<ErrorRateModel>
+AbstractionErrorRateModel::GetModel (void) const
+{
+  if (m_model == 0)
+    {
+      ObjectFactory factory;
+      factory.SetTypeId ("ns3::NistErrorRateModel");
+      m_model = factory.Create<ErrorRateModel> ();
+    }
+  return m_model;
+}
+
+void
+AbstractionErrorRateModel::SetReferenceSize (uint32_t size)
+{
+  m_referenceSize = size;
+  m_curves.clear ();
+  m_lastCurve = 0;
+}
+
+double
+AbstractionErrorRateModel::FindSnr (WifiMode mode, const WifiTxVector &txVector, double successRate) const
+{
+  Ptr<ErrorRateModel> model = GetModel ();
+  uint64_t nbits = static_cast<uint64_t> (m_referenceSize) * 8;
+  // The success rate grows with the SNR; 40 halvings of 100 dB.
+  double lo = -20;
+  double hi = 80;
+  for (uint32_t i = 0; i < 40; ++i)
+    {
+      double mid = 0.5 * (lo + hi);
+      if (model->GetChunkSuccessRate (mode, txVector, std::pow (10.0, mid / 10.0), nbits) < successRate)
+        {
+          lo = mid;
+        }
+      else
+        {
+          hi = mid;
+        }
+    }
+  return std::pow (10.0, (lo + hi) / 20.0);
+}
+
+const AbstractionErrorRateModel::Curve &
+AbstractionErrorRateModel::GetCurve (WifiMode mode, const WifiTxVector &txVector) const
+{
+  uint32_t key = (static_cast<uint32_t> (mode.GetUid ()) << 24)
+    | ((static_cast<uint32_t> (txVector.GetChannelWidth ()) & 0xfff) << 12)
+    | ((static_cast<uint32_t> (txVector.GetNss ()) & 0xf) << 8)
+    | ((txVector.GetGuardInterval () / 100) & 0xff);
+  // The chunks of a frame come in a row with the same key.
+  if (m_lastCurve != 0 && key == m_lastKey)
+    {
+      return *m_lastCurve;
+    }
+  std::unordered_map<uint32_t, Curve>::const_iterator i = m_curves.find (key);
+  if (i != m_curves.end ())
+    {
+      m_lastKey = key;
+      m_lastCurve = &i->second;
+      return i->second;
+    }
+  // log (-log (success rate)) = a - b snr through both points.
+  double snr50 = FindSnr (mode, txVector, 0.5);
+  double snr10 = FindSnr (mode, txVector, 0.9);
+  double y50 = std::log (std::log (2.0));
+  double y10 = std::log (-std::log (0.9));
+  Curve curve;
+  curve.b = snr10 > snr50 ? (y50 - y10) / (snr10 - snr50) : 1e3 / snr50;
+  curve.a = y50 + curve.b * snr50;
+  curve.snr50 = snr50;
+  NS_LOG_DEBUG ("curve of " << mode << ": 50% PER at " << 10 * std::log10 (snr50)
+                << " dB, 10% at " << 10 * std::log10 (snr10) << " dB");
+  m_lastKey = key;
+  m_lastCurve = &(m_curves[key] = curve);
+  return *m_lastCurve;
+}
+
+double
+AbstractionErrorRateModel::DoGetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  // The term of this chunk in the effective SNR sum of its frame: the
+  // product of these rates over the chunks is the success rate of the
+  // whole frame at GetEffectiveSnr ().
+  const Curve &curve = GetCurve (mode, txVector);
+  double share = static_cast<double> (nbits) / (static_cast<double> (m_referenceSize) * 8);
+  return std::exp (-share * std::exp (curve.a - curve.b * std::max (snr, 0.0)));
+}
+
+double
+AbstractionErrorRateModel::GetEffectiveSnr (WifiMode mode, const WifiTxVector &txVector,
+                                            const std::vector<double> &snrs, const std::vector<double> &bits) const
+{
+  NS_ASSERT (snrs.size () == bits.size ());
+  const Curve &curve = GetCurve (mode, txVector);
+  // -log (success rate) of the frame is sum (bits exp (a - b snr)); the
+  // largest exponent is factored out so that none of them underflows.
+  double least = std::numeric_limits<double>::max ();
+  double total = 0;
+  for (uint32_t i = 0; i < snrs.size (); ++i)
+    {
+      least = std::min (least, std::max (snrs[i], 0.0));
+      total += bits[i];
+    }
+  if (total <= 0)
+    {
+      return least;
+    }
+  double sum = 0;
+  for (uint32_t i = 0; i < snrs.size (); ++i)
+    {
+      sum += bits[i] * std::exp (-curve.b * (std::max (snrs[i], 0.0) - least));
+    }
+  return least - std::log (sum / total) / curve.b;
+}
+
+double
+AbstractionErrorRateModel::GetSnr50 (WifiMode mode, const WifiTxVector &txVector) const
+{
+  return GetCurve (mode, txVector).snr50;
+}
+
+} // namespace ns3
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef ABSTRACTION_ERROR_RATE_MODEL_H
+#define ABSTRACTION_ERROR_RATE_MODEL_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include "ns3/error-rate-model.h"
+
+namespace ns3 {
+
+/**
+ * \brief Link-to-system error-rate model: one fitted PER curve per mode
+ * and an exponential effective SNR mapping.
+ *
+ * System-level studies need the packet error rate of a frame, not the
+ * bit error rate of each symbol.  For each mode, channel width, number
+ * of streams and guard interval, this model fits the curve
+ *
+ *   PER (snr) = 1 - exp (-exp (a - b snr))
+ *
+ * of the linear SNR to the frame error rate of ReferenceSize-byte frames
+ * under the reference model (NistErrorRateModel unless Model is set),
+ * through the SNRs where it gives a PER of 50% and 10%.  It is the form
+ * of a coded error rate that falls exponentially with the SNR.  Chunks of
+ * other sizes get the success rate of the reference frame raised to the
+ * relative size, so that the chunks of a frame multiply as with the Yans
+ * and Nist models.  A chunk costs two exp calls, and a curve costs two
+ * bisections of the reference model when a mode is first used.
+ *
+ * GetEffectiveSnr () maps the SNRs of the chunks of a frame to the single
+ * SNR that gives the same success rate on the curve, weighting each chunk
+ * by its length.  This is the exponential effective SNR mapping (EESM)
+ * with beta = 1 / b.  The success rate of a chunk is the term of that
+ * chunk in the mapping, so the product the PHY takes over the chunks of
+ * a frame is the success rate at its effective SNR: set on a PHY, the
+ * model decides each frame by its effective SNR, at two exp calls per
+ * chunk.  The PHY still splits the frame at each interference change;
+ * that walk belongs to InterferenceHelper.
+ *
+ * The curve matches the reference model exactly at 50% and 10% PER; the
+ * tails are less accurate than with TabulatedErrorRateModel.
+ * utils/bench-error-rate-table prints, for each mode of the Yans and Nist
+ * models, the largest error of the chunk success rate, and the largest
+ * difference between the product of the chunk success rates of a frame
+ * and the success rate at its effective SNR.  Running wifi-he-network
+ * or wifi-80211n-mimo with and without --abstraction compares the
+ * throughput over distance.
+ */
+class AbstractionErrorRateModel : public ErrorRateModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  AbstractionErrorRateModel ();
+  virtual ~AbstractionErrorRateModel ();
+
+  /**
+   * \param model the reference model
+   */
+  void SetModel (Ptr<ErrorRateModel> model);
+
+  /// \return the reference model, created if needed
+  Ptr<ErrorRateModel> GetModel (void) const;
+
+  /**
+   * \brief Map the SNRs of the chunks of a frame to one SNR.
+   *
+   * The curve of the mode gives, at the result, the product of the
+   * success rates of the chunks for the whole frame.
+   *
+   * \param mode the mode
+   * \param txVector the TXVECTOR
+   * \param snrs linear SNR of each chunk
+   * \param bits length of each chunk, in bits or any unit
+   * \return the effective linear SNR
+   */
+  double GetEffectiveSnr (WifiMode mode, const WifiTxVector &txVector,
+                          const std::vector<double> &snrs, const std::vector<double> &bits) const;
+
+  /**
+   * \param mode the mode
+   * \param txVector the TXVECTOR
+   * \return the linear SNR of 50% PER on the reference frame size
+   */
+  double GetSnr50 (WifiMode mode, const WifiTxVector &txVector) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual double DoGetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+
+  /// PER curve of a mode: -log (success rate) = exp (a - b snr).
+  struct Curve
+  {
+    double a;       //!< Log of the error exponent at SNR 0
+    double b;       //!< Decay of the exponent per unit of linear SNR
+    double snr50;   //!< Linear SNR of 50% PER
+  };
+
+  /**
+   * \param mode the mode
+   * \param txVector the TXVECTOR
+   * \return the curve of that mode, fitted if needed
+   */
+  const Curve & GetCurve (WifiMode mode, const WifiTxVector &txVector) const;
+
+  /**
+   * \param mode the mode
+   * \param txVector the TXVECTOR
+   * \param successRate success rate of a reference frame
+   * \return the linear SNR where the reference model gives it
+   */
+  double FindSnr (WifiMode mode, const WifiTxVector &txVector, double successRate) const;
+
+  /**
+   * \param size reference frame size (bytes)
+   */
+  void SetReferenceSize (uint32_t size);
+
+  mutable Ptr<ErrorRateModel> m_model;                       //!< Reference model
+  uint32_t m_referenceSize;                                  //!< Size of the fitted frames (bytes)
+  mutable std::unordered_map<uint32_t, Curve> m_curves;      //!< Curves, per key
+  mutable uint32_t m_lastKey;                                //!< Key of m_lastCurve
+  mutable const Curve *m_lastCurve;                          //!< Last curve used, 0 if none
+};
+
+} // namespace ns3
+
+#endif /* ABSTRACTION_ERROR_RATE_MODEL_H */
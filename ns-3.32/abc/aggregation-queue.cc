@@ -0,0 +1,332 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "aggregation-queue.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AggregationQueue");
+
+AggregationQueue::AggregationQueue ()
+  : m_free (NONE),
+    m_oldest (NONE),
+    m_newest (NONE),
+    m_nPackets (0),
+    m_maxPackets (500),
+    m_maxDelay (0),
+    m_dropped (0)
+{
+}
+
+void
+AggregationQueue::SetMaxPackets (uint32_t packets)
+{
+  m_maxPackets = packets;
+}
+
+void
+AggregationQueue::SetMaxDelay (int64_t ticks)
+{
+  m_maxDelay = ticks;
+}
+
+uint64_t
+AggregationQueue::GetKey (Mac48Address ra, uint8_t tid)
+{
+  uint8_t buffer[6];
+  ra.CopyTo (buffer);
+  uint64_t key = 0;
+  for (uint32_t i = 0; i < 6; ++i)
+    {
+      key = (key << 8) | buffer[i];
+    }
+  return (key << 8) | tid;
+}
+
+uint32_t
+AggregationQueue::FindFlow (Mac48Address ra, uint8_t tid) const
+{
+  std::unordered_map<uint64_t, uint32_t>::const_iterator it = m_flowIndex.find (GetKey (ra, tid));
+  return it == m_flowIndex.end () ? NONE : it->second;
+}
+
+uint32_t
+AggregationQueue::GetFlow (Mac48Address ra, uint8_t tid)
+{
+  std::pair<std::unordered_map<uint64_t, uint32_t>::iterator, bool> inserted =
+    m_flowIndex.insert (std::make_pair (GetKey (ra, tid), static_cast<uint32_t> (m_flows.size ())));
+  if (inserted.second)
+    {
+      Flow flow = {NONE, NONE, 0, 0};
+      m_flows.push_back (flow);
+    }
+  return inserted.first->second;
+}
+
+uint32_t
+AggregationQueue::Allocate (void)
+{
+  if (m_free != NONE)
+    {
+      uint32_t i = m_free;
+      m_free = m_items[i].next;
+      return i;
+    }
+  m_items.push_back (Item ());
+  return m_items.size () - 1;
+}
+
+void
+AggregationQueue::Remove (uint32_t i)
+{
+  Item &item = m_items[i];
+  Flow &flow = m_flows[item.flow];
+  if (item.prev != NONE)
+    {
+      m_items[item.prev].next = item.next;
+    }
+  else
+    {
+      flow.head = item.next;
+    }
+  if (item.next != NONE)
+    {
+      m_items[item.next].prev = item.prev;
+    }
+  else
+    {
+      flow.tail = item.prev;
+    }
+  if (item.older != NONE)
+    {
+      m_items[item.older].newer = item.newer;
+    }
+  else
+    {
+      m_oldest = item.newer;
+    }
+  if (item.newer != NONE)
+    {
+      m_items[item.newer].older = item.older;
+    }
+  else
+    {
+      m_newest = item.older;
+    }
+  --flow.nPackets;
+  flow.nBytes -= item.packet->GetSize ();
+  --m_nPackets;
+  item.packet = 0;
+  item.next = m_free;
+  m_free = i;
+}
+
+void
+AggregationQueue::Expire (int64_t now)
+{
+  if (m_maxDelay <= 0)
+    {
+      return;
+    }
+  while (m_oldest != NONE && m_items[m_oldest].enqueued + m_maxDelay < now)
+    {
+      NS_LOG_LOGIC ("expired " << m_items[m_oldest].packet);
+      Remove (m_oldest);
+      ++m_dropped;
+    }
+}
+
+bool
+AggregationQueue::Enqueue (Ptr<const Packet> packet, Mac48Address ra, uint8_t tid, int64_t now)
+{
+  Expire (now);
+  if (m_nPackets >= m_maxPackets)
+    {
+      ++m_dropped;
+      return false;
+    }
+  uint32_t f = GetFlow (ra, tid);
+  uint32_t i = Allocate ();
+  Item &item = m_items[i];
+  Flow &flow = m_flows[f];
+  item.packet = packet;
+  item.enqueued = now;
+  item.flow = f;
+  item.prev = flow.tail;
+  item.next = NONE;
+  item.older = m_newest;
+  item.newer = NONE;
+  if (flow.tail != NONE)
+    {
+      m_items[flow.tail].next = i;
+    }
+  else
+    {
+      flow.head = i;
+    }
+  flow.tail = i;
+  if (m_newest != NONE)
+    {
+      m_items[m_newest].newer = i;
+    }
+  else
+    {
+      m_oldest = i;
+    }
+  m_newest = i;
+  ++flow.nPackets;
+  flow.nBytes += packet->GetSize ();
+  ++m_nPackets;
+  return true;
+}
+
+void
+AggregationQueue::PushFront (Ptr<const Packet> packet, Mac48Address ra, uint8_t tid, int64_t enqueued)
+{
+  uint32_t f = GetFlow (ra, tid);
+  uint32_t i = Allocate ();
+  Item &item = m_items[i];
+  Flow &flow = m_flows[f];
+  item.packet = packet;
+  item.enqueued = enqueued;
+  item.flow = f;
+  item.prev = NONE;
+  item.next = flow.head;
+  if (flow.head != NONE)
+    {
+      m_items[flow.head].prev = i;
+    }
+  else
+    {
+      flow.tail = i;
+    }
+  flow.head = i;
+  // Expire () stops at the first item that has not expired, so the
+  // arrival order stays sorted by enqueue tick: the packet goes after
+  // the items enqueued before or with it.
+  uint32_t newer = m_oldest;
+  while (newer != NONE && m_items[newer].enqueued <= enqueued)
+    {
+      newer = m_items[newer].newer;
+    }
+  item.newer = newer;
+  item.older = newer != NONE ? m_items[newer].older : m_newest;
+  if (item.older != NONE)
+    {
+      m_items[item.older].newer = i;
+    }
+  else
+    {
+      m_oldest = i;
+    }
+  if (newer != NONE)
+    {
+      m_items[newer].older = i;
+    }
+  else
+    {
+      m_newest = i;
+    }
+  ++flow.nPackets;
+  flow.nBytes += packet->GetSize ();
+  ++m_nPackets;
+}
+
+Ptr<const Packet>
+AggregationQueue::Peek (Mac48Address ra, uint8_t tid, int64_t now)
+{
+  Expire (now);
+  uint32_t f = FindFlow (ra, tid);
+  if (f == NONE || m_flows[f].head == NONE)
+    {
+      return 0;
+    }
+  return m_items[m_flows[f].head].packet;
+}
+
+Ptr<const Packet>
+AggregationQueue::Dequeue (Mac48Address ra, uint8_t tid, int64_t now)
+{
+  Expire (now);
+  uint32_t f = FindFlow (ra, tid);
+  if (f == NONE || m_flows[f].head == NONE)
+    {
+      return 0;
+    }
+  uint32_t i = m_flows[f].head;
+  Ptr<const Packet> packet = m_items[i].packet;
+  Remove (i);
+  return packet;
+}
+
+uint32_t
+AggregationQueue::Build (Mac48Address ra, uint8_t tid, int64_t now, uint32_t maxBytes,
+                         uint32_t maxItems, uint32_t header, Aggregate &aggregate)
+{
+  aggregate.packets.clear ();
+  aggregate.size = 0;
+  Expire (now);
+  uint32_t f = FindFlow (ra, tid);
+  if (f == NONE)
+    {
+      return 0;
+    }
+  while (m_flows[f].head != NONE && aggregate.packets.size () < maxItems)
+    {
+      uint32_t i = m_flows[f].head;
+      uint32_t size = header + m_items[i].packet->GetSize ();
+      // The previous subframe is padded to 4 bytes once another follows.
+      uint32_t total = aggregate.packets.empty () ? size : ((aggregate.size + 3) & ~3u) + size;
+      if (total > maxBytes)
+        {
+          break;
+        }
+      aggregate.size = total;
+      aggregate.packets.push_back (m_items[i].packet);
+      Remove (i);
+    }
+  NS_LOG_DEBUG (aggregate.packets.size () << " subframes, " << aggregate.size << " bytes");
+  return aggregate.packets.size ();
+}
+
+uint32_t
+AggregationQueue::BuildAmpdu (Mac48Address ra, uint8_t tid, int64_t now,
+                              uint32_t maxBytes, uint32_t maxMpdus, Aggregate &ampdu)
+{
+  return Build (ra, tid, now, maxBytes, maxMpdus, 4, ampdu);
+}
+
+uint32_t
+AggregationQueue::BuildAmsdu (Mac48Address ra, uint8_t tid, int64_t now,
+                              uint32_t maxBytes, Aggregate &amsdu)
+{
+  return Build (ra, tid, now, maxBytes, 0xffffffff, 14, amsdu);
+}
+
+uint32_t
+AggregationQueue::GetNPackets (Mac48Address ra, uint8_t tid) const
+{
+  uint32_t f = FindFlow (ra, tid);
+  return f == NONE ? 0 : m_flows[f].nPackets;
+}
+
+uint32_t
+AggregationQueue::GetNBytes (Mac48Address ra, uint8_t tid) const
+{
+  uint32_t f = FindFlow (ra, tid);
+  return f == NONE ? 0 : m_flows[f].nBytes;
+}
+
+uint32_t
+AggregationQueue::GetNPackets (void) const
+{
+  return m_nPackets;
+}
+
+uint64_t
+AggregationQueue::GetNDropped (void) const
+{
+  return m_dropped;
+}
+
+} // namespace ns3
@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef AGGREGATION_QUEUE_H
+#define AGGREGATION_QUEUE_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include "ns3/mac48-address.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+/**
+ * \brief MPDU queue with one list per (receiver, TID), building A-MPDUs
+ * and A-MSDUs as lists of packets.
+ *
+ * WifiMacQueue keeps the MPDUs of all receivers and TIDs in one
+ * std::list: finding the next MPDU for a receiver and TID walks the list
+ * from its head, and an A-MPDU of n MPDUs does it n times before the
+ * aggregator copies each MPDU, its delimiter and its padding into one
+ * packet.  Under saturation with many stations this dominates the MAC.
+ *
+ * Here the items live in a slab, a vector whose free slots are reused,
+ * and each one is linked by indices both in arrival order, for the size
+ * limit and the expiry, and in the list of its (receiver, TID) flow.
+ * Peeking, dequeuing and removing are O(1) whatever the number of
+ * flows.  BuildAmpdu () and BuildAmsdu () dequeue the head of a flow into
+ * an Aggregate: the packets themselves, in order, with the size the
+ * aggregate has on air.  Nothing is copied; the PHY serializes the
+ * packets one after another when it needs the bytes.
+ *
+ * Times are integer ticks, such as Time::GetTimeStep ().  Items older
+ * than the maximum delay are dropped from the head of the arrival order
+ * before each operation, as WifiMacQueue does.
+ */
+class AggregationQueue
+{
+public:
+  /// Packets of an aggregate and its size on air.
+  struct Aggregate
+  {
+    std::vector<Ptr<const Packet> > packets; //!< Subframes, in order
+    uint32_t size;                           //!< Bytes on air, delimiters and padding included
+  };
+
+  AggregationQueue ();
+
+  /**
+   * \param packets maximum number of queued packets; newer ones are
+   * dropped beyond it
+   */
+  void SetMaxPackets (uint32_t packets);
+
+  /**
+   * \param ticks maximum time an item waits, 0 for no limit
+   */
+  void SetMaxDelay (int64_t ticks);
+
+  /**
+   * \param packet the MPDU, MAC header and FCS included, or the MSDU
+   * \param ra the receiver address
+   * \param tid the TID
+   * \param now the current tick
+   * \return false if the packet was dropped
+   */
+  bool Enqueue (Ptr<const Packet> packet, Mac48Address ra, uint8_t tid, int64_t now);
+
+  /**
+   * \brief Put back a packet at the head of its flow, for retransmission.
+   *
+   * It keeps its original enqueue tick, and goes in arrival order after
+   * the items enqueued before or at that tick, so that it expires with
+   * them; finding its place walks the arrival order from the oldest item.
+   *
+   * \param packet the packet
+   * \param ra the receiver address
+   * \param tid the TID
+   * \param enqueued the tick it was first enqueued at
+   */
+  void PushFront (Ptr<const Packet> packet, Mac48Address ra, uint8_t tid, int64_t enqueued);
+
+  /**
+   * \param ra the receiver address
+   * \param tid the TID
+   * \param now the current tick
+   * \return the head of the flow, 0 if none
+   */
+  Ptr<const Packet> Peek (Mac48Address ra, uint8_t tid, int64_t now);
+
+  /**
+   * \param ra the receiver address
+   * \param tid the TID
+   * \param now the current tick
+   * \return the head of the flow, removed, 0 if none
+   */
+  Ptr<const Packet> Dequeue (Mac48Address ra, uint8_t tid, int64_t now);
+
+  /**
+   * \brief Dequeue the head MPDUs of a flow into an A-MPDU.
+   *
+   * Each MPDU takes a 4-byte delimiter and is padded to 4 bytes, except
+   * the last one.
+   *
+   * \param ra the receiver address
+   * \param tid the TID
+   * \param now the current tick
+   * \param maxBytes maximum A-MPDU size
+   * \param maxMpdus maximum number of MPDUs, such as the block ack window
+   * \param ampdu output
+   * \return the number of MPDUs
+   */
+  uint32_t BuildAmpdu (Mac48Address ra, uint8_t tid, int64_t now,
+                       uint32_t maxBytes, uint32_t maxMpdus, Aggregate &ampdu);
+
+  /**
+   * \brief Dequeue the head MSDUs of a flow into an A-MSDU.
+   *
+   * Each MSDU takes a 14-byte subframe header and is padded to 4 bytes,
+   * except the last one.
+   *
+   * \param ra the receiver address
+   * \param tid the TID
+   * \param now the current tick
+   * \param maxBytes maximum A-MSDU size
+   * \param amsdu output
+   * \return the number of MSDUs
+   */
+  uint32_t BuildAmsdu (Mac48Address ra, uint8_t tid, int64_t now,
+                       uint32_t maxBytes, Aggregate &amsdu);
+
+  /**
+   * \param ra the receiver address
+   * \param tid the TID
+   * \return the number of packets of the flow
+   */
+  uint32_t GetNPackets (Mac48Address ra, uint8_t tid) const;
+
+  /**
+   * \param ra the receiver address
+   * \param tid the TID
+   * \return the number of bytes of the flow
+   */
+  uint32_t GetNBytes (Mac48Address ra, uint8_t tid) const;
+
+  /// \return the number of packets of all flows
+  uint32_t GetNPackets (void) const;
+
+  /// \return the number of packets dropped, full or expired
+  uint64_t GetNDropped (void) const;
+
+private:
+  static const uint32_t NONE = 0xffffffff; //!< Null index
+
+  /// Queued packet, linked in its flow and in arrival order.
+  struct Item
+  {
+    Ptr<const Packet> packet; //!< The packet
+    int64_t enqueued;         //!< Tick it was enqueued at
+    uint32_t flow;            //!< Index of its flow
+    uint32_t prev;            //!< Previous item of the flow
+    uint32_t next;            //!< Next item of the flow, or next free slot
+    uint32_t older;           //!< Previous item in arrival order
+    uint32_t newer;           //!< Next item in arrival order
+  };
+
+  /// List of the items of one (receiver, TID).
+  struct Flow
+  {
+    uint32_t head;     //!< First item
+    uint32_t tail;     //!< Last item
+    uint32_t nPackets; //!< Items in the list
+    uint32_t nBytes;   //!< Bytes in the list
+  };
+
+  /**
+   * \param ra the receiver address
+   * \param tid the TID
+   * \return the key of the flow
+   */
+  static uint64_t GetKey (Mac48Address ra, uint8_t tid);
+
+  /**
+   * \param ra the receiver address
+   * \param tid the TID
+   * \return the index of the flow, NONE if it never had packets
+   */
+  uint32_t FindFlow (Mac48Address ra, uint8_t tid) const;
+
+  /**
+   * \param ra the receiver address
+   * \param tid the TID
+   * \return the index of the flow, created if needed
+   */
+  uint32_t GetFlow (Mac48Address ra, uint8_t tid);
+
+  /**
+   * \return a free slot of the slab
+   */
+  uint32_t Allocate (void);
+
+  /**
+   * \brief Unlink an item and free its slot.
+   * \param i the item
+   */
+  void Remove (uint32_t i);
+
+  /**
+   * \brief Drop the expired items, oldest first.
+   * \param now the current tick
+   */
+  void Expire (int64_t now);
+
+  /**
+   * \param ra the receiver address
+   * \param tid the TID
+   * \param now the current tick
+   * \param maxBytes maximum aggregate size
+   * \param maxItems maximum number of subframes
+   * \param header bytes added to each subframe
+   * \param aggregate output
+   * \return the number of subframes
+   */
+  uint32_t Build (Mac48Address ra, uint8_t tid, int64_t now, uint32_t maxBytes,
+                  uint32_t maxItems, uint32_t header, Aggregate &aggregate);
+
+  std::vector<Item> m_items;                  //!< Slab of items
+  uint32_t m_free;                            //!< First free slot, chained by next
+  std::vector<Flow> m_flows;                  //!< Flows
+  std::unordered_map<uint64_t, uint32_t> m_flowIndex; //!< Index of each flow key
+  uint32_t m_oldest;                          //!< First item in arrival order
+  uint32_t m_newest;                          //!< Last item in arrival order
+  uint32_t m_nPackets;                        //!< Queued packets
+  uint32_t m_maxPackets;                      //!< Size limit
+  int64_t m_maxDelay;                         //!< Expiry, 0 for none
+  uint64_t m_dropped;                         //!< Dropped packets
+};
+
+} // namespace ns3
+
+#endif /* AGGREGATION_QUEUE_H */
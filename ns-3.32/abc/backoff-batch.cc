@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "backoff-batch.h"
+#include "ns3/log.h"
+#include "ns3/rng-seed-manager.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BackoffBatch");
+
+BackoffBatch::BackoffBatch (uint32_t nStations, Time slotTime, uint32_t minSlots, uint32_t maxSlots,
+                            uint32_t ceiling, uint32_t maxRetries)
+  : m_slotTime (slotTime),
+    m_minSlots (minSlots),
+    m_maxSlots (maxSlots),
+    m_ceiling (ceiling),
+    m_maxRetries (maxRetries),
+    m_retries (nStations, 0),
+    m_draw (0)
+{
+  NS_LOG_FUNCTION (this << nStations << slotTime << minSlots << maxSlots << ceiling << maxRetries);
+  AssignStreams (RngSeedManager::GetNextStreamIndex ());
+}
+
+uint32_t
+BackoffBatch::GetNStations (void) const
+{
+  return m_retries.size ();
+}
+
+Time
+BackoffBatch::GetSlotTime (void) const
+{
+  return m_slotTime;
+}
+
+void
+BackoffBatch::GetBackoffSlots (uint32_t *slots)
+{
+  NS_LOG_FUNCTION (this << slots);
+  const uint32_t n = m_retries.size ();
+  const uint32_t *retries = m_retries.data ();
+  const uint32_t run = static_cast<uint32_t> (RngSeedManager::GetRun ());
+  const uint32_t drawLow = static_cast<uint32_t> (m_draw);
+  const uint32_t drawHigh = static_cast<uint32_t> (m_draw >> 32);
+  ++m_draw;
+
+  // Each Philox block yields the draws of four consecutive stations.  The
+  // loop body has no data-dependent branch so that it can be vectorized.
+  for (uint32_t first = 0; first < n; first += 4)
+    {
+      const uint32_t counter[4] = {first / 4, drawLow, drawHigh, run};
+      uint32_t random[4];
+      Philox4x32::Generate (counter, m_key, random);
+      const uint32_t count = n - first < 4 ? n - first : 4;
+      for (uint32_t j = 0; j < count; ++j)
+        {
+          // Same range as Backoff::GetBackoffTime ().
+          uint32_t exponent = retries[first + j];
+          exponent = (m_ceiling > 0 && exponent > m_ceiling) ? m_ceiling : exponent;
+          exponent = exponent > 31 ? 31 : exponent;
+          uint32_t maxSlot = (1u << exponent) - 1;
+          maxSlot = maxSlot > m_maxSlots ? m_maxSlots : maxSlot;
+          // Backoff truncates min + u * (max - min) with u in [0, 1), which
+          // when max < min (e.g. no retry yet and minSlots = 1) lies in
+          // (max, min] and truncates towards max rather than min.  Both
+          // cases are computed from 32 random bits and the right one picked.
+          const uint64_t r = random[j];
+          const bool up = maxSlot >= m_minSlots;
+          const uint32_t span = up ? maxSlot - m_minSlots : m_minSlots - maxSlot;
+          const uint32_t below = static_cast<uint32_t> ((r * span) >> 32);
+          const uint32_t above = static_cast<uint32_t> ((r * span + 0xffffffffu) >> 32);
+          slots[first + j] = up ? m_minSlots + below : m_minSlots - above;
+        }
+    }
+}
+
+uint32_t
+BackoffBatch::UpdateRetries (const uint8_t *failed, uint8_t *dropped)
+{
+  NS_LOG_FUNCTION (this << failed << dropped);
+  const uint32_t n = m_retries.size ();
+  uint32_t *retries = m_retries.data ();
+  uint32_t nDropped = 0;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      uint32_t next = failed[i] ? retries[i] + 1 : 0;
+      uint32_t drop = next >= m_maxRetries ? 1 : 0;
+      retries[i] = drop ? 0 : next;
+      nDropped += drop;
+      if (dropped != 0)
+        {
+          dropped[i] = drop;
+        }
+    }
+  return nDropped;
+}
+
+uint32_t
+BackoffBatch::GetNumRetries (uint32_t station) const
+{
+  return m_retries[station];
+}
+
+bool
+BackoffBatch::MaxRetriesReached (uint32_t station) const
+{
+  return m_retries[station] >= m_maxRetries;
+}
+
+void
+BackoffBatch::IncrNumRetries (uint32_t station)
+{
+  ++m_retries[station];
+}
+
+void
+BackoffBatch::ResetBackoffTime (uint32_t station)
+{
+  m_retries[station] = 0;
+}
+
+int64_t
+BackoffBatch::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_key[0] = RngSeedManager::GetSeed ();
+  m_key[1] = static_cast<uint32_t> (stream) ^ static_cast<uint32_t> (static_cast<uint64_t> (stream) >> 32);
+  m_draw = 0;
+  return 1;
+}
+
+} // namespace ns3
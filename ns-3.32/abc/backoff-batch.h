@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef BACKOFF_BATCH_H
+#define BACKOFF_BATCH_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \brief Philox4x32-10 counter-based random number generator.
+ *
+ * Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC 2011.
+ * Each (key, counter) pair maps to four independent 32-bit values with no
+ * state carried between calls, so any element of a stream can be
+ * computed directly and loops over counters vectorize.
+ */
+class Philox4x32
+{
+public:
+  /**
+   * \brief Compute one block of the stream.
+   * \param counter 128-bit counter
+   * \param key 64-bit key
+   * \param out the four 32-bit outputs
+   */
+  static inline void Generate (const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);
+};
+
+/**
+ * \brief Backoff state for many stations, drawn in one call.
+ *
+ * Computes the same slot distribution as ns3::Backoff::GetBackoffTime ()
+ * (binary exponential range capped by the ceiling and by maxSlots, and the
+ * same truncation when that range ends below minSlots, e.g. 0 slots before
+ * the first retry with minSlots = 1) for every station at once.  Retry counters are stored contiguously and the
+ * random slots come from Philox4x32 keyed by the global seed, run and
+ * stream number, with the station index and draw number as counter.  A
+ * station therefore sees the same sequence whatever the number of
+ * stations or the order of the calls.
+ */
+class BackoffBatch
+{
+public:
+  /**
+   * \param nStations number of stations
+   * \param slotTime length of one slot
+   * \param minSlots minimum number of backoff slots
+   * \param maxSlots maximum number of backoff slots
+   * \param ceiling cap to the exponential function
+   * \param maxRetries maximum number of transmission retries
+   */
+  BackoffBatch (uint32_t nStations, Time slotTime, uint32_t minSlots, uint32_t maxSlots,
+                uint32_t ceiling, uint32_t maxRetries);
+
+  /**
+   * \return the number of stations
+   */
+  uint32_t GetNStations (void) const;
+
+  /**
+   * \return the length of one slot
+   */
+  Time GetSlotTime (void) const;
+
+  /**
+   * \brief Draw the backoff of every station.
+   * \param slots array of GetNStations () entries receiving the number of
+   * slots each station waits
+   *
+   * Multiply by GetSlotTime () to get the time Backoff::GetBackoffTime ()
+   * would return.
+   */
+  void GetBackoffSlots (uint32_t *slots);
+
+  /**
+   * \brief Apply the outcome of one contention round to every station.
+   * \param failed array of GetNStations () entries, non-zero for stations
+   * whose transmission failed
+   * \param dropped optional array of GetNStations () entries, set to 1 for
+   * stations that reached maxRetries and gave up on their packet
+   * \return the number of stations that gave up
+   *
+   * Failed stations increment their retry count; stations that succeeded
+   * or gave up start again from zero.
+   */
+  uint32_t UpdateRetries (const uint8_t *failed, uint8_t *dropped = 0);
+
+  /**
+   * \param station station index
+   * \return the retry count of the station
+   */
+  uint32_t GetNumRetries (uint32_t station) const;
+
+  /**
+   * \param station station index
+   * \return true if the station reached the maximum number of retries
+   */
+  bool MaxRetriesReached (uint32_t station) const;
+
+  /**
+   * \param station station index
+   */
+  void IncrNumRetries (uint32_t station);
+
+  /**
+   * \param station station index
+   */
+  void ResetBackoffTime (uint32_t station);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+private:
+  Time m_slotTime;                  //!< Length of one slot
+  uint32_t m_minSlots;              //!< Minimum number of backoff slots
+  uint32_t m_maxSlots;              //!< Maximum number of backoff slots
+  uint32_t m_ceiling;               //!< Cap to the exponential function
+  uint32_t m_maxRetries;            //!< Maximum number of retries
+  std::vector<uint32_t> m_retries;  //!< Retry count of each station
+  uint32_t m_key[2];                //!< Philox key
+  uint64_t m_draw;                  //!< Number of GetBackoffSlots calls
+};
+
+
+void
+Philox4x32::Generate (const uint32_t counter[4], const uint32_t key[2], uint32_t out[4])
+{
+  uint32_t c0 = counter[0];
+  uint32_t c1 = counter[1];
+  uint32_t c2 = counter[2];
+  uint32_t c3 = counter[3];
+  uint32_t k0 = key[0];
+  uint32_t k1 = key[1];
+  for (int round = 0; round < 10; ++round)
+    {
+      uint64_t p0 = static_cast<uint64_t> (0xD2511F53) * c0;
+      uint64_t p1 = static_cast<uint64_t> (0xCD9E8D57) * c2;
+      uint32_t n0 = static_cast<uint32_t> (p1 >> 32) ^ c1 ^ k0;
+      uint32_t n2 = static_cast<uint32_t> (p0 >> 32) ^ c3 ^ k1;
+      c1 = static_cast<uint32_t> (p1);
+      c3 = static_cast<uint32_t> (p0);
+      c0 = n0;
+      c2 = n2;
+      k0 += 0x9E3779B9;
+      k1 += 0xBB67AE85;
+    }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
+} // namespace ns3
+
+#endif /* BACKOFF_BATCH_H */
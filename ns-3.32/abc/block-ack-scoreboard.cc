@@ -0,0 +1,319 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "block-ack-scoreboard.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BlockAckScoreboard");
+
+namespace {
+
+/**
+ * \param n a number of bits
+ * \return a word with its n low bits set
+ */
+inline uint64_t
+LowBits (uint32_t n)
+{
+  return n >= 64 ? ~static_cast<uint64_t> (0) : (static_cast<uint64_t> (1) << n) - 1;
+}
+
+/**
+ * \param from a sequence number
+ * \param to another one
+ * \return to - from modulo 4096
+ */
+inline uint16_t
+Distance (uint16_t from, uint16_t to)
+{
+  return (to - from) & 0xfff;
+}
+
+/**
+ * \param bitmap a block ack bitmap
+ * \param nBits its number of bits
+ * \param index first bit to read, may be negative
+ * \return bits index to index + 63, zero outside [0, nBits)
+ */
+uint64_t
+ReadBits (const uint64_t *bitmap, uint16_t nBits, int32_t index)
+{
+  if (index <= -64 || index >= nBits)
+    {
+      return 0;
+    }
+  if (index < 0)
+    {
+      return ReadBits (bitmap, nBits, 0) << -index;
+    }
+  uint32_t w = index / 64;
+  uint32_t shift = index % 64;
+  uint64_t word = bitmap[w] >> shift;
+  if (shift != 0 && (w + 1) * 64 < nBits)
+    {
+      word |= bitmap[w + 1] << (64 - shift);
+    }
+  return word & LowBits (nBits - index);
+}
+
+} // unnamed namespace
+
+SequenceBitmap::SequenceBitmap ()
+{
+  Clear ();
+}
+
+void
+SequenceBitmap::Clear (void)
+{
+  for (uint32_t i = 0; i < SIZE / 64; ++i)
+    {
+      m_words[i] = 0;
+    }
+}
+
+void
+SequenceBitmap::Set (uint16_t seq)
+{
+  uint32_t p = seq % SIZE;
+  m_words[p / 64] |= static_cast<uint64_t> (1) << (p % 64);
+}
+
+bool
+SequenceBitmap::Test (uint16_t seq) const
+{
+  uint32_t p = seq % SIZE;
+  return (m_words[p / 64] >> (p % 64)) & 1;
+}
+
+uint64_t
+SequenceBitmap::GetWord (uint16_t seq) const
+{
+  uint32_t p = seq % SIZE;
+  uint32_t w = p / 64;
+  uint32_t shift = p % 64;
+  uint64_t word = m_words[w] >> shift;
+  if (shift != 0)
+    {
+      word |= m_words[(w + 1) % (SIZE / 64)] << (64 - shift);
+    }
+  return word;
+}
+
+void
+SequenceBitmap::OrWord (uint16_t seq, uint64_t word)
+{
+  uint32_t p = seq % SIZE;
+  uint32_t w = p / 64;
+  uint32_t shift = p % 64;
+  m_words[w] |= word << shift;
+  if (shift != 0)
+    {
+      m_words[(w + 1) % (SIZE / 64)] |= word >> (64 - shift);
+    }
+}
+
+void
+SequenceBitmap::ClearWord (uint16_t seq, uint64_t mask)
+{
+  uint32_t p = seq % SIZE;
+  uint32_t w = p / 64;
+  uint32_t shift = p % 64;
+  m_words[w] &= ~(mask << shift);
+  if (shift != 0)
+    {
+      m_words[(w + 1) % (SIZE / 64)] &= ~(mask >> (64 - shift));
+    }
+}
+
+void
+SequenceBitmap::ClearRange (uint16_t seq, uint32_t n)
+{
+  if (n >= SIZE)
+    {
+      Clear ();
+      return;
+    }
+  for (uint32_t off = 0; off < n; off += 64)
+    {
+      ClearWord (seq + off, LowBits (n - off));
+    }
+}
+
+BlockAckOriginator::BlockAckOriginator (uint16_t winStart, uint16_t winSize)
+{
+  Reset (winStart, winSize);
+}
+
+void
+BlockAckOriginator::Reset (uint16_t winStart, uint16_t winSize)
+{
+  NS_ASSERT (winSize > 0 && winSize <= SequenceBitmap::SIZE);
+  m_sent.Clear ();
+  m_done.Clear ();
+  m_winStart = winStart & 0xfff;
+  m_winSize = winSize;
+}
+
+uint16_t
+BlockAckOriginator::GetWinStart (void) const
+{
+  return m_winStart;
+}
+
+bool
+BlockAckOriginator::IsInWindow (uint16_t seq) const
+{
+  return Distance (m_winStart, seq) < m_winSize;
+}
+
+void
+BlockAckOriginator::NotifySent (uint16_t seq)
+{
+  NS_ASSERT_MSG (IsInWindow (seq), "MPDU " << seq << " outside the window at " << m_winStart);
+  m_sent.Set (seq);
+}
+
+uint32_t
+BlockAckOriginator::NotifyBlockAck (uint16_t startingSeq, const uint64_t *bitmap, uint16_t nBits)
+{
+  // Index in the bitmap of the window start, negative if it precedes the
+  // starting sequence number.
+  int32_t base = ((Distance (startingSeq, m_winStart) + 2048) & 0xfff) - 2048;
+  uint32_t acked = 0;
+  for (uint32_t off = 0; off < m_winSize; off += 64)
+    {
+      uint16_t seq = m_winStart + off;
+      uint64_t ack = ReadBits (bitmap, nBits, base + off) & m_sent.GetWord (seq) & LowBits (m_winSize - off);
+      uint64_t fresh = ack & ~m_done.GetWord (seq);
+      acked += __builtin_popcountll (fresh);
+      m_done.OrWord (seq, fresh);
+    }
+  Advance ();
+  NS_LOG_DEBUG ("block ack at " << startingSeq << ": " << acked << " acked, window at " << m_winStart);
+  return acked;
+}
+
+void
+BlockAckOriginator::NotifyDiscarded (uint16_t seq)
+{
+  if (IsInWindow (seq))
+    {
+      m_done.Set (seq);
+      Advance ();
+    }
+}
+
+void
+BlockAckOriginator::Advance (void)
+{
+  for (;;)
+    {
+      uint64_t notDone = ~m_done.GetWord (m_winStart);
+      uint32_t n = notDone == 0 ? 64 : __builtin_ctzll (notDone);
+      if (n == 0)
+        {
+          return;
+        }
+      m_done.ClearWord (m_winStart, LowBits (n));
+      m_sent.ClearWord (m_winStart, LowBits (n));
+      m_winStart = (m_winStart + n) & 0xfff;
+    }
+}
+
+uint32_t
+BlockAckOriginator::GetRetransmissions (std::vector<uint16_t> &seqs) const
+{
+  seqs.clear ();
+  for (uint32_t off = 0; off < m_winSize; off += 64)
+    {
+      uint16_t seq = m_winStart + off;
+      uint64_t pending = m_sent.GetWord (seq) & ~m_done.GetWord (seq) & LowBits (m_winSize - off);
+      while (pending != 0)
+        {
+          seqs.push_back ((seq + __builtin_ctzll (pending)) & 0xfff);
+          pending &= pending - 1;
+        }
+    }
+  return seqs.size ();
+}
+
+uint32_t
+BlockAckOriginator::GetNInFlight (void) const
+{
+  uint32_t n = 0;
+  for (uint32_t off = 0; off < m_winSize; off += 64)
+    {
+      uint16_t seq = m_winStart + off;
+      n += __builtin_popcountll (m_sent.GetWord (seq) & ~m_done.GetWord (seq) & LowBits (m_winSize - off));
+    }
+  return n;
+}
+
+BlockAckRecipient::BlockAckRecipient (uint16_t winStart, uint16_t winSize)
+{
+  Reset (winStart, winSize);
+}
+
+void
+BlockAckRecipient::Reset (uint16_t winStart, uint16_t winSize)
+{
+  NS_ASSERT (winSize > 0 && winSize <= SequenceBitmap::SIZE);
+  m_received.Clear ();
+  m_winStart = winStart & 0xfff;
+  m_winSize = winSize;
+}
+
+uint16_t
+BlockAckRecipient::GetWinStart (void) const
+{
+  return m_winStart;
+}
+
+void
+BlockAckRecipient::MoveTo (uint16_t winStart)
+{
+  m_received.ClearRange (m_winStart, Distance (m_winStart, winStart));
+  m_winStart = winStart;
+}
+
+void
+BlockAckRecipient::NotifyReceived (uint16_t seq)
+{
+  seq &= 0xfff;
+  uint16_t d = Distance (m_winStart, seq);
+  if (d >= 2048)
+    {
+      return;
+    }
+  if (d >= m_winSize)
+    {
+      MoveTo ((seq - m_winSize + 1) & 0xfff);
+    }
+  m_received.Set (seq);
+}
+
+void
+BlockAckRecipient::NotifyBlockAckRequest (uint16_t startingSeq)
+{
+  startingSeq &= 0xfff;
+  uint16_t d = Distance (m_winStart, startingSeq);
+  if (d > 0 && d < 2048)
+    {
+      MoveTo (startingSeq);
+    }
+}
+
+uint16_t
+BlockAckRecipient::FillBitmap (std::vector<uint64_t> &bitmap) const
+{
+  bitmap.resize ((m_winSize + 63) / 64);
+  for (uint32_t k = 0; k < bitmap.size (); ++k)
+    {
+      bitmap[k] = m_received.GetWord (m_winStart + 64 * k) & LowBits (m_winSize - 64 * k);
+    }
+  return m_winStart;
+}
+
+} // namespace ns3
@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef BLOCK_ACK_SCOREBOARD_H
+#define BLOCK_ACK_SCOREBOARD_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief One bit per sequence number, in a ring of 1024 bits.
+ *
+ * Sequence number s maps to bit s mod 1024; since 4096 is a multiple of
+ * 1024, any window of up to 1024 sequence numbers maps to distinct bits,
+ * across the wrap of the sequence space too.  Reads and writes take 64
+ * consecutive sequence numbers at a time.
+ */
+class SequenceBitmap
+{
+public:
+  SequenceBitmap ();
+
+  /// Number of bits of the ring, the largest window it holds.
+  static const uint16_t SIZE = 1024;
+
+  /// Clear all bits.
+  void Clear (void);
+
+  /**
+   * \param seq a sequence number
+   */
+  void Set (uint16_t seq);
+
+  /**
+   * \param seq a sequence number
+   * \return its bit
+   */
+  bool Test (uint16_t seq) const;
+
+  /**
+   * \param seq a sequence number
+   * \return the bits of seq to seq + 63, seq in bit 0
+   */
+  uint64_t GetWord (uint16_t seq) const;
+
+  /**
+   * \param seq a sequence number
+   * \param word bits to set, seq in bit 0
+   */
+  void OrWord (uint16_t seq, uint64_t word);
+
+  /**
+   * \param seq a sequence number
+   * \param mask bits to clear, seq in bit 0
+   */
+  void ClearWord (uint16_t seq, uint64_t mask);
+
+  /**
+   * \brief Clear the bits of a range of sequence numbers.
+   * \param seq first sequence number
+   * \param n number of sequence numbers; all the ring if n >= SIZE
+   */
+  void ClearRange (uint16_t seq, uint32_t n);
+
+private:
+  uint64_t m_words[SIZE / 64]; //!< The ring
+};
+
+/**
+ * \brief Transmit scoreboard of a block ack agreement, as two bitmaps.
+ *
+ * The BlockAckManager of the wifi module keeps the MPDUs in flight of an
+ * agreement in a std::list; each block ack walks the list and tests the
+ * bit of each MPDU, and the unacknowledged ones are moved to a
+ * retransmission list.  Here the window has one bit per sequence number
+ * in a SequenceBitmap for the MPDUs sent and one for those done
+ * (acknowledged or discarded).  A block ack is ANDed and ORed in 64
+ * sequence numbers at a time, the window start moves over the done
+ * prefix by counting trailing ones, and the retransmissions are the
+ * sent and not done bits.  An agreement takes 260 bytes whatever its
+ * window, and a block ack of a 256-MPDU window costs a few dozen word
+ * operations.
+ *
+ * Sequence numbers are 12-bit, as in the MAC header.
+ */
+class BlockAckOriginator
+{
+public:
+  /**
+   * \param winStart starting sequence number
+   * \param winSize window size, at most SequenceBitmap::SIZE
+   */
+  BlockAckOriginator (uint16_t winStart = 0, uint16_t winSize = 64);
+
+  /**
+   * \brief Start over with an empty window.
+   * \param winStart starting sequence number
+   * \param winSize window size, at most SequenceBitmap::SIZE
+   */
+  void Reset (uint16_t winStart, uint16_t winSize);
+
+  /// \return the starting sequence number of the window
+  uint16_t GetWinStart (void) const;
+
+  /**
+   * \param seq a sequence number
+   * \return true if it is in the window
+   */
+  bool IsInWindow (uint16_t seq) const;
+
+  /**
+   * \param seq sequence number of an MPDU sent, in the window
+   */
+  void NotifySent (uint16_t seq);
+
+  /**
+   * \brief Account a block ack.
+   *
+   * Bit i of the bitmap acknowledges sequence number startingSeq + i;
+   * bits outside the window or for MPDUs not sent are ignored.  The
+   * window then starts at the first MPDU not done.
+   *
+   * \param startingSeq starting sequence number of the block ack
+   * \param bitmap the bitmap, 64 sequence numbers per word
+   * \param nBits number of bits of the bitmap
+   * \return the number of MPDUs acknowledged by this block ack
+   */
+  uint32_t NotifyBlockAck (uint16_t startingSeq, const uint64_t *bitmap, uint16_t nBits);
+
+  /**
+   * \brief Give up an MPDU, e.g. when its lifetime expired.
+   * \param seq its sequence number
+   */
+  void NotifyDiscarded (uint16_t seq);
+
+  /**
+   * \param seqs output, the MPDUs sent and not done, in window order
+   * \return their number
+   */
+  uint32_t GetRetransmissions (std::vector<uint16_t> &seqs) const;
+
+  /// \return the number of MPDUs sent and not done
+  uint32_t GetNInFlight (void) const;
+
+private:
+  /// Move the window start over the done MPDUs.
+  void Advance (void);
+
+  SequenceBitmap m_sent;  //!< MPDUs sent
+  SequenceBitmap m_done;  //!< MPDUs acknowledged or discarded
+  uint16_t m_winStart;    //!< Starting sequence number
+  uint16_t m_winSize;     //!< Window size
+};
+
+/**
+ * \brief Receive scoreboard of a block ack agreement, as one bitmap.
+ *
+ * The BlockAckCache of the wifi module keeps a std::vector<bool> and
+ * moves the window bit by bit.  Here the received MPDUs of the window
+ * are bits of a SequenceBitmap: moving the window clears the bits left
+ * behind a word at a time, and the bitmap of a block ack is read out 64
+ * sequence numbers at a time.
+ */
+class BlockAckRecipient
+{
+public:
+  /**
+   * \param winStart starting sequence number
+   * \param winSize window size, at most SequenceBitmap::SIZE
+   */
+  BlockAckRecipient (uint16_t winStart = 0, uint16_t winSize = 64);
+
+  /**
+   * \brief Start over with an empty window.
+   * \param winStart starting sequence number
+   * \param winSize window size, at most SequenceBitmap::SIZE
+   */
+  void Reset (uint16_t winStart, uint16_t winSize);
+
+  /// \return the starting sequence number of the window
+  uint16_t GetWinStart (void) const;
+
+  /**
+   * \brief Account a received MPDU.
+   *
+   * An MPDU beyond the window moves the window so that it ends with
+   * it; an MPDU before the window is ignored.
+   *
+   * \param seq its sequence number
+   */
+  void NotifyReceived (uint16_t seq);
+
+  /**
+   * \brief Account a block ack request.
+   * \param startingSeq its starting sequence number
+   */
+  void NotifyBlockAckRequest (uint16_t startingSeq);
+
+  /**
+   * \param bitmap output, the bitmap of the window, 64 sequence numbers
+   * per word
+   * \return the starting sequence number of the bitmap
+   */
+  uint16_t FillBitmap (std::vector<uint64_t> &bitmap) const;
+
+private:
+  /**
+   * \param winStart the new starting sequence number, ahead of the
+   * current one
+   */
+  void MoveTo (uint16_t winStart);
+
+  SequenceBitmap m_received; //!< MPDUs received
+  uint16_t m_winStart;       //!< Starting sequence number
+  uint16_t m_winSize;        //!< Window size
+};
+
+} // namespace ns3
+
+#endif /* BLOCK_ACK_SCOREBOARD_H */
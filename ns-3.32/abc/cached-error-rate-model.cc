@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "cached-error-rate-model.h"
+#include <cmath>
+#include <cstring>
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CachedErrorRateModel");
+
+NS_OBJECT_ENSURE_REGISTERED (CachedErrorRateModel);
+
+TypeId
+CachedErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachedErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<CachedErrorRateModel> ()
+    .AddAttribute ("Model",
+                   "The error-rate model to cache.",
+                   PointerValue (),
+                   MakePointerAccessor (&CachedErrorRateModel::SetModel,
+                                        &CachedErrorRateModel::GetModel),
+                   MakePointerChecker<ErrorRateModel> ())
+    .AddAttribute ("MaxEntries",
+                   "Success rates kept before the cache is emptied.",
+                   UintegerValue (1 << 16),
+                   MakeUintegerAccessor (&CachedErrorRateModel::m_maxEntries),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+CachedErrorRateModel::CachedErrorRateModel ()
+  : m_maxEntries (1 << 16),
+    m_hits (0),
+    m_misses (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CachedErrorRateModel::~CachedErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+CachedErrorRateModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_DEBUG ("hits " << m_hits << " misses " << m_misses);
+  m_model = 0;
+  m_successRates.clear ();
+  ErrorRateModel::DoDispose ();
+}
+
+void
+CachedErrorRateModel::SetModel (Ptr<ErrorRateModel> model)
+{
+  m_model = model;
+  m_successRates.clear ();
+}
+
+Ptr<ErrorRateModel>
+CachedErrorRateModel::GetModel (void) const
+{
+  return m_model;
+}
+
+uint64_t
+CachedErrorRateModel::GetHits (void) const
+{
+  return m_hits;
+}
+
+uint64_t
+CachedErrorRateModel::GetMisses (void) const
+{
+  return m_misses;
+}
+
+double
+CachedErrorRateModel::DoGetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  NS_ASSERT_MSG (m_model, "no model to cache");
+  Key key;
+  std::memcpy (&key.snr, &snr, sizeof (snr));
+  key.txVector = (static_cast<uint32_t> (mode.GetUid ()) << 24)
+    | ((static_cast<uint32_t> (txVector.GetChannelWidth ()) & 0xfff) << 12)
+    | ((static_cast<uint32_t> (txVector.GetNss ()) & 0xf) << 8)
+    | ((txVector.GetGuardInterval () / 100) & 0xff);
+  std::unordered_map<Key, double, KeyHash>::const_iterator i = m_successRates.find (key);
+  double p;
+  if (i != m_successRates.end ())
+    {
+      ++m_hits;
+      p = i->second;
+    }
+  else
+    {
+      ++m_misses;
+      if (m_successRates.size () >= m_maxEntries)
+        {
+          m_successRates.clear ();
+        }
+      p = m_model->GetChunkSuccessRate (mode, txVector, snr, 1);
+      m_successRates[key] = p;
+    }
+  return std::pow (p, static_cast<double> (nbits));
+}
+
+} // namespace ns3
@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef CACHED_ERROR_RATE_MODEL_H
+#define CACHED_ERROR_RATE_MODEL_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include "ns3/error-rate-model.h"
+
+namespace ns3 {
+
+/**
+ * \brief ErrorRateModel that remembers the per-bit success rate of
+ * another one per mode and SNR.
+ *
+ * InterferenceHelper asks the error-rate model for every chunk of every
+ * reception, and the Yans and Nist models evaluate erfc, binomial sums
+ * and powers each time, although static scenarios see the same few SNRs
+ * over and over.  Their chunk success rate is a per-bit success rate p
+ * raised to the number of bits, so this model asks the wrapped one for p
+ * once, as the success rate of a single bit, and answers p^nbits from a
+ * hash table keyed by the mode, the channel width, the number of streams,
+ * the guard interval and the exact SNR.  For such models results are
+ * the same as without the cache.
+ *
+ * The table is emptied when it reaches MaxEntries; GetHits () and
+ * GetMisses () tell how well it works.
+ */
+class CachedErrorRateModel : public ErrorRateModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  CachedErrorRateModel ();
+  virtual ~CachedErrorRateModel ();
+
+  /**
+   * \param model the model to cache
+   */
+  void SetModel (Ptr<ErrorRateModel> model);
+
+  /// \return the cached model
+  Ptr<ErrorRateModel> GetModel (void) const;
+
+  /// \return the number of lookups answered from the cache
+  uint64_t GetHits (void) const;
+
+  /// \return the number of lookups that had to compute
+  uint64_t GetMisses (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual double DoGetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+
+  /// Lookup key.
+  struct Key
+  {
+    uint64_t snr;       //!< Bits of the SNR
+    uint32_t txVector;  //!< Mode, width, streams and guard interval
+
+    /**
+     * \param o another key
+     * \return true if equal
+     */
+    bool operator== (const Key &o) const
+    {
+      return snr == o.snr && txVector == o.txVector;
+    }
+  };
+
+  /// Hash of a Key.
+  struct KeyHash
+  {
+    /**
+     * \param k a key
+     * \return its hash
+     */
+    std::size_t operator() (const Key &k) const
+    {
+      return std::hash<uint64_t> () (k.snr ^ (static_cast<uint64_t> (k.txVector) * 0x9e3779b97f4a7c15ULL));
+    }
+  };
+
+  Ptr<ErrorRateModel> m_model;                                       //!< Cached model
+  mutable std::unordered_map<Key, double, KeyHash> m_successRates;   //!< Per-bit success rates
+  uint32_t m_maxEntries;                                             //!< Capacity
+  mutable uint64_t m_hits;                                           //!< Cache hits
+  mutable uint64_t m_misses;                                         //!< Cache misses
+};
+
+} // namespace ns3
+
+#endif /* CACHED_ERROR_RATE_MODEL_H */
@@ -0,0 +1,378 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "cached-propagation-model.h"
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CachedPropagationModel");
+
+NS_OBJECT_ENSURE_REGISTERED (CachedPropagationLossModel);
+NS_OBJECT_ENSURE_REGISTERED (CachedPropagationDelayModel);
+
+namespace {
+
+/**
+ * \param m a mobility model
+ * \return true if it may move without firing CourseChange
+ */
+bool
+IsMoving (Ptr<MobilityModel> m)
+{
+  Vector v = m->GetVelocity ();
+  return v.x != 0 || v.y != 0 || v.z != 0;
+}
+
+} // anonymous namespace
+
+PropagationPairCache::PropagationPairCache (uint32_t maxEntries)
+  : m_maxEntries (maxEntries),
+    m_pending (0),
+    m_pendingA (0),
+    m_pendingB (0),
+    m_hits (0),
+    m_misses (0),
+    m_bypasses (0),
+    m_evictions (0)
+{
+}
+
+PropagationPairCache::~PropagationPairCache ()
+{
+  Clear ();
+}
+
+void
+PropagationPairCache::SetMaxEntries (uint32_t maxEntries)
+{
+  m_maxEntries = maxEntries;
+  if (m_entries.size () > m_maxEntries)
+    {
+      m_entries.clear ();
+    }
+}
+
+void
+PropagationPairCache::Clear (void)
+{
+  for (std::vector<Ptr<MobilityModel> >::const_iterator m = m_models.begin (); m != m_models.end (); ++m)
+    {
+      (*m)->TraceDisconnectWithoutContext ("CourseChange",
+                                           MakeCallback (&PropagationPairCache::CourseChanged, this));
+    }
+  m_entries.clear ();
+  m_ids.clear ();
+  m_models.clear ();
+  m_versions.clear ();
+}
+
+uint32_t
+PropagationPairCache::GetId (Ptr<MobilityModel> m)
+{
+  std::map<const MobilityModel *, uint32_t>::const_iterator i = m_ids.find (PeekPointer (m));
+  if (i != m_ids.end ())
+    {
+      return i->second;
+    }
+  uint32_t id = m_models.size ();
+  m_ids[PeekPointer (m)] = id;
+  m_models.push_back (m);
+  m_versions.push_back (0);
+  m->TraceConnectWithoutContext ("CourseChange", MakeCallback (&PropagationPairCache::CourseChanged, this));
+  return id;
+}
+
+void
+PropagationPairCache::CourseChanged (Ptr<const MobilityModel> m)
+{
+  std::map<const MobilityModel *, uint32_t>::const_iterator i = m_ids.find (PeekPointer (m));
+  if (i != m_ids.end ())
+    {
+      ++m_versions[i->second];
+    }
+}
+
+bool
+PropagationPairCache::Lookup (Ptr<MobilityModel> a, Ptr<MobilityModel> b, double &value)
+{
+  if (m_maxEntries == 0 || IsMoving (a) || IsMoving (b))
+    {
+      ++m_bypasses;
+      m_pending = ~static_cast<uint64_t> (0);
+      return false;
+    }
+  uint32_t idA = GetId (a);
+  uint32_t idB = GetId (b);
+  uint64_t key = (static_cast<uint64_t> (idA) << 32) | idB;
+  std::unordered_map<uint64_t, Entry>::const_iterator e = m_entries.find (key);
+  if (e != m_entries.end () && e->second.versionA == m_versions[idA] && e->second.versionB == m_versions[idB])
+    {
+      ++m_hits;
+      value = e->second.value;
+      return true;
+    }
+  ++m_misses;
+  m_pending = key;
+  m_pendingA = m_versions[idA];
+  m_pendingB = m_versions[idB];
+  return false;
+}
+
+void
+PropagationPairCache::Store (double value)
+{
+  if (m_pending == ~static_cast<uint64_t> (0))
+    {
+      return;
+    }
+  if (m_entries.size () >= m_maxEntries && m_entries.find (m_pending) == m_entries.end ())
+    {
+      NS_LOG_LOGIC ("cache full at " << m_entries.size () << " entries, flushing");
+      m_entries.clear ();
+      ++m_evictions;
+    }
+  Entry &e = m_entries[m_pending];
+  e.value = value;
+  e.versionA = m_pendingA;
+  e.versionB = m_pendingB;
+  m_pending = ~static_cast<uint64_t> (0);
+}
+
+uint64_t
+PropagationPairCache::GetHits (void) const
+{
+  return m_hits;
+}
+
+uint64_t
+PropagationPairCache::GetMisses (void) const
+{
+  return m_misses;
+}
+
+uint64_t
+PropagationPairCache::GetBypasses (void) const
+{
+  return m_bypasses;
+}
+
+uint64_t
+PropagationPairCache::GetEvictions (void) const
+{
+  return m_evictions;
+}
+
+uint32_t
+PropagationPairCache::GetNEntries (void) const
+{
+  return m_entries.size ();
+}
+
+TypeId
+CachedPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachedPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .SetGroupName ("Propagation")
+    .AddConstructor<CachedPropagationLossModel> ()
+    .AddAttribute ("Model",
+                   "The deterministic loss model to cache.",
+                   PointerValue (),
+                   MakePointerAccessor (&CachedPropagationLossModel::SetModel,
+                                       &CachedPropagationLossModel::GetModel),
+                   MakePointerChecker<PropagationLossModel> ())
+    .AddAttribute ("MaxEntries",
+                   "Node pairs kept before the cache is emptied; 0 disables it.",
+                   UintegerValue (1 << 20),
+                   MakeUintegerAccessor (&CachedPropagationLossModel::SetMaxEntries,
+                                         &CachedPropagationLossModel::GetMaxEntries),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+CachedPropagationLossModel::CachedPropagationLossModel ()
+  : m_cache (1 << 20),
+    m_maxEntries (1 << 20)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CachedPropagationLossModel::~CachedPropagationLossModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+CachedPropagationLossModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_DEBUG ("hits " << m_cache.GetHits () << " misses " << m_cache.GetMisses ()
+                        << " bypasses " << m_cache.GetBypasses () << " evictions " << m_cache.GetEvictions ());
+  m_cache.Clear ();
+  m_model = 0;
+  PropagationLossModel::DoDispose ();
+}
+
+void
+CachedPropagationLossModel::SetModel (Ptr<PropagationLossModel> model)
+{
+  m_model = model;
+  m_cache.Clear ();
+}
+
+Ptr<PropagationLossModel>
+CachedPropagationLossModel::GetModel (void) const
+{
+  return m_model;
+}
+
+void
+CachedPropagationLossModel::SetMaxEntries (uint32_t maxEntries)
+{
+  m_maxEntries = maxEntries;
+  m_cache.SetMaxEntries (maxEntries);
+}
+
+uint32_t
+CachedPropagationLossModel::GetMaxEntries (void) const
+{
+  return m_maxEntries;
+}
+
+uint64_t
+CachedPropagationLossModel::GetHits (void) const
+{
+  return m_cache.GetHits ();
+}
+
+uint64_t
+CachedPropagationLossModel::GetMisses (void) const
+{
+  return m_cache.GetMisses () + m_cache.GetBypasses ();
+}
+
+double
+CachedPropagationLossModel::DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  NS_ASSERT_MSG (m_model, "no model to cache");
+  double gainDb;
+  if (!m_cache.Lookup (a, b, gainDb))
+    {
+      gainDb = m_model->CalcRxPower (0, a, b);
+      m_cache.Store (gainDb);
+    }
+  return txPowerDbm + gainDb;
+}
+
+int64_t
+CachedPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  return m_model ? m_model->AssignStreams (stream) : 0;
+}
+
+TypeId
+CachedPropagationDelayModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachedPropagationDelayModel")
+    .SetParent<PropagationDelayModel> ()
+    .SetGroupName ("Propagation")
+    .AddConstructor<CachedPropagationDelayModel> ()
+    .AddAttribute ("Model",
+                   "The deterministic delay model to cache.",
+                   PointerValue (),
+                   MakePointerAccessor (&CachedPropagationDelayModel::SetModel,
+                                       &CachedPropagationDelayModel::GetModel),
+                   MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxEntries",
+                   "Node pairs kept before the cache is emptied; 0 disables it.",
+                   UintegerValue (1 << 20),
+                   MakeUintegerAccessor (&CachedPropagationDelayModel::SetMaxEntries,
+                                         &CachedPropagationDelayModel::GetMaxEntries),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+CachedPropagationDelayModel::CachedPropagationDelayModel ()
+  : m_cache (1 << 20),
+    m_maxEntries (1 << 20)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CachedPropagationDelayModel::~CachedPropagationDelayModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+CachedPropagationDelayModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_cache.Clear ();
+  m_model = 0;
+  PropagationDelayModel::DoDispose ();
+}
+
+void
+CachedPropagationDelayModel::SetModel (Ptr<PropagationDelayModel> model)
+{
+  m_model = model;
+  m_cache.Clear ();
+}
+
+Ptr<PropagationDelayModel>
+CachedPropagationDelayModel::GetModel (void) const
+{
+  return m_model;
+}
+
+void
+CachedPropagationDelayModel::SetMaxEntries (uint32_t maxEntries)
+{
+  m_maxEntries = maxEntries;
+  m_cache.SetMaxEntries (maxEntries);
+}
+
+uint32_t
+CachedPropagationDelayModel::GetMaxEntries (void) const
+{
+  return m_maxEntries;
+}
+
+uint64_t
+CachedPropagationDelayModel::GetHits (void) const
+{
+  return m_cache.GetHits ();
+}
+
+uint64_t
+CachedPropagationDelayModel::GetMisses (void) const
+{
+  return m_cache.GetMisses () + m_cache.GetBypasses ();
+}
+
+Time
+CachedPropagationDelayModel::GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  NS_ASSERT_MSG (m_model, "no model to cache");
+  // Time steps are below 2^53, so a double holds them exactly.
+  double steps;
+  if (!m_cache.Lookup (a, b, steps))
+    {
+      Time delay = m_model->GetDelay (a, b);
+      m_cache.Store (static_cast<double> (delay.GetTimeStep ()));
+      return delay;
+    }
+  return TimeStep (static_cast<uint64_t> (steps));
+}
+
+int64_t
+CachedPropagationDelayModel::DoAssignStreams (int64_t stream)
+{
+  return m_model ? m_model->AssignStreams (stream) : 0;
+}
+
+} // namespace ns3
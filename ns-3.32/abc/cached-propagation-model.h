@@ -0,0 +1,227 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef CACHED_PROPAGATION_MODEL_H
+#define CACHED_PROPAGATION_MODEL_H
+
+#include <stdint.h>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/mobility-model.h"
+
+namespace ns3 {
+
+/**
+ * \brief Memo of a value per ordered pair of mobility models.
+ *
+ * Each mobility model gets a small id and a version the first time it is
+ * seen; its CourseChange trace bumps the version, which invalidates every
+ * entry involving it in O(1).  Entries live in a hash table keyed by the
+ * two ids, emptied when it reaches its capacity.  A model that moves
+ * without firing CourseChange, i.e. with a non-zero velocity, is never
+ * cached.
+ *
+ * An entry takes about 40 bytes.
+ */
+class PropagationPairCache
+{
+public:
+  /**
+   * \param maxEntries capacity; 0 disables caching
+   */
+  PropagationPairCache (uint32_t maxEntries);
+  ~PropagationPairCache ();
+
+  /**
+   * \param a a mobility model
+   * \param b another one
+   * \param value the cached value, if found
+   * \return true if found; false if absent, stale or not cacheable
+   */
+  bool Lookup (Ptr<MobilityModel> a, Ptr<MobilityModel> b, double &value);
+
+  /**
+   * \brief Store the value of the pair of the last missed Lookup ().
+   * \param value the value
+   */
+  void Store (double value);
+
+  /**
+   * \param maxEntries capacity; 0 disables caching
+   */
+  void SetMaxEntries (uint32_t maxEntries);
+
+  /// Drop every entry and stop tracking the mobility models.
+  void Clear (void);
+
+  /// \return the number of lookups answered from the cache
+  uint64_t GetHits (void) const;
+
+  /// \return the number of lookups of static pairs that had to compute
+  uint64_t GetMisses (void) const;
+
+  /// \return the number of lookups of moving pairs, never cached
+  uint64_t GetBypasses (void) const;
+
+  /// \return the number of times the table was emptied for room
+  uint64_t GetEvictions (void) const;
+
+  /// \return the number of entries
+  uint32_t GetNEntries (void) const;
+
+private:
+  /// A cached value.
+  struct Entry
+  {
+    double value;       //!< Cached value
+    uint32_t versionA;  //!< Version of the first model when stored
+    uint32_t versionB;  //!< Version of the second model when stored
+  };
+
+  /**
+   * \param m a mobility model
+   * \return its id, assigned on first sight
+   */
+  uint32_t GetId (Ptr<MobilityModel> m);
+
+  /**
+   * \brief CourseChange trace sink.
+   * \param m the mobility model that changed course
+   */
+  void CourseChanged (Ptr<const MobilityModel> m);
+
+  std::unordered_map<uint64_t, Entry> m_entries;        //!< Values, by id pair
+  std::map<const MobilityModel *, uint32_t> m_ids;     //!< Id of each model
+  std::vector<Ptr<MobilityModel> > m_models;           //!< Model of each id
+  std::vector<uint32_t> m_versions;                    //!< Version of each id
+  uint32_t m_maxEntries;                               //!< Capacity
+  uint64_t m_pending;                                  //!< Key of the last miss
+  uint32_t m_pendingA;                                 //!< Version of its first model
+  uint32_t m_pendingB;                                 //!< Version of its second model
+  uint64_t m_hits;                                     //!< Cache hits
+  uint64_t m_misses;                                   //!< Cache misses
+  uint64_t m_bypasses;                                 //!< Uncacheable lookups
+  uint64_t m_evictions;                                //!< Table flushes
+};
+
+/**
+ * \brief PropagationLossModel that remembers the loss of another one per
+ * pair of nodes.
+ *
+ * Friis, log-distance and the other deterministic models redo their
+ * logarithms for every frame and every receiver, although the nodes of
+ * most scenarios never move.  This model asks the wrapped one once per
+ * ordered pair of static nodes for its gain, CalcRxPower (0, a, b), and
+ * then answers txPowerDbm plus the gain from a hash table, until either
+ * node changes course; results match the wrapped model up to rounding.
+ * The wrapped model and its chain must be deterministic and linear in
+ * the transmit power, which all distance based models are; put random
+ * fading after this model with SetNext () so that it is still drawn for
+ * every frame.
+ *
+ * GetHits () and GetMisses () tell how well the cache works; MaxEntries
+ * bounds its memory.
+ */
+class CachedPropagationLossModel : public PropagationLossModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  CachedPropagationLossModel ();
+  virtual ~CachedPropagationLossModel ();
+
+  /**
+   * \param model the model to cache, with its chained models
+   */
+  void SetModel (Ptr<PropagationLossModel> model);
+
+  /// \return the cached model
+  Ptr<PropagationLossModel> GetModel (void) const;
+
+  /// \return the number of lookups answered from the cache
+  uint64_t GetHits (void) const;
+
+  /// \return the number of lookups that had to compute
+  uint64_t GetMisses (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  /**
+   * \param maxEntries cache capacity
+   */
+  void SetMaxEntries (uint32_t maxEntries);
+
+  /// \return the cache capacity
+  uint32_t GetMaxEntries (void) const;
+
+  Ptr<PropagationLossModel> m_model;      //!< Cached model
+  mutable PropagationPairCache m_cache;   //!< Gain of each pair (dB)
+  uint32_t m_maxEntries;                  //!< Cache capacity
+};
+
+/**
+ * \brief PropagationDelayModel that remembers the delay of another one per
+ * pair of nodes, under the same rules as CachedPropagationLossModel: the
+ * wrapped model must be deterministic, such as
+ * ConstantSpeedPropagationDelayModel.
+ */
+class CachedPropagationDelayModel : public PropagationDelayModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  CachedPropagationDelayModel ();
+  virtual ~CachedPropagationDelayModel ();
+
+  virtual Time GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+
+  /**
+   * \param model the model to cache
+   */
+  void SetModel (Ptr<PropagationDelayModel> model);
+
+  /// \return the cached model
+  Ptr<PropagationDelayModel> GetModel (void) const;
+
+  /// \return the number of lookups answered from the cache
+  uint64_t GetHits (void) const;
+
+  /// \return the number of lookups that had to compute
+  uint64_t GetMisses (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  /**
+   * \param maxEntries cache capacity
+   */
+  void SetMaxEntries (uint32_t maxEntries);
+
+  /// \return the cache capacity
+  uint32_t GetMaxEntries (void) const;
+
+  Ptr<PropagationDelayModel> m_model;     //!< Cached model
+  mutable PropagationPairCache m_cache;   //!< Delay of each pair (time steps)
+  uint32_t m_maxEntries;                  //!< Cache capacity
+};
+
+} // namespace ns3
+
+#endif /* CACHED_PROPAGATION_MODEL_H */
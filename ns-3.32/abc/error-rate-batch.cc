@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "error-rate-batch.h"
+#include <algorithm>
+#include <cstring>
+#include "tabulated-error-rate-model.h"
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * \param v a double
+ * \return its bits
+ */
+inline uint64_t
+Bits (double v)
+{
+  uint64_t b;
+  std::memcpy (&b, &v, sizeof (v));
+  return b;
+}
+
+/**
+ * \param b bits of a double
+ * \return the double
+ */
+inline double
+FromBits (uint64_t b)
+{
+  double v;
+  std::memcpy (&v, &b, sizeof (v));
+  return v;
+}
+
+} // unnamed namespace
+
+void
+ErrorRateBatch::GetChunkSuccessRates (Ptr<const ErrorRateModel> model, WifiMode mode,
+                                      const WifiTxVector &txVector, const std::vector<double> &snrs,
+                                      uint64_t nbits, std::vector<double> &ps)
+{
+  Ptr<const TabulatedErrorRateModel> tabulated = DynamicCast<const TabulatedErrorRateModel> (model);
+  if (tabulated)
+    {
+      tabulated->GetChunkSuccessRates (mode, txVector, snrs, nbits, ps);
+      return;
+    }
+  ps.resize (snrs.size ());
+  for (uint32_t i = 0; i < snrs.size (); ++i)
+    {
+      ps[i] = model->GetChunkSuccessRate (mode, txVector, snrs[i], nbits);
+    }
+}
+
+void
+ErrorRateBatch::ToDb (const std::vector<double> &in, std::vector<double> &out)
+{
+  out.resize (in.size ());
+  const double *x = in.data ();
+  double *y = out.data ();
+  uint32_t n = in.size ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      // x = m 2^e with m in [sqrt(2)/2, sqrt(2)), then
+      // ln (m) = 2 atanh (s) with s = (m - 1) / (m + 1), |s| < 0.172.
+      uint64_t b = Bits (x[i]);
+      // The exponent field, as a double without an integer conversion.
+      double e = FromBits ((b >> 52) | 0x4330000000000000ULL) - (4503599627370496.0 + 1023);
+      // Mantissas above that of sqrt(2) get the exponent of [0.5, 1).
+      // Selects are integer masks: floating compares keep GCC from
+      // vectorizing without -fno-trapping-math.
+      uint64_t big = (b & 0x000fffffffffffffULL) > 0x6a09e667f3bccULL ? ~0ULL : 0;
+      double m = FromBits ((b & 0x000fffffffffffffULL) | (0x3ff0000000000000ULL - (big & (1ULL << 52))));
+      e += FromBits (big & 0x3ff0000000000000ULL);   // 1 or 0
+      double s = (m - 1) / (m + 1);
+      double s2 = s * s;
+      double p = 1 + s2 * (1.0 / 3 + s2 * (1.0 / 5 + s2 * (1.0 / 7 + s2 * (1.0 / 9 + s2 * (1.0 / 11 + s2 * (1.0 / 13))))));
+      double ln = e * 0.6931471805599453 + 2 * s * p;
+      y[i] = 4.3429448190325183 * ln;   // 10 / ln (10)
+    }
+}
+
+void
+ErrorRateBatch::Exp (std::vector<double> &x)
+{
+  double *y = x.data ();
+  uint32_t n = x.size ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      // e^x = 2^k e^r, with k the integer nearest to x / ln (2).
+      // Negative doubles order as their bits do, so that values below
+      // -708 are found, clamped and zeroed with integer operations.
+      uint64_t b = Bits (y[i]);
+      uint64_t low = b > 0xc086200000000000ULL ? ~0ULL : 0;
+      double v = FromBits ((b & ~low) | (0xc086200000000000ULL & low));
+      // Rounds to the nearest integer without a call, for |v| < 2^51;
+      // the low bits of kb are then k.
+      double kb = v * 1.4426950408889634 + 6755399441055744.0;
+      double k = kb - 6755399441055744.0;
+      double r = (v - k * 6.93147180369123816490e-01) - k * 1.90821492927058770002e-10;
+      double p = 1 + r * (1 + r * (1.0 / 2 + r * (1.0 / 6 + r * (1.0 / 24 + r * (1.0 / 120 + r * (1.0 / 720 + r * (1.0 / 5040 + r * (1.0 / 40320 + r * (1.0 / 362880 + r * (1.0 / 3628800 + r * (1.0 / 39916800 + r * (1.0 / 479001600))))))))))));
+      double scale = FromBits ((Bits (kb) + 1023) << 52);
+      y[i] = FromBits (Bits (p * scale) & ~low);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,60 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef ERROR_RATE_BATCH_H
+#define ERROR_RATE_BATCH_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/error-rate-model.h"
+
+namespace ns3 {
+
+/**
+ * \brief Chunk success rates of many SNRs at once.
+ *
+ * ErrorRateModel::GetChunkSuccessRate takes one SNR per call, through a
+ * virtual call, and a sweep or the chunks of a reception pay for it once
+ * per point.  GetChunkSuccessRates () takes a whole vector of SNRs: for a
+ * TabulatedErrorRateModel it converts them to dB, interpolates and takes
+ * the exponential in separate passes over contiguous arrays, with kernels
+ * written without branches or library calls so that the compiler
+ * vectorizes them (with AVX2, which has 64-bit integer compares); for
+ * other models it calls GetChunkSuccessRate for each SNR.
+ */
+class ErrorRateBatch
+{
+public:
+  /**
+   * \param model the error-rate model
+   * \param mode the mode
+   * \param txVector the TXVECTOR
+   * \param snrs linear SNRs
+   * \param nbits bits per chunk
+   * \param ps output, the success rate of each chunk; not snrs
+   */
+  static void GetChunkSuccessRates (Ptr<const ErrorRateModel> model, WifiMode mode,
+                                    const WifiTxVector &txVector, const std::vector<double> &snrs,
+                                    uint64_t nbits, std::vector<double> &ps);
+
+  /**
+   * \brief 10 log10 of each value, within 2e-12 dB from -100 to 100 dB.
+   *
+   * Only positive normal values give a meaningful result.
+   *
+   * \param in linear values
+   * \param out output, the values in dB
+   */
+  static void ToDb (const std::vector<double> &in, std::vector<double> &out);
+
+  /**
+   * \brief exp of each value, in place, within a few ulps.
+   *
+   * Values below -708 give 0; values must not exceed 709.
+   *
+   * \param x the values
+   */
+  static void Exp (std::vector<double> &x);
+};
+
+} // namespace ns3
+
+#endif /* ERROR_RATE_BATCH_H */
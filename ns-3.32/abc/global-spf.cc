@@ -0,0 +1,349 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "global-spf.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("GlobalSpf");
+
+const uint32_t GlobalSpf::NONE;
+
+namespace {
+
+/// Order edges by key, then by metric.
+bool
+EdgeMetricLess (const GlobalSpf::Edge &a, const GlobalSpf::Edge &b)
+{
+  return a < b || (!(b < a) && a.metric < b.metric);
+}
+
+/// Same key.
+bool
+EdgeKeyEqual (const GlobalSpf::Edge &a, const GlobalSpf::Edge &b)
+{
+  return !(a < b) && !(b < a);
+}
+
+} // anonymous namespace
+
+GlobalSpf::GlobalSpf (uint32_t nThreads)
+  : m_nThreads (1),
+    m_n (0),
+    m_nSpfRuns (0)
+{
+  NS_LOG_FUNCTION (this << nThreads);
+  SetThreads (nThreads);
+  m_firstEdge.push_back (0);
+}
+
+void
+GlobalSpf::SetThreads (uint32_t nThreads)
+{
+  NS_LOG_FUNCTION (this << nThreads);
+  if (nThreads == 0)
+    {
+      nThreads = std::max (1u, std::thread::hardware_concurrency ());
+    }
+  m_nThreads = nThreads;
+}
+
+uint32_t
+GlobalSpf::GetNNodes (void) const
+{
+  return m_n;
+}
+
+const GlobalSpf::Edge &
+GlobalSpf::GetEdge (uint32_t i) const
+{
+  return m_edges[i];
+}
+
+uint32_t
+GlobalSpf::GetDistance (uint32_t root, uint32_t node) const
+{
+  return m_dist[static_cast<size_t> (root) * m_n + node];
+}
+
+uint64_t
+GlobalSpf::GetNSpfRuns (void) const
+{
+  return m_nSpfRuns;
+}
+
+void
+GlobalSpf::Reset (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::fill (m_pending.begin (), m_pending.end (), 1);
+}
+
+bool
+GlobalSpf::OnShortestPath (uint32_t root, const Edge &e) const
+{
+  const uint32_t *dist = &m_dist[static_cast<size_t> (root) * m_n];
+  return dist[e.from] != NONE && static_cast<uint64_t> (dist[e.from]) + e.metric == dist[e.to];
+}
+
+bool
+GlobalSpf::Improves (uint32_t root, const Edge &e) const
+{
+  const uint32_t *dist = &m_dist[static_cast<size_t> (root) * m_n];
+  return dist[e.from] != NONE && static_cast<uint64_t> (dist[e.from]) + e.metric <= dist[e.to];
+}
+
+bool
+GlobalSpf::AttachmentChanges (uint32_t root, const std::vector<uint32_t> &before,
+                              const std::vector<uint32_t> &after) const
+{
+  const uint32_t *dist = &m_dist[static_cast<size_t> (root) * m_n];
+  std::vector<uint32_t> changed;
+  std::set_symmetric_difference (before.begin (), before.end (), after.begin (), after.end (),
+                                 std::back_inserter (changed));
+  uint32_t best = NONE;
+  for (std::vector<uint32_t>::const_iterator a = before.begin (); a != before.end (); ++a)
+    {
+      best = std::min (best, dist[*a]);
+    }
+  for (std::vector<uint32_t>::const_iterator a = after.begin (); a != after.end (); ++a)
+    {
+      best = std::min (best, dist[*a]);
+    }
+  for (std::vector<uint32_t>::const_iterator a = changed.begin (); a != changed.end (); ++a)
+    {
+      if (dist[*a] != NONE && dist[*a] <= best)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+std::vector<uint32_t>
+GlobalSpf::Update (uint32_t nNodes, std::vector<Edge> edges,
+                   const std::vector<std::vector<uint32_t> > &destinations)
+{
+  NS_LOG_FUNCTION (this << nNodes << edges.size () << destinations.size ());
+  for (std::vector<Edge>::iterator e = edges.begin (); e != edges.end (); ++e)
+    {
+      NS_ASSERT (e->from < nNodes && e->to < nNodes);
+      e->metric = std::max (1u, e->metric);
+    }
+  // Parallel edges with the same ports collapse into the cheapest one.
+  std::sort (edges.begin (), edges.end (), &EdgeMetricLess);
+  edges.erase (std::unique (edges.begin (), edges.end (), &EdgeKeyEqual), edges.end ());
+
+  if (nNodes != m_n || destinations.size () != m_destinations.size ())
+    {
+      m_n = nNodes;
+      m_dist.assign (static_cast<size_t> (nNodes) * nNodes, NONE);
+      m_pending.assign (nNodes, 1);
+      m_destinations = destinations;
+    }
+  else
+    {
+      // Merge the old and new sorted edge lists: what was removed or got
+      // dearer may break the trees using it, what was added or got
+      // cheaper may improve any tree.
+      std::vector<Edge> removed;
+      std::vector<Edge> added;
+      std::vector<Edge>::const_iterator o = m_edges.begin ();
+      std::vector<Edge>::const_iterator n = edges.begin ();
+      while (o != m_edges.end () || n != edges.end ())
+        {
+          if (n == edges.end () || (o != m_edges.end () && *o < *n))
+            {
+              removed.push_back (*o++);
+            }
+          else if (o == m_edges.end () || *n < *o)
+            {
+              added.push_back (*n++);
+            }
+          else
+            {
+              if (o->metric != n->metric)
+                {
+                  removed.push_back (*o);
+                  added.push_back (*n);
+                }
+              ++o;
+              ++n;
+            }
+        }
+      std::vector<uint32_t> moved;
+      for (uint32_t j = 0; j < destinations.size (); ++j)
+        {
+          if (destinations[j] != m_destinations[j])
+            {
+              moved.push_back (j);
+            }
+        }
+      NS_LOG_LOGIC (removed.size () << " edges removed, " << added.size () << " added, "
+                                    << moved.size () << " destinations moved");
+      for (uint32_t root = 0; root < m_n; ++root)
+        {
+          if (m_pending[root])
+            {
+              continue;
+            }
+          for (std::vector<Edge>::const_iterator e = removed.begin (); e != removed.end () && !m_pending[root]; ++e)
+            {
+              m_pending[root] = OnShortestPath (root, *e);
+            }
+          for (std::vector<Edge>::const_iterator e = added.begin (); e != added.end () && !m_pending[root]; ++e)
+            {
+              m_pending[root] = Improves (root, *e);
+            }
+          // Distances of roots still clean are unchanged, so they tell
+          // which attachment changes matter.
+          for (std::vector<uint32_t>::const_iterator j = moved.begin (); j != moved.end () && !m_pending[root]; ++j)
+            {
+              m_pending[root] = AttachmentChanges (root, m_destinations[*j], destinations[*j]);
+            }
+        }
+      m_destinations = destinations;
+    }
+
+  m_edges.swap (edges);
+  m_firstEdge.assign (m_n + 1, 0);
+  for (std::vector<Edge>::const_iterator e = m_edges.begin (); e != m_edges.end (); ++e)
+    {
+      ++m_firstEdge[e->from + 1];
+    }
+  for (uint32_t i = 0; i < m_n; ++i)
+    {
+      m_firstEdge[i + 1] += m_firstEdge[i];
+    }
+
+  std::vector<uint32_t> roots;
+  for (uint32_t root = 0; root < m_n; ++root)
+    {
+      if (m_pending[root])
+        {
+          roots.push_back (root);
+        }
+    }
+  return roots;
+}
+
+void
+GlobalSpf::Compute (const std::vector<uint32_t> &roots, std::vector<std::vector<uint32_t> > &routes)
+{
+  NS_LOG_FUNCTION (this << roots.size ());
+  routes.resize (roots.size ());
+  std::atomic<size_t> next (0);
+  // Each worker takes the next root until none are left; rows of m_dist
+  // and entries of routes are only written by the thread owning the root.
+  auto work = [this, &roots, &routes, &next] ()
+  {
+    Workspace ws;
+    for (size_t i = next++; i < roots.size (); i = next++)
+      {
+        Spf (roots[i], ws, routes[i]);
+      }
+  };
+  uint32_t nThreads = std::min<size_t> (m_nThreads, roots.size ());
+  if (nThreads <= 1)
+    {
+      work ();
+    }
+  else
+    {
+      std::vector<std::thread> threads;
+      for (uint32_t t = 0; t < nThreads; ++t)
+        {
+          threads.push_back (std::thread (work));
+        }
+      for (std::vector<std::thread>::iterator t = threads.begin (); t != threads.end (); ++t)
+        {
+          t->join ();
+        }
+    }
+  for (std::vector<uint32_t>::const_iterator root = roots.begin (); root != roots.end (); ++root)
+    {
+      m_pending[*root] = 0;
+    }
+  m_nSpfRuns += roots.size ();
+}
+
+void
+GlobalSpf::Spf (uint32_t root, Workspace &ws, std::vector<uint32_t> &routes)
+{
+  uint32_t *dist = &m_dist[static_cast<size_t> (root) * m_n];
+  std::fill (dist, dist + m_n, NONE);
+  ws.firstHop.assign (m_n, NONE);
+  ws.heap.clear ();
+
+  std::greater<uint64_t> cmp;
+  dist[root] = 0;
+  ws.heap.push_back (root);
+  while (!ws.heap.empty ())
+    {
+      std::pop_heap (ws.heap.begin (), ws.heap.end (), cmp);
+      uint64_t top = ws.heap.back ();
+      ws.heap.pop_back ();
+      uint32_t u = top & 0xffffffff;
+      if ((top >> 32) != dist[u])
+        {
+          continue; // stale entry
+        }
+      for (uint32_t i = m_firstEdge[u]; i < m_firstEdge[u + 1]; ++i)
+        {
+          const Edge &e = m_edges[i];
+          uint64_t d = static_cast<uint64_t> (dist[u]) + e.metric;
+          uint32_t hop = u == root ? i : ws.firstHop[u];
+          if (d >= NONE)
+            {
+              continue;
+            }
+          if (d < dist[e.to])
+            {
+              dist[e.to] = d;
+              ws.firstHop[e.to] = hop;
+              ws.heap.push_back ((d << 32) | e.to);
+              std::push_heap (ws.heap.begin (), ws.heap.end (), cmp);
+            }
+          else if (d == dist[e.to] && hop < ws.firstHop[e.to])
+            {
+              // Metrics are at least 1, so e.to is not settled yet and
+              // passes the lower first hop on.
+              ws.firstHop[e.to] = hop;
+            }
+        }
+    }
+
+  routes.assign (m_destinations.size (), NONE);
+  for (uint32_t j = 0; j < m_destinations.size (); ++j)
+    {
+      const std::vector<uint32_t> &attached = m_destinations[j];
+      if (std::binary_search (attached.begin (), attached.end (), root))
+        {
+          continue;
+        }
+      uint32_t best = NONE;
+      for (std::vector<uint32_t>::const_iterator a = attached.begin (); a != attached.end (); ++a)
+        {
+          if (dist[*a] == NONE)
+            {
+              continue;
+            }
+          if (best == NONE || dist[*a] < dist[best]
+              || (dist[*a] == dist[best] && ws.firstHop[*a] < ws.firstHop[best]))
+            {
+              best = *a;
+            }
+        }
+      if (best != NONE)
+        {
+          routes[j] = ws.firstHop[best];
+        }
+    }
+}
+
+} // namespace ns3
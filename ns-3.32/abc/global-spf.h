@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef GLOBAL_SPF_H
+#define GLOBAL_SPF_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Shortest-path first from every root of a weighted graph, spread
+ * over worker threads and kept across topology changes.
+ *
+ * Global routing runs one Dijkstra per router, one after the other; the
+ * runs are independent, so Compute () hands roots to a pool of threads,
+ * each with its own heap and workspace.  The distance row of every root
+ * is kept, which lets Update () tell which roots a topology change can
+ * affect: removing (or raising the metric of) edge u->v matters to a root
+ * only if the edge lies on one of its shortest paths, dist[u] + w ==
+ * dist[v]; adding (or lowering) it only if dist[u] + w <= dist[v].  Other
+ * roots keep both their distances and their routes.
+ *
+ * Equal-cost paths are broken towards the lowest first-hop edge, in the
+ * order of Edge::operator<, so results do not depend on the number of
+ * threads nor on whether a root was recomputed incrementally.
+ *
+ * Routes are computed towards destinations, each attached to zero or more
+ * nodes (e.g. the nodes of a subnet): the route of a root goes to the
+ * closest attached node, none if the root is itself attached.  Attaching
+ * or detaching a node only affects the roots for which that node is, or
+ * ties with, the closest attached one.
+ *
+ * Memory is nNodes^2 distances, 100 MB for 5000 nodes.
+ */
+class GlobalSpf
+{
+public:
+  /// Distance of unreachable nodes, and index of missing routes.
+  static const uint32_t NONE = 0xffffffff;
+
+  /// Directed edge.  Ports tell parallel edges apart, e.g. interfaces.
+  struct Edge
+  {
+    uint32_t from;      //!< Tail node
+    uint32_t fromPort;  //!< Port of the tail node
+    uint32_t to;        //!< Head node
+    uint32_t toPort;    //!< Port of the head node
+    uint32_t metric;    //!< Cost, at least 1
+
+    /**
+     * \param o another edge
+     * \return true if this edge sorts first, by (from, fromPort, to, toPort)
+     */
+    bool operator< (const Edge &o) const
+    {
+      if (from != o.from)
+        {
+          return from < o.from;
+        }
+      if (fromPort != o.fromPort)
+        {
+          return fromPort < o.fromPort;
+        }
+      if (to != o.to)
+        {
+          return to < o.to;
+        }
+      return toPort < o.toPort;
+    }
+  };
+
+  /**
+   * \param nThreads worker threads, 0 for one per hardware thread
+   */
+  GlobalSpf (uint32_t nThreads = 0);
+
+  /**
+   * \param nThreads worker threads, 0 for one per hardware thread
+   */
+  void SetThreads (uint32_t nThreads);
+
+  /**
+   * \brief Replace the topology.
+   * \param nNodes number of nodes
+   * \param edges edges, in any order
+   * \param destinations sorted nodes attached to each destination
+   * \return the roots whose routes may have changed, sorted: every root
+   *         on the first call, after Reset () or if the number of nodes or
+   *         destinations changed.  Roots returned here stay pending, and
+   *         are returned again, until Compute () runs them.
+   */
+  std::vector<uint32_t> Update (uint32_t nNodes, std::vector<Edge> edges,
+                                const std::vector<std::vector<uint32_t> > &destinations);
+
+  /**
+   * \brief Run SPF from some roots of the current topology.
+   * \param roots the roots
+   * \param routes for each root, the index of the first-hop edge towards
+   *        each destination, or NONE; indices are valid until the next
+   *        Update ()
+   */
+  void Compute (const std::vector<uint32_t> &roots, std::vector<std::vector<uint32_t> > &routes);
+
+  /// Forget the distances, so that the next Update () returns every root.
+  void Reset (void);
+
+  /**
+   * \return the number of nodes
+   */
+  uint32_t GetNNodes (void) const;
+
+  /**
+   * \param i edge index
+   * \return the edge, in sorted order
+   */
+  const Edge & GetEdge (uint32_t i) const;
+
+  /**
+   * \param root a root
+   * \param node a node
+   * \return the distance from root to node as of the last Compute (), or NONE
+   */
+  uint32_t GetDistance (uint32_t root, uint32_t node) const;
+
+  /**
+   * \return the number of SPF runs so far
+   */
+  uint64_t GetNSpfRuns (void) const;
+
+private:
+  /// Workspace of one thread.
+  struct Workspace
+  {
+    std::vector<uint32_t> firstHop;  //!< First-hop edge of each node
+    std::vector<uint64_t> heap;      //!< (distance, node) min-heap
+  };
+
+  /**
+   * \brief Run SPF from one root and derive its routes.
+   * \param root the root
+   * \param ws thread workspace
+   * \param routes first-hop edge towards each destination
+   */
+  void Spf (uint32_t root, Workspace &ws, std::vector<uint32_t> &routes);
+
+  /**
+   * \param root a root
+   * \param e an edge
+   * \return true if the edge is on a shortest path of the root
+   */
+  bool OnShortestPath (uint32_t root, const Edge &e) const;
+
+  /**
+   * \param root a root
+   * \param e an edge
+   * \return true if the edge would shorten, or tie, a path of the root
+   */
+  bool Improves (uint32_t root, const Edge &e) const;
+
+  /**
+   * \param root a root
+   * \param before nodes attached to a destination
+   * \param after nodes now attached to it
+   * \return true if the closest attached node may have changed
+   */
+  bool AttachmentChanges (uint32_t root, const std::vector<uint32_t> &before,
+                          const std::vector<uint32_t> &after) const;
+
+  uint32_t m_nThreads;                                 //!< Worker threads
+  uint32_t m_n;                                        //!< Number of nodes
+  std::vector<uint8_t> m_pending;                      //!< Roots whose distances are stale
+  std::vector<Edge> m_edges;                           //!< Sorted edges
+  std::vector<uint32_t> m_firstEdge;                   //!< Out-edges of node i: [m_firstEdge[i], m_firstEdge[i + 1])
+  std::vector<std::vector<uint32_t> > m_destinations;  //!< Attached nodes of each destination
+  std::vector<uint32_t> m_dist;                        //!< Distances, indexed by root * m_n + node
+  uint64_t m_nSpfRuns;                                 //!< SPF runs
+};
+
+} // namespace ns3
+
+#endif /* GLOBAL_SPF_H */
@@ -0,0 +1,491 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "grid-spectrum-channel.h"
+#include <algorithm>
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/spectrum-phy.h"
+#include "ns3/antenna-model.h"
+#include "ns3/angles.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/spectrum-propagation-loss-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "psd-kernels.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("GridSpectrumChannel");
+
+NS_OBJECT_ENSURE_REGISTERED (GridSpectrumChannel);
+
+TypeId
+GridSpectrumChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::GridSpectrumChannel")
+    .SetParent<SpectrumChannel> ()
+    .SetGroupName ("Spectrum")
+    .AddConstructor<GridSpectrumChannel> ()
+    .AddAttribute ("Range",
+                   "Receivers farther than this from the sender get nothing (m); "
+                   "0 delivers to every receiver.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&GridSpectrumChannel::SetRange,
+                                       &GridSpectrumChannel::GetRange),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("Slack",
+                   "How far a receiver moving at constant velocity may drift "
+                   "before it is indexed again (m).",
+                   DoubleValue (10.0),
+                   MakeDoubleAccessor (&GridSpectrumChannel::m_slack),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
+
+GridSpectrumChannel::GridSpectrumChannel ()
+  : m_range (0),
+    m_slack (10.0),
+    m_cellSize (0),
+    m_nLoss (0),
+    m_nVisits (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+GridSpectrumChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::map<Ptr<const MobilityModel>, std::vector<uint32_t> >::const_iterator m = m_byMobility.begin ();
+       m != m_byMobility.end (); ++m)
+    {
+      m_receivers[m->second.front ()].mobility->TraceDisconnectWithoutContext (
+        "CourseChange", MakeCallback (&GridSpectrumChannel::CourseChanged, this));
+    }
+  m_byMobility.clear ();
+  m_receivers.clear ();
+  m_receiverIds.clear ();
+  m_unindexed.clear ();
+  m_deadlines = std::priority_queue<Deadline> ();
+  m_index.Clear ();
+  m_cellSize = 0;
+  m_converters.clear ();
+  m_orthogonal.clear ();
+  m_bands.clear ();
+  m_bandIds.clear ();
+  m_overlapping.clear ();
+  SpectrumChannel::DoDispose ();
+}
+
+void
+GridSpectrumChannel::SetRange (double range)
+{
+  NS_LOG_FUNCTION (this << range);
+  m_range = range;
+}
+
+double
+GridSpectrumChannel::GetRange (void) const
+{
+  return m_range;
+}
+
+uint64_t
+GridSpectrumChannel::GetNLossComputations (void) const
+{
+  return m_nLoss;
+}
+
+uint64_t
+GridSpectrumChannel::GetNVisits (void) const
+{
+  return m_nVisits;
+}
+
+void
+GridSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  // PHYs add themselves again when their spectrum model changes.
+  std::map<Ptr<SpectrumPhy>, uint32_t>::const_iterator known = m_receiverIds.find (phy);
+  if (known != m_receiverIds.end ())
+    {
+      SetBand (known->second);
+      return;
+    }
+  Receiver r;
+  r.phy = phy;
+  r.version = 0;
+  r.band = 0xffffffff;
+  m_receiverIds[phy] = m_receivers.size ();
+  m_unindexed.push_back (m_receivers.size ());
+  m_receivers.push_back (r);
+  SetBand (m_receivers.size () - 1);
+}
+
+void
+GridSpectrumChannel::SetBand (uint32_t rx)
+{
+  Receiver &r = m_receivers[rx];
+  Ptr<const SpectrumModel> model = r.phy->GetRxSpectrumModel ();
+  SpectrumModelUid_t uid = model ? model->GetUid () : 0;
+  std::map<SpectrumModelUid_t, uint32_t>::const_iterator b = m_bandIds.find (uid);
+  uint32_t band;
+  if (b == m_bandIds.end ())
+    {
+      band = m_bands.size ();
+      m_bandIds[uid] = band;
+      Band newBand;
+      newBand.model = model;
+      m_bands.push_back (newBand);
+      m_overlapping.clear ();
+      NS_LOG_LOGIC ("band " << band << " for spectrum model " << uid);
+    }
+  else
+    {
+      band = b->second;
+    }
+  if (band == r.band)
+    {
+      return;
+    }
+  if (r.band != 0xffffffff)
+    {
+      std::vector<uint32_t> &old = m_bands[r.band].receivers;
+      old.erase (std::lower_bound (old.begin (), old.end (), rx));
+    }
+  std::vector<uint32_t> &receivers = m_bands[band].receivers;
+  receivers.insert (std::lower_bound (receivers.begin (), receivers.end (), rx), rx);
+  r.band = band;
+}
+
+const std::vector<uint32_t> &
+GridSpectrumChannel::GetOverlappingBands (Ptr<const SpectrumModel> tx)
+{
+  std::map<SpectrumModelUid_t, std::vector<uint32_t> >::const_iterator o = m_overlapping.find (tx->GetUid ());
+  if (o != m_overlapping.end ())
+    {
+      return o->second;
+    }
+  std::vector<uint32_t> &bands = m_overlapping[tx->GetUid ()];
+  for (uint32_t b = 0; b < m_bands.size (); ++b)
+    {
+      Ptr<const SpectrumModel> rx = m_bands[b].model;
+      if (!rx || rx->GetUid () == tx->GetUid () || GetConverter (tx, rx) != 0)
+        {
+          bands.push_back (b);
+        }
+    }
+  NS_LOG_LOGIC ("spectrum model " << tx->GetUid () << " overlaps " << bands.size ()
+                                  << " of " << m_bands.size () << " bands");
+  return bands;
+}
+
+std::size_t
+GridSpectrumChannel::GetNDevices (void) const
+{
+  return m_receivers.size ();
+}
+
+Ptr<NetDevice>
+GridSpectrumChannel::GetDevice (std::size_t i) const
+{
+  return m_receivers.at (i).phy->GetDevice ()->GetObject<NetDevice> ();
+}
+
+void
+GridSpectrumChannel::Reindex (uint32_t rx)
+{
+  Receiver &r = m_receivers[rx];
+  m_index.Insert (rx, r.mobility->GetPosition ());
+  ++r.version;
+  Vector v = r.mobility->GetVelocity ();
+  double speed = std::sqrt (v.x * v.x + v.y * v.y + v.z * v.z);
+  if (speed > 0)
+    {
+      Deadline d;
+      d.at = Simulator::Now () + Seconds (m_slack / speed);
+      d.rx = rx;
+      d.version = r.version;
+      m_deadlines.push (d);
+    }
+}
+
+void
+GridSpectrumChannel::Refresh (void)
+{
+  if (m_cellSize != m_range + m_slack)
+    {
+      NS_LOG_LOGIC ("indexing " << m_receivers.size () << " receivers in cells of "
+                                << m_range + m_slack << " m");
+      m_cellSize = m_range + m_slack;
+      m_index.SetCellSize (m_cellSize);
+      m_deadlines = std::priority_queue<Deadline> ();
+      for (uint32_t rx = 0; rx < m_receivers.size (); ++rx)
+        {
+          if (m_receivers[rx].mobility)
+            {
+              Reindex (rx);
+            }
+        }
+    }
+
+  if (!m_unindexed.empty ())
+    {
+      std::vector<uint32_t> still;
+      for (std::vector<uint32_t>::const_iterator rx = m_unindexed.begin (); rx != m_unindexed.end (); ++rx)
+        {
+          Receiver &r = m_receivers[*rx];
+          r.mobility = r.phy->GetMobility ();
+          if (!r.mobility)
+            {
+              still.push_back (*rx);
+              continue;
+            }
+          std::vector<uint32_t> &sharing = m_byMobility[r.mobility];
+          if (sharing.empty ())
+            {
+              r.mobility->TraceConnectWithoutContext (
+                "CourseChange", MakeCallback (&GridSpectrumChannel::CourseChanged, this));
+            }
+          sharing.push_back (*rx);
+          Reindex (*rx);
+        }
+      m_unindexed.swap (still);
+    }
+
+  // Take the expired deadlines out first: with no slack, a moving
+  // receiver is due again as soon as it is indexed.
+  std::vector<uint32_t> due;
+  while (!m_deadlines.empty () && m_deadlines.top ().at <= Simulator::Now ())
+    {
+      if (m_deadlines.top ().version == m_receivers[m_deadlines.top ().rx].version)
+        {
+          due.push_back (m_deadlines.top ().rx);
+        }
+      m_deadlines.pop ();
+    }
+  for (std::vector<uint32_t>::const_iterator rx = due.begin (); rx != due.end (); ++rx)
+    {
+      Reindex (*rx);
+    }
+}
+
+void
+GridSpectrumChannel::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  std::map<Ptr<const MobilityModel>, std::vector<uint32_t> >::const_iterator m = m_byMobility.find (mobility);
+  if (m == m_byMobility.end () || m_cellSize != m_range + m_slack)
+    {
+      return;   // indexed on the next transmission
+    }
+  for (std::vector<uint32_t>::const_iterator rx = m->second.begin (); rx != m->second.end (); ++rx)
+    {
+      Reindex (*rx);
+    }
+}
+
+const SpectrumConverter *
+GridSpectrumChannel::GetConverter (Ptr<const SpectrumModel> tx, Ptr<const SpectrumModel> rx)
+{
+  std::pair<SpectrumModelUid_t, SpectrumModelUid_t> key (tx->GetUid (), rx->GetUid ());
+  std::map<std::pair<SpectrumModelUid_t, SpectrumModelUid_t>, SpectrumConverter>::const_iterator c = m_converters.find (key);
+  if (c != m_converters.end ())
+    {
+      return &c->second;
+    }
+  if (m_orthogonal.find (key) != m_orthogonal.end ())
+    {
+      return 0;
+    }
+  if (tx->IsOrthogonal (*rx))
+    {
+      m_orthogonal.insert (key);
+      return 0;
+    }
+  return &m_converters.insert (std::make_pair (key, SpectrumConverter (tx, rx))).first->second;
+}
+
+void
+GridSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
+{
+  NS_LOG_FUNCTION (this << txParams);
+  NS_ASSERT_MSG (txParams->psd, "NULL txPsd");
+  NS_ASSERT_MSG (txParams->txPhy, "NULL txPhy");
+
+  Ptr<SpectrumSignalParameters> txParamsTrace = txParams->Copy ();
+  m_txSigsTrace (txParamsTrace);
+
+  Ptr<const SpectrumModel> txModel = txParams->psd->GetSpectrumModel ();
+  const std::vector<uint32_t> &bands = GetOverlappingBands (txModel);
+  Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility ();
+  Vector senderPosition;
+  bool cut = m_range > 0 && senderMobility;
+  m_candidates.clear ();
+  if (cut)
+    {
+      Refresh ();
+      senderPosition = senderMobility->GetPosition ();
+      m_index.Query (senderPosition, m_range + m_slack, m_candidates);
+      m_candidates.insert (m_candidates.end (), m_unindexed.begin (), m_unindexed.end ());
+      if (bands.size () < m_bands.size ())
+        {
+          m_overlaps.assign (m_bands.size (), 0);
+          for (std::vector<uint32_t>::const_iterator b = bands.begin (); b != bands.end (); ++b)
+            {
+              m_overlaps[*b] = 1;
+            }
+          uint32_t kept = 0;
+          for (uint32_t i = 0; i < m_candidates.size (); ++i)
+            {
+              if (m_overlaps[m_receivers[m_candidates[i]].band])
+                {
+                  m_candidates[kept++] = m_candidates[i];
+                }
+            }
+          m_candidates.resize (kept);
+        }
+    }
+  else
+    {
+      for (std::vector<uint32_t>::const_iterator b = bands.begin (); b != bands.end (); ++b)
+        {
+          m_candidates.insert (m_candidates.end (), m_bands[*b].receivers.begin (), m_bands[*b].receivers.end ());
+        }
+    }
+  // Serve receivers in AddRx order, as SingleModelSpectrumChannel does
+  // (MultiModelSpectrumChannel only within one receive model).
+  if (cut || bands.size () > 1)
+    {
+      std::sort (m_candidates.begin (), m_candidates.end ());
+    }
+  m_nVisits += m_candidates.size ();
+  NS_LOG_LOGIC (m_candidates.size () << " of " << m_receivers.size () << " receivers in range and band");
+
+  for (std::vector<uint32_t>::const_iterator rx = m_candidates.begin (); rx != m_candidates.end (); ++rx)
+    {
+      Ptr<SpectrumPhy> rxPhy = m_receivers[*rx].phy;
+      if (rxPhy == txParams->txPhy)
+        {
+          continue;
+        }
+      Ptr<MobilityModel> receiverMobility = rxPhy->GetMobility ();
+      if (cut && receiverMobility
+          && CalculateDistance (senderPosition, receiverMobility->GetPosition ()) > m_range)
+        {
+          continue;
+        }
+      const SpectrumConverter *converter = 0;
+      Ptr<const SpectrumModel> rxModel = rxPhy->GetRxSpectrumModel ();
+      if (rxModel && rxModel->GetUid () != txModel->GetUid ())
+        {
+          converter = GetConverter (txModel, rxModel);
+          if (converter == 0)
+            {
+              continue;
+            }
+        }
+
+      Time delay = MicroSeconds (0);
+      Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+      if (converter != 0)
+        {
+          rxParams->psd = converter->Convert (txParams->psd);
+        }
+      if (senderMobility && receiverMobility)
+        {
+          double txAntennaGain = 0;
+          double rxAntennaGain = 0;
+          double propagationGainDb = 0;
+          double pathLossDb = 0;
+          if (rxParams->txAntenna != 0)
+            {
+              Angles txAngles (receiverMobility->GetPosition (), senderMobility->GetPosition ());
+              txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
+              pathLossDb -= txAntennaGain;
+            }
+          Ptr<AntennaModel> rxAntenna = rxPhy->GetRxAntenna ();
+          if (rxAntenna != 0)
+            {
+              Angles rxAngles (senderMobility->GetPosition (), receiverMobility->GetPosition ());
+              rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
+              pathLossDb -= rxAntennaGain;
+            }
+          if (m_propagationLoss)
+            {
+              propagationGainDb = m_propagationLoss->CalcRxPower (0, senderMobility, receiverMobility);
+              pathLossDb -= propagationGainDb;
+              ++m_nLoss;
+            }
+          m_gainTrace (senderMobility, receiverMobility, txAntennaGain, rxAntennaGain, propagationGainDb, pathLossDb);
+          m_pathLossTrace (txParams->txPhy, rxPhy, pathLossDb);
+          if (pathLossDb > m_maxLossDb)
+            {
+              continue;
+            }
+          PsdKernels::Scale (*rxParams->psd, std::pow (10.0, -pathLossDb / 10.0));
+          if (m_spectrumPropagationLoss)
+            {
+              rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, senderMobility, receiverMobility);
+            }
+          if (m_propagationDelay)
+            {
+              delay = m_propagationDelay->GetDelay (senderMobility, receiverMobility);
+            }
+        }
+
+      Ptr<NetDevice> netDev = rxPhy->GetDevice ();
+      if (netDev)
+        {
+          uint32_t dstNode = netDev->GetNode ()->GetId ();
+          Simulator::ScheduleWithContext (dstNode, delay, &GridSpectrumChannel::StartRx, this, rxParams, rxPhy);
+        }
+      else
+        {
+          // No device, so no node to take the context of.
+          Simulator::Schedule (delay, &GridSpectrumChannel::StartRx, this, rxParams, rxPhy);
+        }
+    }
+}
+
+void
+GridSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
+{
+  NS_LOG_FUNCTION (this << params);
+  receiver->StartRx (params);
+}
+
+double
+GridSpectrumChannel::GetCutoffRange (Ptr<PropagationLossModel> loss, double txPowerDbm,
+                                     double floorDbm, double maxRange)
+{
+  Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 0));
+  b->SetPosition (Vector (maxRange, 0, 0));
+  if (loss->CalcRxPower (txPowerDbm, a, b) >= floorDbm)
+    {
+      return maxRange;
+    }
+  double lo = 0;
+  double hi = maxRange;
+  while (hi - lo > 0.01)
+    {
+      double mid = (lo + hi) / 2;
+      b->SetPosition (Vector (mid, 0, 0));
+      if (loss->CalcRxPower (txPowerDbm, a, b) >= floorDbm)
+        {
+          lo = mid;
+        }
+      else
+        {
+          hi = mid;
+        }
+    }
+  return hi;
+}
+
+} // namespace ns3
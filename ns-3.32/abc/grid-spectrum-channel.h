@@ -0,0 +1,221 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef GRID_SPECTRUM_CHANNEL_H
+#define GRID_SPECTRUM_CHANNEL_H
+
+#include <map>
+#include <queue>
+#include <set>
+#include <utility>
+#include <vector>
+#include "ns3/spectrum-channel.h"
+#include "ns3/spectrum-converter.h"
+#include "ns3/mobility-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/nstime.h"
+#include "spatial-grid-index.h"
+
+namespace ns3 {
+
+/**
+ * \brief SpectrumChannel that only computes the signal of receivers
+ * within a cut-off range of the sender.
+ *
+ * SingleModelSpectrumChannel and MultiModelSpectrumChannel compute the
+ * propagation loss from the sender to every PHY of the channel, so a
+ * frame costs O(n) loss computations and a dense network O(n^2) per
+ * round of traffic, although most receivers are too far to hear.  This
+ * channel keeps the receiver positions in a SpatialGridIndex with cells
+ * of the Range attribute plus Slack, and delivers a frame only to the
+ * receivers within Range of the sender: a few cells instead of the whole
+ * channel.  Everything else is MultiModelSpectrumChannel: PSD conversion
+ * between spectrum models, antenna gains, MaxLossDb, delays and traces.
+ * Receivers are served in the order they were added, as by
+ * SingleModelSpectrumChannel.  MultiModelSpectrumChannel serves them in
+ * that order within each receive spectrum model but takes the models in
+ * uid order, so with every receiver in range the events, hence the
+ * results, are the same as with it only when all the receivers share one
+ * spectrum model; otherwise receptions scheduled at the same time may
+ * start in another order.
+ *
+ * The index is updated from the CourseChange trace of each receiver
+ * mobility model.  A receiver moving at constant velocity does not fire
+ * CourseChange, so it is indexed where it was, and queries look Slack
+ * further: it is re-indexed when it may have moved farther than Slack,
+ * through a queue of deadlines, so moving nodes cost O(log n) each time
+ * they travel Slack meters.  PHYs with no mobility model when added are
+ * indexed on the first transmission after they get one; until then, and
+ * if the sender has none, they always receive, unattenuated, as with the
+ * other channels.
+ *
+ * Receivers are also kept in bands, one per receive spectrum model.  A
+ * transmission visits only the bands whose model overlaps its PSD, found
+ * once per transmit model with the converters, so channels that do not
+ * overlap cost nothing to each other, with or without Range.  As with
+ * MultiModelSpectrumChannel, PHYs must call AddRx again when their
+ * spectrum model changes; those with no model yet are in a band that
+ * overlaps every transmission.
+ *
+ * Accuracy: apart from that order, the only difference with
+ * MultiModelSpectrumChannel is that a receiver beyond Range gets nothing.  If Range is such that the received
+ * power at that distance is below a floor F for the strongest sender,
+ * which GetCutoffRange () computes for a loss model that decreases with
+ * distance, each receiver misses only signals weaker than F, and n such
+ * signals add at most n * F (mW) of interference.  Choosing F 10 dB
+ * below the noise floor bounds the error on the SINR to 10 log10 (1 +
+ * n / 10) dB over n hidden interferers.  For random loss models (fading,
+ * shadowing) the bound only holds with the fading margin included in the
+ * transmit power passed to GetCutoffRange (), and with antennas, with
+ * their maximum gains included as well.  A Range of 0 disables the cut
+ * off.
+ */
+class GridSpectrumChannel : public SpectrumChannel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  GridSpectrumChannel ();
+
+  virtual void AddRx (Ptr<SpectrumPhy> phy);
+  virtual void StartTx (Ptr<SpectrumSignalParameters> params);
+  virtual std::size_t GetNDevices (void) const;
+  virtual Ptr<NetDevice> GetDevice (std::size_t i) const;
+
+  /**
+   * \param range cut-off range (m), 0 to deliver to every receiver
+   */
+  void SetRange (double range);
+
+  /// \return the cut-off range (m)
+  double GetRange (void) const;
+
+  /**
+   * \brief Distance beyond which a loss model keeps the received power
+   * below a floor.
+   *
+   * Bisects over the distance between two fixed nodes, so the model must
+   * be deterministic and its loss non-decreasing with distance; for a
+   * random one, add the fading margin to txPowerDbm.
+   *
+   * \param loss propagation loss model, with its chained models
+   * \param txPowerDbm strongest transmit power, plus antenna gains (dBm)
+   * \param floorDbm received power that may be ignored (dBm)
+   * \param maxRange result if the power is still above the floor there (m)
+   * \return the cut-off range (m)
+   */
+  static double GetCutoffRange (Ptr<PropagationLossModel> loss, double txPowerDbm,
+                                double floorDbm, double maxRange);
+
+  /// \return the number of propagation loss computations so far
+  uint64_t GetNLossComputations (void) const;
+
+  /// \return the number of receivers visited by transmissions so far
+  uint64_t GetNVisits (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// A PHY of the channel.
+  struct Receiver
+  {
+    Ptr<SpectrumPhy> phy;            //!< PHY
+    Ptr<MobilityModel> mobility;     //!< Mobility model, once known
+    uint32_t version;                //!< Bumped on each re-index
+    uint32_t band;                   //!< Band of its spectrum model
+  };
+
+  /// Receivers with the same receive spectrum model.
+  struct Band
+  {
+    Ptr<const SpectrumModel> model;  //!< Model, 0 for PHYs without one
+    std::vector<uint32_t> receivers; //!< Receivers, in AddRx order
+  };
+
+  /// Deadline to re-index a moving receiver.
+  struct Deadline
+  {
+    Time at;           //!< When it may have moved Slack meters
+    uint32_t rx;       //!< Receiver
+    uint32_t version;  //!< Receiver version when queued
+
+    /**
+     * \param o another deadline
+     * \return true if this one is later, for a min-heap
+     */
+    bool operator< (const Deadline &o) const
+    {
+      return at > o.at;
+    }
+  };
+
+  /**
+   * \brief Index a receiver at its current position.
+   * \param rx receiver
+   */
+  void Reindex (uint32_t rx);
+
+  /**
+   * \brief Index the receivers that got a mobility model and those
+   * whose deadline passed.
+   */
+  void Refresh (void);
+
+  /**
+   * \brief CourseChange trace sink.
+   * \param mobility the mobility model that changed course
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+
+  /**
+   * \brief Put a receiver in the band of its current spectrum model.
+   * \param rx receiver
+   */
+  void SetBand (uint32_t rx);
+
+  /**
+   * \param tx model of a transmitted PSD
+   * \return the bands it overlaps, in increasing order
+   */
+  const std::vector<uint32_t> & GetOverlappingBands (Ptr<const SpectrumModel> tx);
+
+  /**
+   * \brief Deliver a signal.
+   * \param params signal, with its received PSD
+   * \param receiver receiving PHY
+   */
+  void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
+
+  /**
+   * \param tx model of the transmitted PSD
+   * \param rx model of the receiver
+   * \return the converter between them, or 0 if they do not overlap
+   */
+  const SpectrumConverter * GetConverter (Ptr<const SpectrumModel> tx, Ptr<const SpectrumModel> rx);
+
+  std::vector<Receiver> m_receivers;                          //!< PHYs, in AddRx order
+  std::map<Ptr<SpectrumPhy>, uint32_t> m_receiverIds;         //!< Position of each PHY
+  std::map<Ptr<const MobilityModel>, std::vector<uint32_t> > m_byMobility; //!< Receivers of each mobility model
+  std::vector<uint32_t> m_unindexed;                          //!< Receivers with no mobility model yet
+  std::priority_queue<Deadline> m_deadlines;                  //!< Moving receivers
+  SpatialGridIndex m_index;                                   //!< Indexed receivers
+  double m_range;                                             //!< Cut-off range (m)
+  double m_slack;                                             //!< Drift allowed before re-indexing (m)
+  double m_cellSize;                                          //!< Cell size of the index, 0 before the first one
+  std::vector<uint32_t> m_candidates;                         //!< Scratch for StartTx
+  std::vector<Band> m_bands;                                  //!< Receivers by spectrum model
+  std::map<SpectrumModelUid_t, uint32_t> m_bandIds;           //!< Band of each model, 0 for none
+  std::map<SpectrumModelUid_t, std::vector<uint32_t> > m_overlapping; //!< Bands of each transmit model
+  std::vector<uint8_t> m_overlaps;                            //!< Scratch for StartTx, per band
+  std::map<std::pair<SpectrumModelUid_t, SpectrumModelUid_t>, SpectrumConverter> m_converters; //!< PSD converters
+  std::set<std::pair<SpectrumModelUid_t, SpectrumModelUid_t> > m_orthogonal; //!< Model pairs with no overlap
+  uint64_t m_nLoss;                                           //!< Loss computations
+  uint64_t m_nVisits;                                         //!< Receivers visited
+};
+
+} // namespace ns3
+
+#endif /* GRID_SPECTRUM_CHANNEL_H */
@@ -6,32 +6,55 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("HelloPacket");
 
-HelloPacket::HelloPacket(Time helloInterval)
-  : m_helloInterval(helloInterval) {
-  m_timer.SetFunction(&HelloPacket::SendHello, this);
+HelloPacket::HelloPacket(Time helloInterval, Time maxJitter)
+  : m_helloInterval(helloInterval),
+    m_maxJitter(maxJitter),
+    m_jitter(CreateObject<UniformRandomVariable> ()),
+    m_timerId(0),
+    m_running(false) {
+}
+
+HelloPacket::~HelloPacket() {
+  Stop();
 }
 
 void HelloPacket::Start() {
-  m_timer.Schedule(m_helloInterval);
+  if (m_running) {
+    return;
+  }
+  // Look the group up here rather than in the constructor: groups are
+  // dropped at Simulator::Destroy.
+  m_group = PeriodicTimerGroup::Get(m_helloInterval);
+  Time jitter = m_maxJitter.IsStrictlyPositive() ? Seconds(m_jitter->GetValue(0, m_maxJitter.GetSeconds())) : Seconds(0);
+  // The first jitter spreads the nodes over the buckets; the group then
+  // redraws an offset of up to maxJitter for every later HELLO.
+  m_timerId = m_group->Add(MakeCallback(&HelloPacket::SendHello, this), m_helloInterval + jitter,
+                           m_maxJitter, m_jitter);
+  m_running = true;
   NS_LOG_INFO("Hello packet timer started with interval " << m_helloInterval.GetSeconds() << " seconds");
 }
 
 void HelloPacket::Stop() {
-  if (m_timer.IsRunning()) {
-    m_timer.Cancel();
+  if (m_running) {
+    m_group->Remove(m_timerId);
+    m_group = 0;
+    m_running = false;
     NS_LOG_INFO("Hello packet timer stopped");
   }
 }
 
 bool HelloPacket::IsRunning() const {
-  return m_timer.IsRunning();
+  return m_running;
+}
+
+int64_t HelloPacket::AssignStreams(int64_t stream) {
+  m_jitter->SetStream(stream);
+  return 1;
 }
 
 void HelloPacket::SendHello() {
   NS_LOG_INFO("Sending hello packet");
   // Implement hello packet sending logic here
-  m_timer.Schedule(m_helloInterval);
 }
 
 } // namespace ns3
-
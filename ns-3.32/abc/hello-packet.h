@@ -3,25 +3,42 @@
 #define HELLO_PACKET_H
 
 #include "ns3/nstime.h"
-#include "ns3/timer.h"
+#include "ns3/random-variable-stream.h"
+#include "periodic-timer-group.h"
 
 namespace ns3 {
 
+/**
+ * Periodic HELLO emission.
+ *
+ * All HelloPacket instances with the same interval share one
+ * PeriodicTimerGroup, so a 10k-node run keeps at most one scheduler event
+ * per phase bucket instead of one per node.  A non-zero maxJitter offsets
+ * the first HELLO of each node by up to that amount, which spreads nodes
+ * over the buckets, and every later HELLO by a fresh offset of up to that
+ * amount from the start of its bucket, so that the nodes of a bucket do
+ * not stay synchronised.  It must be less than the interval.
+ */
 class HelloPacket {
 public:
-  HelloPacket(Time helloInterval);
+  HelloPacket(Time helloInterval, Time maxJitter = Seconds (0));
+  ~HelloPacket();
   void Start();
   void Stop();
   bool IsRunning() const;
+  int64_t AssignStreams(int64_t stream);
 
 private:
   void SendHello();
 
   Time m_helloInterval;
-  Timer m_timer;
+  Time m_maxJitter;
+  Ptr<UniformRandomVariable> m_jitter;
+  Ptr<PeriodicTimerGroup> m_group;
+  uint32_t m_timerId;
+  bool m_running;
 };
 
 } // namespace ns3
 
 #endif /* HELLO_PACKET_H */
-
@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "interference-buffer.h"
+#include <algorithm>
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+InterferenceBuffer::InterferenceBuffer ()
+  : m_base (0)
+{
+}
+
+void
+InterferenceBuffer::Insert (int64_t t, double delta)
+{
+  // After the changes at the same time, as a multimap inserts.
+  std::vector<int64_t>::iterator at = std::upper_bound (m_times.begin (), m_times.end (), t);
+  m_deltas.insert (m_deltas.begin () + (at - m_times.begin ()), delta);
+  m_times.insert (at, t);
+}
+
+void
+InterferenceBuffer::Add (int64_t start, int64_t end, double powerW)
+{
+  NS_ASSERT (start <= end);
+  Insert (start, powerW);
+  Insert (end, -powerW);
+}
+
+double
+InterferenceBuffer::Sum (uint32_t n) const
+{
+  // Four independent accumulators, so that the loop vectorizes without
+  // -ffast-math.
+  const double *d = m_deltas.data ();
+  double s0 = 0;
+  double s1 = 0;
+  double s2 = 0;
+  double s3 = 0;
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    {
+      s0 += d[i];
+      s1 += d[i + 1];
+      s2 += d[i + 2];
+      s3 += d[i + 3];
+    }
+  for (; i < n; ++i)
+    {
+      s0 += d[i];
+    }
+  return (s0 + s1) + (s2 + s3);
+}
+
+double
+InterferenceBuffer::GetPower (int64_t t) const
+{
+  uint32_t n = std::upper_bound (m_times.begin (), m_times.end (), t) - m_times.begin ();
+  return m_base + Sum (n);
+}
+
+uint32_t
+InterferenceBuffer::GetChunks (int64_t start, int64_t end, double ownPowerW,
+                               std::vector<int64_t> &boundaries, std::vector<double> &interferenceW) const
+{
+  boundaries.clear ();
+  interferenceW.clear ();
+  uint32_t first = std::upper_bound (m_times.begin (), m_times.end (), start) - m_times.begin ();
+  uint32_t last = std::lower_bound (m_times.begin () + first, m_times.end (), end) - m_times.begin ();
+  double power = m_base + Sum (first) - ownPowerW;
+  boundaries.reserve (last - first + 2);
+  interferenceW.reserve (last - first + 1);
+  boundaries.push_back (start);
+  interferenceW.push_back (std::max (power, 0.0));
+  for (uint32_t i = first; i < last; ++i)
+    {
+      power += m_deltas[i];
+      if (m_times[i] != boundaries.back ())
+        {
+          boundaries.push_back (m_times[i]);
+          interferenceW.push_back (std::max (power, 0.0));
+        }
+      else
+        {
+          interferenceW.back () = std::max (power, 0.0);   // several changes at once
+        }
+    }
+  boundaries.push_back (end);
+  return interferenceW.size ();
+}
+
+void
+InterferenceBuffer::GetSnrs (double signalW, double noiseW, const std::vector<double> &interferenceW,
+                             std::vector<double> &snr)
+{
+  uint32_t n = interferenceW.size ();
+  snr.resize (n);
+  const double *in = interferenceW.data ();
+  double *out = snr.data ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      out[i] = signalW / (noiseW + in[i]);
+    }
+}
+
+int64_t
+InterferenceBuffer::GetEnergyEnd (int64_t now, double thresholdW) const
+{
+  uint32_t i = std::upper_bound (m_times.begin (), m_times.end (), now) - m_times.begin ();
+  double power = m_base + Sum (i);
+  int64_t t = now;
+  while (power >= thresholdW && i < m_times.size ())
+    {
+      t = m_times[i];
+      // Every change at that time.
+      while (i < m_times.size () && m_times[i] == t)
+        {
+          power += m_deltas[i++];
+        }
+    }
+  return t;
+}
+
+void
+InterferenceBuffer::EraseBefore (int64_t t)
+{
+  uint32_t n = std::lower_bound (m_times.begin (), m_times.end (), t) - m_times.begin ();
+  if (n == 0)
+    {
+      return;
+    }
+  m_base += Sum (n);
+  m_times.erase (m_times.begin (), m_times.begin () + n);
+  m_deltas.erase (m_deltas.begin (), m_deltas.begin () + n);
+  if (m_times.empty ())
+    {
+      m_base = 0;   // no rounding residue once every signal ended
+    }
+}
+
+void
+InterferenceBuffer::Clear (void)
+{
+  m_times.clear ();
+  m_deltas.clear ();
+  m_base = 0;
+}
+
+uint32_t
+InterferenceBuffer::GetNChanges (void) const
+{
+  return m_times.size ();
+}
+
+} // namespace ns3
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef INTERFERENCE_BUFFER_H
+#define INTERFERENCE_BUFFER_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Time-sorted power changes of the signals on a receiver, in
+ * contiguous arrays.
+ *
+ * InterferenceHelper keeps one NiChange per signal start and end in a
+ * std::multimap, each with the total power after it, and walks the map
+ * node by node for every reception.  This buffer keeps the times and the
+ * power deltas in two sorted vectors instead: inserting moves a few
+ * contiguous elements, the power at a time is a reduction over a
+ * contiguous array, unrolled so that the compiler vectorizes it, and the
+ * interference and SNR of the chunks of a reception come out as arrays
+ * that the error-rate loop reads sequentially.
+ *
+ * Times are integer ticks, such as Time::GetTimeStep ().  Changes older
+ * than the receptions still being decoded are folded into a base power
+ * by EraseBefore (), which keeps the arrays short.  Sums are computed in
+ * a different order than InterferenceHelper, so powers may differ in the
+ * last bits.
+ */
+class InterferenceBuffer
+{
+public:
+  InterferenceBuffer ();
+
+  /**
+   * \brief Add a signal.
+   * \param start first tick of the signal
+   * \param end tick after its last one
+   * \param powerW received power (W)
+   */
+  void Add (int64_t start, int64_t end, double powerW);
+
+  /**
+   * \param t a tick
+   * \return the total power at t, changes at t included (W)
+   */
+  double GetPower (int64_t t) const;
+
+  /**
+   * \brief Interference over a reception, chunk by chunk.
+   *
+   * Chunk k spans [boundaries[k], boundaries[k + 1]), with start and end
+   * as first and last boundaries.
+   *
+   * \param start first tick of the reception
+   * \param end tick after its last one
+   * \param ownPowerW power of the received signal, if it was added (W)
+   * \param boundaries output, chunk boundaries
+   * \param interferenceW output, interference of each chunk (W)
+   * \return the number of chunks
+   */
+  uint32_t GetChunks (int64_t start, int64_t end, double ownPowerW,
+                      std::vector<int64_t> &boundaries, std::vector<double> &interferenceW) const;
+
+  /**
+   * \brief SNR of each chunk.
+   * \param signalW received power (W)
+   * \param noiseW thermal noise (W)
+   * \param interferenceW interference of each chunk, from GetChunks () (W)
+   * \param snr output, linear SNR of each chunk
+   */
+  static void GetSnrs (double signalW, double noiseW, const std::vector<double> &interferenceW,
+                       std::vector<double> &snr);
+
+  /**
+   * \param now current tick
+   * \param thresholdW energy detection threshold (W)
+   * \return the first tick from now on when the power is below the
+   * threshold, as for InterferenceHelper::GetEnergyDuration
+   */
+  int64_t GetEnergyEnd (int64_t now, double thresholdW) const;
+
+  /**
+   * \brief Fold the changes before a tick into the base power.
+   * \param t oldest tick still needed
+   */
+  void EraseBefore (int64_t t);
+
+  /// Remove every signal.
+  void Clear (void);
+
+  /// \return the number of power changes kept
+  uint32_t GetNChanges (void) const;
+
+private:
+  /**
+   * \param n number of deltas to add, from the first
+   * \return their sum
+   */
+  double Sum (uint32_t n) const;
+
+  /**
+   * \param t a tick
+   * \param delta power change at t (W)
+   */
+  void Insert (int64_t t, double delta);
+
+  std::vector<int64_t> m_times;   //!< Change times, sorted
+  std::vector<double> m_deltas;   //!< Power change at each time (W)
+  double m_base;                  //!< Power of the erased changes (W)
+};
+
+} // namespace ns3
+
+#endif /* INTERFERENCE_BUFFER_H */
@@ -0,0 +1,440 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ipv4-lpm-routing.h"
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/node.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/global-router-interface.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4LpmRouting");
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv4LpmStaticRouting);
+NS_OBJECT_ENSURE_REGISTERED (Ipv4LpmGlobalRouting);
+
+namespace {
+
+/// A static route and its position, to sort by precedence.
+struct StaticRoute
+{
+  uint32_t index;   //!< Position in Ipv4StaticRouting
+  uint32_t metric;  //!< Metric
+  uint8_t length;   //!< Prefix length
+};
+
+/**
+ * \param a a route
+ * \param b another route
+ * \return true if LookupStatic prefers a over b when both match
+ */
+bool
+StaticPrecedes (const StaticRoute &a, const StaticRoute &b)
+{
+  if (a.length != b.length)
+    {
+      return a.length > b.length;
+    }
+  if (a.length == 32)
+    {
+      return a.index < b.index;  // the scan stops at the first /32
+    }
+  if (a.metric != b.metric)
+    {
+      return a.metric < b.metric;
+    }
+  return a.index > b.index;      // equal metrics: the last one wins
+}
+
+/**
+ * \param entry a route
+ * \return its prefix
+ */
+LpmTrie::Prefix
+MakePrefix (const Ipv4RoutingTableEntry &entry)
+{
+  LpmTrie::Prefix prefix;
+  prefix.key = LpmKey::FromIpv4 (entry.GetDestNetwork ().Get ());
+  prefix.length = entry.GetDestNetworkMask ().GetPrefixLength ();
+  return prefix;
+}
+
+} // anonymous namespace
+
+TypeId
+Ipv4LpmStaticRouting::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv4LpmStaticRouting")
+    .SetParent<Ipv4StaticRouting> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<Ipv4LpmStaticRouting> ()
+  ;
+  return tid;
+}
+
+Ipv4LpmStaticRouting::Ipv4LpmStaticRouting ()
+  : m_stale (true),
+    m_nRoutes (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Ipv4LpmStaticRouting::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_ipv4 = 0;
+  m_trie.Clear ();
+  m_routes.clear ();
+  Ipv4StaticRouting::DoDispose ();
+}
+
+void
+Ipv4LpmStaticRouting::SetIpv4 (Ptr<Ipv4> ipv4)
+{
+  m_ipv4 = ipv4;
+  Ipv4StaticRouting::SetIpv4 (ipv4);
+  Invalidate ();
+}
+
+void
+Ipv4LpmStaticRouting::Invalidate (void)
+{
+  m_stale = true;
+}
+
+void
+Ipv4LpmStaticRouting::NotifyInterfaceUp (uint32_t interface)
+{
+  Ipv4StaticRouting::NotifyInterfaceUp (interface);
+  Invalidate ();
+}
+
+void
+Ipv4LpmStaticRouting::NotifyInterfaceDown (uint32_t interface)
+{
+  Ipv4StaticRouting::NotifyInterfaceDown (interface);
+  Invalidate ();
+}
+
+void
+Ipv4LpmStaticRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
+{
+  Ipv4StaticRouting::NotifyAddAddress (interface, address);
+  Invalidate ();
+}
+
+void
+Ipv4LpmStaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
+{
+  Ipv4StaticRouting::NotifyRemoveAddress (interface, address);
+  Invalidate ();
+}
+
+Ipv4Address
+Ipv4LpmStaticRouting::SelectSource (uint32_t interface, Ipv4Address dest) const
+{
+  // Same rule as Ipv4StaticRouting: the first address, unless a primary
+  // address is on the destination subnet.
+  if (m_ipv4->GetNAddresses (interface) == 1)
+    {
+      return m_ipv4->GetAddress (interface, 0).GetLocal ();
+    }
+  for (uint32_t i = 0; i < m_ipv4->GetNAddresses (interface); ++i)
+    {
+      Ipv4InterfaceAddress address = m_ipv4->GetAddress (interface, i);
+      if (address.GetLocal ().CombineMask (address.GetMask ()) == dest.CombineMask (address.GetMask ())
+          && !address.IsSecondary ())
+        {
+          return address.GetLocal ();
+        }
+    }
+  return m_ipv4->GetAddress (interface, 0).GetLocal ();
+}
+
+Ptr<Ipv4Route>
+Ipv4LpmStaticRouting::Lookup (Ipv4Address dest)
+{
+  uint32_t nRoutes = GetNRoutes ();
+  if (m_stale || nRoutes != m_nRoutes)
+    {
+      std::vector<StaticRoute> order (nRoutes);
+      std::vector<Ipv4RoutingTableEntry> entries;
+      entries.reserve (nRoutes);
+      for (uint32_t i = 0; i < nRoutes; ++i)
+        {
+          entries.push_back (GetRoute (i));
+          order[i].index = i;
+          order[i].metric = GetMetric (i);
+          order[i].length = entries[i].GetDestNetworkMask ().GetPrefixLength ();
+        }
+      std::sort (order.begin (), order.end (), &StaticPrecedes);
+      std::vector<LpmTrie::Prefix> prefixes;
+      m_routes.clear ();
+      for (std::vector<StaticRoute>::const_iterator r = order.begin (); r != order.end (); ++r)
+        {
+          m_routes.push_back (entries[r->index]);
+          prefixes.push_back (MakePrefix (entries[r->index]));
+        }
+      m_trie.Build (prefixes);
+      m_nRoutes = nRoutes;
+      m_stale = false;
+      NS_LOG_LOGIC ("rebuilt the trie of " << nRoutes << " routes");
+    }
+
+  uint32_t i = m_trie.Lookup (LpmKey::FromIpv4 (dest.Get ()));
+  if (i == LpmTrie::NONE)
+    {
+      return 0;
+    }
+  const Ipv4RoutingTableEntry &route = m_routes[i];
+  Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
+  rtentry->SetDestination (route.GetDest ());
+  rtentry->SetSource (SelectSource (route.GetInterface (), route.GetDest ()));
+  rtentry->SetGateway (route.GetGateway ());
+  rtentry->SetOutputDevice (m_ipv4->GetNetDevice (route.GetInterface ()));
+  return rtentry;
+}
+
+Ptr<Ipv4Route>
+Ipv4LpmStaticRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif,
+                                   Socket::SocketErrno &sockerr)
+{
+  Ipv4Address dest = header.GetDestination ();
+  if (dest.IsMulticast () || dest.IsLocalMulticast () || oif)
+    {
+      return Ipv4StaticRouting::RouteOutput (p, header, oif, sockerr);
+    }
+  Ptr<Ipv4Route> rtentry = Lookup (dest);
+  sockerr = rtentry ? Socket::ERROR_NOTERROR : Socket::ERROR_NOROUTETOHOST;
+  return rtentry;
+}
+
+bool
+Ipv4LpmStaticRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                                  UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                                  LocalDeliverCallback lcb, ErrorCallback ecb)
+{
+  uint32_t iif = m_ipv4->GetInterfaceForDevice (idev);
+  Ipv4Address dest = header.GetDestination ();
+  if (dest.IsMulticast () || m_ipv4->IsDestinationAddress (dest, iif) || !m_ipv4->IsForwarding (iif))
+    {
+      return Ipv4StaticRouting::RouteInput (p, header, idev, ucb, mcb, lcb, ecb);
+    }
+  Ptr<Ipv4Route> rtentry = Lookup (dest);
+  if (rtentry)
+    {
+      ucb (rtentry, p, header);
+      return true;
+    }
+  return false;
+}
+
+TypeId
+Ipv4LpmGlobalRouting::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv4LpmGlobalRouting")
+    .SetParent<Ipv4GlobalRouting> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<Ipv4LpmGlobalRouting> ()
+  ;
+  return tid;
+}
+
+uint64_t Ipv4LpmGlobalRouting::g_generation = 0;
+
+Ipv4LpmGlobalRouting::Ipv4LpmGlobalRouting ()
+  : m_stale (true),
+    m_nRoutes (0),
+    m_generation (0),
+    m_randomEcmpRouting (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Ipv4LpmGlobalRouting::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_ipv4 = 0;
+  m_trie.Clear ();
+  m_routes.clear ();
+  Ipv4GlobalRouting::DoDispose ();
+}
+
+void
+Ipv4LpmGlobalRouting::SetIpv4 (Ptr<Ipv4> ipv4)
+{
+  m_ipv4 = ipv4;
+  Ipv4GlobalRouting::SetIpv4 (ipv4);
+  Invalidate ();
+}
+
+void
+Ipv4LpmGlobalRouting::Invalidate (void)
+{
+  m_stale = true;
+}
+
+void
+Ipv4LpmGlobalRouting::InvalidateAll (void)
+{
+  ++g_generation;
+}
+
+void
+Ipv4LpmGlobalRouting::NotifyInterfaceUp (uint32_t interface)
+{
+  Ipv4GlobalRouting::NotifyInterfaceUp (interface);
+  InvalidateAll ();
+}
+
+void
+Ipv4LpmGlobalRouting::NotifyInterfaceDown (uint32_t interface)
+{
+  Ipv4GlobalRouting::NotifyInterfaceDown (interface);
+  InvalidateAll ();
+}
+
+void
+Ipv4LpmGlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
+{
+  Ipv4GlobalRouting::NotifyAddAddress (interface, address);
+  InvalidateAll ();
+}
+
+void
+Ipv4LpmGlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
+{
+  Ipv4GlobalRouting::NotifyRemoveAddress (interface, address);
+  InvalidateAll ();
+}
+
+bool
+Ipv4LpmGlobalRouting::Update (void)
+{
+  uint32_t nRoutes = GetNRoutes ();
+  if (m_stale || nRoutes != m_nRoutes || m_generation != g_generation)
+    {
+      // The attribute is stored by the accessor of Ipv4GlobalRouting,
+      // which a subclass cannot register again, so it is read here rather
+      // than on every lookup.
+      BooleanValue ecmp;
+      GetAttribute ("RandomEcmpRouting", ecmp);
+      m_randomEcmpRouting = ecmp.Get ();
+      // GetRoute () lists host, network then external routes, which is
+      // the order LookupGlobal tries them in: the first match wins.
+      std::vector<LpmTrie::Prefix> prefixes;
+      m_routes.clear ();
+      for (uint32_t i = 0; i < nRoutes; ++i)
+        {
+          m_routes.push_back (*GetRoute (i));
+          prefixes.push_back (MakePrefix (m_routes.back ()));
+        }
+      m_trie.Build (prefixes);
+      m_nRoutes = nRoutes;
+      m_generation = g_generation;
+      m_stale = false;
+      NS_LOG_LOGIC ("rebuilt the trie of " << nRoutes << " routes");
+    }
+  return !m_randomEcmpRouting;
+}
+
+Ptr<Ipv4Route>
+Ipv4LpmGlobalRouting::Lookup (Ipv4Address dest)
+{
+  uint32_t i = m_trie.Lookup (LpmKey::FromIpv4 (dest.Get ()));
+  if (i == LpmTrie::NONE)
+    {
+      return 0;
+    }
+  const Ipv4RoutingTableEntry &route = m_routes[i];
+  Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
+  rtentry->SetDestination (route.GetDest ());
+  rtentry->SetSource (m_ipv4->GetAddress (route.GetInterface (), 0).GetLocal ());
+  rtentry->SetGateway (route.GetGateway ());
+  rtentry->SetOutputDevice (m_ipv4->GetNetDevice (route.GetInterface ()));
+  return rtentry;
+}
+
+Ptr<Ipv4Route>
+Ipv4LpmGlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif,
+                                   Socket::SocketErrno &sockerr)
+{
+  Ipv4Address dest = header.GetDestination ();
+  if (dest.IsMulticast () || oif || !Update ())
+    {
+      return Ipv4GlobalRouting::RouteOutput (p, header, oif, sockerr);
+    }
+  Ptr<Ipv4Route> rtentry = Lookup (dest);
+  sockerr = rtentry ? Socket::ERROR_NOTERROR : Socket::ERROR_NOROUTETOHOST;
+  return rtentry;
+}
+
+bool
+Ipv4LpmGlobalRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                                  UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                                  LocalDeliverCallback lcb, ErrorCallback ecb)
+{
+  uint32_t iif = m_ipv4->GetInterfaceForDevice (idev);
+  Ipv4Address dest = header.GetDestination ();
+  if (dest.IsMulticast () || m_ipv4->IsDestinationAddress (dest, iif) || !m_ipv4->IsForwarding (iif)
+      || !Update ())
+    {
+      return Ipv4GlobalRouting::RouteInput (p, header, idev, ucb, mcb, lcb, ecb);
+    }
+  Ptr<Ipv4Route> rtentry = Lookup (dest);
+  if (rtentry)
+    {
+      ucb (rtentry, p, header);
+      return true;
+    }
+  return false;
+}
+
+Ipv4LpmStaticRoutingHelper *
+Ipv4LpmStaticRoutingHelper::Copy (void) const
+{
+  return new Ipv4LpmStaticRoutingHelper (*this);
+}
+
+Ptr<Ipv4RoutingProtocol>
+Ipv4LpmStaticRoutingHelper::Create (Ptr<Node> node) const
+{
+  return CreateObject<Ipv4LpmStaticRouting> ();
+}
+
+Ipv4LpmGlobalRoutingHelper *
+Ipv4LpmGlobalRoutingHelper::Copy (void) const
+{
+  return new Ipv4LpmGlobalRoutingHelper (*this);
+}
+
+Ptr<Ipv4RoutingProtocol>
+Ipv4LpmGlobalRoutingHelper::Create (Ptr<Node> node) const
+{
+  // As Ipv4GlobalRoutingHelper::Create, so that GlobalRouteManager finds
+  // the routing protocol through the GlobalRouter of the node.
+  Ptr<GlobalRouter> globalRouter = CreateObject<GlobalRouter> ();
+  node->AggregateObject (globalRouter);
+  Ptr<Ipv4LpmGlobalRouting> globalRouting = CreateObject<Ipv4LpmGlobalRouting> ();
+  globalRouter->SetRoutingProtocol (globalRouting);
+  return globalRouting;
+}
+
+void
+Ipv4LpmGlobalRoutingHelper::PopulateRoutingTables (void)
+{
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Ipv4LpmGlobalRouting::InvalidateAll ();
+}
+
+void
+Ipv4LpmGlobalRoutingHelper::RecomputeRoutingTables (void)
+{
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  Ipv4LpmGlobalRouting::InvalidateAll ();
+}
+
+} // namespace ns3
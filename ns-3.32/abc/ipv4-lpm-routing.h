@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef IPV4_LPM_ROUTING_H
+#define IPV4_LPM_ROUTING_H
+
+#include <vector>
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "lpm-trie.h"
+
+namespace ns3 {
+
+/**
+ * \brief Ipv4StaticRouting with unicast lookups in an LpmTrie.
+ *
+ * Ipv4StaticRouting scans every route for each packet.  This subclass
+ * keeps the routes in a compressed trie, rebuilt on the first lookup
+ * after the table changed, and answers unicast lookups with the route
+ * LookupStatic would pick: longest prefix, then lowest metric, then the
+ * last one added, except for /32 routes where the first one added wins.
+ * Multicast, local delivery and lookups bound to an output device go to
+ * Ipv4StaticRouting.
+ *
+ * Changes are detected through the route count and the interface and
+ * address notifications.  Ipv4StaticRouting does not report route
+ * changes, so call Invalidate () after replacing a route by another one
+ * between two lookups.  Reading the table back costs O(n^2) on the list
+ * based Ipv4StaticRouting, which is fine for thousands of routes.
+ */
+class Ipv4LpmStaticRouting : public Ipv4StaticRouting
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  Ipv4LpmStaticRouting ();
+
+  virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif,
+                                      Socket::SocketErrno &sockerr);
+  virtual bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                           UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                           LocalDeliverCallback lcb, ErrorCallback ecb);
+  virtual void NotifyInterfaceUp (uint32_t interface);
+  virtual void NotifyInterfaceDown (uint32_t interface);
+  virtual void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void SetIpv4 (Ptr<Ipv4> ipv4);
+
+  /// Rebuild the trie on the next lookup.
+  void Invalidate (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \param dest destination address
+   * \return the route, or 0
+   */
+  Ptr<Ipv4Route> Lookup (Ipv4Address dest);
+
+  /**
+   * \param interface output interface
+   * \param dest destination address
+   * \return the source address Ipv4StaticRouting would use
+   */
+  Ipv4Address SelectSource (uint32_t interface, Ipv4Address dest) const;
+
+  Ptr<Ipv4> m_ipv4;                              //!< IPv4 stack
+  LpmTrie m_trie;                                //!< Routes, by precedence
+  std::vector<Ipv4RoutingTableEntry> m_routes;   //!< Routes, in trie order
+  bool m_stale;                                  //!< Trie needs a rebuild
+  uint32_t m_nRoutes;                            //!< Route count of the trie
+};
+
+/**
+ * \brief Ipv4GlobalRouting with unicast lookups in an LpmTrie.
+ *
+ * Ipv4GlobalRouting scans its host routes, then its network routes, then
+ * its external routes, and takes the first match of the first list that
+ * has one.  This subclass answers the same, from a trie rebuilt on the
+ * first lookup after the table changed.  Lookups bound to an output
+ * device, and every lookup while RandomEcmpRouting is on, go to
+ * Ipv4GlobalRouting.
+ *
+ * Global routes are recomputed for every node at once and
+ * Ipv4GlobalRouting does not report it, so every trie is rebuilt when a
+ * process-wide generation counter moves.  InvalidateAll () moves it, and
+ * is called on any interface or address notification of any node (the
+ * events RespondToInterfaceEvents recomputes the routes on), by the
+ * PopulateRoutingTables () and RecomputeRoutingTables () of
+ * Ipv4LpmGlobalRoutingHelper and by ParallelGlobalRoutingHelper.  When
+ * calling Ipv4GlobalRoutingHelper::RecomputeRoutingTables () directly,
+ * call it afterwards, unless the recompute runs in the same event as the
+ * notification that made it necessary (as with RespondToInterfaceEvents).
+ * RandomEcmpRouting is read when the trie is rebuilt rather than on every
+ * lookup; call Invalidate () after setting it on a routing protocol that
+ * already routed packets.
+ */
+class Ipv4LpmGlobalRouting : public Ipv4GlobalRouting
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  Ipv4LpmGlobalRouting ();
+
+  virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif,
+                                      Socket::SocketErrno &sockerr);
+  virtual bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                           UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                           LocalDeliverCallback lcb, ErrorCallback ecb);
+  virtual void NotifyInterfaceUp (uint32_t interface);
+  virtual void NotifyInterfaceDown (uint32_t interface);
+  virtual void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void SetIpv4 (Ptr<Ipv4> ipv4);
+
+  /// Rebuild the trie on the next lookup.
+  void Invalidate (void);
+
+  /// Rebuild the trie of every node on its next lookup.
+  static void InvalidateAll (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Rebuild the trie and read RandomEcmpRouting if the table changed.
+   * \return false if lookups must go to Ipv4GlobalRouting
+   */
+  bool Update (void);
+
+  /**
+   * \param dest destination address
+   * \return the route, or 0
+   */
+  Ptr<Ipv4Route> Lookup (Ipv4Address dest);
+
+  Ptr<Ipv4> m_ipv4;                              //!< IPv4 stack
+  LpmTrie m_trie;                                //!< Routes, by precedence
+  std::vector<Ipv4RoutingTableEntry> m_routes;   //!< Routes, in trie order
+  bool m_stale;                                  //!< Trie needs a rebuild
+  uint32_t m_nRoutes;                            //!< Route count of the trie
+  uint64_t m_generation;                         //!< g_generation at the last rebuild
+  bool m_randomEcmpRouting;                      //!< RandomEcmpRouting at the last rebuild
+
+  static uint64_t g_generation;                  //!< Moved by InvalidateAll ()
+};
+
+/**
+ * \brief Installs Ipv4LpmStaticRouting; GetStaticRouting () and the
+ * other Ipv4StaticRoutingHelper methods work as usual.
+ */
+class Ipv4LpmStaticRoutingHelper : public Ipv4StaticRoutingHelper
+{
+public:
+  virtual Ipv4LpmStaticRoutingHelper * Copy (void) const;
+  virtual Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const;
+};
+
+/**
+ * \brief Installs Ipv4LpmGlobalRouting; the Ipv4GlobalRoutingHelper
+ * methods work as usual, and PopulateRoutingTables () and
+ * RecomputeRoutingTables () also invalidate the tries.
+ */
+class Ipv4LpmGlobalRoutingHelper : public Ipv4GlobalRoutingHelper
+{
+public:
+  virtual Ipv4LpmGlobalRoutingHelper * Copy (void) const;
+  virtual Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const;
+
+  /// As Ipv4GlobalRoutingHelper::PopulateRoutingTables ().
+  static void PopulateRoutingTables (void);
+
+  /// As Ipv4GlobalRoutingHelper::RecomputeRoutingTables ().
+  static void RecomputeRoutingTables (void);
+};
+
+} // namespace ns3
+
+#endif /* IPV4_LPM_ROUTING_H */
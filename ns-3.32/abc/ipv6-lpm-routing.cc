@@ -0,0 +1,248 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ipv6-lpm-routing.h"
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/ipv6-route.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv6LpmStaticRouting");
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv6LpmStaticRouting);
+
+namespace {
+
+/// A static route and its position, to sort by precedence.
+struct StaticRoute
+{
+  uint32_t index;   //!< Position in Ipv6StaticRouting
+  uint32_t metric;  //!< Metric
+  uint8_t length;   //!< Prefix length
+};
+
+/**
+ * \param a a route
+ * \param b another route
+ * \return true if LookupStatic prefers a over b when both match
+ */
+bool
+StaticPrecedes (const StaticRoute &a, const StaticRoute &b)
+{
+  if (a.length != b.length)
+    {
+      return a.length > b.length;
+    }
+  if (a.length == 128)
+    {
+      return a.index < b.index;  // the scan stops at the first /128
+    }
+  if (a.metric != b.metric)
+    {
+      return a.metric < b.metric;
+    }
+  return a.index > b.index;      // equal metrics: the last one wins
+}
+
+/**
+ * \param address an address
+ * \return its key
+ */
+LpmKey
+MakeKey (Ipv6Address address)
+{
+  uint8_t bytes[16];
+  address.GetBytes (bytes);
+  return LpmKey::FromIpv6 (bytes);
+}
+
+} // anonymous namespace
+
+TypeId
+Ipv6LpmStaticRouting::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv6LpmStaticRouting")
+    .SetParent<Ipv6StaticRouting> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<Ipv6LpmStaticRouting> ()
+  ;
+  return tid;
+}
+
+Ipv6LpmStaticRouting::Ipv6LpmStaticRouting ()
+  : m_stale (true),
+    m_nRoutes (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Ipv6LpmStaticRouting::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_ipv6 = 0;
+  m_trie.Clear ();
+  m_routes.clear ();
+  Ipv6StaticRouting::DoDispose ();
+}
+
+void
+Ipv6LpmStaticRouting::SetIpv6 (Ptr<Ipv6> ipv6)
+{
+  m_ipv6 = ipv6;
+  Ipv6StaticRouting::SetIpv6 (ipv6);
+  Invalidate ();
+}
+
+void
+Ipv6LpmStaticRouting::Invalidate (void)
+{
+  m_stale = true;
+}
+
+void
+Ipv6LpmStaticRouting::NotifyInterfaceUp (uint32_t interface)
+{
+  Ipv6StaticRouting::NotifyInterfaceUp (interface);
+  Invalidate ();
+}
+
+void
+Ipv6LpmStaticRouting::NotifyInterfaceDown (uint32_t interface)
+{
+  Ipv6StaticRouting::NotifyInterfaceDown (interface);
+  Invalidate ();
+}
+
+void
+Ipv6LpmStaticRouting::NotifyAddAddress (uint32_t interface, Ipv6InterfaceAddress address)
+{
+  Ipv6StaticRouting::NotifyAddAddress (interface, address);
+  Invalidate ();
+}
+
+void
+Ipv6LpmStaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAddress address)
+{
+  Ipv6StaticRouting::NotifyRemoveAddress (interface, address);
+  Invalidate ();
+}
+
+void
+Ipv6LpmStaticRouting::NotifyAddRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop,
+                                      uint32_t interface, Ipv6Address prefixToUse)
+{
+  Ipv6StaticRouting::NotifyAddRoute (dst, mask, nextHop, interface, prefixToUse);
+  Invalidate ();
+}
+
+void
+Ipv6LpmStaticRouting::NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop,
+                                         uint32_t interface, Ipv6Address prefixToUse)
+{
+  Ipv6StaticRouting::NotifyRemoveRoute (dst, mask, nextHop, interface, prefixToUse);
+  Invalidate ();
+}
+
+Ptr<Ipv6Route>
+Ipv6LpmStaticRouting::Lookup (Ipv6Address dest)
+{
+  uint32_t nRoutes = GetNRoutes ();
+  if (m_stale || nRoutes != m_nRoutes)
+    {
+      std::vector<StaticRoute> order (nRoutes);
+      std::vector<Ipv6RoutingTableEntry> entries;
+      entries.reserve (nRoutes);
+      for (uint32_t i = 0; i < nRoutes; ++i)
+        {
+          entries.push_back (GetRoute (i));
+          order[i].index = i;
+          order[i].metric = GetMetric (i);
+          order[i].length = entries[i].GetDestNetworkPrefix ().GetPrefixLength ();
+        }
+      std::sort (order.begin (), order.end (), &StaticPrecedes);
+      std::vector<LpmTrie::Prefix> prefixes;
+      m_routes.clear ();
+      for (std::vector<StaticRoute>::const_iterator r = order.begin (); r != order.end (); ++r)
+        {
+          m_routes.push_back (entries[r->index]);
+          LpmTrie::Prefix prefix;
+          prefix.key = MakeKey (entries[r->index].GetDestNetwork ());
+          prefix.length = r->length;
+          prefixes.push_back (prefix);
+        }
+      m_trie.Build (prefixes);
+      m_nRoutes = nRoutes;
+      m_stale = false;
+      NS_LOG_LOGIC ("rebuilt the trie of " << nRoutes << " routes");
+    }
+
+  uint32_t i = m_trie.Lookup (MakeKey (dest));
+  if (i == LpmTrie::NONE)
+    {
+      return 0;
+    }
+  const Ipv6RoutingTableEntry &route = m_routes[i];
+  uint32_t interface = route.GetInterface ();
+  Ptr<Ipv6Route> rtentry = Create<Ipv6Route> ();
+  // Source selection as in Ipv6StaticRouting::LookupStatic.
+  if (!route.GetGateway ().IsAny () && route.GetDest ().IsAny ())
+    {
+      rtentry->SetSource (m_ipv6->SourceAddressSelection (interface, route.GetPrefixToUse ().IsAny () ? dest : route.GetPrefixToUse ()));
+    }
+  else
+    {
+      rtentry->SetSource (m_ipv6->SourceAddressSelection (interface, route.GetDest ()));
+    }
+  rtentry->SetDestination (route.GetDest ());
+  rtentry->SetGateway (route.GetGateway ());
+  rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interface));
+  return rtentry;
+}
+
+Ptr<Ipv6Route>
+Ipv6LpmStaticRouting::RouteOutput (Ptr<Packet> p, const Ipv6Header &header, Ptr<NetDevice> oif,
+                                   Socket::SocketErrno &sockerr)
+{
+  Ipv6Address dest = header.GetDestinationAddress ();
+  if (dest.IsMulticast () || oif)
+    {
+      return Ipv6StaticRouting::RouteOutput (p, header, oif, sockerr);
+    }
+  Ptr<Ipv6Route> rtentry = Lookup (dest);
+  sockerr = rtentry ? Socket::ERROR_NOTERROR : Socket::ERROR_NOROUTETOHOST;
+  return rtentry;
+}
+
+bool
+Ipv6LpmStaticRouting::RouteInput (Ptr<const Packet> p, const Ipv6Header &header, Ptr<const NetDevice> idev,
+                                  UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                                  LocalDeliverCallback lcb, ErrorCallback ecb)
+{
+  uint32_t iif = m_ipv6->GetInterfaceForDevice (idev);
+  Ipv6Address dest = header.GetDestinationAddress ();
+  if (dest.IsMulticast () || m_ipv6->GetInterfaceForAddress (dest) >= 0 || !m_ipv6->IsForwarding (iif))
+    {
+      return Ipv6StaticRouting::RouteInput (p, header, idev, ucb, mcb, lcb, ecb);
+    }
+  Ptr<Ipv6Route> rtentry = Lookup (dest);
+  if (rtentry)
+    {
+      ucb (idev, rtentry, p, header);
+      return true;
+    }
+  return false;
+}
+
+Ipv6LpmStaticRoutingHelper *
+Ipv6LpmStaticRoutingHelper::Copy (void) const
+{
+  return new Ipv6LpmStaticRoutingHelper (*this);
+}
+
+Ptr<Ipv6RoutingProtocol>
+Ipv6LpmStaticRoutingHelper::Create (Ptr<Node> node) const
+{
+  return CreateObject<Ipv6LpmStaticRouting> ();
+}
+
+} // namespace ns3
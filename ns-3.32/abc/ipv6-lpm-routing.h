@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef IPV6_LPM_ROUTING_H
+#define IPV6_LPM_ROUTING_H
+
+#include <vector>
+#include "ns3/ipv6-static-routing.h"
+#include "ns3/ipv6-static-routing-helper.h"
+#include "ns3/ipv6-routing-table-entry.h"
+#include "lpm-trie.h"
+
+namespace ns3 {
+
+/**
+ * \brief Ipv6StaticRouting with unicast lookups in an LpmTrie.
+ *
+ * The IPv6 counterpart of Ipv4LpmStaticRouting: same precedence as
+ * LookupStatic (longest prefix, lowest metric, last added, first /128),
+ * same lazy rebuild, and multicast, local delivery and lookups bound to
+ * an output device go to Ipv6StaticRouting.
+ */
+class Ipv6LpmStaticRouting : public Ipv6StaticRouting
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  Ipv6LpmStaticRouting ();
+
+  virtual Ptr<Ipv6Route> RouteOutput (Ptr<Packet> p, const Ipv6Header &header, Ptr<NetDevice> oif,
+                                      Socket::SocketErrno &sockerr);
+  virtual bool RouteInput (Ptr<const Packet> p, const Ipv6Header &header, Ptr<const NetDevice> idev,
+                           UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                           LocalDeliverCallback lcb, ErrorCallback ecb);
+  virtual void NotifyInterfaceUp (uint32_t interface);
+  virtual void NotifyInterfaceDown (uint32_t interface);
+  virtual void NotifyAddAddress (uint32_t interface, Ipv6InterfaceAddress address);
+  virtual void NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAddress address);
+  virtual void NotifyAddRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop,
+                               uint32_t interface, Ipv6Address prefixToUse = Ipv6Address::GetZero ());
+  virtual void NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop,
+                                  uint32_t interface, Ipv6Address prefixToUse = Ipv6Address::GetZero ());
+  virtual void SetIpv6 (Ptr<Ipv6> ipv6);
+
+  /// Rebuild the trie on the next lookup.
+  void Invalidate (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \param dest destination address
+   * \return the route, or 0
+   */
+  Ptr<Ipv6Route> Lookup (Ipv6Address dest);
+
+  Ptr<Ipv6> m_ipv6;                              //!< IPv6 stack
+  LpmTrie m_trie;                                //!< Routes, by precedence
+  std::vector<Ipv6RoutingTableEntry> m_routes;   //!< Routes, in trie order
+  bool m_stale;                                  //!< Trie needs a rebuild
+  uint32_t m_nRoutes;                            //!< Route count of the trie
+};
+
+/**
+ * \brief Installs Ipv6LpmStaticRouting; GetStaticRouting () and the
+ * other Ipv6StaticRoutingHelper methods work as usual.
+ */
+class Ipv6LpmStaticRoutingHelper : public Ipv6StaticRoutingHelper
+{
+public:
+  virtual Ipv6LpmStaticRoutingHelper * Copy (void) const;
+  virtual Ptr<Ipv6RoutingProtocol> Create (Ptr<Node> node) const;
+};
+
+} // namespace ns3
+
+#endif /* IPV6_LPM_ROUTING_H */
@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "log-ring.h"
+#include "ns3/abort.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace ns3 {
+
+LogRing *LogRing::g_ring = 0;
+
+LogRing::LogRing (std::string filename, uint32_t capacity)
+  : m_buffer (capacity),
+    m_mask (capacity - 1),
+    m_head (0),
+    m_tail (0),
+    m_stop (false),
+    m_stalls (0),
+    m_file (filename.c_str ()),
+    m_previous (0)
+{
+  NS_ABORT_MSG_IF (!m_file, "cannot open log file " << filename);
+  m_writer = std::thread (&LogRing::Drain, this);
+}
+
+LogRing::~LogRing ()
+{
+  m_stop.store (true, std::memory_order_release);
+  m_writer.join ();
+}
+
+void
+LogRing::Install (std::string filename, uint32_t capacity)
+{
+  NS_ABORT_MSG_IF (g_ring != 0, "a LogRing is already installed");
+  uint32_t size = 1;
+  while (size < capacity)
+    {
+      size <<= 1;
+    }
+  g_ring = new LogRing (filename, size);
+  g_ring->m_previous = std::clog.rdbuf (g_ring);
+}
+
+void
+LogRing::Uninstall (void)
+{
+  if (g_ring == 0)
+    {
+      return;
+    }
+  std::clog.rdbuf (g_ring->m_previous);
+  delete g_ring;
+  g_ring = 0;
+}
+
+uint64_t
+LogRing::GetStalls (void)
+{
+  return g_ring != 0 ? g_ring->m_stalls : 0;
+}
+
+std::streamsize
+LogRing::xsputn (const char *s, std::streamsize n)
+{
+  uint64_t capacity = m_mask + 1;
+  uint64_t head = m_head.load (std::memory_order_relaxed);
+  std::streamsize written = 0;
+  while (written < n)
+    {
+      uint64_t tail = m_tail.load (std::memory_order_acquire);
+      uint64_t space = capacity - (head - tail);
+      if (space == 0)
+        {
+          ++m_stalls;
+          std::this_thread::yield ();
+          continue;
+        }
+      // Copy up to the end of the storage, then wrap on the next turn.
+      uint64_t offset = head & m_mask;
+      uint64_t chunk = std::min<uint64_t> (std::min<uint64_t> (space, n - written), capacity - offset);
+      std::memcpy (&m_buffer[offset], s + written, chunk);
+      head += chunk;
+      written += chunk;
+      m_head.store (head, std::memory_order_release);
+    }
+  return n;
+}
+
+LogRing::int_type
+LogRing::overflow (int_type c)
+{
+  if (!traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      char ch = traits_type::to_char_type (c);
+      xsputn (&ch, 1);
+    }
+  return traits_type::not_eof (c);
+}
+
+int
+LogRing::sync (void)
+{
+  // std::endl calls this after every message; the writer flushes on its
+  // own schedule, so there is nothing to wait for here.
+  return 0;
+}
+
+void
+LogRing::Drain (void)
+{
+  uint64_t capacity = m_mask + 1;
+  uint64_t tail = m_tail.load (std::memory_order_relaxed);
+  for (;;)
+    {
+      bool stop = m_stop.load (std::memory_order_acquire);
+      uint64_t head = m_head.load (std::memory_order_acquire);
+      if (head == tail)
+        {
+          if (stop)
+            {
+              break;
+            }
+          m_file.flush ();
+          std::this_thread::sleep_for (std::chrono::milliseconds (1));
+          continue;
+        }
+      uint64_t offset = tail & m_mask;
+      uint64_t chunk = std::min<uint64_t> (head - tail, capacity - offset);
+      m_file.write (&m_buffer[offset], chunk);
+      tail += chunk;
+      m_tail.store (tail, std::memory_order_release);
+    }
+  m_file.flush ();
+}
+
+} // namespace ns3
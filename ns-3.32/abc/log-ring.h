@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdint.h>
+#include <atomic>
+#include <fstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Moves NS_LOG output off the simulation thread.
+ *
+ * Install () points std::clog, where every NS_LOG statement writes, at a
+ * single-producer single-consumer byte ring.  The simulation thread only
+ * copies characters into the ring; a background thread drains it to the
+ * output file.  Neither side takes a lock: when the ring is full the
+ * producer yields until the writer has caught up, so no message is lost.
+ *
+ * The NS_LOG macros stream their arguments eagerly, so the text is still
+ * formatted on the simulation thread; the file I/O and its latency are
+ * what move to the background.
+ *
+ * \code
+ *   LogRing::Install ("backoff.log");
+ *   LogComponentEnable ("BackoffExample", LOG_LEVEL_ALL);
+ *   ...
+ *   Simulator::Destroy ();
+ *   LogRing::Uninstall ();
+ * \endcode
+ */
+class LogRing : public std::streambuf
+{
+public:
+  /**
+   * \brief Redirect std::clog to a new ring.
+   * \param filename file the background thread writes to
+   * \param capacity ring size in bytes, rounded up to a power of two
+   */
+  static void Install (std::string filename, uint32_t capacity = 1 << 20);
+
+  /**
+   * \brief Flush the ring, stop the writer and restore std::clog.
+   */
+  static void Uninstall (void);
+
+  /**
+   * \return the number of times the producer had to wait for space
+   */
+  static uint64_t GetStalls (void);
+
+protected:
+  // Inherited from std::streambuf
+  virtual int_type overflow (int_type c);
+  virtual std::streamsize xsputn (const char *s, std::streamsize n);
+  virtual int sync (void);
+
+private:
+  /**
+   * \param filename output file
+   * \param capacity ring size in bytes, a power of two
+   */
+  LogRing (std::string filename, uint32_t capacity);
+  ~LogRing ();
+
+  /// Body of the background writer thread.
+  void Drain (void);
+
+  std::vector<char> m_buffer;      //!< Ring storage
+  uint64_t m_mask;                 //!< Capacity - 1
+  std::atomic<uint64_t> m_head;    //!< Bytes written by the producer
+  std::atomic<uint64_t> m_tail;    //!< Bytes consumed by the writer
+  std::atomic<bool> m_stop;        //!< Asks the writer to finish
+  uint64_t m_stalls;               //!< Waits for free space
+  std::ofstream m_file;            //!< Output file
+  std::thread m_writer;            //!< Background writer
+  std::streambuf *m_previous;      //!< std::clog buffer before Install
+
+  static LogRing *g_ring;          //!< Installed ring, if any
+};
+
+} // namespace ns3
+
+#endif /* LOG_RING_H */
@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef LOG_THRESHOLD_H
+#define LOG_THRESHOLD_H
+
+/**
+ * \file
+ * \brief Compile-time ceiling for the NS_LOG macros.
+ *
+ * Optimized builds already drop every NS_LOG statement, while debug
+ * builds keep them all and test a runtime flag in each one.  This header
+ * sits in between: statements whose level is not in the compile-time mask
+ * expand to a constant-false branch, so neither the flag test nor the
+ * argument expressions survive the optimizer.
+ *
+ * The mask is the intersection of a build-wide and a per-component level:
+ * \code
+ *   // configure time, for every file including this header
+ *   CXXFLAGS="-DNS3_LOG_COMPILE_LEVEL=ns3::LOG_LEVEL_WARN" ./waf configure
+ *
+ *   // per file, before the include
+ *   #define NS_LOG_COMPILE_LEVEL ns3::LOG_LEVEL_INFO
+ *   #include "log-threshold.h"
+ * \endcode
+ * Statements that are compiled in still honour LogComponentEnable ().
+ *
+ * Include this header after every ns-3 header, since it redefines the
+ * NS_LOG_* macros from ns3/log.h.
+ */
+
+#include <iostream>
+#include "ns3/log.h"
+
+#ifndef NS3_LOG_COMPILE_LEVEL
+#define NS3_LOG_COMPILE_LEVEL ns3::LOG_LEVEL_ALL
+#endif
+
+#ifndef NS_LOG_COMPILE_LEVEL
+#define NS_LOG_COMPILE_LEVEL ns3::LOG_LEVEL_ALL
+#endif
+
+namespace ns3 {
+namespace {
+
+/// Levels compiled into this translation unit.
+constexpr int g_logCompileLevel = (NS_LOG_COMPILE_LEVEL) & (NS3_LOG_COMPILE_LEVEL);
+
+} // unnamed namespace
+} // namespace ns3
+
+#ifdef NS3_LOG_ENABLE
+
+/**
+ * \ingroup logging
+ * Log \p msg at \p level if \p level is compiled in.
+ */
+#define NS_LOG_COMPILED(level, msg)                     \
+  do                                                    \
+    {                                                   \
+      if (ns3::g_logCompileLevel & (level))             \
+        {                                               \
+          NS_LOG (level, msg);                          \
+        }                                               \
+    }                                                   \
+  while (false)
+
+#undef NS_LOG_ERROR
+#define NS_LOG_ERROR(msg) NS_LOG_COMPILED (ns3::LOG_ERROR, msg)
+
+#undef NS_LOG_WARN
+#define NS_LOG_WARN(msg) NS_LOG_COMPILED (ns3::LOG_WARN, msg)
+
+#undef NS_LOG_DEBUG
+#define NS_LOG_DEBUG(msg) NS_LOG_COMPILED (ns3::LOG_DEBUG, msg)
+
+#undef NS_LOG_INFO
+#define NS_LOG_INFO(msg) NS_LOG_COMPILED (ns3::LOG_INFO, msg)
+
+#undef NS_LOG_LOGIC
+#define NS_LOG_LOGIC(msg) NS_LOG_COMPILED (ns3::LOG_LOGIC, msg)
+
+// The function macros write the prefixes and the name once, in the
+// format of ns3/log-macros-enabled.h, rather than going through NS_LOG,
+// which would prepend the function name again.
+
+#undef NS_LOG_FUNCTION_NOARGS
+#define NS_LOG_FUNCTION_NOARGS()                                        \
+  do                                                                    \
+    {                                                                   \
+      if ((ns3::g_logCompileLevel & ns3::LOG_FUNCTION)                  \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))                       \
+        {                                                               \
+          NS_LOG_APPEND_TIME_PREFIX;                                    \
+          NS_LOG_APPEND_NODE_PREFIX;                                    \
+          NS_LOG_APPEND_CONTEXT;                                        \
+          std::clog << g_log.Name () << ":"                             \
+                    << __FUNCTION__ << "()" << std::endl;               \
+        }                                                               \
+    }                                                                   \
+  while (false)
+
+#undef NS_LOG_FUNCTION
+#define NS_LOG_FUNCTION(parameters)                                     \
+  do                                                                    \
+    {                                                                   \
+      if ((ns3::g_logCompileLevel & ns3::LOG_FUNCTION)                  \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))                       \
+        {                                                               \
+          NS_LOG_APPEND_TIME_PREFIX;                                    \
+          NS_LOG_APPEND_NODE_PREFIX;                                    \
+          NS_LOG_APPEND_CONTEXT;                                        \
+          std::clog << g_log.Name () << ":"                             \
+                    << __FUNCTION__ << "(";                             \
+          ns3::ParameterLogger (std::clog) << parameters;               \
+          std::clog << ")" << std::endl;                                \
+        }                                                               \
+    }                                                                   \
+  while (false)
+
+#endif /* NS3_LOG_ENABLE */
+
+#endif /* LOG_THRESHOLD_H */
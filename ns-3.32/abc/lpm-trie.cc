@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "lpm-trie.h"
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LpmTrie");
+
+const uint32_t LpmTrie::NONE;
+const uint32_t LpmTrie::STRIDE;
+
+LpmTrie::LpmTrie ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LpmTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nodes.clear ();
+  m_leaves.clear ();
+}
+
+void
+LpmTrie::Build (const std::vector<Prefix> &prefixes)
+{
+  NS_LOG_FUNCTION (this << prefixes.size ());
+  Clear ();
+  m_prefixes = prefixes;
+  uint32_t inherited = NONE;
+  std::vector<uint32_t> rest;
+  for (uint32_t i = 0; i < m_prefixes.size (); ++i)
+    {
+      NS_ASSERT (m_prefixes[i].length <= 128);
+      if (m_prefixes[i].length == 0)
+        {
+          inherited = std::min (inherited, i);
+        }
+      else
+        {
+          rest.push_back (i);
+        }
+    }
+  m_nodes.resize (1);
+  BuildNode (0, 0, rest, inherited);
+  m_prefixes.clear ();
+  NS_LOG_LOGIC (prefixes.size () << " prefixes in " << m_nodes.size () << " nodes, "
+                                 << m_leaves.size () << " leaves");
+}
+
+void
+LpmTrie::BuildNode (uint32_t n, uint32_t offset, const std::vector<uint32_t> &prefixes, uint32_t inherited)
+{
+  // Expand the prefixes ending in this node over their slots, and hand
+  // the longer ones down to the children.
+  uint32_t best[64];
+  std::fill (best, best + 64, inherited);
+  std::vector<uint32_t> below[64];
+  for (std::vector<uint32_t>::const_iterator p = prefixes.begin (); p != prefixes.end (); ++p)
+    {
+      const Prefix &prefix = m_prefixes[*p];
+      uint32_t slot = Chunk (prefix.key, offset);
+      if (prefix.length > offset + STRIDE)
+        {
+          below[slot].push_back (*p);
+          continue;
+        }
+      uint32_t span = (1u << (offset + STRIDE - prefix.length)) - 1;
+      for (uint32_t s = slot & ~span; s <= (slot | span); ++s)
+        {
+          best[s] = std::min (best[s], *p);
+        }
+    }
+
+  Node node;
+  node.children = 0;
+  node.leaves = 0;
+  node.firstLeaf = m_leaves.size ();
+  uint32_t nChildren = 0;
+  for (uint32_t s = 0; s < 64; ++s)
+    {
+      if (!below[s].empty ())
+        {
+          node.children |= static_cast<uint64_t> (1) << s;
+          ++nChildren;
+        }
+      else if (m_leaves.size () == node.firstLeaf || m_leaves.back () != best[s])
+        {
+          node.leaves |= static_cast<uint64_t> (1) << s;
+          m_leaves.push_back (best[s]);
+        }
+    }
+  node.firstChild = m_nodes.size ();
+  m_nodes[n] = node;
+  m_nodes.resize (m_nodes.size () + nChildren);
+
+  uint32_t child = node.firstChild;
+  for (uint32_t s = 0; s < 64; ++s)
+    {
+      if (!below[s].empty ())
+        {
+          BuildNode (child++, offset + STRIDE, below[s], best[s]);
+        }
+    }
+}
+
+uint32_t
+LpmTrie::GetNNodes (void) const
+{
+  return m_nodes.size ();
+}
+
+uint32_t
+LpmTrie::GetNLeaves (void) const
+{
+  return m_leaves.size ();
+}
+
+uint64_t
+LpmTrie::GetMemory (void) const
+{
+  return m_nodes.size () * sizeof (Node) + m_leaves.size () * sizeof (uint32_t);
+}
+
+} // namespace ns3
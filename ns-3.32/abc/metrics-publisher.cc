@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "metrics-publisher.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MetricsPublisher");
+
+NS_OBJECT_ENSURE_REGISTERED (MetricsSimulatorImpl);
+
+TypeId
+MetricsSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MetricsSimulatorImpl")
+    .SetParent<DefaultSimulatorImpl> ()
+    .SetGroupName ("Core")
+    .AddConstructor<MetricsSimulatorImpl> ()
+  ;
+  return tid;
+}
+
+MetricsSimulatorImpl::MetricsSimulatorImpl ()
+  : m_inserted (0),
+    m_removed (0)
+{
+}
+
+uint64_t
+MetricsSimulatorImpl::GetPendingEventCount (void) const
+{
+  // Cancelled events stay in the queue and are counted when popped.
+  return m_inserted - m_removed - GetEventCount ();
+}
+
+EventId
+MetricsSimulatorImpl::Schedule (const Time &delay, EventImpl *event)
+{
+  ++m_inserted;
+  return DefaultSimulatorImpl::Schedule (delay, event);
+}
+
+void
+MetricsSimulatorImpl::ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event)
+{
+  ++m_inserted;
+  DefaultSimulatorImpl::ScheduleWithContext (context, delay, event);
+}
+
+EventId
+MetricsSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  ++m_inserted;
+  return DefaultSimulatorImpl::ScheduleNow (event);
+}
+
+void
+MetricsSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () != EventId::UID::DESTROY && !IsExpired (id))
+    {
+      ++m_removed;
+    }
+  DefaultSimulatorImpl::Remove (id);
+}
+
+
+MetricsPublisher::MetricsPublisher ()
+  : m_timer (Timer::CANCEL_ON_DESTROY),
+    m_lastWallMs (0),
+    m_lastEventCount (0)
+{
+  m_timer.SetFunction (&MetricsPublisher::Publish, this);
+}
+
+MetricsPublisher::~MetricsPublisher ()
+{
+  m_ring.Close ();
+}
+
+void
+MetricsPublisher::AddCounter (std::string name, Callback<uint64_t> counter)
+{
+  NS_LOG_FUNCTION (this << name);
+  NS_ASSERT_MSG (!m_ring.IsOpen (), "counters must be added before Start ()");
+  NS_ASSERT_MSG (m_counters.size () < MetricsRecord::MAX_COUNTERS,
+                 "at most " << MetricsRecord::MAX_COUNTERS << " counters are supported");
+  m_names.push_back (name);
+  m_counters.push_back (counter);
+}
+
+void
+MetricsPublisher::Start (std::string name, Time interval, uint32_t capacity)
+{
+  NS_LOG_FUNCTION (this << name << interval << capacity);
+  NS_ASSERT (interval.IsStrictlyPositive ());
+  m_interval = interval;
+  m_ring.Create (name, capacity);
+  for (std::vector<std::string>::const_iterator i = m_names.begin (); i != m_names.end (); ++i)
+    {
+      m_ring.AddCounterName (*i);
+    }
+  m_impl = DynamicCast<MetricsSimulatorImpl> (Simulator::GetImplementation ());
+  if (m_impl == 0)
+    {
+      NS_LOG_INFO ("simulator is not a MetricsSimulatorImpl; queue depth will not be published");
+    }
+  m_clock.Start ();
+  m_lastWallMs = 0;
+  m_lastEventCount = Simulator::GetEventCount ();
+  Publish ();
+}
+
+void
+MetricsPublisher::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_ring.IsOpen ())
+    {
+      return;
+    }
+  m_timer.Cancel ();
+  Publish ();
+  m_timer.Cancel ();
+  m_ring.Close ();
+}
+
+bool
+MetricsPublisher::IsRunning (void) const
+{
+  return m_ring.IsOpen ();
+}
+
+void
+MetricsPublisher::Publish (void)
+{
+  MetricsRecord record;
+  record.m_simTimeNs = Simulator::Now ().GetNanoSeconds ();
+  record.m_wallTimeMs = m_clock.End ();
+  record.m_eventCount = Simulator::GetEventCount ();
+  int64_t elapsedMs = record.m_wallTimeMs - m_lastWallMs;
+  if (elapsedMs > 0)
+    {
+      record.m_eventsPerSecond = (record.m_eventCount - m_lastEventCount) * 1000.0 / elapsedMs;
+      m_lastWallMs = record.m_wallTimeMs;
+      m_lastEventCount = record.m_eventCount;
+    }
+  else
+    {
+      // Less than one wall-clock millisecond since the last sample: keep
+      // accumulating so that the next rate is not computed on noise.
+      record.m_eventsPerSecond = 0;
+    }
+  record.m_pendingEvents = m_impl ? m_impl->GetPendingEventCount () : 0;
+  for (uint32_t i = 0; i < MetricsRecord::MAX_COUNTERS; ++i)
+    {
+      record.m_counters[i] = i < m_counters.size () ? m_counters[i] () : 0;
+    }
+  m_ring.Publish (record);
+  m_timer.Schedule (m_interval);
+}
+
+} // namespace ns3
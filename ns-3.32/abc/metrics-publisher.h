@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef METRICS_PUBLISHER_H
+#define METRICS_PUBLISHER_H
+
+#include <vector>
+#include "ns3/nstime.h"
+#include "ns3/timer.h"
+#include "ns3/callback.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/default-simulator-impl.h"
+#include "metrics-ring.h"
+
+namespace ns3 {
+
+/**
+ * \brief DefaultSimulatorImpl that also keeps track of the scheduler
+ * queue depth.
+ *
+ * Select it with
+ * \code
+ *   GlobalValue::Bind ("SimulatorImplementationType",
+ *                      StringValue ("ns3::MetricsSimulatorImpl"));
+ * \endcode
+ * The only extra cost is one increment per scheduled event.
+ */
+class MetricsSimulatorImpl : public DefaultSimulatorImpl
+{
+public:
+  /**
+   * \brief Get the registered TypeId for this class.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  MetricsSimulatorImpl ();
+
+  /**
+   * \return the number of events currently in the scheduler queue
+   */
+  uint64_t GetPendingEventCount (void) const;
+
+  // Inherited
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual void Remove (const EventId &id);
+
+private:
+  uint64_t m_inserted; //!< Events ever inserted in the scheduler queue
+  uint64_t m_removed;  //!< Events taken out of the queue without running
+};
+
+/**
+ * \brief Periodically publishes simulation progress to a MetricsRing.
+ *
+ * Samples are taken from one self-rescheduling event, so the cost to the
+ * simulation is one event per interval whatever the event rate is.
+ * Counters are pulled through callbacks at sample time; models do not
+ * pay anything to keep them up to date.
+ *
+ * \code
+ *   MetricsPublisher publisher;
+ *   publisher.AddCounter ("rxBytes", MakeBoundCallback (&GetRxBytes, sink));
+ *   publisher.Start ("/ns3-metrics", MilliSeconds (100));
+ * \endcode
+ * and from another shell: `metrics-ring-reader --name=/ns3-metrics`.
+ */
+class MetricsPublisher
+{
+public:
+  MetricsPublisher ();
+  ~MetricsPublisher ();
+
+  /**
+   * \brief Register a counter sampled at every publication.
+   * \param name counter name shown by the reader
+   * \param counter callback returning the current value
+   *
+   * Must be called before Start ().
+   */
+  void AddCounter (std::string name, Callback<uint64_t> counter);
+
+  /**
+   * \brief Create the shared-memory ring and schedule the first sample.
+   * \param name POSIX shared-memory object name, e.g. "/ns3-metrics"
+   * \param interval simulated time between two samples
+   * \param capacity number of samples kept in the ring
+   */
+  void Start (std::string name, Time interval, uint32_t capacity = 1024);
+
+  /**
+   * \brief Publish a last sample and remove the shared-memory ring.
+   */
+  void Stop (void);
+
+  /**
+   * \return true if the publisher is running
+   */
+  bool IsRunning (void) const;
+
+private:
+  /// Take a sample and reschedule.
+  void Publish (void);
+
+  Time m_interval;                            //!< Sampling interval
+  Timer m_timer;                              //!< Sampling timer
+  MetricsRing m_ring;                         //!< Shared-memory ring
+  std::vector<std::string> m_names;           //!< Counter names
+  std::vector<Callback<uint64_t> > m_counters; //!< Counter sources
+  Ptr<MetricsSimulatorImpl> m_impl;           //!< Simulator, if instrumented
+  SystemWallClockMs m_clock;                  //!< Wall clock since Start
+  int64_t m_lastWallMs;                       //!< Wall clock at the last sample
+  uint64_t m_lastEventCount;                  //!< Event count at the last sample
+};
+
+} // namespace ns3
+
+#endif /* METRICS_PUBLISHER_H */
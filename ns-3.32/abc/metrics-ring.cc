@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "metrics-ring.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MetricsRing");
+
+MetricsRing::MetricsRing ()
+  : m_header (0),
+    m_size (0),
+    m_producer (false)
+{
+}
+
+MetricsRing::~MetricsRing ()
+{
+  Close ();
+}
+
+size_t
+MetricsRing::GetSegmentSize (uint32_t capacity)
+{
+  return sizeof (MetricsRingHeader) + capacity * sizeof (MetricsSlot);
+}
+
+MetricsSlot *
+MetricsRing::GetSlot (uint64_t index) const
+{
+  MetricsSlot *slots = reinterpret_cast<MetricsSlot *> (m_header + 1);
+  return &slots[index % m_header->m_capacity];
+}
+
+void
+MetricsRing::Create (std::string name, uint32_t capacity)
+{
+  NS_LOG_FUNCTION (this << name << capacity);
+  NS_ABORT_MSG_IF (m_header != 0, "MetricsRing already attached to " << m_name);
+  NS_ABORT_MSG_IF (capacity == 0, "MetricsRing needs at least one slot");
+
+  int fd = shm_open (name.c_str (), O_CREAT | O_RDWR | O_TRUNC, 0644);
+  NS_ABORT_MSG_IF (fd < 0, "shm_open (" << name << ") failed: " << std::strerror (errno));
+  size_t size = GetSegmentSize (capacity);
+  NS_ABORT_MSG_IF (ftruncate (fd, size) != 0, "ftruncate (" << name << ") failed: " << std::strerror (errno));
+  void *addr = mmap (0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close (fd);
+  NS_ABORT_MSG_IF (addr == MAP_FAILED, "mmap (" << name << ") failed: " << std::strerror (errno));
+
+  std::memset (addr, 0, size);
+  m_header = static_cast<MetricsRingHeader *> (addr);
+  m_header->m_capacity = capacity;
+  m_header->m_nCounters = 0;
+  m_header->m_head.store (0, std::memory_order_relaxed);
+  m_header->m_closed.store (0, std::memory_order_relaxed);
+  m_header->m_version = MetricsRingHeader::VERSION;
+  // Readers check the magic last, so publish it after the rest of the header.
+  std::atomic_thread_fence (std::memory_order_release);
+  m_header->m_magic = MetricsRingHeader::MAGIC;
+
+  m_name = name;
+  m_size = size;
+  m_producer = true;
+}
+
+bool
+MetricsRing::Open (std::string name)
+{
+  NS_LOG_FUNCTION (this << name);
+  NS_ABORT_MSG_IF (m_header != 0, "MetricsRing already attached to " << m_name);
+
+  int fd = shm_open (name.c_str (), O_RDWR, 0);
+  if (fd < 0)
+    {
+      NS_LOG_LOGIC ("no segment named " << name);
+      return false;
+    }
+  struct stat st;
+  if (fstat (fd, &st) != 0 || static_cast<size_t> (st.st_size) < sizeof (MetricsRingHeader))
+    {
+      close (fd);
+      return false;
+    }
+  void *addr = mmap (0, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close (fd);
+  if (addr == MAP_FAILED)
+    {
+      return false;
+    }
+  MetricsRingHeader *header = static_cast<MetricsRingHeader *> (addr);
+  std::atomic_thread_fence (std::memory_order_acquire);
+  if (header->m_magic != MetricsRingHeader::MAGIC
+      || header->m_version != MetricsRingHeader::VERSION
+      || GetSegmentSize (header->m_capacity) > static_cast<size_t> (st.st_size))
+    {
+      NS_LOG_LOGIC ("segment " << name << " has an unexpected layout");
+      munmap (addr, st.st_size);
+      return false;
+    }
+
+  m_header = header;
+  m_name = name;
+  m_size = st.st_size;
+  m_producer = false;
+  return true;
+}
+
+void
+MetricsRing::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_header == 0)
+    {
+      return;
+    }
+  if (m_producer)
+    {
+      m_header->m_closed.store (1, std::memory_order_release);
+      // Readers that are already attached keep their mapping; new readers
+      // will simply not find the segment.
+      shm_unlink (m_name.c_str ());
+    }
+  munmap (m_header, m_size);
+  m_header = 0;
+  m_size = 0;
+  m_producer = false;
+}
+
+bool
+MetricsRing::IsOpen (void) const
+{
+  return m_header != 0;
+}
+
+uint32_t
+MetricsRing::AddCounterName (std::string name)
+{
+  NS_LOG_FUNCTION (this << name);
+  NS_ASSERT_MSG (m_producer, "only the producer can register counters");
+  NS_ABORT_MSG_IF (m_header->m_nCounters >= MetricsRecord::MAX_COUNTERS,
+                   "at most " << MetricsRecord::MAX_COUNTERS << " counters are supported");
+  uint32_t index = m_header->m_nCounters;
+  std::strncpy (m_header->m_counterNames[index], name.c_str (), MetricsRingHeader::NAME_LENGTH - 1);
+  m_header->m_nCounters = index + 1;
+  return index;
+}
+
+std::string
+MetricsRing::GetCounterName (uint32_t index) const
+{
+  NS_ASSERT (index < GetNCounters ());
+  return std::string (m_header->m_counterNames[index]);
+}
+
+uint32_t
+MetricsRing::GetNCounters (void) const
+{
+  return m_header->m_nCounters;
+}
+
+void
+MetricsRing::Publish (const MetricsRecord &record)
+{
+  NS_ASSERT (m_producer);
+  uint64_t head = m_header->m_head.load (std::memory_order_relaxed);
+  MetricsSlot *slot = GetSlot (head);
+  uint64_t seq = slot->m_seq.load (std::memory_order_relaxed);
+  slot->m_seq.store (seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence (std::memory_order_release);
+  slot->m_record = record;
+  slot->m_seq.store (seq + 2, std::memory_order_release);
+  m_header->m_head.store (head + 1, std::memory_order_release);
+}
+
+bool
+MetricsRing::ReadLatest (MetricsRecord &record) const
+{
+  NS_ASSERT (m_header != 0);
+  for (;;)
+    {
+      uint64_t head = m_header->m_head.load (std::memory_order_acquire);
+      if (head == 0)
+        {
+          return false;
+        }
+      const MetricsSlot *slot = GetSlot (head - 1);
+      uint64_t before = slot->m_seq.load (std::memory_order_acquire);
+      if (before & 1)
+        {
+          continue;
+        }
+      std::memcpy (&record, &slot->m_record, sizeof (MetricsRecord));
+      std::atomic_thread_fence (std::memory_order_acquire);
+      if (slot->m_seq.load (std::memory_order_relaxed) == before)
+        {
+          return true;
+        }
+      // The producer lapped us while copying; retry with the newer head.
+    }
+}
+
+uint64_t
+MetricsRing::GetHead (void) const
+{
+  return m_header->m_head.load (std::memory_order_acquire);
+}
+
+bool
+MetricsRing::IsClosed (void) const
+{
+  return m_header->m_closed.load (std::memory_order_acquire) != 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef METRICS_RING_H
+#define METRICS_RING_H
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \brief One sample of the live simulation metrics.
+ */
+struct MetricsRecord
+{
+  static const uint32_t MAX_COUNTERS = 16; //!< Maximum number of user counters
+
+  int64_t m_simTimeNs;           //!< Simulated time of the sample, in ns
+  int64_t m_wallTimeMs;          //!< Wall-clock time since publishing started, in ms
+  uint64_t m_eventCount;         //!< Events executed so far
+  double m_eventsPerSecond;      //!< Events executed per wall-clock second since the last sample
+  uint64_t m_pendingEvents;      //!< Events in the scheduler queue, if known
+  uint64_t m_counters[MAX_COUNTERS]; //!< Values of the registered counters
+};
+
+/**
+ * \brief One slot of the ring.
+ *
+ * The slot is guarded by a sequence number: the writer makes it odd while
+ * the record is being updated and even once it is consistent, so readers
+ * in another process never need a lock.
+ */
+struct MetricsSlot
+{
+  std::atomic<uint64_t> m_seq; //!< Slot sequence number (odd while writing)
+  MetricsRecord m_record;      //!< The sample
+};
+
+/**
+ * \brief Header of the shared-memory segment, followed by the record slots.
+ */
+struct MetricsRingHeader
+{
+  static const uint32_t MAGIC = 0x6e334d52; //!< "n3MR"
+  static const uint32_t VERSION = 1;        //!< Layout version
+  static const uint32_t NAME_LENGTH = 32;   //!< Size of a counter name, including the NUL
+
+  uint32_t m_magic;      //!< Always MAGIC
+  uint32_t m_version;    //!< Always VERSION
+  uint32_t m_capacity;   //!< Number of record slots
+  uint32_t m_nCounters;  //!< Number of registered counters
+  char m_counterNames[MetricsRecord::MAX_COUNTERS][NAME_LENGTH]; //!< Counter names
+  std::atomic<uint64_t> m_head;    //!< Number of records published so far
+  std::atomic<uint32_t> m_closed;  //!< Set by the producer when it detaches
+};
+
+/**
+ * \brief A fixed-size ring of MetricsRecord in POSIX shared memory.
+ *
+ * A single producer (the simulation thread) calls Create() and Publish();
+ * any number of readers in other processes call Open() and ReadLatest().
+ * Nothing goes over the network and the producer never blocks on readers.
+ */
+class MetricsRing
+{
+public:
+  MetricsRing ();
+  ~MetricsRing ();
+
+  /**
+   * \brief Create (or truncate) the segment and become its producer.
+   * \param name POSIX shared-memory object name, e.g. "/ns3-metrics"
+   * \param capacity number of record slots
+   */
+  void Create (std::string name, uint32_t capacity);
+
+  /**
+   * \brief Attach to an existing segment as a reader.
+   * \param name POSIX shared-memory object name
+   * \return false if the segment does not exist or has a different layout
+   */
+  bool Open (std::string name);
+
+  /**
+   * \brief Detach from the segment; the producer also unlinks it.
+   */
+  void Close (void);
+
+  /**
+   * \return true if the ring is attached to a segment
+   */
+  bool IsOpen (void) const;
+
+  /**
+   * \brief Register the name of the next counter column.
+   * \param name counter name, truncated to NAME_LENGTH - 1 characters
+   * \return the column index of the counter
+   */
+  uint32_t AddCounterName (std::string name);
+
+  /**
+   * \param index column index
+   * \return the name of a counter column
+   */
+  std::string GetCounterName (uint32_t index) const;
+
+  /**
+   * \return number of registered counters
+   */
+  uint32_t GetNCounters (void) const;
+
+  /**
+   * \brief Write a sample into the next slot.
+   * \param record the sample
+   */
+  void Publish (const MetricsRecord &record);
+
+  /**
+   * \brief Copy the most recent consistent sample.
+   * \param record the destination
+   * \return false if nothing has been published yet
+   */
+  bool ReadLatest (MetricsRecord &record) const;
+
+  /**
+   * \return the number of records published so far
+   */
+  uint64_t GetHead (void) const;
+
+  /**
+   * \return true if the producer has detached
+   */
+  bool IsClosed (void) const;
+
+private:
+  /**
+   * \param capacity number of record slots
+   * \return the segment size in bytes
+   */
+  static size_t GetSegmentSize (uint32_t capacity);
+  /**
+   * \param index slot index
+   * \return the slot
+   */
+  MetricsSlot * GetSlot (uint64_t index) const;
+
+  std::string m_name;           //!< Shared-memory object name
+  MetricsRingHeader *m_header;  //!< Mapped segment
+  size_t m_size;                //!< Mapped size in bytes
+  bool m_producer;              //!< True if this side created the segment
+};
+
+} // namespace ns3
+
+#endif /* METRICS_RING_H */
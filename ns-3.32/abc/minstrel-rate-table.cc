@@ -0,0 +1,354 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "minstrel-rate-table.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MinstrelRateTable");
+
+MinstrelRateTable::MinstrelRateTable (uint8_t nRates)
+  : m_nRates (nRates),
+    m_nWords ((nRates + 63) / 64),
+    m_ewmaWeight (96),
+    m_lookAround (10),
+    m_scale (nRates, 1),
+    m_rng (CreateObject<UniformRandomVariable> ()),
+    m_nScans (0)
+{
+  NS_LOG_FUNCTION (this << +nRates);
+  NS_ASSERT_MSG (nRates > 0, "need at least one rate");
+  FillSampleTable ();
+}
+
+MinstrelRateTable::~MinstrelRateTable ()
+{
+  m_event.Cancel ();
+}
+
+void
+MinstrelRateTable::SetTxTime (uint8_t rate, Time txTime)
+{
+  NS_ASSERT (rate < m_nRates);
+  int64_t us = txTime.GetMicroSeconds ();
+  // 2^19 / us reference frames per 2^19 us: with the Q12 probability the
+  // throughput stays below 2^31.
+  m_scale[rate] = us > 1 ? static_cast<uint32_t> ((1 << 19) / us) : (1 << 19);
+  if (m_scale[rate] == 0)
+    {
+      m_scale[rate] = 1;
+    }
+}
+
+void
+MinstrelRateTable::SetEwmaLevel (uint8_t percent)
+{
+  NS_ASSERT (percent <= 100);
+  m_ewmaWeight = percent * 128 / 100;
+}
+
+void
+MinstrelRateTable::SetLookAroundRate (uint8_t percent)
+{
+  NS_ASSERT (percent <= 100);
+  m_lookAround = percent;
+}
+
+uint8_t
+MinstrelRateTable::GetNRates (void) const
+{
+  return m_nRates;
+}
+
+void
+MinstrelRateTable::FillSampleTable (void)
+{
+  // Same permutations as Minstrel's InitSampleTable: each rate goes to a
+  // random row of each column, or the next free one.
+  m_sampleTable.assign (m_nRates * SAMPLE_COLUMNS, 0xff);
+  for (uint8_t col = 0; col < SAMPLE_COLUMNS; ++col)
+    {
+      for (uint8_t rate = 0; rate < m_nRates; ++rate)
+        {
+          uint32_t row = m_rng->GetInteger (0, m_nRates - 1);
+          while (m_sampleTable[row * SAMPLE_COLUMNS + col] != 0xff)
+            {
+              row = (row + 1) % m_nRates;
+            }
+          m_sampleTable[row * SAMPLE_COLUMNS + col] = rate;
+        }
+    }
+}
+
+uint32_t
+MinstrelRateTable::AddStation (void)
+{
+  Station station;
+  station.packets = 0;
+  station.samples = 0;
+  station.best = 0;
+  station.second = 0;
+  station.maxProb = 0;
+  station.sampleRow = m_rng->GetInteger (0, m_nRates - 1);
+  station.sampleColumn = 0;
+  station.queued = false;
+  m_stations.push_back (station);
+  m_attempts.resize (m_attempts.size () + m_nRates, 0);
+  m_successes.resize (m_successes.size () + m_nRates, 0);
+  m_prob.resize (m_prob.size () + m_nRates, 0);
+  m_dirty.resize (m_dirty.size () + m_nWords, 0);
+  m_seen.resize (m_seen.size () + m_nWords, 0);
+  return m_stations.size () - 1;
+}
+
+uint32_t
+MinstrelRateTable::GetNStations (void) const
+{
+  return m_stations.size ();
+}
+
+uint32_t
+MinstrelRateTable::GetBytesPerStation (void) const
+{
+  return sizeof (Station) + 3 * m_nRates * sizeof (uint16_t) + 2 * m_nWords * sizeof (uint64_t);
+}
+
+void
+MinstrelRateTable::NotifyTx (uint32_t station, uint8_t rate, uint16_t attempts, uint16_t successes)
+{
+  NS_ASSERT (station < m_stations.size () && rate < m_nRates && successes <= attempts);
+  uint32_t i = station * m_nRates + rate;
+  uint32_t a = m_attempts[i] + attempts;
+  uint32_t s = m_successes[i] + successes;
+  while (a > 0xffff)
+    {
+      a >>= 1;
+      s >>= 1;
+    }
+  m_attempts[i] = a;
+  m_successes[i] = s;
+  m_dirty[station * m_nWords + rate / 64] |= static_cast<uint64_t> (1) << (rate % 64);
+  Station &st = m_stations[station];
+  if (!st.queued)
+    {
+      st.queued = true;
+      m_pending.push_back (station);
+    }
+}
+
+uint8_t
+MinstrelRateTable::FindRate (uint32_t station)
+{
+  Station &st = m_stations[station];
+  ++st.packets;
+  if (static_cast<uint64_t> (st.samples) * 100 < static_cast<uint64_t> (st.packets) * m_lookAround)
+    {
+      uint8_t rate = m_sampleTable[st.sampleRow * SAMPLE_COLUMNS + st.sampleColumn];
+      if (++st.sampleRow == m_nRates)
+        {
+          st.sampleRow = 0;
+          st.sampleColumn = (st.sampleColumn + 1) % SAMPLE_COLUMNS;
+        }
+      if (rate != st.best)
+        {
+          ++st.samples;
+          return rate;
+        }
+    }
+  return st.best;
+}
+
+uint8_t
+MinstrelRateTable::GetBestRate (uint32_t station) const
+{
+  return m_stations[station].best;
+}
+
+uint8_t
+MinstrelRateTable::GetSecondBestRate (uint32_t station) const
+{
+  return m_stations[station].second;
+}
+
+uint8_t
+MinstrelRateTable::GetMaxProbRate (uint32_t station) const
+{
+  return m_stations[station].maxProb;
+}
+
+double
+MinstrelRateTable::GetSuccessProbability (uint32_t station, uint8_t rate) const
+{
+  return static_cast<double> (m_prob[station * m_nRates + rate]) / PROB_ONE;
+}
+
+uint32_t
+MinstrelRateTable::GetThroughput (uint32_t station, uint8_t rate) const
+{
+  // Rates that succeed less than 10% of the time are not worth it, as in
+  // the Linux minstrel.
+  uint32_t prob = m_prob[station * m_nRates + rate];
+  return prob < PROB_ONE / 10 ? 0 : prob * m_scale[rate];
+}
+
+void
+MinstrelRateTable::Scan (uint32_t station)
+{
+  ++m_nScans;
+  Station &st = m_stations[station];
+  const uint16_t *prob = &m_prob[station * m_nRates];
+  uint32_t bestTp = 0;
+  st.best = 0;
+  st.maxProb = 0;
+  for (uint8_t r = 0; r < m_nRates; ++r)
+    {
+      uint32_t tp = GetThroughput (station, r);
+      if (tp > bestTp)
+        {
+          bestTp = tp;
+          st.best = r;
+        }
+      if (prob[r] > prob[st.maxProb])
+        {
+          st.maxProb = r;
+        }
+    }
+  uint32_t secondTp = 0;
+  st.second = st.best == 0 && m_nRates > 1 ? 1 : 0;
+  for (uint8_t r = 0; r < m_nRates; ++r)
+    {
+      uint32_t tp = GetThroughput (station, r);
+      if (r != st.best && tp > secondTp)
+        {
+          secondTp = tp;
+          st.second = r;
+        }
+    }
+}
+
+void
+MinstrelRateTable::UpdateStation (uint32_t station)
+{
+  Station &st = m_stations[station];
+  uint64_t *dirty = &m_dirty[station * m_nWords];
+  uint64_t *seen = &m_seen[station * m_nWords];
+  uint32_t base = station * m_nRates;
+  bool rescan = false;
+  for (uint32_t w = 0; w < m_nWords; ++w)
+    {
+      for (uint64_t bits = dirty[w]; bits != 0; bits &= bits - 1)
+        {
+          uint8_t r = w * 64 + __builtin_ctzll (bits);
+          uint32_t i = base + r;
+          if (m_attempts[i] > 0)
+            {
+              uint32_t prob = (static_cast<uint32_t> (m_successes[i]) << 12) / m_attempts[i];
+              if ((seen[w] >> (r % 64)) & 1)
+                {
+                  prob = (prob * (128 - m_ewmaWeight) + m_prob[i] * m_ewmaWeight) / 128;
+                }
+              m_prob[i] = prob;
+              seen[w] |= static_cast<uint64_t> (1) << (r % 64);
+            }
+          m_attempts[i] = 0;
+          m_successes[i] = 0;
+          rescan = rescan || r == st.best || r == st.second || r == st.maxProb;
+        }
+    }
+  if (rescan)
+    {
+      // A top rate may have dropped: any other rate may replace it.
+      Scan (station);
+    }
+  else
+    {
+      // Only the dirty rates changed and the top ones did not, so only
+      // the dirty ones may displace them.  Ties go to the lower rate, as
+      // in Scan ().
+      for (uint32_t w = 0; w < m_nWords; ++w)
+        {
+          for (uint64_t bits = dirty[w]; bits != 0; bits &= bits - 1)
+            {
+              uint8_t r = w * 64 + __builtin_ctzll (bits);
+              uint32_t tp = GetThroughput (station, r);
+              uint32_t bestTp = GetThroughput (station, st.best);
+              uint32_t secondTp = GetThroughput (station, st.second);
+              if (tp > bestTp || (tp == bestTp && r < st.best))
+                {
+                  st.second = st.best;
+                  st.best = r;
+                }
+              else if (tp > secondTp || (tp == secondTp && r < st.second))
+                {
+                  st.second = r;
+                }
+              uint16_t prob = m_prob[base + r];
+              uint16_t maxProb = m_prob[base + st.maxProb];
+              if (prob > maxProb || (prob == maxProb && r < st.maxProb))
+                {
+                  st.maxProb = r;
+                }
+            }
+        }
+    }
+  for (uint32_t w = 0; w < m_nWords; ++w)
+    {
+      dirty[w] = 0;
+    }
+  NS_LOG_LOGIC ("station " << station << ": best " << +st.best << ", second " << +st.second
+                           << ", max prob " << +st.maxProb);
+}
+
+void
+MinstrelRateTable::Update (void)
+{
+  NS_LOG_FUNCTION (this << m_pending.size ());
+  for (std::vector<uint32_t>::const_iterator s = m_pending.begin (); s != m_pending.end (); ++s)
+    {
+      UpdateStation (*s);
+      m_stations[*s].queued = false;
+    }
+  m_pending.clear ();
+}
+
+void
+MinstrelRateTable::Tick (void)
+{
+  Update ();
+  m_event = Simulator::Schedule (m_interval, &MinstrelRateTable::Tick, this);
+}
+
+void
+MinstrelRateTable::Start (Time interval)
+{
+  NS_LOG_FUNCTION (this << interval);
+  NS_ASSERT (interval.IsStrictlyPositive ());
+  m_interval = interval;
+  m_event.Cancel ();
+  m_event = Simulator::Schedule (m_interval, &MinstrelRateTable::Tick, this);
+}
+
+void
+MinstrelRateTable::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+}
+
+uint64_t
+MinstrelRateTable::GetNScans (void) const
+{
+  return m_nScans;
+}
+
+int64_t
+MinstrelRateTable::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rng->SetStream (stream);
+  FillSampleTable ();
+  return 1;
+}
+
+} // namespace ns3
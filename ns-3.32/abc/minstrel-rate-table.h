@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef MINSTREL_RATE_TABLE_H
+#define MINSTREL_RATE_TABLE_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3 {
+
+/**
+ * \brief Minstrel rate statistics of many stations in fixed point.
+ *
+ * MinstrelWifiManager and MinstrelHtWifiManager keep, for each station, a
+ * vector of RateInfo structures with the success probabilities in double
+ * and a sample table of their own, and every statistics update goes over
+ * all the rates of the station.  Here the statistics of all stations are
+ * in three arrays of 16-bit counters, station by station, and the EWMA
+ * success probabilities are in Q12 fixed point as in the Linux minstrel
+ * (4096 is 1).  The rates attempted since the last update are flagged in
+ * a bitmap per station and the stations with any in a list, so that
+ * Update () only visits those rates, and the best throughput, second best
+ * and highest probability rates are kept up to date incrementally: a
+ * station is scanned in full only when one of these three rates changed.
+ *
+ * One event updates every station each interval, instead of each station
+ * on its own, and sampling reads a single table of random rate
+ * permutations shared by all stations, each starting at a random row.
+ *
+ * Rates are indices from 0 to the number of rates minus 1, and a
+ * throughput is the success probability times the number of reference
+ * frames per second at the rate, SetTxTime () giving the duration of
+ * one; only their order matters.
+ */
+class MinstrelRateTable
+{
+public:
+  /**
+   * \param nRates number of rates, at most 255
+   */
+  MinstrelRateTable (uint8_t nRates);
+  ~MinstrelRateTable ();
+
+  /// Columns of the sample table, as in Minstrel.
+  static const uint8_t SAMPLE_COLUMNS = 10;
+
+  /// Fixed-point 1 of the success probabilities.
+  static const uint16_t PROB_ONE = 1 << 12;
+
+  /**
+   * \param rate a rate
+   * \param txTime duration of a reference frame at this rate
+   */
+  void SetTxTime (uint8_t rate, Time txTime);
+
+  /**
+   * \param percent weight of the past in the EWMA, as Minstrel's EwmaLevel
+   */
+  void SetEwmaLevel (uint8_t percent);
+
+  /**
+   * \param percent share of the frames sent at a sampled rate, as
+   * Minstrel's LookAroundRate
+   */
+  void SetLookAroundRate (uint8_t percent);
+
+  /**
+   * \return the number of rates
+   */
+  uint8_t GetNRates (void) const;
+
+  /**
+   * \return the index of a new station, with no statistics
+   */
+  uint32_t AddStation (void);
+
+  /**
+   * \return the number of stations
+   */
+  uint32_t GetNStations (void) const;
+
+  /**
+   * \return the bytes of state per station
+   */
+  uint32_t GetBytesPerStation (void) const;
+
+  /**
+   * \brief Account the transmissions of a station at a rate.
+   * \param station a station
+   * \param rate the rate
+   * \param attempts number of attempts
+   * \param successes number of them that succeeded
+   */
+  void NotifyTx (uint32_t station, uint8_t rate, uint16_t attempts, uint16_t successes);
+
+  /**
+   * \brief Choose the rate of a new frame: a sampled one for
+   * LookAroundRate percent of the frames, the best throughput rate
+   * otherwise.
+   * \param station a station
+   * \return the rate
+   */
+  uint8_t FindRate (uint32_t station);
+
+  /**
+   * \param station a station
+   * \return its best throughput rate
+   */
+  uint8_t GetBestRate (uint32_t station) const;
+
+  /**
+   * \param station a station
+   * \return its second best throughput rate
+   */
+  uint8_t GetSecondBestRate (uint32_t station) const;
+
+  /**
+   * \param station a station
+   * \return its highest success probability rate
+   */
+  uint8_t GetMaxProbRate (uint32_t station) const;
+
+  /**
+   * \param station a station
+   * \param rate a rate
+   * \return the EWMA success probability of the rate, in [0, 1]
+   */
+  double GetSuccessProbability (uint32_t station, uint8_t rate) const;
+
+  /**
+   * \brief Update the statistics of every station now.
+   */
+  void Update (void);
+
+  /**
+   * \brief Update the statistics of every station periodically.
+   * \param interval update interval, as Minstrel's UpdateStatistics
+   */
+  void Start (Time interval);
+
+  /// Stop the periodic updates.
+  void Stop (void);
+
+  /**
+   * \return the number of full scans of a station so far
+   */
+  uint64_t GetNScans (void) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model, and draw the sample table again.  Return the
+   * number of streams (possibly zero) that have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+private:
+  /// Scalar state of a station.
+  struct Station
+  {
+    uint32_t packets;      //!< Frames since the station was added
+    uint32_t samples;      //!< Of which at a sampled rate
+    uint8_t best;          //!< Best throughput rate
+    uint8_t second;        //!< Second best throughput rate
+    uint8_t maxProb;       //!< Highest probability rate
+    uint8_t sampleRow;     //!< Next row of the sample table
+    uint8_t sampleColumn;  //!< Next column of the sample table
+    bool queued;           //!< In m_pending
+  };
+
+  /// Draw the sample table.
+  void FillSampleTable (void);
+
+  /**
+   * \param station a station
+   */
+  void UpdateStation (uint32_t station);
+
+  /**
+   * \param station a station
+   */
+  void Scan (uint32_t station);
+
+  /**
+   * \param station a station
+   * \param rate a rate
+   * \return its throughput
+   */
+  uint32_t GetThroughput (uint32_t station, uint8_t rate) const;
+
+  /// Periodic update.
+  void Tick (void);
+
+  uint8_t m_nRates;                    //!< Number of rates
+  uint32_t m_nWords;                   //!< Bitmap words per station
+  uint16_t m_ewmaWeight;               //!< Weight of the past, out of 128
+  uint8_t m_lookAround;                //!< Sampled frames, percent
+  std::vector<uint32_t> m_scale;       //!< Reference frames per unit of time, per rate
+  std::vector<uint8_t> m_sampleTable;  //!< Rate permutations, row by row
+  std::vector<Station> m_stations;     //!< Scalar state
+  std::vector<uint16_t> m_attempts;    //!< Attempts since the last update, per station and rate
+  std::vector<uint16_t> m_successes;   //!< Successes since the last update, per station and rate
+  std::vector<uint16_t> m_prob;        //!< EWMA success probability (Q12), per station and rate
+  std::vector<uint64_t> m_dirty;       //!< Rates attempted since the last update
+  std::vector<uint64_t> m_seen;        //!< Rates ever attempted
+  std::vector<uint32_t> m_pending;     //!< Stations with dirty rates
+  Ptr<UniformRandomVariable> m_rng;    //!< Sample table and starting rows
+  Time m_interval;                     //!< Update interval
+  EventId m_event;                     //!< Next update
+  uint64_t m_nScans;                   //!< Full scans
+};
+
+} // namespace ns3
+
+#endif /* MINSTREL_RATE_TABLE_H */
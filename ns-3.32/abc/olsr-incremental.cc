@@ -0,0 +1,445 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "olsr-incremental.h"
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("OlsrIncrementalState");
+
+OlsrIncrementalState::OlsrIncrementalState (uint32_t nNodes, bool incremental)
+  : m_n (nNodes),
+    m_incremental (incremental),
+    m_adj (nNodes),
+    m_mpr (nNodes),
+    m_dist (static_cast<size_t> (nNodes) * nNodes),
+    m_parent (static_cast<size_t> (nNodes) * nNodes),
+    m_nextHop (static_cast<size_t> (nNodes) * nNodes),
+    m_mark (nNodes, 0),
+    m_count (nNodes, 0),
+    m_nSptUpdates (0),
+    m_nMprComputations (0)
+{
+  NS_LOG_FUNCTION (this << nNodes << incremental);
+  m_queue.reserve (nNodes);
+  m_affected.reserve (nNodes);
+  Recompute ();
+}
+
+uint32_t
+OlsrIncrementalState::GetNNodes (void) const
+{
+  return m_n;
+}
+
+const std::vector<uint32_t> &
+OlsrIncrementalState::GetNeighbors (uint32_t node) const
+{
+  return m_adj[node];
+}
+
+const std::vector<uint32_t> &
+OlsrIncrementalState::GetMprSet (uint32_t node) const
+{
+  return m_mpr[node];
+}
+
+uint32_t
+OlsrIncrementalState::GetDistance (uint32_t src, uint32_t dst) const
+{
+  return m_dist[static_cast<size_t> (src) * m_n + dst];
+}
+
+uint32_t
+OlsrIncrementalState::GetNextHop (uint32_t src, uint32_t dst) const
+{
+  return m_nextHop[static_cast<size_t> (src) * m_n + dst];
+}
+
+uint64_t
+OlsrIncrementalState::GetNSptUpdates (void) const
+{
+  return m_nSptUpdates;
+}
+
+uint64_t
+OlsrIncrementalState::GetNMprComputations (void) const
+{
+  return m_nMprComputations;
+}
+
+bool
+OlsrIncrementalState::HasLink (uint32_t u, uint32_t v) const
+{
+  return std::binary_search (m_adj[u].begin (), m_adj[u].end (), v);
+}
+
+bool
+OlsrIncrementalState::AddLink (uint32_t u, uint32_t v)
+{
+  NS_LOG_FUNCTION (this << u << v);
+  NS_ASSERT (u < m_n && v < m_n && u != v);
+  if (HasLink (u, v))
+    {
+      return false;
+    }
+  m_adj[u].insert (std::lower_bound (m_adj[u].begin (), m_adj[u].end (), v), v);
+  m_adj[v].insert (std::lower_bound (m_adj[v].begin (), m_adj[v].end (), u), u);
+  if (!m_incremental)
+    {
+      Recompute ();
+      return true;
+    }
+  for (uint32_t root = 0; root < m_n; ++root)
+    {
+      SptAddLink (root, u, v);
+    }
+  UpdateMprs (u, v);
+  return true;
+}
+
+bool
+OlsrIncrementalState::RemoveLink (uint32_t u, uint32_t v)
+{
+  NS_LOG_FUNCTION (this << u << v);
+  NS_ASSERT (u < m_n && v < m_n);
+  if (!HasLink (u, v))
+    {
+      return false;
+    }
+  m_adj[u].erase (std::lower_bound (m_adj[u].begin (), m_adj[u].end (), v));
+  m_adj[v].erase (std::lower_bound (m_adj[v].begin (), m_adj[v].end (), u));
+  if (!m_incremental)
+    {
+      Recompute ();
+      return true;
+    }
+  for (uint32_t root = 0; root < m_n; ++root)
+    {
+      SptRemoveLink (root, u, v);
+    }
+  UpdateMprs (u, v);
+  return true;
+}
+
+void
+OlsrIncrementalState::Recompute (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t node = 0; node < m_n; ++node)
+    {
+      Bfs (node);
+      ComputeMpr (node);
+    }
+}
+
+void
+OlsrIncrementalState::SetIncremental (bool incremental)
+{
+  m_incremental = incremental;
+}
+
+void
+OlsrIncrementalState::SetParent (uint32_t root, uint32_t node, uint32_t parent)
+{
+  size_t base = static_cast<size_t> (root) * m_n;
+  m_parent[base + node] = parent;
+  m_nextHop[base + node] = parent == root ? node : m_nextHop[base + parent];
+}
+
+void
+OlsrIncrementalState::Bfs (uint32_t root)
+{
+  size_t base = static_cast<size_t> (root) * m_n;
+  std::fill (m_dist.begin () + base, m_dist.begin () + base + m_n, UNREACHABLE);
+  std::fill (m_parent.begin () + base, m_parent.begin () + base + m_n, UNREACHABLE);
+  std::fill (m_nextHop.begin () + base, m_nextHop.begin () + base + m_n, UNREACHABLE);
+  m_dist[base + root] = 0;
+  m_parent[base + root] = root;
+  m_nextHop[base + root] = root;
+  m_queue.clear ();
+  m_queue.push_back (root);
+  Relax (root);
+}
+
+void
+OlsrIncrementalState::Relax (uint32_t root)
+{
+  size_t base = static_cast<size_t> (root) * m_n;
+  // Nodes are queued in hop-count order, so the first relaxation of a
+  // node is final.
+  for (size_t i = 0; i < m_queue.size (); ++i)
+    {
+      uint32_t x = m_queue[i];
+      uint32_t d = m_dist[base + x] + 1;
+      const std::vector<uint32_t> &adj = m_adj[x];
+      for (std::vector<uint32_t>::const_iterator y = adj.begin (); y != adj.end (); ++y)
+        {
+          if (d < m_dist[base + *y])
+            {
+              m_dist[base + *y] = d;
+              SetParent (root, *y, x);
+              m_queue.push_back (*y);
+            }
+        }
+    }
+  m_nSptUpdates += m_queue.size ();
+}
+
+void
+OlsrIncrementalState::SptAddLink (uint32_t root, uint32_t u, uint32_t v)
+{
+  size_t base = static_cast<size_t> (root) * m_n;
+  uint32_t du = m_dist[base + u];
+  uint32_t dv = m_dist[base + v];
+  if (du == dv)
+    {
+      return;
+    }
+  // Only the far end, and the nodes behind it, can get closer.
+  uint32_t near = du < dv ? u : v;
+  uint32_t far = du < dv ? v : u;
+  if (m_dist[base + near] + 1 >= m_dist[base + far])
+    {
+      return;
+    }
+  m_dist[base + far] = m_dist[base + near] + 1;
+  SetParent (root, far, near);
+  m_queue.clear ();
+  m_queue.push_back (far);
+  Relax (root);
+}
+
+void
+OlsrIncrementalState::SptRemoveLink (uint32_t root, uint32_t u, uint32_t v)
+{
+  size_t base = static_cast<size_t> (root) * m_n;
+  uint32_t child;
+  if (m_parent[base + v] == u)
+    {
+      child = v;
+    }
+  else if (m_parent[base + u] == v)
+    {
+      child = u;
+    }
+  else
+    {
+      // Not a tree link: no hop count changes.
+      return;
+    }
+
+  // Detach the subtree below the link.  Parents are neighbours, so the
+  // children of a node are found among its neighbours.
+  m_affected.clear ();
+  m_affected.push_back (child);
+  m_mark[child] = 1;
+  for (size_t i = 0; i < m_affected.size (); ++i)
+    {
+      uint32_t x = m_affected[i];
+      const std::vector<uint32_t> &adj = m_adj[x];
+      for (std::vector<uint32_t>::const_iterator y = adj.begin (); y != adj.end (); ++y)
+        {
+          if (!m_mark[*y] && m_parent[base + *y] == x)
+            {
+              m_mark[*y] = 1;
+              m_affected.push_back (*y);
+            }
+        }
+    }
+  for (std::vector<uint32_t>::const_iterator y = m_affected.begin (); y != m_affected.end (); ++y)
+    {
+      m_dist[base + *y] = UNREACHABLE;
+      m_parent[base + *y] = UNREACHABLE;
+      m_nextHop[base + *y] = UNREACHABLE;
+    }
+
+  // Reattach each detached node to its best neighbour outside the subtree.
+  std::vector<std::pair<uint32_t, uint32_t> > candidates;
+  for (std::vector<uint32_t>::const_iterator y = m_affected.begin (); y != m_affected.end (); ++y)
+    {
+      uint32_t best = UNREACHABLE;
+      uint32_t bestParent = UNREACHABLE;
+      const std::vector<uint32_t> &adj = m_adj[*y];
+      for (std::vector<uint32_t>::const_iterator w = adj.begin (); w != adj.end (); ++w)
+        {
+          uint32_t dw = m_dist[base + *w];
+          if (!m_mark[*w] && dw != UNREACHABLE && dw + 1 < best)
+            {
+              best = dw + 1;
+              bestParent = *w;
+            }
+        }
+      if (best != UNREACHABLE)
+        {
+          m_dist[base + *y] = best;
+          SetParent (root, *y, bestParent);
+          candidates.push_back (std::make_pair (best, *y));
+        }
+    }
+  std::sort (candidates.begin (), candidates.end ());
+
+  // Settle the subtree in hop-count order, merging the sorted candidates
+  // with the nodes they improve, which are queued in hop-count order too.
+  m_queue.clear ();
+  size_t head = 0;
+  std::vector<std::pair<uint32_t, uint32_t> >::const_iterator c = candidates.begin ();
+  while (c != candidates.end () || head < m_queue.size ())
+    {
+      uint32_t x;
+      if (head < m_queue.size ()
+          && (c == candidates.end () || m_dist[base + m_queue[head]] <= c->first))
+        {
+          x = m_queue[head++];
+        }
+      else
+        {
+          x = (c++)->second;
+          if (c[-1].first != m_dist[base + x])
+            {
+              // Improved since, and queued with its final hop count.
+              continue;
+            }
+        }
+      uint32_t d = m_dist[base + x] + 1;
+      const std::vector<uint32_t> &adj = m_adj[x];
+      for (std::vector<uint32_t>::const_iterator y = adj.begin (); y != adj.end (); ++y)
+        {
+          if (m_mark[*y] && d < m_dist[base + *y])
+            {
+              m_dist[base + *y] = d;
+              SetParent (root, *y, x);
+              m_queue.push_back (*y);
+            }
+        }
+    }
+  for (std::vector<uint32_t>::const_iterator y = m_affected.begin (); y != m_affected.end (); ++y)
+    {
+      m_mark[*y] = 0;
+    }
+  m_nSptUpdates += m_affected.size ();
+}
+
+void
+OlsrIncrementalState::UpdateMprs (uint32_t u, uint32_t v)
+{
+  // Nodes whose 1-hop or 2-hop neighbourhood contains the link.
+  std::vector<uint32_t> nodes;
+  nodes.push_back (u);
+  nodes.push_back (v);
+  nodes.insert (nodes.end (), m_adj[u].begin (), m_adj[u].end ());
+  nodes.insert (nodes.end (), m_adj[v].begin (), m_adj[v].end ());
+  std::sort (nodes.begin (), nodes.end ());
+  nodes.erase (std::unique (nodes.begin (), nodes.end ()), nodes.end ());
+  for (std::vector<uint32_t>::const_iterator x = nodes.begin (); x != nodes.end (); ++x)
+    {
+      ComputeMpr (*x);
+    }
+}
+
+void
+OlsrIncrementalState::ComputeMpr (uint32_t node)
+{
+  enum { NONE = 0, N1 = 1, N2 = 2, COVERED = 3 };
+  ++m_nMprComputations;
+  std::vector<uint32_t> &mpr = m_mpr[node];
+  mpr.clear ();
+  const std::vector<uint32_t> &n1 = m_adj[node];
+
+  // Strict 2-hop neighbours, with the number of neighbours covering each.
+  std::vector<uint32_t> n2;
+  m_mark[node] = N1;
+  for (std::vector<uint32_t>::const_iterator y = n1.begin (); y != n1.end (); ++y)
+    {
+      m_mark[*y] = N1;
+    }
+  for (std::vector<uint32_t>::const_iterator y = n1.begin (); y != n1.end (); ++y)
+    {
+      for (std::vector<uint32_t>::const_iterator z = m_adj[*y].begin (); z != m_adj[*y].end (); ++z)
+        {
+          if (m_mark[*z] == NONE)
+            {
+              m_mark[*z] = N2;
+              n2.push_back (*z);
+            }
+          if (m_mark[*z] == N2)
+            {
+              ++m_count[*z];
+            }
+        }
+    }
+  uint32_t uncovered = n2.size ();
+
+  // Neighbours which are the only ones to reach some 2-hop neighbour.
+  for (std::vector<uint32_t>::const_iterator y = n1.begin (); y != n1.end (); ++y)
+    {
+      for (std::vector<uint32_t>::const_iterator z = m_adj[*y].begin (); z != m_adj[*y].end (); ++z)
+        {
+          if (m_mark[*z] >= N2 && m_count[*z] == 1)
+            {
+              mpr.push_back (*y);
+              break;
+            }
+        }
+    }
+  for (std::vector<uint32_t>::const_iterator y = mpr.begin (); y != mpr.end (); ++y)
+    {
+      for (std::vector<uint32_t>::const_iterator z = m_adj[*y].begin (); z != m_adj[*y].end (); ++z)
+        {
+          if (m_mark[*z] == N2)
+            {
+              m_mark[*z] = COVERED;
+              --uncovered;
+            }
+        }
+    }
+
+  // Then the neighbour covering most uncovered 2-hop neighbours, ties
+  // broken by degree and then by the lowest address.
+  while (uncovered > 0)
+    {
+      uint32_t best = 0;
+      uint32_t bestReach = 0;
+      uint32_t bestDegree = 0;
+      for (std::vector<uint32_t>::const_iterator y = n1.begin (); y != n1.end (); ++y)
+        {
+          uint32_t reach = 0;
+          for (std::vector<uint32_t>::const_iterator z = m_adj[*y].begin (); z != m_adj[*y].end (); ++z)
+            {
+              reach += m_mark[*z] == N2;
+            }
+          uint32_t degree = m_adj[*y].size ();
+          if (reach > bestReach || (reach == bestReach && reach > 0 && degree > bestDegree))
+            {
+              best = *y;
+              bestReach = reach;
+              bestDegree = degree;
+            }
+        }
+      NS_ASSERT (bestReach > 0);
+      mpr.push_back (best);
+      for (std::vector<uint32_t>::const_iterator z = m_adj[best].begin (); z != m_adj[best].end (); ++z)
+        {
+          if (m_mark[*z] == N2)
+            {
+              m_mark[*z] = COVERED;
+              --uncovered;
+            }
+        }
+    }
+  std::sort (mpr.begin (), mpr.end ());
+
+  m_mark[node] = NONE;
+  for (std::vector<uint32_t>::const_iterator y = n1.begin (); y != n1.end (); ++y)
+    {
+      m_mark[*y] = NONE;
+    }
+  for (std::vector<uint32_t>::const_iterator z = n2.begin (); z != n2.end (); ++z)
+    {
+      m_mark[*z] = NONE;
+      m_count[*z] = 0;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef OLSR_INCREMENTAL_H
+#define OLSR_INCREMENTAL_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief OLSR MPR sets and hop-count routing tables of every node,
+ * maintained across symmetric link changes.
+ *
+ * OLSR recomputes the MPR set and the whole routing table of a node on
+ * every HELLO or TC change, i.e. a BFS over all nodes per change and per
+ * node.  This class keeps one shortest-path tree per node instead and
+ * repairs it on each link change:
+ *
+ * - a link addition only relaxes the nodes whose hop count decreases,
+ *   walking outwards from the closer end of the link;
+ * - a link removal only touches the subtree hanging below the link, which
+ *   is detached and settled again from its boundary, in hop-count order.
+ *
+ * The MPR set of a node depends on its 1-hop and 2-hop neighbourhood
+ * only, so a change of link (u, v) recomputes the MPR sets of u, v and
+ * their neighbours, with the RFC 3626 section 8.3.1 heuristic.
+ *
+ * With incremental updates disabled, every change recomputes all trees
+ * and MPR sets, as OLSR does; both modes give the same hop counts and
+ * MPR sets.  Next hops may differ between equal-cost paths.
+ */
+class OlsrIncrementalState
+{
+public:
+  /// Hop count of unreachable nodes.
+  static const uint32_t UNREACHABLE = 0xffffffff;
+
+  /**
+   * \param nNodes number of nodes
+   * \param incremental repair trees and MPR sets instead of recomputing them
+   */
+  OlsrIncrementalState (uint32_t nNodes, bool incremental = true);
+
+  /**
+   * \brief Add a symmetric link.
+   * \param u one end
+   * \param v other end
+   * \return false if the link already existed
+   */
+  bool AddLink (uint32_t u, uint32_t v);
+
+  /**
+   * \brief Remove a symmetric link.
+   * \param u one end
+   * \param v other end
+   * \return false if the link did not exist
+   */
+  bool RemoveLink (uint32_t u, uint32_t v);
+
+  /**
+   * \param u one end
+   * \param v other end
+   * \return true if the link exists
+   */
+  bool HasLink (uint32_t u, uint32_t v) const;
+
+  /// Recompute every tree and MPR set from scratch.
+  void Recompute (void);
+
+  /**
+   * \param incremental repair trees and MPR sets instead of recomputing them
+   */
+  void SetIncremental (bool incremental);
+
+  /**
+   * \return the number of nodes
+   */
+  uint32_t GetNNodes (void) const;
+
+  /**
+   * \param node a node
+   * \return the symmetric neighbours of the node
+   */
+  const std::vector<uint32_t> & GetNeighbors (uint32_t node) const;
+
+  /**
+   * \param node a node
+   * \return the MPR set of the node, sorted
+   */
+  const std::vector<uint32_t> & GetMprSet (uint32_t node) const;
+
+  /**
+   * \param src source node
+   * \param dst destination node
+   * \return hop count from src to dst, or UNREACHABLE
+   */
+  uint32_t GetDistance (uint32_t src, uint32_t dst) const;
+
+  /**
+   * \param src source node
+   * \param dst destination node
+   * \return first hop from src to dst, or UNREACHABLE
+   */
+  uint32_t GetNextHop (uint32_t src, uint32_t dst) const;
+
+  /**
+   * \return the number of (tree, node) entries updated so far
+   */
+  uint64_t GetNSptUpdates (void) const;
+
+  /**
+   * \return the number of MPR set computations so far
+   */
+  uint64_t GetNMprComputations (void) const;
+
+private:
+  /**
+   * \brief Rebuild the tree of a root with a BFS.
+   * \param root tree root
+   */
+  void Bfs (uint32_t root);
+
+  /**
+   * \brief Repair the tree of a root after adding link (u, v).
+   * \param root tree root
+   * \param u one end
+   * \param v other end
+   */
+  void SptAddLink (uint32_t root, uint32_t u, uint32_t v);
+
+  /**
+   * \brief Repair the tree of a root after removing link (u, v).
+   * \param root tree root
+   * \param u one end
+   * \param v other end
+   */
+  void SptRemoveLink (uint32_t root, uint32_t u, uint32_t v);
+
+  /**
+   * \brief Relax the tree of a root from the nodes queued in m_queue.
+   * \param root tree root
+   */
+  void Relax (uint32_t root);
+
+  /**
+   * \brief Set the parent of a node and derive its next hop.
+   * \param root tree root
+   * \param node the node
+   * \param parent its new parent
+   */
+  void SetParent (uint32_t root, uint32_t node, uint32_t parent);
+
+  /**
+   * \brief Recompute the MPR set of a node.
+   * \param node the node
+   */
+  void ComputeMpr (uint32_t node);
+
+  /**
+   * \brief Recompute the MPR sets whose neighbourhood contains link (u, v).
+   * \param u one end
+   * \param v other end
+   */
+  void UpdateMprs (uint32_t u, uint32_t v);
+
+  uint32_t m_n;                                  //!< Number of nodes
+  bool m_incremental;                            //!< Repair instead of recompute
+  std::vector<std::vector<uint32_t> > m_adj;     //!< Sorted neighbours of each node
+  std::vector<std::vector<uint32_t> > m_mpr;     //!< MPR set of each node
+  // Trees, indexed by root * m_n + node.
+  std::vector<uint32_t> m_dist;                  //!< Hop counts
+  std::vector<uint32_t> m_parent;                //!< Parents in the trees
+  std::vector<uint32_t> m_nextHop;               //!< First hops
+  // Workspace.
+  std::vector<uint32_t> m_queue;                 //!< BFS queue
+  std::vector<uint32_t> m_affected;              //!< Detached subtree
+  std::vector<uint8_t> m_mark;                   //!< Per-node flags
+  std::vector<uint32_t> m_count;                 //!< Per-node counters
+  uint64_t m_nSptUpdates;                        //!< Tree entries updated
+  uint64_t m_nMprComputations;                   //!< MPR sets computed
+};
+
+} // namespace ns3
+
+#endif /* OLSR_INCREMENTAL_H */
@@ -0,0 +1,283 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "parallel-global-routing-helper.h"
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-global-routing.h"
+#include "global-spf.h"
+#include "ipv4-lpm-routing.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ParallelGlobalRoutingHelper");
+
+namespace {
+
+/// Roots computed between two installs, to bound the memory of routes.
+const uint32_t BATCH_SIZE = 256;
+
+/// Routing state kept between calls.
+struct State
+{
+  GlobalSpf spf;                                      //!< SPF of every router
+  std::vector<uint32_t> addresses;                    //!< (node, interface, address, mask) of every router interface
+  std::vector<std::pair<Ipv4Address, Ipv4Mask> > prefixes;  //!< Subnet of each destination
+  uint32_t nRecomputed;                               //!< Routers recomputed by the last call
+
+  State ()
+    : nRecomputed (0)
+  {
+  }
+};
+
+/// \return the routing state
+State &
+GetState (void)
+{
+  static State state;
+  return state;
+}
+
+/**
+ * \param protocol a routing protocol
+ * \return the global routing inside it, if any
+ */
+Ptr<Ipv4GlobalRouting>
+FindGlobalRouting (Ptr<Ipv4RoutingProtocol> protocol)
+{
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (protocol);
+  if (list)
+    {
+      for (uint32_t i = 0; i < list->GetNRoutingProtocols (); ++i)
+        {
+          int16_t priority;
+          Ptr<Ipv4GlobalRouting> global = DynamicCast<Ipv4GlobalRouting> (list->GetRoutingProtocol (i, priority));
+          if (global)
+            {
+              return global;
+            }
+        }
+      return 0;
+    }
+  return DynamicCast<Ipv4GlobalRouting> (protocol);
+}
+
+/**
+ * \param node a node
+ * \return the global routing of the node, if any
+ */
+Ptr<Ipv4GlobalRouting>
+GetGlobalRouting (Ptr<Node> node)
+{
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  if (!ipv4 || !ipv4->GetRoutingProtocol ())
+    {
+      return 0;
+    }
+  return FindGlobalRouting (ipv4->GetRoutingProtocol ());
+}
+
+/**
+ * \brief Read the topology of the routers.
+ * \param edges links between up router interfaces
+ * \param destinations up routers on each subnet
+ * \param prefixes each subnet
+ * \param addresses every router interface address, up or down
+ */
+void
+ReadTopology (std::vector<GlobalSpf::Edge> &edges, std::vector<std::vector<uint32_t> > &destinations,
+              std::vector<std::pair<Ipv4Address, Ipv4Mask> > &prefixes, std::vector<uint32_t> &addresses)
+{
+  std::map<std::pair<uint32_t, uint32_t>, std::vector<uint32_t> > subnets;
+  for (uint32_t i = 0; i < NodeList::GetNNodes (); ++i)
+    {
+      Ptr<Node> node = NodeList::GetNode (i);
+      if (!GetGlobalRouting (node))
+        {
+          continue;
+        }
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      for (uint32_t j = 0; j < ipv4->GetNInterfaces (); ++j)
+        {
+          Ptr<NetDevice> device = ipv4->GetNetDevice (j);
+          Ptr<Channel> channel = device ? device->GetChannel () : 0;
+          if (!channel)
+            {
+              continue; // loopback
+            }
+          // Subnets of down interfaces stay listed, unattached, so that an
+          // interface event only changes one attachment.
+          bool up = ipv4->IsUp (j);
+          for (uint32_t a = 0; a < ipv4->GetNAddresses (j); ++a)
+            {
+              Ipv4InterfaceAddress address = ipv4->GetAddress (j, a);
+              Ipv4Mask mask = address.GetMask ();
+              std::vector<uint32_t> &attached = subnets[std::make_pair (address.GetLocal ().CombineMask (mask).Get (), mask.Get ())];
+              if (up)
+                {
+                  attached.push_back (i);
+                }
+              addresses.push_back (i);
+              addresses.push_back (j);
+              addresses.push_back (address.GetLocal ().Get ());
+              addresses.push_back (mask.Get ());
+            }
+          if (!up)
+            {
+              continue;
+            }
+          for (uint32_t d = 0; d < channel->GetNDevices (); ++d)
+            {
+              Ptr<NetDevice> peerDevice = channel->GetDevice (d);
+              Ptr<Node> peer = peerDevice->GetNode ();
+              if (peerDevice == device || !GetGlobalRouting (peer))
+                {
+                  continue;
+                }
+              Ptr<Ipv4> peerIpv4 = peer->GetObject<Ipv4> ();
+              int32_t peerInterface = peerIpv4->GetInterfaceForDevice (peerDevice);
+              if (peerInterface < 0 || !peerIpv4->IsUp (peerInterface) || peerIpv4->GetNAddresses (peerInterface) == 0)
+                {
+                  continue;
+                }
+              GlobalSpf::Edge e;
+              e.from = i;
+              e.fromPort = j;
+              e.to = peer->GetId ();
+              e.toPort = peerInterface;
+              e.metric = ipv4->GetMetric (j);
+              edges.push_back (e);
+            }
+        }
+    }
+  for (std::map<std::pair<uint32_t, uint32_t>, std::vector<uint32_t> >::iterator s = subnets.begin (); s != subnets.end (); ++s)
+    {
+      std::vector<uint32_t> &attached = s->second;
+      std::sort (attached.begin (), attached.end ());
+      attached.erase (std::unique (attached.begin (), attached.end ()), attached.end ());
+      destinations.push_back (attached);
+      prefixes.push_back (std::make_pair (Ipv4Address (s->first.first), Ipv4Mask (s->first.second)));
+    }
+}
+
+/**
+ * \brief Replace the routes of a router.
+ * \param state routing state
+ * \param root the router
+ * \param routes first-hop edge towards each subnet, or GlobalSpf::NONE
+ */
+void
+InstallRoutes (const State &state, uint32_t root, const std::vector<uint32_t> &routes)
+{
+  Ptr<Ipv4GlobalRouting> global = GetGlobalRouting (NodeList::GetNode (root));
+  while (global->GetNRoutes () > 0)
+    {
+      global->RemoveRoute (0);
+    }
+  for (uint32_t j = 0; j < routes.size (); ++j)
+    {
+      if (routes[j] == GlobalSpf::NONE)
+        {
+          continue;
+        }
+      const GlobalSpf::Edge &e = state.spf.GetEdge (routes[j]);
+      Ipv4Address nextHop = NodeList::GetNode (e.to)->GetObject<Ipv4> ()->GetAddress (e.toPort, 0).GetLocal ();
+      global->AddNetworkRouteTo (state.prefixes[j].first, state.prefixes[j].second, nextHop, e.fromPort);
+    }
+  Ptr<Ipv4LpmGlobalRouting> lpm = DynamicCast<Ipv4LpmGlobalRouting> (global);
+  if (lpm)
+    {
+      lpm->Invalidate ();
+    }
+}
+
+/**
+ * \brief Read the topology and recompute the routers it requires.
+ * \param state routing state
+ */
+void
+Update (State &state)
+{
+  std::vector<GlobalSpf::Edge> edges;
+  std::vector<std::vector<uint32_t> > destinations;
+  std::vector<uint32_t> addresses;
+  state.prefixes.clear ();
+  ReadTopology (edges, destinations, state.prefixes, addresses);
+  if (addresses != state.addresses)
+    {
+      // Next hops are addresses: rewrite every table.
+      state.spf.Reset ();
+      state.addresses.swap (addresses);
+    }
+
+  std::vector<uint32_t> roots;
+  std::vector<uint32_t> pending = state.spf.Update (NodeList::GetNNodes (), edges, destinations);
+  for (std::vector<uint32_t>::const_iterator r = pending.begin (); r != pending.end (); ++r)
+    {
+      if (GetGlobalRouting (NodeList::GetNode (*r)))
+        {
+          roots.push_back (*r);
+        }
+    }
+  NS_LOG_LOGIC ("recomputing " << roots.size () << " routers, " << edges.size () << " links, "
+                               << destinations.size () << " subnets");
+
+  std::vector<std::vector<uint32_t> > routes;
+  for (uint32_t first = 0; first < roots.size (); first += BATCH_SIZE)
+    {
+      std::vector<uint32_t> batch (roots.begin () + first,
+                                   roots.begin () + std::min<size_t> (first + BATCH_SIZE, roots.size ()));
+      state.spf.Compute (batch, routes);
+      for (uint32_t i = 0; i < batch.size (); ++i)
+        {
+          InstallRoutes (state, batch[i], routes[i]);
+        }
+    }
+  state.nRecomputed = roots.size ();
+}
+
+} // anonymous namespace
+
+void
+ParallelGlobalRoutingHelper::PopulateRoutingTables (uint32_t nThreads)
+{
+  NS_LOG_FUNCTION (nThreads);
+  State &state = GetState ();
+  state.spf.SetThreads (nThreads);
+  state.spf.Reset ();
+  Update (state);
+}
+
+void
+ParallelGlobalRoutingHelper::RecomputeRoutingTables (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Update (GetState ());
+}
+
+uint32_t
+ParallelGlobalRoutingHelper::GetNRecomputed (void)
+{
+  return GetState ().nRecomputed;
+}
+
+void
+ParallelGlobalRoutingHelper::Reset (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  State &state = GetState ();
+  state.spf.Reset ();
+  state.addresses.clear ();
+  state.prefixes.clear ();
+  state.nRecomputed = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef PARALLEL_GLOBAL_ROUTING_HELPER_H
+#define PARALLEL_GLOBAL_ROUTING_HELPER_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \brief Drop-in replacement for Ipv4GlobalRoutingHelper::PopulateRoutingTables
+ * and RecomputeRoutingTables, with SPF spread over threads and
+ * incremental recomputation.
+ *
+ * The topology is read from the nodes themselves: every node with an
+ * Ipv4GlobalRouting protocol (alone or in Ipv4ListRouting) is a router,
+ * and every up interface links it to the up interfaces of the other
+ * routers on the same channel, at the interface metric.  SPF from every
+ * router runs in GlobalSpf on a pool of threads; the resulting routes are
+ * installed on the simulation thread, one network route per subnet of
+ * the other routers, towards the closest router on that subnet.
+ * Directly connected subnets are left to Ipv4StaticRouting, as usual.
+ *
+ * RecomputeRoutingTables () reads the topology again and only runs SPF,
+ * and rewrites the routing table, of the routers whose shortest paths a
+ * changed link or interface can affect.  Any address change recomputes
+ * every router.
+ *
+ * These routes replace the whole table of each Ipv4GlobalRouting, so do
+ * not mix with Ipv4GlobalRoutingHelper, and leave
+ * ns3::Ipv4GlobalRouting::RespondToInterfaceEvents off: call
+ * RecomputeRoutingTables () after the interface events instead.
+ */
+class ParallelGlobalRoutingHelper
+{
+public:
+  /**
+   * \brief Compute and install the routes of every router.
+   * \param nThreads SPF threads, 0 for one per hardware thread
+   */
+  static void PopulateRoutingTables (uint32_t nThreads = 0);
+
+  /**
+   * \brief Update the routes of the routers affected by topology changes
+   * since the last call.
+   */
+  static void RecomputeRoutingTables (void);
+
+  /**
+   * \return the number of routers whose routes the last call recomputed
+   */
+  static uint32_t GetNRecomputed (void);
+
+  /// Forget the topology, e.g. before building another simulation.
+  static void Reset (void);
+};
+
+} // namespace ns3
+
+#endif /* PARALLEL_GLOBAL_ROUTING_HELPER_H */
@@ -0,0 +1,259 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "periodic-timer-group.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PeriodicTimerGroup");
+
+std::map<int64_t, Ptr<PeriodicTimerGroup> > PeriodicTimerGroup::g_groups;
+
+Ptr<PeriodicTimerGroup>
+PeriodicTimerGroup::Get (Time interval, uint32_t nBuckets)
+{
+  NS_LOG_FUNCTION (interval << nBuckets);
+  std::map<int64_t, Ptr<PeriodicTimerGroup> >::const_iterator it = g_groups.find (interval.GetTimeStep ());
+  if (it != g_groups.end ())
+    {
+      return it->second;
+    }
+  if (g_groups.empty ())
+    {
+      Simulator::ScheduleDestroy (&PeriodicTimerGroup::DestroyGroups);
+    }
+  Ptr<PeriodicTimerGroup> group = Create<PeriodicTimerGroup> (interval, nBuckets);
+  g_groups[interval.GetTimeStep ()] = group;
+  return group;
+}
+
+void
+PeriodicTimerGroup::DestroyGroups (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_groups.clear ();
+}
+
+PeriodicTimerGroup::PeriodicTimerGroup (Time interval, uint32_t nBuckets)
+  : m_interval (interval.GetTimeStep ()),
+    m_buckets (nBuckets),
+    m_events (nBuckets),
+    m_starts (nBuckets, 0),
+    m_cursors (nBuckets, 0),
+    m_nActive (0)
+{
+  NS_LOG_FUNCTION (this << interval << nBuckets);
+  NS_ASSERT_MSG (interval.IsStrictlyPositive (), "the interval must be positive");
+  NS_ASSERT_MSG (nBuckets > 0 && nBuckets <= m_interval, "need 1 to interval time steps buckets");
+  // Round up so that the buckets cover the whole interval; the last ones
+  // may then start past it and are never used.
+  m_width = (m_interval + nBuckets - 1) / nBuckets;
+}
+
+uint32_t
+PeriodicTimerGroup::Add (Callback<void> callback, Time delay, Time maxJitter,
+                         Ptr<UniformRandomVariable> jitter)
+{
+  NS_LOG_FUNCTION (this << delay << maxJitter);
+  NS_ASSERT (!delay.IsStrictlyNegative ());
+  NS_ASSERT_MSG (!maxJitter.IsStrictlyNegative () && maxJitter.GetTimeStep () < m_interval,
+                 "the jitter must be less than the interval");
+  NS_ASSERT_MSG (!maxJitter.IsStrictlyPositive () || jitter != 0, "a jitter needs a random variable");
+  Member member;
+  member.callback = callback;
+  member.notBefore = Simulator::Now () + delay;
+  member.phase = member.notBefore.GetTimeStep () % m_interval;
+  // Round the phase up so that no expiry happens early; past the last
+  // bucket that starts within the interval, the next one is bucket 0 of
+  // the following period.
+  member.bucket = (member.phase + m_width - 1) / m_width;
+  if (static_cast<int64_t> (member.bucket) * m_width >= m_interval)
+    {
+      member.bucket = 0;
+    }
+  member.active = true;
+  member.maxJitter = maxJitter.GetTimeStep ();
+  member.jitter = jitter;
+  member.offset = DrawOffset (member);
+  uint32_t id = m_members.size ();
+  m_members.push_back (member);
+  ++m_nActive;
+
+  // Ids grow with insertion, so inserting after the members that do not
+  // expire later keeps (offset, phase, insertion) order.
+  uint32_t b = member.bucket;
+  std::vector<uint32_t> &bucket = m_buckets[b];
+  bool wasEmpty = bucket.empty ();
+  std::vector<uint32_t>::iterator pos = bucket.end ();
+  while (pos != bucket.begin () && Before (id, *(pos - 1)))
+    {
+      --pos;
+    }
+  uint32_t index = pos - bucket.begin ();
+  bucket.insert (pos, id);
+  if (wasEmpty)
+    {
+      ScheduleBucket (b);
+    }
+  else if (index < m_cursors[b])
+    {
+      // Its offset has passed in this period: it starts at the next one.
+      ++m_cursors[b];
+    }
+  else if (index == m_cursors[b])
+    {
+      ScheduleNext (b);
+    }
+  NS_LOG_LOGIC ("timer " << id << " in bucket " << b << " of " << m_buckets.size ());
+  return id;
+}
+
+void
+PeriodicTimerGroup::Remove (uint32_t id)
+{
+  NS_LOG_FUNCTION (this << id);
+  NS_ASSERT (id < m_members.size ());
+  Member &member = m_members[id];
+  if (!member.active)
+    {
+      return;
+    }
+  member.active = false;
+  member.callback = Callback<void> ();
+  member.jitter = 0;
+  --m_nActive;
+  uint32_t b = member.bucket;
+  std::vector<uint32_t> &bucket = m_buckets[b];
+  std::vector<uint32_t>::iterator pos = std::find (bucket.begin (), bucket.end (), id);
+  if (static_cast<uint32_t> (pos - bucket.begin ()) < m_cursors[b])
+    {
+      --m_cursors[b];
+    }
+  bucket.erase (pos);
+  if (bucket.empty ())
+    {
+      m_events[b].Cancel ();
+    }
+}
+
+bool
+PeriodicTimerGroup::Before (uint32_t a, uint32_t b) const
+{
+  const Member &x = m_members[a];
+  const Member &y = m_members[b];
+  if (x.offset != y.offset)
+    {
+      return x.offset < y.offset;
+    }
+  if (x.phase != y.phase)
+    {
+      return x.phase < y.phase;
+    }
+  return a < b;
+}
+
+int64_t
+PeriodicTimerGroup::DrawOffset (Member &member)
+{
+  if (member.maxJitter <= 0)
+    {
+      return 0;
+    }
+  // Uniform over [0, maxJitter] time steps, which may not fit 32 bits.
+  int64_t offset = static_cast<int64_t> (member.jitter->GetValue (0, static_cast<double> (member.maxJitter) + 1));
+  return std::min (offset, member.maxJitter);
+}
+
+void
+PeriodicTimerGroup::ScheduleBucket (uint32_t bucket)
+{
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  int64_t at = static_cast<int64_t> (bucket) * m_width;
+  if (at < now)
+    {
+      at += ((now - at + m_interval - 1) / m_interval) * m_interval;
+    }
+  m_starts[bucket] = at;
+  m_cursors[bucket] = 0;
+  ScheduleNext (bucket);
+}
+
+void
+PeriodicTimerGroup::ScheduleNext (uint32_t bucket)
+{
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  int64_t at = m_starts[bucket] + m_members[m_buckets[bucket][m_cursors[bucket]]].offset;
+  m_events[bucket].Cancel ();
+  m_events[bucket] = Simulator::Schedule (TimeStep (std::max (at, now) - now), &PeriodicTimerGroup::Fire, this, bucket);
+}
+
+void
+PeriodicTimerGroup::Fire (uint32_t bucket)
+{
+  NS_LOG_FUNCTION (this << bucket);
+  Time now = Simulator::Now ();
+  // Callbacks may add or remove timers, which moves the cursor and may
+  // reschedule the bucket.
+  std::vector<uint32_t> &ids = m_buckets[bucket];
+  while (m_cursors[bucket] < ids.size ())
+    {
+      const Member &member = m_members[ids[m_cursors[bucket]]];
+      if (m_starts[bucket] + member.offset > now.GetTimeStep ())
+        {
+          break;
+        }
+      ++m_cursors[bucket];
+      if (member.notBefore <= now)
+        {
+          // Copy: the callback may grow m_members.
+          Callback<void> callback = member.callback;
+          callback ();
+        }
+    }
+  if (ids.empty ())
+    {
+      return;
+    }
+  if (m_cursors[bucket] == ids.size ())
+    {
+      // End of the period: draw the offsets of the next one.
+      m_starts[bucket] += m_interval;
+      m_cursors[bucket] = 0;
+      bool jittered = false;
+      for (std::vector<uint32_t>::const_iterator i = ids.begin (); i != ids.end (); ++i)
+        {
+          Member &member = m_members[*i];
+          if (member.maxJitter > 0)
+            {
+              member.offset = DrawOffset (member);
+              jittered = true;
+            }
+        }
+      if (jittered)
+        {
+          std::sort (ids.begin (), ids.end (), Order (this));
+        }
+    }
+  ScheduleNext (bucket);
+}
+
+Time
+PeriodicTimerGroup::GetInterval (void) const
+{
+  return TimeStep (m_interval);
+}
+
+uint32_t
+PeriodicTimerGroup::GetNBuckets (void) const
+{
+  return m_buckets.size ();
+}
+
+uint32_t
+PeriodicTimerGroup::GetNMembers (void) const
+{
+  return m_nActive;
+}
+
+} // namespace ns3
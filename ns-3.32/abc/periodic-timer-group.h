@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef PERIODIC_TIMER_GROUP_H
+#define PERIODIC_TIMER_GROUP_H
+
+#include <map>
+#include <vector>
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * \brief Periodic timers with a common interval sharing scheduler events.
+ *
+ * The interval is cut into phase buckets of equal width, the interval
+ * divided by the number of buckets rounded up to a time step.  A member is
+ * placed in the bucket its phase (expiry time modulo the interval) rounds
+ * up to, and each non-empty bucket owns a single periodic event that
+ * expires all its members.  N timers thus cost at most GetNBuckets ()
+ * pending events instead of N.
+ *
+ * The price is that expiries are delayed by less than one bucket width.
+ * A member added with a maximum jitter also gets a fresh random offset
+ * in [0, maxJitter] from the start of its bucket at every period, as a
+ * timer rescheduled with jitter each time would: the bucket event then
+ * walks its members in offset order, rescheduling itself at the next
+ * offset, so jittered members cost one event each per period but still
+ * at most one pending event per bucket.  Members of a bucket expire in
+ * (offset, phase, insertion) order, so runs are deterministic and follow
+ * the order the uncoalesced timers would have had.
+ */
+class PeriodicTimerGroup : public SimpleRefCount<PeriodicTimerGroup>
+{
+public:
+  /**
+   * \brief Get the group shared by every timer of this interval.
+   * \param interval period of the timers
+   * \param nBuckets number of phase buckets used if the group is created
+   * \return the group
+   *
+   * Groups live until Simulator::Destroy ().
+   */
+  static Ptr<PeriodicTimerGroup> Get (Time interval, uint32_t nBuckets = 64);
+
+  /**
+   * \param interval period of the timers
+   * \param nBuckets number of phase buckets
+   */
+  PeriodicTimerGroup (Time interval, uint32_t nBuckets);
+
+  /**
+   * \brief Add a periodic timer.
+   * \param callback invoked at every expiry
+   * \param delay time to the first expiry; later ones follow every interval
+   * \param maxJitter largest random offset of each expiry, less than the
+   *        interval; 0 for none
+   * \param jitter draws the offsets; required if maxJitter is not 0
+   * \return an identifier for Remove ()
+   */
+  uint32_t Add (Callback<void> callback, Time delay, Time maxJitter = Seconds (0),
+                Ptr<UniformRandomVariable> jitter = 0);
+
+  /**
+   * \brief Stop a periodic timer.
+   * \param id identifier returned by Add ()
+   */
+  void Remove (uint32_t id);
+
+  /**
+   * \return the period of the timers
+   */
+  Time GetInterval (void) const;
+
+  /**
+   * \return the number of phase buckets
+   */
+  uint32_t GetNBuckets (void) const;
+
+  /**
+   * \return the number of active timers
+   */
+  uint32_t GetNMembers (void) const;
+
+private:
+  /// A periodic timer.
+  struct Member
+  {
+    Callback<void> callback;           //!< Invoked at every expiry
+    int64_t phase;                     //!< Expiry time modulo the interval, in time steps
+    Time notBefore;                    //!< First expiry
+    uint32_t bucket;                   //!< Bucket index
+    bool active;                       //!< False once removed
+    int64_t maxJitter;                 //!< Largest offset, in time steps
+    int64_t offset;                    //!< Offset in the current period, in time steps
+    Ptr<UniformRandomVariable> jitter; //!< Draws the offsets
+  };
+
+  /**
+   * \param a a member id
+   * \param b another member id
+   * \return true if a expires before b within a period
+   */
+  bool Before (uint32_t a, uint32_t b) const;
+
+  /// Expiry order of the members of a bucket, for std::sort.
+  struct Order
+  {
+    /// \param group the group of the members
+    Order (const PeriodicTimerGroup *group)
+      : group (group)
+    {
+    }
+    /**
+     * \param a a member id
+     * \param b another member id
+     * \return true if a expires before b within a period
+     */
+    bool operator() (uint32_t a, uint32_t b) const
+    {
+      return group->Before (a, b);
+    }
+    const PeriodicTimerGroup *group; //!< Group of the members
+  };
+
+  /**
+   * \param member a member
+   * \return a new offset for it, in time steps
+   */
+  int64_t DrawOffset (Member &member);
+
+  /**
+   * \brief Expire the members of a bucket that are due, then schedule the
+   * next one or the next period.
+   * \param bucket bucket index
+   */
+  void Fire (uint32_t bucket);
+
+  /**
+   * \brief Start the first period of a bucket, not before now.
+   * \param bucket bucket index
+   */
+  void ScheduleBucket (uint32_t bucket);
+
+  /**
+   * \brief Schedule the bucket event at the next member of the period.
+   * \param bucket bucket index
+   */
+  void ScheduleNext (uint32_t bucket);
+
+  /// Drop every group at Simulator::Destroy ().
+  static void DestroyGroups (void);
+
+  int64_t m_interval;                            //!< Interval, in time steps
+  int64_t m_width;                               //!< Bucket width, in time steps
+  std::vector<Member> m_members;                 //!< Members, indexed by id
+  std::vector<std::vector<uint32_t> > m_buckets; //!< Ids of each bucket, in expiry order
+  std::vector<EventId> m_events;                 //!< Pending event of each bucket
+  std::vector<int64_t> m_starts;                 //!< Start of the current period of each bucket
+  std::vector<uint32_t> m_cursors;               //!< First member of each bucket not yet expired this period
+  uint32_t m_nActive;                            //!< Number of active members
+
+  static std::map<int64_t, Ptr<PeriodicTimerGroup> > g_groups; //!< Groups by interval
+};
+
+} // namespace ns3
+
+#endif /* PERIODIC_TIMER_GROUP_H */
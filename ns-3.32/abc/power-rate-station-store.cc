@@ -0,0 +1,464 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include <algorithm>
+#include <cmath>
+#include "power-rate-station-store.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-source-accessor.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PowerRateStationStore");
+
+NS_OBJECT_ENSURE_REGISTERED (PowerRateStationStore);
+
+TypeId
+PowerRateStationStore::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PowerRateStationStore")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<PowerRateStationStore> ()
+    .AddTraceSource ("RateChange",
+                     "The rate index of a station changed.",
+                     MakeTraceSourceAccessor (&PowerRateStationStore::m_rateChange),
+                     "ns3::PowerRateStationStore::LevelChangeTracedCallback")
+    .AddTraceSource ("PowerChange",
+                     "The power level of a station changed.",
+                     MakeTraceSourceAccessor (&PowerRateStationStore::m_powerChange),
+                     "ns3::PowerRateStationStore::LevelChangeTracedCallback")
+  ;
+  return tid;
+}
+
+PowerRateStationStore::PowerRateStationStore ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+PowerRateStationStore::AddStation (uint8_t rate, uint8_t power)
+{
+  m_rate.push_back (rate);
+  m_power.push_back (power);
+  m_successes.push_back (0);
+  m_failures.push_back (0);
+  m_attempts.push_back (0);
+  return m_rate.size () - 1;
+}
+
+uint32_t
+PowerRateStationStore::GetNStations (void) const
+{
+  return m_rate.size ();
+}
+
+uint32_t
+PowerRateStationStore::GetBytesPerStation (void) const
+{
+  return 2 * sizeof (uint8_t) + 3 * sizeof (uint16_t);
+}
+
+ParfPowerControl::ParfPowerControl (Ptr<PowerRateStationStore> store, uint8_t nRates, uint8_t minPower,
+                                    uint8_t maxPower, uint16_t attemptThreshold, uint16_t successThreshold)
+  : m_store (store),
+    m_nRates (nRates),
+    m_minPower (minPower),
+    m_maxPower (maxPower),
+    m_attemptThreshold (attemptThreshold),
+    m_successThreshold (successThreshold)
+{
+  NS_LOG_FUNCTION (this << +nRates << +minPower << +maxPower);
+  NS_ASSERT (nRates > 0 && minPower <= maxPower);
+}
+
+uint32_t
+ParfPowerControl::AddStation (void)
+{
+  m_retries.push_back (0);
+  m_flags.push_back (0);
+  return m_store->AddStation (0, m_maxPower);
+}
+
+uint32_t
+ParfPowerControl::GetBytesPerStation (void) const
+{
+  return m_store->GetBytesPerStation () + 2 * sizeof (uint8_t);
+}
+
+void
+ParfPowerControl::ReportDataOk (uint32_t station)
+{
+  PowerRateStationStore &s = *m_store;
+  uint16_t attempts = s.GetAttempts (station) + 1;
+  uint16_t successes = s.GetSuccesses (station) + 1;
+  s.SetFailures (station, 0);
+  m_flags[station] = 0;
+  m_retries[station] = 0;
+  // Exact matches, as in ParfWifiManager: a failure can carry the
+  // attempts past the threshold, which then waits for the next reset.
+  if (successes == m_successThreshold || attempts == m_attemptThreshold)
+    {
+      uint8_t rate = s.GetRate (station);
+      uint8_t power = s.GetPower (station);
+      if (rate < m_nRates - 1)
+        {
+          s.SetRate (station, rate + 1);
+          m_flags[station] = RECOVERY_RATE;
+        }
+      else
+        {
+          if (power > m_minPower)
+            {
+              s.SetPower (station, power - 1);
+            }
+          m_flags[station] = RECOVERY_POWER;
+        }
+      attempts = 0;
+      successes = 0;
+    }
+  s.SetAttempts (station, attempts);
+  s.SetSuccesses (station, successes);
+}
+
+void
+ParfPowerControl::ReportDataFailed (uint32_t station)
+{
+  PowerRateStationStore &s = *m_store;
+  // Only whether this is the first failure and the parity of the count
+  // matter past the first one, so 2 and 3 alternate instead of counting up.
+  uint8_t retries = m_retries[station] == 3 ? 2 : m_retries[station] + 1;
+  m_retries[station] = retries;
+  uint8_t rate = s.GetRate (station);
+  uint8_t power = s.GetPower (station);
+  // The failed transmission counts as an attempt.
+  s.SetAttempts (station, s.GetAttempts (station) + 1);
+  s.SetSuccesses (station, 0);
+  if (m_flags[station] & RECOVERY_RATE)
+    {
+      // The rate just went up: go back down at the first failure.
+      if (retries == 1 && rate > 0)
+        {
+          s.SetRate (station, rate - 1);
+          m_flags[station] = 0;
+        }
+      s.SetAttempts (station, 0);
+    }
+  else if (m_flags[station] & RECOVERY_POWER)
+    {
+      if (retries == 1 && power < m_maxPower)
+        {
+          s.SetPower (station, power + 1);
+          m_flags[station] = 0;
+        }
+      s.SetAttempts (station, 0);
+    }
+  else
+    {
+      if ((retries - 1) % 2 == 1)
+        {
+          if (power < m_maxPower)
+            {
+              s.SetPower (station, power + 1);
+            }
+          else if (rate > 0)
+            {
+              s.SetRate (station, rate - 1);
+            }
+        }
+      if (retries >= 2)
+        {
+          s.SetAttempts (station, 0);
+        }
+    }
+}
+
+AparfPowerControl::AparfPowerControl (Ptr<PowerRateStationStore> store, uint8_t nRates,
+                                      uint8_t minPower, uint8_t maxPower)
+  : m_store (store),
+    m_nRates (nRates),
+    m_minPower (minPower),
+    m_maxPower (maxPower),
+    m_successMax1 (3),
+    m_successMax2 (10),
+    m_failMax (1),
+    m_powerMax (10)
+{
+  NS_LOG_FUNCTION (this << +nRates << +minPower << +maxPower);
+  NS_ASSERT (nRates > 0 && minPower <= maxPower);
+}
+
+uint32_t
+AparfPowerControl::AddStation (void)
+{
+  m_state.push_back (HIGH);
+  m_critRate.push_back (0);
+  m_pCount.push_back (0);
+  m_successMax.push_back (m_successMax1);
+  return m_store->AddStation (0, m_maxPower);
+}
+
+uint32_t
+AparfPowerControl::GetBytesPerStation (void) const
+{
+  return m_store->GetBytesPerStation () + 3 * sizeof (uint8_t) + sizeof (uint16_t);
+}
+
+void
+AparfPowerControl::ReportDataFailed (uint32_t station)
+{
+  PowerRateStationStore &s = *m_store;
+  uint16_t failures = s.GetFailures (station) + 1;
+  s.SetSuccesses (station, 0);
+  if (m_state[station] == LOW)
+    {
+      m_state[station] = HIGH;
+      m_successMax[station] = m_successMax1;
+    }
+  else if (m_state[station] == SPREAD)
+    {
+      m_state[station] = LOW;
+      m_successMax[station] = m_successMax2;
+    }
+  if (failures == m_failMax)
+    {
+      failures = 0;
+      m_pCount[station] = 0;
+      uint8_t power = s.GetPower (station);
+      if (power == m_maxPower)
+        {
+          uint8_t rate = s.GetRate (station);
+          m_critRate[station] = rate;
+          if (rate > 0)
+            {
+              s.SetRate (station, rate - 1);
+            }
+        }
+      else
+        {
+          s.SetPower (station, power + 1);
+        }
+    }
+  s.SetFailures (station, failures);
+}
+
+void
+AparfPowerControl::ReportDataOk (uint32_t station)
+{
+  PowerRateStationStore &s = *m_store;
+  uint16_t successes = s.GetSuccesses (station) + 1;
+  s.SetFailures (station, 0);
+  if ((m_state[station] == HIGH || m_state[station] == LOW) && successes >= m_successMax[station])
+    {
+      m_state[station] = SPREAD;
+    }
+  else if (m_state[station] == SPREAD)
+    {
+      m_state[station] = HIGH;
+      m_successMax[station] = m_successMax1;
+    }
+  if (successes == m_successMax[station])
+    {
+      successes = 0;
+      uint8_t rate = s.GetRate (station);
+      uint8_t power = s.GetPower (station);
+      if (rate == m_nRates - 1)
+        {
+          if (power > m_minPower)
+            {
+              s.SetPower (station, power - 1);
+            }
+        }
+      else if (m_critRate[station] == 0)
+        {
+          s.SetRate (station, rate + 1);
+        }
+      else if (m_pCount[station] == m_powerMax)
+        {
+          s.SetPower (station, m_maxPower);
+          s.SetRate (station, m_critRate[station]);
+          m_pCount[station] = 0;
+          m_critRate[station] = 0;
+        }
+      else if (power > m_minPower)
+        {
+          s.SetPower (station, power - 1);
+          ++m_pCount[station];
+        }
+    }
+  s.SetSuccesses (station, successes);
+}
+
+RrpaaPowerControl::RrpaaPowerControl (Ptr<PowerRateStationStore> store, const std::vector<Time> &txTimes,
+                                      uint8_t minPower, uint8_t maxPower, Time timeout)
+  : m_store (store),
+    m_nRates (txTimes.size ()),
+    m_minPower (minPower),
+    m_maxPower (maxPower),
+    m_nPd (txTimes.size () * (maxPower + 1)),
+    m_timeout (timeout.GetTimeStep ()),
+    m_gamma (2),
+    m_delta (1.0905),
+    m_ori (txTimes.size ()),
+    m_mtl (txTimes.size ()),
+    m_ewnd (txTimes.size ()),
+    m_rng (CreateObject<UniformRandomVariable> ())
+{
+  NS_LOG_FUNCTION (this << txTimes.size () << +minPower << +maxPower << timeout);
+  NS_ASSERT (!txTimes.empty () && txTimes.size () < 256 && minPower <= maxPower);
+  // RrpaaWifiManager's Alpha, Beta and Tau.
+  const double alpha = 1.25;
+  const double beta = 2;
+  const double tau = 0.015;
+  for (uint8_t i = 0; i < m_nRates; ++i)
+    {
+      double t = txTimes[i].GetSeconds ();
+      m_ori[i] = i + 1 < m_nRates ? alpha * (1 - txTimes[i + 1].GetSeconds () / t) / beta : 0;
+      m_mtl[i] = i > 0 ? alpha * (1 - t / txTimes[i - 1].GetSeconds ()) : 1;
+      m_ewnd[i] = static_cast<uint16_t> (std::ceil (tau / t));
+    }
+}
+
+uint32_t
+RrpaaPowerControl::AddStation (void)
+{
+  m_lastReset.push_back (Simulator::Now ().GetTimeStep ());
+  m_pd.resize (m_pd.size () + m_nPd, 1);
+  uint32_t station = m_store->AddStation (0, m_maxPower);
+  m_store->SetAttempts (station, m_ewnd[0]);
+  return station;
+}
+
+uint32_t
+RrpaaPowerControl::GetBytesPerStation (void) const
+{
+  return m_store->GetBytesPerStation () + sizeof (int64_t) + m_nPd * sizeof (float);
+}
+
+float &
+RrpaaPowerControl::Pd (uint32_t station, uint8_t rate, uint8_t power)
+{
+  return m_pd[station * m_nPd + rate * (m_maxPower + 1) + power];
+}
+
+void
+RrpaaPowerControl::ResetCounters (uint32_t station)
+{
+  m_store->SetAttempts (station, m_ewnd[m_store->GetRate (station)]);
+  m_store->SetFailures (station, 0);
+  m_lastReset[station] = Simulator::Now ().GetTimeStep ();
+}
+
+void
+RrpaaPowerControl::CheckTimeout (uint32_t station)
+{
+  if (m_store->GetAttempts (station) == 0
+      || Simulator::Now ().GetTimeStep () - m_lastReset[station] > m_timeout)
+    {
+      ResetCounters (station);
+    }
+}
+
+void
+RrpaaPowerControl::ReportDataOk (uint32_t station)
+{
+  CheckTimeout (station);
+  m_store->SetAttempts (station, m_store->GetAttempts (station) - 1);
+  RunBasicAlgorithm (station);
+}
+
+void
+RrpaaPowerControl::ReportDataFailed (uint32_t station)
+{
+  CheckTimeout (station);
+  m_store->SetAttempts (station, m_store->GetAttempts (station) - 1);
+  m_store->SetFailures (station, m_store->GetFailures (station) + 1);
+  RunBasicAlgorithm (station);
+}
+
+void
+RrpaaPowerControl::RunBasicAlgorithm (uint32_t station)
+{
+  PowerRateStationStore &s = *m_store;
+  uint8_t rate = s.GetRate (station);
+  uint8_t power = s.GetPower (station);
+  double ewnd = m_ewnd[rate];
+  double bploss = s.GetFailures (station) / ewnd;
+  double wploss = (s.GetAttempts (station) + s.GetFailures (station)) / ewnd;
+  if (bploss >= m_mtl[rate])
+    {
+      if (power < m_maxPower)
+        {
+          Pd (station, rate, power) /= m_gamma;
+          s.SetPower (station, power + 1);
+          ResetCounters (station);
+        }
+      else if (rate > 0)
+        {
+          Pd (station, rate, power) /= m_gamma;
+          s.SetRate (station, rate - 1);
+          ResetCounters (station);
+        }
+    }
+  else if (wploss <= m_ori[rate])
+    {
+      if (rate < m_nRates - 1)
+        {
+          for (uint8_t i = 0; i <= rate; ++i)
+            {
+              float &pd = Pd (station, i, power);
+              pd = std::min (pd * m_delta, 1.0);
+            }
+          if (m_rng->GetValue (0, 1) < Pd (station, rate + 1, power))
+            {
+              s.SetRate (station, rate + 1);
+            }
+        }
+      else if (power > m_minPower)
+        {
+          // At the highest rate, lower the power with the probability of
+          // the next level, after raising those of the higher ones.
+          for (uint8_t i = m_maxPower; i > power; --i)
+            {
+              float &pd = Pd (station, rate, i);
+              pd = std::min (pd * m_delta, 1.0);
+            }
+          if (m_rng->GetValue (0, 1) < Pd (station, rate, power - 1))
+            {
+              s.SetPower (station, power - 1);
+            }
+        }
+      ResetCounters (station);
+    }
+  else if (bploss > m_ori[rate] && wploss < m_mtl[rate])
+    {
+      if (power > m_minPower)
+        {
+          for (uint8_t i = m_maxPower; i >= power; --i)
+            {
+              float &pd = Pd (station, rate, i);
+              pd = std::min (pd * m_delta, 1.0);
+            }
+          if (m_rng->GetValue (0, 1) < Pd (station, rate, power - 1))
+            {
+              s.SetPower (station, power - 1);
+            }
+          ResetCounters (station);
+        }
+    }
+  if (s.GetAttempts (station) == 0)
+    {
+      ResetCounters (station);
+    }
+}
+
+int64_t
+RrpaaPowerControl::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rng->SetStream (stream);
+  return 1;
+}
+
+} // namespace ns3
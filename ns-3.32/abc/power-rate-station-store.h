@@ -0,0 +1,410 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef POWER_RATE_STATION_STORE_H
+#define POWER_RATE_STATION_STORE_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * \brief Rate and power state of the stations of a power and rate
+ * control manager, one array per field.
+ *
+ * ParfWifiManager, AparfWifiManager and RrpaaWifiManager each allocate a
+ * station object of their own, reached through a virtual call on every
+ * report, and fire their PowerChange and RateChange traces with the
+ * power in dBm, a DataRate and the station address computed whether or
+ * not anything is connected.  Here the fields every algorithm reads on
+ * every report (rate, power level and the success, failure and attempt
+ * counters) are arrays indexed by station, shared by the three
+ * algorithms below, which keep their own fields in arrays as well.  The
+ * traces pass the station index and the old and new levels, and are
+ * only fired when a sink is connected.
+ */
+class PowerRateStationStore : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PowerRateStationStore ();
+
+  /**
+   * \param rate initial rate index
+   * \param power initial power level
+   * \return the index of the new station
+   */
+  uint32_t AddStation (uint8_t rate, uint8_t power);
+
+  /// \return the number of stations
+  uint32_t GetNStations (void) const;
+
+  /// \return the bytes of state per station
+  uint32_t GetBytesPerStation (void) const;
+
+  /**
+   * \param station a station
+   * \return its rate index
+   */
+  inline uint8_t GetRate (uint32_t station) const;
+
+  /**
+   * \param station a station
+   * \param rate its new rate index
+   */
+  inline void SetRate (uint32_t station, uint8_t rate);
+
+  /**
+   * \param station a station
+   * \return its power level
+   */
+  inline uint8_t GetPower (uint32_t station) const;
+
+  /**
+   * \param station a station
+   * \param power its new power level
+   */
+  inline void SetPower (uint32_t station, uint8_t power);
+
+  /**
+   * \param station a station
+   * \return its success counter
+   */
+  inline uint16_t GetSuccesses (uint32_t station) const;
+
+  /**
+   * \param station a station
+   * \param n its new success counter
+   */
+  inline void SetSuccesses (uint32_t station, uint16_t n);
+
+  /**
+   * \param station a station
+   * \return its failure counter
+   */
+  inline uint16_t GetFailures (uint32_t station) const;
+
+  /**
+   * \param station a station
+   * \param n its new failure counter
+   */
+  inline void SetFailures (uint32_t station, uint16_t n);
+
+  /**
+   * \param station a station
+   * \return its attempt counter
+   */
+  inline uint16_t GetAttempts (uint32_t station) const;
+
+  /**
+   * \param station a station
+   * \param n its new attempt counter
+   */
+  inline void SetAttempts (uint32_t station, uint16_t n);
+
+  /**
+   * TracedCallback signature for rate and power changes.
+   * \param station the station
+   * \param oldLevel the previous rate index or power level
+   * \param newLevel the new one
+   */
+  typedef void (* LevelChangeTracedCallback)(uint32_t station, uint8_t oldLevel, uint8_t newLevel);
+
+private:
+  std::vector<uint8_t> m_rate;        //!< Rate index
+  std::vector<uint8_t> m_power;       //!< Power level
+  std::vector<uint16_t> m_successes;  //!< Success counter
+  std::vector<uint16_t> m_failures;   //!< Failure counter
+  std::vector<uint16_t> m_attempts;   //!< Attempt counter
+
+  TracedCallback<uint32_t, uint8_t, uint8_t> m_rateChange;  //!< Rate change trace
+  TracedCallback<uint32_t, uint8_t, uint8_t> m_powerChange; //!< Power change trace
+};
+
+/**
+ * \brief The PARF algorithm of ParfWifiManager over a
+ * PowerRateStationStore.
+ *
+ * Akella et al., "Self-management in chaotic wireless deployments".
+ * After SuccessThreshold successes or AttemptThreshold attempts, failed
+ * ones included, raise the rate, or at the highest rate lower the power,
+ * and fall back at the first failure; otherwise every second failure
+ * raises the power, or at the highest power lowers the rate.
+ */
+class ParfPowerControl
+{
+public:
+  /**
+   * \param store the station store
+   * \param nRates number of rates
+   * \param minPower lowest power level
+   * \param maxPower highest power level
+   * \param attemptThreshold as ParfWifiManager's AttemptThreshold
+   * \param successThreshold as ParfWifiManager's SuccessThreshold
+   */
+  ParfPowerControl (Ptr<PowerRateStationStore> store, uint8_t nRates, uint8_t minPower,
+                    uint8_t maxPower, uint16_t attemptThreshold = 15, uint16_t successThreshold = 10);
+
+  /// \return the index of a new station, at the lowest rate and highest power
+  uint32_t AddStation (void);
+
+  /// \return the bytes of state per station, the store included
+  uint32_t GetBytesPerStation (void) const;
+
+  /**
+   * \param station a station whose frame got through
+   */
+  void ReportDataOk (uint32_t station);
+
+  /**
+   * \param station a station whose frame failed
+   */
+  void ReportDataFailed (uint32_t station);
+
+private:
+  /// Flags of a station.
+  enum
+  {
+    RECOVERY_RATE = 1,   //!< Just raised the rate
+    RECOVERY_POWER = 2   //!< Just lowered the power
+  };
+
+  Ptr<PowerRateStationStore> m_store; //!< Shared fields
+  uint8_t m_nRates;                   //!< Number of rates
+  uint8_t m_minPower;                 //!< Lowest power level
+  uint8_t m_maxPower;                 //!< Highest power level
+  uint16_t m_attemptThreshold;        //!< Attempts before going up
+  uint16_t m_successThreshold;        //!< Successes before going up
+  std::vector<uint8_t> m_retries;     //!< Consecutive failures, 2 and 3 alternating past 3
+  std::vector<uint8_t> m_flags;       //!< Recovery flags
+};
+
+/**
+ * \brief The APARF algorithm of AparfWifiManager over a
+ * PowerRateStationStore.
+ *
+ * Chevillat et al., "Dynamic data rate and transmit power adjustment in
+ * IEEE 802.11 wireless LANs".  Like PARF, with a success threshold that
+ * adapts through the High, Low and Spread states, and a critical rate
+ * at which lowering the power is tried PowerThreshold times before going
+ * back to full power.
+ */
+class AparfPowerControl
+{
+public:
+  /**
+   * \param store the station store
+   * \param nRates number of rates
+   * \param minPower lowest power level
+   * \param maxPower highest power level
+   */
+  AparfPowerControl (Ptr<PowerRateStationStore> store, uint8_t nRates, uint8_t minPower, uint8_t maxPower);
+
+  /// \return the index of a new station, at the lowest rate and highest power
+  uint32_t AddStation (void);
+
+  /// \return the bytes of state per station, the store included
+  uint32_t GetBytesPerStation (void) const;
+
+  /**
+   * \param station a station whose frame got through
+   */
+  void ReportDataOk (uint32_t station);
+
+  /**
+   * \param station a station whose frame failed
+   */
+  void ReportDataFailed (uint32_t station);
+
+private:
+  /// State of a station.
+  enum State
+  {
+    HIGH,   //!< Few successes needed
+    LOW,    //!< Many successes needed
+    SPREAD  //!< Between the two
+  };
+
+  Ptr<PowerRateStationStore> m_store;    //!< Shared fields
+  uint8_t m_nRates;                      //!< Number of rates
+  uint8_t m_minPower;                    //!< Lowest power level
+  uint8_t m_maxPower;                    //!< Highest power level
+  uint16_t m_successMax1;                //!< SuccessThreshold1
+  uint16_t m_successMax2;                //!< SuccessThreshold2
+  uint16_t m_failMax;                    //!< FailThreshold
+  uint8_t m_powerMax;                    //!< PowerThreshold
+  std::vector<uint8_t> m_state;          //!< High, Low or Spread
+  std::vector<uint8_t> m_critRate;       //!< Critical rate, 0 for none
+  std::vector<uint8_t> m_pCount;         //!< Power decreases at the critical rate
+  std::vector<uint16_t> m_successMax;    //!< Current success threshold
+};
+
+/**
+ * \brief The RRPAA algorithm of RrpaaWifiManager over a
+ * PowerRateStationStore.
+ *
+ * Richard et al., "Robust rate and power adaptation".  The loss
+ * thresholds and window of each rate only depend on the rate set, so
+ * they are computed once for all stations; each station keeps the
+ * probabilities of using each (rate, power) pair, in float.  The attempt
+ * counter of the store is the remaining window.
+ */
+class RrpaaPowerControl
+{
+public:
+  /**
+   * \param store the station store
+   * \param txTimes duration of a frame and its ack at each rate
+   * \param minPower lowest power level
+   * \param maxPower highest power level
+   * \param timeout as RrpaaWifiManager's Timeout
+   */
+  RrpaaPowerControl (Ptr<PowerRateStationStore> store, const std::vector<Time> &txTimes,
+                     uint8_t minPower, uint8_t maxPower, Time timeout = MilliSeconds (50));
+
+  /// \return the index of a new station, at the lowest rate and highest power
+  uint32_t AddStation (void);
+
+  /// \return the bytes of state per station, the store included
+  uint32_t GetBytesPerStation (void) const;
+
+  /**
+   * \param station a station whose frame got through
+   */
+  void ReportDataOk (uint32_t station);
+
+  /**
+   * \param station a station whose frame failed
+   */
+  void ReportDataFailed (uint32_t station);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+private:
+  /**
+   * \param station a station
+   */
+  void CheckTimeout (uint32_t station);
+
+  /**
+   * \param station a station
+   */
+  void ResetCounters (uint32_t station);
+
+  /**
+   * \param station a station
+   */
+  void RunBasicAlgorithm (uint32_t station);
+
+  /**
+   * \param station a station
+   * \param rate a rate
+   * \param power a power level
+   * \return the probability of using them
+   */
+  float & Pd (uint32_t station, uint8_t rate, uint8_t power);
+
+  Ptr<PowerRateStationStore> m_store;     //!< Shared fields
+  uint8_t m_nRates;                       //!< Number of rates
+  uint8_t m_minPower;                     //!< Lowest power level
+  uint8_t m_maxPower;                     //!< Highest power level
+  uint32_t m_nPd;                         //!< Probabilities per station
+  int64_t m_timeout;                      //!< Timeout, in time steps
+  double m_gamma;                         //!< Probability divisor
+  double m_delta;                         //!< Probability multiplier
+  std::vector<double> m_ori;              //!< Opportunistic rate increase threshold, per rate
+  std::vector<double> m_mtl;              //!< Maximum tolerable loss threshold, per rate
+  std::vector<uint16_t> m_ewnd;           //!< Window, per rate
+  std::vector<int64_t> m_lastReset;       //!< Time of the last window reset
+  std::vector<float> m_pd;                //!< Probabilities, per station, rate and power
+  Ptr<UniformRandomVariable> m_rng;       //!< Probability draws
+};
+
+uint8_t
+PowerRateStationStore::GetRate (uint32_t station) const
+{
+  return m_rate[station];
+}
+
+void
+PowerRateStationStore::SetRate (uint32_t station, uint8_t rate)
+{
+  if (rate != m_rate[station] && !m_rateChange.IsEmpty ())
+    {
+      m_rateChange (station, m_rate[station], rate);
+    }
+  m_rate[station] = rate;
+}
+
+uint8_t
+PowerRateStationStore::GetPower (uint32_t station) const
+{
+  return m_power[station];
+}
+
+void
+PowerRateStationStore::SetPower (uint32_t station, uint8_t power)
+{
+  if (power != m_power[station] && !m_powerChange.IsEmpty ())
+    {
+      m_powerChange (station, m_power[station], power);
+    }
+  m_power[station] = power;
+}
+
+uint16_t
+PowerRateStationStore::GetSuccesses (uint32_t station) const
+{
+  return m_successes[station];
+}
+
+void
+PowerRateStationStore::SetSuccesses (uint32_t station, uint16_t n)
+{
+  m_successes[station] = n;
+}
+
+uint16_t
+PowerRateStationStore::GetFailures (uint32_t station) const
+{
+  return m_failures[station];
+}
+
+void
+PowerRateStationStore::SetFailures (uint32_t station, uint16_t n)
+{
+  m_failures[station] = n;
+}
+
+uint16_t
+PowerRateStationStore::GetAttempts (uint32_t station) const
+{
+  return m_attempts[station];
+}
+
+void
+PowerRateStationStore::SetAttempts (uint32_t station, uint16_t n)
+{
+  m_attempts[station] = n;
+}
+
+} // namespace ns3
+
+#endif /* POWER_RATE_STATION_STORE_H */
@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef PSD_KERNELS_H
+#define PSD_KERNELS_H
+
+#include <stdint.h>
+#include <map>
+#include <utility>
+#include <vector>
+#include "ns3/callback.h"
+#include "ns3/spectrum-value.h"
+
+namespace ns3 {
+
+/**
+ * \brief Element-wise PSD arithmetic written for the vectorizer.
+ *
+ * The SpectrumValue operators build a temporary for each binary
+ * operation, and Integral () recomputes the width of every band from the
+ * spectrum model on each call.  These kernels work in place on the value
+ * arrays, with independent accumulators in the reductions so that GCC
+ * and Clang vectorize them without -ffast-math (with AVX2 when the
+ * build targets it).  Integral () takes the band widths of the spectrum
+ * model, which the caller computes once with GetWidths () and keeps with
+ * the PSDs it integrates, e.g. one table per PHY, so the kernels hold no
+ * state of their own.  Sums are computed in a different order than by
+ * SpectrumValue, so results may differ in the last bits.
+ */
+class PsdKernels
+{
+public:
+  /**
+   * \param psd the PSD, scaled in place
+   * \param factor the factor
+   */
+  static void Scale (SpectrumValue &psd, double factor);
+
+  /**
+   * \param dst output, factor * src; same spectrum model as src
+   * \param src the PSD
+   * \param factor the factor
+   */
+  static void ScaleTo (SpectrumValue &dst, const SpectrumValue &src, double factor);
+
+  /**
+   * \param dst the PSD src is added to
+   * \param src another PSD of the same spectrum model
+   */
+  static void Add (SpectrumValue &dst, const SpectrumValue &src);
+
+  /**
+   * \param dst the PSD factor * src is added to
+   * \param src another PSD of the same spectrum model
+   * \param factor the factor
+   */
+  static void AddScaled (SpectrumValue &dst, const SpectrumValue &src, double factor);
+
+  /**
+   * \param model a spectrum model
+   * \param widths output, the width of each of its bands (Hz)
+   */
+  static void GetWidths (Ptr<const SpectrumModel> model, std::vector<double> &widths);
+
+  /**
+   * \param psd a PSD (W/Hz)
+   * \param widths band widths of its spectrum model, from GetWidths ()
+   * \return its power over all bands (W)
+   */
+  static double Integral (const SpectrumValue &psd, const std::vector<double> &widths);
+
+  /**
+   * \param psd a PSD (W/Hz)
+   * \param widths band widths of its spectrum model, from GetWidths ()
+   * \param start first band
+   * \param stop last band, included, as in a WifiSpectrumBand
+   * \return its power over these bands (W)
+   */
+  static double Integral (const SpectrumValue &psd, const std::vector<double> &widths,
+                          uint32_t start, uint32_t stop);
+};
+
+/**
+ * \brief Transmit PSDs shared between the frames that have the same
+ * channel, width and power.
+ *
+ * A helper such as
+ * WifiSpectrumValueHelper::CreateHeOfdmTxPowerSpectralDensity ()
+ * allocates a transmit PSD and computes the spectral mask band by band,
+ * although a node sends on one channel at a few power levels.  For code
+ * that builds its transmit PSDs itself, this cache calls the helper once
+ * per (center frequency, width, guard bandwidth, power) and then returns
+ * the same SpectrumValue, shared by reference count.  SpectrumWifiPhy
+ * builds its PSDs in src/wifi and does not use it, so it still
+ * allocates a PSD for each frame it sends, and the channel copies it for
+ * each receiver.
+ *
+ * The PSDs it returns must not be modified in place: channels that scale
+ * a PSD copy it first, as SpectrumSignalParameters::Copy () does, and
+ * other code calls MakeWritable (), which copies a PSD only when it is
+ * shared.  When the cache holds MaxEntries PSDs it starts over.
+ */
+class TxPsdCache
+{
+public:
+  /// Builds a PSD from center frequency (MHz), width (MHz), power (W) and guard bandwidth (MHz).
+  typedef Callback<Ptr<SpectrumValue>, uint32_t, uint16_t, double, uint16_t> Creator;
+
+  /**
+   * \param creator builds the PSDs on a miss
+   * \param maxEntries number of PSDs kept
+   */
+  TxPsdCache (Creator creator, uint32_t maxEntries = 64);
+
+  /**
+   * \param centerFrequency center frequency (MHz)
+   * \param channelWidth channel width (MHz)
+   * \param txPowerW transmit power (W)
+   * \param guardBandwidth guard bandwidth (MHz)
+   * \return the shared PSD
+   */
+  Ptr<SpectrumValue> Get (uint32_t centerFrequency, uint16_t channelWidth,
+                          double txPowerW, uint16_t guardBandwidth);
+
+  /**
+   * \brief Copy a PSD if anything else refers to it.
+   * \param psd the PSD, replaced by a private copy if shared
+   */
+  static void MakeWritable (Ptr<SpectrumValue> &psd);
+
+  /// \return the number of Get () calls served from the cache
+  uint64_t GetNHits (void) const;
+
+  /// \return the number of PSDs built
+  uint64_t GetNMisses (void) const;
+
+private:
+  /// Channel and width, then power bits.
+  typedef std::pair<uint64_t, uint64_t> Key;
+
+  Creator m_creator;                         //!< PSD builder
+  uint32_t m_maxEntries;                     //!< Size limit
+  std::map<Key, Ptr<SpectrumValue> > m_psds; //!< Cached PSDs
+  uint64_t m_hits;                           //!< Hits
+  uint64_t m_misses;                         //!< Misses
+};
+
+} // namespace ns3
+
+#endif /* PSD_KERNELS_H */
@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "resettable-simulator-impl.h"
+#include <algorithm>
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ResettableSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (ResettableSimulatorImpl);
+
+/**
+ * \brief Event wrapper remembering whether the wrapped event has run.
+ */
+class ResettableSimulatorImpl::EpochEvent : public EventImpl
+{
+public:
+  /**
+   * \param event the wrapped event; its reference is taken over
+   */
+  EpochEvent (EventImpl *event)
+    : m_event (event, false)
+  {
+  }
+
+  /// \return true if the event ran or was cancelled
+  bool IsDone (void)
+  {
+    return m_event == 0 || IsCancelled ();
+  }
+
+protected:
+  virtual void Notify (void)
+  {
+    m_event->Invoke ();
+    // Releases what the event holds while the wrapper waits for a prune.
+    m_event = 0;
+  }
+
+private:
+  Ptr<EventImpl> m_event; //!< Wrapped event, 0 once run
+};
+
+TypeId
+ResettableSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ResettableSimulatorImpl")
+    .SetParent<DefaultSimulatorImpl> ()
+    .SetGroupName ("Core")
+    .AddConstructor<ResettableSimulatorImpl> ()
+  ;
+  return tid;
+}
+
+ResettableSimulatorImpl::ResettableSimulatorImpl ()
+  : m_pruneAt (1024),
+    m_epochStart (Seconds (0)),
+    m_resets (0),
+    m_running (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ptr<ResettableSimulatorImpl>
+ResettableSimulatorImpl::Get (void)
+{
+  Ptr<ResettableSimulatorImpl> impl = DynamicCast<ResettableSimulatorImpl> (Simulator::GetImplementation ());
+  NS_ABORT_MSG_IF (impl == 0, "SimulatorImplementationType is not ns3::ResettableSimulatorImpl");
+  return impl;
+}
+
+EventImpl *
+ResettableSimulatorImpl::Wrap (EventImpl *event)
+{
+  if (m_pending.size () >= m_pruneAt)
+    {
+      std::size_t kept = 0;
+      for (std::size_t i = 0; i < m_pending.size (); ++i)
+        {
+          if (!m_pending[i]->IsDone ())
+            {
+              m_pending[kept++] = m_pending[i];
+            }
+        }
+      m_pending.resize (kept);
+      m_pruneAt = std::max<std::size_t> (1024, 2 * m_pending.size ());
+    }
+  Ptr<EpochEvent> wrapper = Create<EpochEvent> (event);
+  m_pending.push_back (wrapper);
+  // The simulator owns one reference, released after the event runs.
+  wrapper->Ref ();
+  return PeekPointer (wrapper);
+}
+
+EventId
+ResettableSimulatorImpl::Schedule (const Time &delay, EventImpl *event)
+{
+  return DefaultSimulatorImpl::Schedule (delay, Wrap (event));
+}
+
+void
+ResettableSimulatorImpl::ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event)
+{
+  DefaultSimulatorImpl::ScheduleWithContext (context, delay, Wrap (event));
+}
+
+EventId
+ResettableSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return DefaultSimulatorImpl::ScheduleNow (Wrap (event));
+}
+
+void
+ResettableSimulatorImpl::Reset (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Cancelled events stay in the queue and are skipped when they come
+  // due; only ScheduleWithContext events have no EventId to remove them.
+  uint32_t cancelled = 0;
+  for (std::vector<Ptr<EpochEvent> >::const_iterator i = m_pending.begin (); i != m_pending.end (); ++i)
+    {
+      if (!(*i)->IsDone ())
+        {
+          (*i)->Cancel ();
+          ++cancelled;
+        }
+    }
+  m_pending.clear ();
+  m_pruneAt = 1024;
+  if (m_running)
+    {
+      Stop ();
+    }
+  m_epochStart = Now ();
+  ++m_resets;
+  NS_LOG_DEBUG ("reset " << m_resets << " at " << m_epochStart.As (Time::S)
+                << ", " << cancelled << " events cancelled");
+  for (std::vector<Callback<void> >::const_iterator i = m_resetCallbacks.begin (); i != m_resetCallbacks.end (); ++i)
+    {
+      (*i)();
+    }
+}
+
+void
+ResettableSimulatorImpl::AddResetCallback (Callback<void> callback)
+{
+  m_resetCallbacks.push_back (callback);
+}
+
+Time
+ResettableSimulatorImpl::GetEpochStart (void) const
+{
+  return m_epochStart;
+}
+
+Time
+ResettableSimulatorImpl::GetEpochNow (void) const
+{
+  return Now () - m_epochStart;
+}
+
+uint32_t
+ResettableSimulatorImpl::GetNResets (void) const
+{
+  return m_resets;
+}
+
+void
+ResettableSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_running = true;
+  DefaultSimulatorImpl::Run ();
+  m_running = false;
+}
+
+void
+ResettableSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  m_resetCallbacks.clear ();
+  DefaultSimulatorImpl::Destroy ();
+  m_pending.clear ();
+}
+
+} // namespace ns3
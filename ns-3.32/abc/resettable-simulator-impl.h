@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef RESETTABLE_SIMULATOR_IMPL_H
+#define RESETTABLE_SIMULATOR_IMPL_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/callback.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \brief DefaultSimulatorImpl whose pending events can be dropped between
+ * the points of a sweep, so that one topology serves them all.
+ *
+ * Sweeps that build nodes, channel, devices and stacks for every point
+ * and tear them down with Simulator::Destroy () spend most of their wall
+ * time in setup when the points are short.  With this implementation a
+ * sweep builds them once, and between points calls Reset (), which
+ *
+ *  - cancels every pending event except the destroy events, so that
+ *    timers and traffic of the previous point never fire;
+ *  - starts a new epoch: GetEpochNow () is the time since the reset;
+ *  - runs the callbacks added with AddResetCallback (), in which the
+ *    sweep clears its own counters and protocol state.
+ *
+ * The sweep then changes the attributes it varies and calls
+ * Simulator::Run () again.  The simulator clock itself keeps running:
+ * devices and protocols, the wifi MAC and PHY among them, keep absolute
+ * times (end of the last reception, NAV, queue timestamps) that a
+ * rewound clock would put in the future.  Points are therefore
+ * equivalent to fresh runs, not bit-identical to them, since the random
+ * streams carry on.  Reset () must be called while the devices are idle,
+ * e.g. after Run () returned once the traffic of the point has ended:
+ * cancelling the end of a transmission would leave a PHY busy forever,
+ * and cancelling periodic events (beacons, routing hellos) stops them
+ * until the callbacks restart them.
+ *
+ * Select it from the command line:
+ * \code
+ *   --SimulatorImplementationType=ns3::ResettableSimulatorImpl
+ * \endcode
+ * or with GlobalValue::Bind () before the first event is scheduled.
+ *
+ * The bookkeeping is not synchronized, so events must only be scheduled
+ * from the simulation thread.
+ */
+class ResettableSimulatorImpl : public DefaultSimulatorImpl
+{
+public:
+  /**
+   * \brief Get the registered TypeId for this class.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  ResettableSimulatorImpl ();
+
+  /**
+   * \return the simulator implementation; aborts if it is not a
+   * ResettableSimulatorImpl
+   */
+  static Ptr<ResettableSimulatorImpl> Get (void);
+
+  /**
+   * \brief Cancel the pending events and start a new epoch.
+   *
+   * May be called between two Simulator::Run () or from an event, in
+   * which case it also stops the run: Run () returns once the current
+   * event completes, as after Simulator::Stop ().
+   *
+   * A pending Simulator::Stop (delay) is cancelled with the other
+   * events, so the sweep schedules the end of the next point again.  The
+   * cancelled events stay in the queue until their time, as with
+   * Simulator::Cancel (): they never run, but the next Run () moves the
+   * clock to each of them on the way, and a Run () without a stop only
+   * returns after the last one.
+   */
+  void Reset (void);
+
+  /**
+   * \param callback called at the end of each Reset (); events it
+   * schedules belong to the new epoch
+   */
+  void AddResetCallback (Callback<void> callback);
+
+  /// \return the time of the last Reset (), 0 if none
+  Time GetEpochStart (void) const;
+
+  /// \return the time since the last Reset ()
+  Time GetEpochNow (void) const;
+
+  /// \return the number of Reset () calls
+  uint32_t GetNResets (void) const;
+
+  // Inherited
+  virtual void Destroy ();
+  virtual void Run (void);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+
+private:
+  class EpochEvent;
+
+  /**
+   * \param event event about to be scheduled
+   * \return a wrapper that Reset () can cancel
+   */
+  EventImpl * Wrap (EventImpl *event);
+
+  std::vector<Ptr<EpochEvent> > m_pending;       //!< Events scheduled in this epoch
+  std::size_t m_pruneAt;                         //!< Size of m_pending triggering a prune
+  std::vector<Callback<void> > m_resetCallbacks; //!< Called by Reset ()
+  Time m_epochStart;                             //!< Time of the last reset
+  uint32_t m_resets;                             //!< Number of resets
+  bool m_running;                                //!< Run () in progress
+};
+
+} // namespace ns3
+
+#endif /* RESETTABLE_SIMULATOR_IMPL_H */
@@ -0,0 +1,253 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "routing-snapshot-writer.h"
+#include <algorithm>
+#include <cstring>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/olsr-routing-protocol.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("RoutingSnapshotWriter");
+
+namespace {
+
+/// Order records by key.
+bool
+KeyLess (const RoutingSnapshotRecord &a, const RoutingSnapshotRecord &b)
+{
+  return a.KeyLess (b);
+}
+
+/// Same key.
+bool
+KeyEqual (const RoutingSnapshotRecord &a, const RoutingSnapshotRecord &b)
+{
+  return a.KeyEqual (b);
+}
+
+/**
+ * \param node node id
+ * \param entry a route
+ * \param distance its distance
+ * \return the record of the route
+ */
+RoutingSnapshotRecord
+MakeRecord (uint32_t node, const Ipv4RoutingTableEntry &entry, uint32_t distance)
+{
+  RoutingSnapshotRecord r;
+  r.node = node;
+  r.destination = entry.GetDest ().Get ();
+  r.nextHop = entry.GetGateway ().Get ();
+  r.interface = entry.GetInterface ();
+  r.distance = distance > 0xffff ? 0xffff : distance;
+  r.prefixLength = entry.GetDestNetworkMask ().GetPrefixLength ();
+  r.op = RoutingSnapshotRecord::SET;
+  return r;
+}
+
+/**
+ * \param node node id
+ * \param protocol a routing protocol
+ * \param records routes, appended
+ */
+void
+CollectProtocol (uint32_t node, Ptr<Ipv4RoutingProtocol> protocol, std::vector<RoutingSnapshotRecord> &records)
+{
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (protocol);
+  if (list)
+    {
+      for (uint32_t i = 0; i < list->GetNRoutingProtocols (); ++i)
+        {
+          int16_t priority;
+          CollectProtocol (node, list->GetRoutingProtocol (i, priority), records);
+        }
+      return;
+    }
+  Ptr<olsr::RoutingProtocol> olsr = DynamicCast<olsr::RoutingProtocol> (protocol);
+  if (olsr)
+    {
+      std::vector<olsr::RoutingTableEntry> entries = olsr->GetRoutingTableEntries ();
+      for (std::vector<olsr::RoutingTableEntry>::const_iterator e = entries.begin (); e != entries.end (); ++e)
+        {
+          RoutingSnapshotRecord r;
+          r.node = node;
+          r.destination = e->destAddr.Get ();
+          r.nextHop = e->nextAddr.Get ();
+          r.interface = e->interface;
+          r.distance = e->distance > 0xffff ? 0xffff : e->distance;
+          r.prefixLength = 32;
+          r.op = RoutingSnapshotRecord::SET;
+          records.push_back (r);
+        }
+      return;
+    }
+  Ptr<Ipv4StaticRouting> staticRouting = DynamicCast<Ipv4StaticRouting> (protocol);
+  if (staticRouting)
+    {
+      for (uint32_t i = 0; i < staticRouting->GetNRoutes (); ++i)
+        {
+          records.push_back (MakeRecord (node, staticRouting->GetRoute (i), staticRouting->GetMetric (i)));
+        }
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> global = DynamicCast<Ipv4GlobalRouting> (protocol);
+  if (global)
+    {
+      for (uint32_t i = 0; i < global->GetNRoutes (); ++i)
+        {
+          records.push_back (MakeRecord (node, *global->GetRoute (i), 0));
+        }
+    }
+}
+
+} // anonymous namespace
+
+RoutingSnapshotWriter::RoutingSnapshotWriter (std::string filename, uint32_t keyframeInterval)
+  : m_keyframeInterval (keyframeInterval),
+    m_nSnapshots (0),
+    m_nBytes (0)
+{
+  NS_LOG_FUNCTION (this << filename << keyframeInterval);
+  m_out.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_UNLESS (m_out.is_open (), "cannot open " << filename);
+  uint8_t header[RoutingSnapshotFormat::FILE_HEADER_SIZE];
+  std::memcpy (header, RoutingSnapshotFormat::MAGIC, 8);
+  uint32_t fields[2] = { RoutingSnapshotFormat::VERSION, RoutingSnapshotFormat::RECORD_SIZE };
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      for (uint32_t b = 0; b < 4; ++b)
+        {
+          header[8 + 4 * i + b] = (fields[i] >> (8 * b)) & 0xff;
+        }
+    }
+  m_out.write (reinterpret_cast<const char *> (header), sizeof (header));
+  m_nBytes += sizeof (header);
+}
+
+RoutingSnapshotWriter::~RoutingSnapshotWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  m_out.close ();
+}
+
+void
+RoutingSnapshotWriter::Collect (Ptr<Node> node, std::vector<RoutingSnapshotRecord> &records)
+{
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  if (ipv4 && ipv4->GetRoutingProtocol ())
+    {
+      CollectProtocol (node->GetId (), ipv4->GetRoutingProtocol (), records);
+    }
+}
+
+void
+RoutingSnapshotWriter::WriteAll (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_current.clear ();
+  for (uint32_t i = 0; i < NodeList::GetNNodes (); ++i)
+    {
+      Collect (NodeList::GetNode (i), m_current);
+    }
+  // One route per key: the stable sort keeps the routes of a key in
+  // collection order, so the first protocol, or the first match, wins.
+  std::stable_sort (m_current.begin (), m_current.end (), &KeyLess);
+  m_current.erase (std::unique (m_current.begin (), m_current.end (), &KeyEqual), m_current.end ());
+
+  bool full = m_nSnapshots == 0 || (m_keyframeInterval > 0 && m_nSnapshots % m_keyframeInterval == 0);
+  std::vector<RoutingSnapshotRecord> delta;
+  const std::vector<RoutingSnapshotRecord> *records = &m_current;
+  if (!full)
+    {
+      std::vector<RoutingSnapshotRecord>::const_iterator p = m_previous.begin ();
+      std::vector<RoutingSnapshotRecord>::const_iterator c = m_current.begin ();
+      while (p != m_previous.end () || c != m_current.end ())
+        {
+          if (c == m_current.end () || (p != m_previous.end () && p->KeyLess (*c)))
+            {
+              delta.push_back (*p++);
+              delta.back ().op = RoutingSnapshotRecord::REMOVE;
+            }
+          else if (p == m_previous.end () || c->KeyLess (*p))
+            {
+              delta.push_back (*c++);
+            }
+          else
+            {
+              if (!p->RouteEqual (*c))
+                {
+                  delta.push_back (*c);
+                }
+              ++p;
+              ++c;
+            }
+        }
+      records = &delta;
+    }
+
+  // Encode the whole snapshot, then write it at once.
+  uint32_t n = records->size ();
+  m_buffer.resize (RoutingSnapshotFormat::SNAPSHOT_HEADER_SIZE + static_cast<size_t> (n) * RoutingSnapshotFormat::RECORD_SIZE);
+  uint64_t time = static_cast<uint64_t> (Simulator::Now ().GetNanoSeconds ());
+  for (uint32_t b = 0; b < 8; ++b)
+    {
+      m_buffer[b] = (time >> (8 * b)) & 0xff;
+    }
+  for (uint32_t b = 0; b < 4; ++b)
+    {
+      m_buffer[8 + b] = (n >> (8 * b)) & 0xff;
+    }
+  m_buffer[12] = full ? RoutingSnapshotFormat::FULL : RoutingSnapshotFormat::DELTA;
+  m_buffer[13] = m_buffer[14] = m_buffer[15] = 0;
+  uint8_t *out = &m_buffer[RoutingSnapshotFormat::SNAPSHOT_HEADER_SIZE];
+  for (uint32_t i = 0; i < n; ++i, out += RoutingSnapshotFormat::RECORD_SIZE)
+    {
+      RoutingSnapshotFormat::EncodeRecord ((*records)[i], out);
+    }
+  m_out.write (reinterpret_cast<const char *> (&m_buffer[0]), m_buffer.size ());
+  m_nBytes += m_buffer.size ();
+  ++m_nSnapshots;
+  m_previous.swap (m_current);
+  NS_LOG_LOGIC ((full ? "full" : "delta") << " snapshot of " << n << " routes");
+}
+
+void
+RoutingSnapshotWriter::WriteAllAt (Time printTime, Ptr<RoutingSnapshotWriter> writer)
+{
+  Simulator::Schedule (printTime, &RoutingSnapshotWriter::WriteAll, writer);
+}
+
+void
+RoutingSnapshotWriter::WriteAllEvery (Time printInterval, Ptr<RoutingSnapshotWriter> writer)
+{
+  Simulator::Schedule (printInterval, &RoutingSnapshotWriter::WriteEvery, printInterval, writer);
+}
+
+void
+RoutingSnapshotWriter::WriteEvery (Time printInterval, Ptr<RoutingSnapshotWriter> writer)
+{
+  writer->WriteAll ();
+  Simulator::Schedule (printInterval, &RoutingSnapshotWriter::WriteEvery, printInterval, writer);
+}
+
+uint32_t
+RoutingSnapshotWriter::GetNSnapshots (void) const
+{
+  return m_nSnapshots;
+}
+
+uint64_t
+RoutingSnapshotWriter::GetNBytes (void) const
+{
+  return m_nBytes;
+}
+
+} // namespace ns3
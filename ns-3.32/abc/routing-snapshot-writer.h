@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef ROUTING_SNAPSHOT_WRITER_H
+#define ROUTING_SNAPSHOT_WRITER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "routing-snapshot.h"
+
+namespace ns3 {
+
+class Node;
+
+/**
+ * \brief Binary replacement for Ipv4RoutingHelper::PrintRoutingTableAllAt.
+ *
+ * Writes the IPv4 routes of every node in the routing snapshot format of
+ * routing-snapshot.h: fixed-width records, no text formatting on the
+ * simulation thread.  After the first snapshot only the routes which
+ * changed are written, with a full snapshot every KeyframeInterval
+ * snapshots so that readers can seek.
+ *
+ * Routes are taken from OLSR, static and global routing, on their own or
+ * inside Ipv4ListRouting, and only the first route of each (node,
+ * destination, prefix length) is kept, as described in
+ * routing-snapshot.h.  utils/routing-snapshot-render prints a file as
+ * text and NetAnim opens it in its routing statistics view.
+ */
+class RoutingSnapshotWriter : public SimpleRefCount<RoutingSnapshotWriter>
+{
+public:
+  /**
+   * \param filename output file
+   * \param keyframeInterval write a full snapshot every this many
+   *        snapshots, 0 for the first one only
+   */
+  RoutingSnapshotWriter (std::string filename, uint32_t keyframeInterval = 0);
+  ~RoutingSnapshotWriter ();
+
+  /**
+   * \brief Write the routes of every node now.
+   */
+  void WriteAll (void);
+
+  /**
+   * \brief Write the routes of every node at a given time.
+   * \param printTime the time
+   * \param writer the writer
+   */
+  static void WriteAllAt (Time printTime, Ptr<RoutingSnapshotWriter> writer);
+
+  /**
+   * \brief Write the routes of every node periodically.
+   * \param printInterval the period
+   * \param writer the writer
+   */
+  static void WriteAllEvery (Time printInterval, Ptr<RoutingSnapshotWriter> writer);
+
+  /**
+   * \return the number of snapshots written
+   */
+  uint32_t GetNSnapshots (void) const;
+
+  /**
+   * \return the number of bytes written
+   */
+  uint64_t GetNBytes (void) const;
+
+  /**
+   * \brief Append the routes of a node.
+   * \param node the node
+   * \param records routes, appended in no particular order
+   */
+  static void Collect (Ptr<Node> node, std::vector<RoutingSnapshotRecord> &records);
+
+private:
+  /**
+   * \param printInterval the period
+   * \param writer the writer
+   */
+  static void WriteEvery (Time printInterval, Ptr<RoutingSnapshotWriter> writer);
+
+  std::ofstream m_out;                            //!< Output file
+  uint32_t m_keyframeInterval;                    //!< Snapshots between full ones
+  uint32_t m_nSnapshots;                          //!< Snapshots written
+  uint64_t m_nBytes;                              //!< Bytes written
+  std::vector<RoutingSnapshotRecord> m_previous;  //!< Routes of the last snapshot
+  std::vector<RoutingSnapshotRecord> m_current;   //!< Routes being collected
+  std::vector<uint8_t> m_buffer;                  //!< Encoded snapshot
+};
+
+} // namespace ns3
+
+#endif /* ROUTING_SNAPSHOT_WRITER_H */
@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "routing-snapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+
+namespace ns3 {
+
+const char RoutingSnapshotFormat::MAGIC[8] = { 'N', 'S', '3', 'R', 'S', 'N', 'A', 'P' };
+
+namespace {
+
+void
+PutU32 (uint8_t *p, uint32_t v)
+{
+  p[0] = v & 0xff;
+  p[1] = (v >> 8) & 0xff;
+  p[2] = (v >> 16) & 0xff;
+  p[3] = (v >> 24) & 0xff;
+}
+
+uint32_t
+GetU32 (const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t> (p[3]) << 24);
+}
+
+/**
+ * \param os output stream
+ * \param address IPv4 address in host order
+ */
+void
+PrintAddress (std::ostream &os, uint32_t address)
+{
+  os << ((address >> 24) & 0xff) << "." << ((address >> 16) & 0xff) << "."
+     << ((address >> 8) & 0xff) << "." << (address & 0xff);
+}
+
+} // anonymous namespace
+
+void
+RoutingSnapshotFormat::EncodeRecord (const RoutingSnapshotRecord &r, uint8_t *buffer)
+{
+  PutU32 (buffer, r.node);
+  PutU32 (buffer + 4, r.destination);
+  PutU32 (buffer + 8, r.nextHop);
+  PutU32 (buffer + 12, r.interface);
+  buffer[16] = r.distance & 0xff;
+  buffer[17] = r.distance >> 8;
+  buffer[18] = r.prefixLength;
+  buffer[19] = r.op;
+}
+
+RoutingSnapshotRecord
+RoutingSnapshotFormat::DecodeRecord (const uint8_t *buffer)
+{
+  RoutingSnapshotRecord r;
+  r.node = GetU32 (buffer);
+  r.destination = GetU32 (buffer + 4);
+  r.nextHop = GetU32 (buffer + 8);
+  r.interface = GetU32 (buffer + 12);
+  r.distance = buffer[16] | (buffer[17] << 8);
+  r.prefixLength = buffer[18];
+  r.op = buffer[19];
+  return r;
+}
+
+void
+RoutingSnapshotFormat::Print (std::ostream &os, std::vector<RoutingSnapshotRecord>::const_iterator first,
+                              std::vector<RoutingSnapshotRecord>::const_iterator last)
+{
+  os << "Destination\t\tNextHop\t\tInterface\tDistance\n";
+  for (; first != last; ++first)
+    {
+      PrintAddress (os, first->destination);
+      if (first->prefixLength != 32)
+        {
+          os << "/" << static_cast<uint32_t> (first->prefixLength);
+        }
+      os << "\t\t";
+      PrintAddress (os, first->nextHop);
+      os << "\t\t" << first->interface << "\t\t" << first->distance << "\t\n";
+    }
+}
+
+RoutingSnapshotReader::RoutingSnapshotReader ()
+  : m_time (0),
+    m_full (false)
+{
+}
+
+bool
+RoutingSnapshotReader::Open (std::string filename)
+{
+  m_in.open (filename.c_str (), std::ios::in | std::ios::binary);
+  uint8_t header[RoutingSnapshotFormat::FILE_HEADER_SIZE];
+  if (!m_in.read (reinterpret_cast<char *> (header), sizeof (header)))
+    {
+      return false;
+    }
+  return std::memcmp (header, RoutingSnapshotFormat::MAGIC, 8) == 0
+         && GetU32 (header + 8) == RoutingSnapshotFormat::VERSION
+         && GetU32 (header + 12) == RoutingSnapshotFormat::RECORD_SIZE;
+}
+
+bool
+RoutingSnapshotReader::ReadNext (void)
+{
+  uint8_t header[RoutingSnapshotFormat::SNAPSHOT_HEADER_SIZE];
+  if (!m_in.read (reinterpret_cast<char *> (header), sizeof (header)))
+    {
+      return false;
+    }
+  m_time = static_cast<int64_t> (GetU32 (header) | (static_cast<uint64_t> (GetU32 (header + 4)) << 32));
+  uint32_t n = GetU32 (header + 8);
+  m_full = header[12] == RoutingSnapshotFormat::FULL;
+
+  std::vector<uint8_t> buffer (static_cast<size_t> (n) * RoutingSnapshotFormat::RECORD_SIZE);
+  if (n > 0 && !m_in.read (reinterpret_cast<char *> (&buffer[0]), buffer.size ()))
+    {
+      return false;
+    }
+  m_records.resize (n);
+  m_changed.clear ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      m_records[i] = RoutingSnapshotFormat::DecodeRecord (&buffer[static_cast<size_t> (i) * RoutingSnapshotFormat::RECORD_SIZE]);
+      if (m_changed.empty () || m_changed.back () != m_records[i].node)
+        {
+          m_changed.push_back (m_records[i].node);
+        }
+    }
+
+  if (m_full)
+    {
+      // Nodes the full snapshot leaves out lost all their routes.
+      for (std::vector<RoutingSnapshotRecord>::const_iterator t = m_table.begin (); t != m_table.end (); ++t)
+        {
+          if (m_changed.empty () || m_changed.back () != t->node)
+            {
+              m_changed.push_back (t->node);
+            }
+        }
+      m_table = m_records;
+    }
+  else
+    {
+      // Merge the sorted delta into the sorted table.
+      std::vector<RoutingSnapshotRecord> table;
+      table.reserve (m_table.size () + n);
+      std::vector<RoutingSnapshotRecord>::const_iterator t = m_table.begin ();
+      std::vector<RoutingSnapshotRecord>::const_iterator d = m_records.begin ();
+      while (t != m_table.end () || d != m_records.end ())
+        {
+          if (d == m_records.end () || (t != m_table.end () && t->KeyLess (*d)))
+            {
+              table.push_back (*t++);
+              continue;
+            }
+          if (t != m_table.end () && t->KeyEqual (*d))
+            {
+              ++t;
+            }
+          if (d->op == RoutingSnapshotRecord::SET)
+            {
+              table.push_back (*d);
+            }
+          ++d;
+        }
+      m_table.swap (table);
+    }
+  std::sort (m_changed.begin (), m_changed.end ());
+  m_changed.erase (std::unique (m_changed.begin (), m_changed.end ()), m_changed.end ());
+  return true;
+}
+
+int64_t
+RoutingSnapshotReader::GetTime (void) const
+{
+  return m_time;
+}
+
+bool
+RoutingSnapshotReader::IsFull (void) const
+{
+  return m_full;
+}
+
+const std::vector<RoutingSnapshotRecord> &
+RoutingSnapshotReader::GetRecords (void) const
+{
+  return m_records;
+}
+
+const std::vector<RoutingSnapshotRecord> &
+RoutingSnapshotReader::GetTable (void) const
+{
+  return m_table;
+}
+
+const std::vector<uint32_t> &
+RoutingSnapshotReader::GetChangedNodes (void) const
+{
+  return m_changed;
+}
+
+} // namespace ns3
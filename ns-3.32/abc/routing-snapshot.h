@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef ROUTING_SNAPSHOT_H
+#define ROUTING_SNAPSHOT_H
+
+#include <stdint.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief One route of a routing snapshot.
+ *
+ * Routing snapshot files hold the routing tables of all nodes at a
+ * series of times, as fixed-width binary records instead of text:
+ *
+ * - file header (16 bytes): magic "NS3RSNAP", version (u32), record
+ *   size (u32);
+ * - per snapshot, a header (16 bytes): time in ns (i64), number of
+ *   records (u32), kind (u8, 0 full, 1 delta), 3 padding bytes;
+ * - followed by the records (20 bytes): node (u32), destination (u32),
+ *   next hop (u32), interface (u32), distance (u16), prefix length (u8),
+ *   op (u8, 0 set, 1 remove).
+ *
+ * Integers are little-endian and addresses are IPv4 addresses in host
+ * order.  A full snapshot lists every route; a delta lists the routes set
+ * or removed since the previous snapshot, keyed by (node, destination,
+ * prefix length).  A snapshot keeps one route per key: of equal-cost
+ * next hops, or of routes to the same prefix that differ only by metric
+ * or interface, only the first one the node's routing protocols list is
+ * written.
+ */
+struct RoutingSnapshotRecord
+{
+  uint32_t node;         //!< Node id
+  uint32_t destination;  //!< Destination address
+  uint32_t nextHop;      //!< Next hop address
+  uint32_t interface;    //!< Output interface
+  uint16_t distance;     //!< Hop count or metric
+  uint8_t prefixLength;  //!< Destination prefix length
+  uint8_t op;            //!< SET or REMOVE
+
+  /// Record operations.
+  enum
+  {
+    SET = 0,    //!< Add or replace the route
+    REMOVE = 1  //!< Remove the route
+  };
+
+  /**
+   * \param o another record
+   * \return true if this record has a lower (node, destination, prefix) key
+   */
+  bool KeyLess (const RoutingSnapshotRecord &o) const
+  {
+    if (node != o.node)
+      {
+        return node < o.node;
+      }
+    if (destination != o.destination)
+      {
+        return destination < o.destination;
+      }
+    return prefixLength < o.prefixLength;
+  }
+
+  /**
+   * \param o another record
+   * \return true if both records have the same key
+   */
+  bool KeyEqual (const RoutingSnapshotRecord &o) const
+  {
+    return node == o.node && destination == o.destination && prefixLength == o.prefixLength;
+  }
+
+  /**
+   * \param o another record
+   * \return true if both records describe the same route
+   */
+  bool RouteEqual (const RoutingSnapshotRecord &o) const
+  {
+    return KeyEqual (o) && nextHop == o.nextHop && interface == o.interface && distance == o.distance;
+  }
+};
+
+/// Constants of the routing snapshot format.
+struct RoutingSnapshotFormat
+{
+  static const char MAGIC[8];             //!< File magic
+  static const uint32_t VERSION = 1;      //!< Format version
+  static const uint32_t FILE_HEADER_SIZE = 16;     //!< File header size
+  static const uint32_t SNAPSHOT_HEADER_SIZE = 16; //!< Snapshot header size
+  static const uint32_t RECORD_SIZE = 20; //!< Record size
+
+  /// Snapshot kinds.
+  enum
+  {
+    FULL = 0,  //!< Every route
+    DELTA = 1  //!< Changes since the previous snapshot
+  };
+
+  /**
+   * \brief Encode a record.
+   * \param r the record
+   * \param buffer RECORD_SIZE bytes
+   */
+  static void EncodeRecord (const RoutingSnapshotRecord &r, uint8_t *buffer);
+
+  /**
+   * \brief Decode a record.
+   * \param buffer RECORD_SIZE bytes
+   * \return the record
+   */
+  static RoutingSnapshotRecord DecodeRecord (const uint8_t *buffer);
+
+  /**
+   * \brief Write the routes of one node as text, in the layout of
+   * olsr::RoutingProtocol::PrintRoutingTable.
+   * \param os output stream
+   * \param first first route of the node
+   * \param last past the last route of the node
+   */
+  static void Print (std::ostream &os, std::vector<RoutingSnapshotRecord>::const_iterator first,
+                     std::vector<RoutingSnapshotRecord>::const_iterator last);
+};
+
+/**
+ * \brief Replay a routing snapshot file.
+ *
+ * Each ReadNext () applies one snapshot, full or delta, to the current
+ * tables.
+ */
+class RoutingSnapshotReader
+{
+public:
+  RoutingSnapshotReader ();
+
+  /**
+   * \param filename snapshot file
+   * \return false if the file cannot be opened or is not a snapshot file
+   */
+  bool Open (std::string filename);
+
+  /**
+   * \brief Read and apply the next snapshot.
+   * \return false at the end of the file or on a truncated snapshot
+   */
+  bool ReadNext (void);
+
+  /**
+   * \return time of the current snapshot, in ns
+   */
+  int64_t GetTime (void) const;
+
+  /**
+   * \return true if the current snapshot is a full one
+   */
+  bool IsFull (void) const;
+
+  /**
+   * \return the records of the current snapshot, as stored in the file
+   */
+  const std::vector<RoutingSnapshotRecord> & GetRecords (void) const;
+
+  /**
+   * \return every current route, sorted by (node, destination, prefix)
+   */
+  const std::vector<RoutingSnapshotRecord> & GetTable (void) const;
+
+  /**
+   * \return the nodes whose routes the current snapshot listed, and
+   * after a full snapshot those whose routes it dropped, sorted
+   */
+  const std::vector<uint32_t> & GetChangedNodes (void) const;
+
+private:
+  std::ifstream m_in;                          //!< Snapshot file
+  int64_t m_time;                              //!< Current snapshot time
+  bool m_full;                                 //!< Current snapshot kind
+  std::vector<RoutingSnapshotRecord> m_records; //!< Current snapshot records
+  std::vector<RoutingSnapshotRecord> m_table;   //!< Current routes
+  std::vector<uint32_t> m_changed;              //!< Nodes of the current snapshot
+};
+
+} // namespace ns3
+
+#endif /* ROUTING_SNAPSHOT_H */
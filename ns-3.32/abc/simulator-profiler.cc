@@ -0,0 +1,300 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "simulator-profiler.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ProfilingSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (ProfilingSimulatorImpl);
+
+/**
+ * \brief Event wrapper accounting the execution of the wrapped event.
+ */
+class ProfilingSimulatorImpl::ProfiledEvent : public EventImpl
+{
+public:
+  /**
+   * \param profiler the profiler to report to
+   * \param event the wrapped event; its reference is taken over
+   * \param key the (type, context) key of the event
+   */
+  ProfiledEvent (ProfilingSimulatorImpl *profiler, EventImpl *event, uint32_t key)
+    : m_profiler (profiler),
+      m_event (event, false),
+      m_key (key)
+  {
+  }
+
+protected:
+  virtual void Notify (void)
+  {
+    if (m_profiler->ShouldSample ())
+      {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+        m_event->Invoke ();
+        std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now () - start;
+        m_profiler->Record (m_key, std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ());
+      }
+    else
+      {
+        m_event->Invoke ();
+        m_profiler->Record (m_key, -1);
+      }
+  }
+
+private:
+  ProfilingSimulatorImpl *m_profiler; //!< Profiler
+  Ptr<EventImpl> m_event;             //!< Wrapped event
+  uint32_t m_key;                     //!< Key in the profiler statistics
+};
+
+TypeId
+ProfilingSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ProfilingSimulatorImpl")
+    .SetParent<DefaultSimulatorImpl> ()
+    .SetGroupName ("Core")
+    .AddConstructor<ProfilingSimulatorImpl> ()
+    .AddAttribute ("SamplePeriod",
+                   "Time one event out of this many; the others are only counted.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&ProfilingSimulatorImpl::m_samplePeriod),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("TopN",
+                   "Number of rows of the summary table.",
+                   UintegerValue (20),
+                   MakeUintegerAccessor (&ProfilingSimulatorImpl::m_topN),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("OutputPrefix",
+                   "Prefix of the .folded and .txt output files.",
+                   StringValue ("simulator-profile"),
+                   MakeStringAccessor (&ProfilingSimulatorImpl::m_outputPrefix),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+ProfilingSimulatorImpl::ProfilingSimulatorImpl ()
+  : m_samplePeriod (1),
+    m_sampleCountdown (0),
+    m_topN (20),
+    m_dumped (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+EventImpl *
+ProfilingSimulatorImpl::Wrap (EventImpl *event, uint32_t context)
+{
+  std::type_index type (typeid (*event));
+  std::unordered_map<std::type_index, uint32_t>::const_iterator it = m_typeIndex.find (type);
+  uint32_t typeIndex;
+  if (it == m_typeIndex.end ())
+    {
+      typeIndex = m_types.size ();
+      m_types.push_back (&typeid (*event));
+      m_typeIndex.insert (std::make_pair (type, typeIndex));
+      m_index.push_back (std::vector<uint32_t> ());
+    }
+  else
+    {
+      typeIndex = it->second;
+    }
+
+  // Context 0xffffffff (no node) lands in slot 0.
+  uint32_t slot = context + 1;
+  std::vector<uint32_t> &contexts = m_index[typeIndex];
+  if (slot >= contexts.size ())
+    {
+      contexts.resize (slot + 1, 0);
+    }
+  if (contexts[slot] == 0)
+    {
+      Stats stats = {typeIndex, context, 0, 0, 0};
+      m_stats.push_back (stats);
+      contexts[slot] = m_stats.size ();
+    }
+  return new ProfiledEvent (this, event, contexts[slot] - 1);
+}
+
+bool
+ProfilingSimulatorImpl::ShouldSample (void)
+{
+  if (m_sampleCountdown > 0)
+    {
+      --m_sampleCountdown;
+      return false;
+    }
+  m_sampleCountdown = m_samplePeriod - 1;
+  return true;
+}
+
+void
+ProfilingSimulatorImpl::Record (uint32_t key, int64_t ns)
+{
+  Stats &stats = m_stats[key];
+  ++stats.count;
+  if (ns >= 0)
+    {
+      ++stats.sampled;
+      stats.sampledNs += ns;
+    }
+}
+
+EventId
+ProfilingSimulatorImpl::Schedule (const Time &delay, EventImpl *event)
+{
+  return DefaultSimulatorImpl::Schedule (delay, Wrap (event, GetContext ()));
+}
+
+void
+ProfilingSimulatorImpl::ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event)
+{
+  DefaultSimulatorImpl::ScheduleWithContext (context, delay, Wrap (event, context));
+}
+
+EventId
+ProfilingSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return DefaultSimulatorImpl::ScheduleNow (Wrap (event, GetContext ()));
+}
+
+EventId
+ProfilingSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  return DefaultSimulatorImpl::ScheduleDestroy (Wrap (event, GetContext ()));
+}
+
+void
+ProfilingSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  DefaultSimulatorImpl::Destroy ();
+  if (!m_dumped)
+    {
+      Dump ();
+      m_dumped = true;
+    }
+}
+
+double
+ProfilingSimulatorImpl::GetEstimatedNs (const Stats &stats)
+{
+  if (stats.sampled == 0)
+    {
+      return 0;
+    }
+  return static_cast<double> (stats.sampledNs) * stats.count / stats.sampled;
+}
+
+namespace {
+
+/**
+ * \param type a type
+ * \return the demangled name of the type
+ */
+std::string
+Demangle (const std::type_info &type)
+{
+  int status;
+  char *name = abi::__cxa_demangle (type.name (), 0, 0, &status);
+  if (status != 0)
+    {
+      return type.name ();
+    }
+  std::string demangled (name);
+  std::free (name);
+  return demangled;
+}
+
+/**
+ * \param context a simulator context
+ * \return the stack frame standing for the context
+ */
+std::string
+ContextName (uint32_t context)
+{
+  if (context == 0xffffffff)
+    {
+      return "no-context";
+    }
+  std::ostringstream oss;
+  oss << "node-" << context;
+  return oss.str ();
+}
+
+} // unnamed namespace
+
+void
+ProfilingSimulatorImpl::Dump (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<std::string> names;
+  for (std::vector<const std::type_info *>::const_iterator i = m_types.begin (); i != m_types.end (); ++i)
+    {
+      names.push_back (Demangle (**i));
+    }
+
+  std::vector<std::pair<double, uint32_t> > order;
+  double totalNs = 0;
+  uint64_t totalCount = 0;
+  for (uint32_t key = 0; key < m_stats.size (); ++key)
+    {
+      double ns = GetEstimatedNs (m_stats[key]);
+      order.push_back (std::make_pair (ns, key));
+      totalNs += ns;
+      totalCount += m_stats[key].count;
+    }
+  std::sort (order.begin (), order.end (), std::greater<std::pair<double, uint32_t> > ());
+
+  std::ofstream folded ((m_outputPrefix + ".folded").c_str ());
+  for (std::vector<std::pair<double, uint32_t> >::const_iterator i = order.begin (); i != order.end (); ++i)
+    {
+      const Stats &stats = m_stats[i->second];
+      if (stats.count == 0)
+        {
+          continue;
+        }
+      folded << ContextName (stats.context) << ";" << names[stats.type]
+             << " " << static_cast<uint64_t> (i->first) << "\n";
+    }
+
+  std::ofstream table ((m_outputPrefix + ".txt").c_str ());
+  table << "events: " << totalCount << ", estimated event time: "
+        << std::fixed << std::setprecision (3) << totalNs / 1e6 << " ms"
+        << ", sample period: " << m_samplePeriod << "\n\n";
+  table << std::setw (12) << "time (ms)" << std::setw (8) << "%"
+        << std::setw (12) << "count" << std::setw (12) << "mean (us)"
+        << std::setw (14) << "context" << "  event\n";
+  uint32_t rows = 0;
+  for (uint32_t i = 0; i < order.size () && rows < m_topN; ++i)
+    {
+      const Stats &stats = m_stats[order[i].second];
+      if (stats.count == 0)
+        {
+          continue;
+        }
+      ++rows;
+      double ns = order[i].first;
+      table << std::setw (12) << std::setprecision (3) << ns / 1e6
+            << std::setw (8) << std::setprecision (1) << (totalNs > 0 ? 100 * ns / totalNs : 0)
+            << std::setw (12) << stats.count
+            << std::setw (12) << std::setprecision (3) << ns / stats.count / 1e3
+            << std::setw (14) << ContextName (stats.context)
+            << "  " << names[stats.type] << "\n";
+    }
+  NS_LOG_INFO ("profile written to " << m_outputPrefix << ".folded and " << m_outputPrefix << ".txt");
+}
+
+} // namespace ns3
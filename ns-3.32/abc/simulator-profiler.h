@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef SIMULATOR_PROFILER_H
+#define SIMULATOR_PROFILER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <typeinfo>
+#include <typeindex>
+#include <unordered_map>
+#include "ns3/default-simulator-impl.h"
+
+namespace ns3 {
+
+/**
+ * \brief DefaultSimulatorImpl that attributes wall-clock time to event
+ * types and node contexts.
+ *
+ * Every scheduled event is wrapped so that its execution can be counted
+ * per (event type, context).  The event type is the dynamic type of the
+ * EventImpl, which for events made by Simulator::Schedule names the
+ * callback and its bound object.  One event out of SamplePeriod is timed
+ * with a steady clock; the time of the others is extrapolated from the
+ * samples of the same key.
+ *
+ * Select it from the command line of any program linking this file:
+ * \code
+ *   --SimulatorImplementationType=ns3::ProfilingSimulatorImpl
+ *   --ns3::ProfilingSimulatorImpl::OutputPrefix=olsr
+ * \endcode
+ * At Simulator::Destroy () it writes <prefix>.folded, which flamegraph.pl
+ * renders as context;event-type stacks weighted by nanoseconds, and
+ * <prefix>.txt, a table of the TopN most expensive keys.
+ *
+ * The bookkeeping is not synchronized, so events must only be scheduled
+ * from the simulation thread.
+ */
+class ProfilingSimulatorImpl : public DefaultSimulatorImpl
+{
+public:
+  /**
+   * \brief Get the registered TypeId for this class.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  ProfilingSimulatorImpl ();
+
+  /**
+   * \brief Write the folded-stack file and the top-N table.
+   *
+   * Called automatically on Destroy (); may also be called at any time.
+   */
+  void Dump (void) const;
+
+  // Inherited
+  virtual void Destroy ();
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+
+  /// Accumulated cost of one (event type, context) pair.
+  struct Stats
+  {
+    uint32_t type;      //!< Index in m_types
+    uint32_t context;   //!< Node context
+    uint64_t count;     //!< Events executed
+    uint64_t sampled;   //!< Events timed
+    uint64_t sampledNs; //!< Wall-clock time of the timed events
+  };
+
+  /**
+   * \brief Account one executed event.
+   * \param key index in m_stats
+   * \param ns wall-clock time, or -1 if the event was not timed
+   */
+  void Record (uint32_t key, int64_t ns);
+
+  /**
+   * \return true if the next event to run should be timed
+   */
+  bool ShouldSample (void);
+
+private:
+  class ProfiledEvent;
+
+  /**
+   * \param event event about to be scheduled
+   * \param context context it will run in
+   * \return a wrapper accounting its execution
+   */
+  EventImpl * Wrap (EventImpl *event, uint32_t context);
+
+  /**
+   * \param stats accumulated cost
+   * \return the estimated total wall-clock time in ns
+   */
+  static double GetEstimatedNs (const Stats &stats);
+
+  std::vector<const std::type_info *> m_types;  //!< Event types seen so far
+  std::unordered_map<std::type_index, uint32_t> m_typeIndex; //!< Index of each type in m_types
+  std::vector<Stats> m_stats;                   //!< Cost per key
+  std::vector<std::vector<uint32_t> > m_index;  //!< 1 + key of each (type, context + 1)
+  uint32_t m_samplePeriod;                      //!< Time one event out of this many
+  uint32_t m_sampleCountdown;                   //!< Events left before the next sample
+  uint32_t m_topN;                              //!< Rows in the table
+  std::string m_outputPrefix;                   //!< Output file prefix
+  bool m_dumped;                                //!< Output already written
+};
+
+} // namespace ns3
+
+#endif /* SIMULATOR_PROFILER_H */
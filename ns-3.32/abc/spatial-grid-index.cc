@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "spatial-grid-index.h"
+#include <algorithm>
+#include <cmath>
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+namespace {
+
+/// Cells per axis are kept within +/- 2^20, so that a key fits 63 bits.
+const int64_t MAX_CELL = (1 << 20) - 1;
+
+} // anonymous namespace
+
+SpatialGridIndex::SpatialGridIndex ()
+  : m_cellSize (1.0),
+    m_n (0)
+{
+  Clear ();
+}
+
+void
+SpatialGridIndex::SetCellSize (double size)
+{
+  NS_ASSERT_MSG (size > 0, "cell size must be positive");
+  Clear ();
+  m_cellSize = size;
+}
+
+double
+SpatialGridIndex::GetCellSize (void) const
+{
+  return m_cellSize;
+}
+
+int64_t
+SpatialGridIndex::CellOf (double x) const
+{
+  double c = std::floor (x / m_cellSize);
+  if (!(c > -MAX_CELL))
+    {
+      return -MAX_CELL;   // also NaN
+    }
+  return c < MAX_CELL ? static_cast<int64_t> (c) : MAX_CELL;
+}
+
+uint64_t
+SpatialGridIndex::MakeKey (int64_t x, int64_t y, int64_t z)
+{
+  return (static_cast<uint64_t> (x + MAX_CELL) << 42)
+         | (static_cast<uint64_t> (y + MAX_CELL) << 21)
+         | static_cast<uint64_t> (z + MAX_CELL);
+}
+
+void
+SpatialGridIndex::Insert (uint32_t id, const Vector &position)
+{
+  int64_t c[3] = { CellOf (position.x), CellOf (position.y), CellOf (position.z) };
+  uint64_t key = MakeKey (c[0], c[1], c[2]);
+  if (id >= m_entries.size ())
+    {
+      Entry empty = { 0, 0, false };
+      m_entries.resize (id + 1, empty);
+    }
+  Entry &e = m_entries[id];
+  if (e.present)
+    {
+      if (e.cell == key)
+        {
+          return;
+        }
+      Remove (id);
+    }
+  std::vector<uint32_t> &cell = m_cells[key];
+  e.cell = key;
+  e.slot = cell.size ();
+  e.present = true;
+  cell.push_back (id);
+  ++m_n;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      m_min[i] = std::min (m_min[i], c[i]);
+      m_max[i] = std::max (m_max[i], c[i]);
+    }
+}
+
+void
+SpatialGridIndex::Remove (uint32_t id)
+{
+  if (!Contains (id))
+    {
+      return;
+    }
+  Entry &e = m_entries[id];
+  std::unordered_map<uint64_t, std::vector<uint32_t> >::iterator cell = m_cells.find (e.cell);
+  NS_ASSERT (cell != m_cells.end () && cell->second[e.slot] == id);
+  // Swap with the last point of the cell.
+  uint32_t last = cell->second.back ();
+  cell->second[e.slot] = last;
+  m_entries[last].slot = e.slot;
+  cell->second.pop_back ();
+  if (cell->second.empty ())
+    {
+      m_cells.erase (cell);
+    }
+  e.present = false;
+  --m_n;
+}
+
+bool
+SpatialGridIndex::Contains (uint32_t id) const
+{
+  return id < m_entries.size () && m_entries[id].present;
+}
+
+void
+SpatialGridIndex::Query (const Vector &center, double radius, std::vector<uint32_t> &ids) const
+{
+  if (m_n == 0)
+    {
+      return;
+    }
+  // Cells of the bounding box, clipped to the occupied ones: on a plane
+  // this avoids looking up empty layers above and below.
+  int64_t lo[3] = { CellOf (center.x - radius), CellOf (center.y - radius), CellOf (center.z - radius) };
+  int64_t hi[3] = { CellOf (center.x + radius), CellOf (center.y + radius), CellOf (center.z + radius) };
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      lo[i] = std::max (lo[i], m_min[i]);
+      hi[i] = std::min (hi[i], m_max[i]);
+      if (lo[i] > hi[i])
+        {
+          return;
+        }
+    }
+  if ((hi[0] - lo[0] + 1) * (hi[1] - lo[1] + 1) * (hi[2] - lo[2] + 1) > static_cast<int64_t> (m_cells.size ()))
+    {
+      // The box covers more cells than there are occupied ones.
+      for (std::unordered_map<uint64_t, std::vector<uint32_t> >::const_iterator cell = m_cells.begin ();
+           cell != m_cells.end (); ++cell)
+        {
+          int64_t x = static_cast<int64_t> (cell->first >> 42) - MAX_CELL;
+          int64_t y = static_cast<int64_t> ((cell->first >> 21) & 0x1fffff) - MAX_CELL;
+          int64_t z = static_cast<int64_t> (cell->first & 0x1fffff) - MAX_CELL;
+          if (x >= lo[0] && x <= hi[0] && y >= lo[1] && y <= hi[1] && z >= lo[2] && z <= hi[2])
+            {
+              ids.insert (ids.end (), cell->second.begin (), cell->second.end ());
+            }
+        }
+      return;
+    }
+  for (int64_t x = lo[0]; x <= hi[0]; ++x)
+    {
+      for (int64_t y = lo[1]; y <= hi[1]; ++y)
+        {
+          for (int64_t z = lo[2]; z <= hi[2]; ++z)
+            {
+              std::unordered_map<uint64_t, std::vector<uint32_t> >::const_iterator cell = m_cells.find (MakeKey (x, y, z));
+              if (cell != m_cells.end ())
+                {
+                  ids.insert (ids.end (), cell->second.begin (), cell->second.end ());
+                }
+            }
+        }
+    }
+}
+
+uint32_t
+SpatialGridIndex::GetN (void) const
+{
+  return m_n;
+}
+
+uint32_t
+SpatialGridIndex::GetNCells (void) const
+{
+  return m_cells.size ();
+}
+
+void
+SpatialGridIndex::Clear (void)
+{
+  m_cells.clear ();
+  m_entries.clear ();
+  m_n = 0;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      m_min[i] = MAX_CELL;
+      m_max[i] = -MAX_CELL;
+    }
+}
+
+} // namespace ns3
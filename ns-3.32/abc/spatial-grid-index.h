@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef SPATIAL_GRID_INDEX_H
+#define SPATIAL_GRID_INDEX_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include "ns3/vector.h"
+
+namespace ns3 {
+
+/**
+ * \brief Uniform grid of points, for range queries.
+ *
+ * Space is cut in cubic cells; each cell lists the ids of the points it
+ * holds.  A query visits the cells that overlap the bounding box of the
+ * query sphere, so with cells as large as the query radius it looks at
+ * 3x3 cells on a plane whatever the number of points.  Inserting, moving
+ * and removing a point are O(1).
+ *
+ * Ids are small integers chosen by the caller, such as positions in a
+ * vector; the index keeps one slot per id up to the largest one.
+ */
+class SpatialGridIndex
+{
+public:
+  SpatialGridIndex ();
+
+  /**
+   * \brief Set the cell size and empty the index.
+   * \param size cell edge (m), strictly positive
+   */
+  void SetCellSize (double size);
+
+  /// \return the cell edge (m)
+  double GetCellSize (void) const;
+
+  /**
+   * \brief Insert a point, or move it if already present.
+   * \param id point id
+   * \param position position
+   */
+  void Insert (uint32_t id, const Vector &position);
+
+  /**
+   * \param id point id; nothing happens if absent
+   */
+  void Remove (uint32_t id);
+
+  /**
+   * \param id point id
+   * \return true if the point is in the index
+   */
+  bool Contains (uint32_t id) const;
+
+  /**
+   * \brief Append the points of the cells within radius of center.
+   *
+   * The result is a superset of the points within radius of center, in
+   * no particular order; callers check the exact distance themselves.
+   *
+   * \param center query center
+   * \param radius query radius (m)
+   * \param ids output, appended to
+   */
+  void Query (const Vector &center, double radius, std::vector<uint32_t> &ids) const;
+
+  /// \return the number of points
+  uint32_t GetN (void) const;
+
+  /// \return the number of non-empty cells
+  uint32_t GetNCells (void) const;
+
+  /// Remove every point.
+  void Clear (void);
+
+private:
+  /// Place of a point in the grid.
+  struct Entry
+  {
+    uint64_t cell;  //!< Cell key
+    uint32_t slot;  //!< Position in the list of the cell
+    bool present;   //!< Point is in the index
+  };
+
+  /**
+   * \param x coordinate (m)
+   * \return the cell coordinate, clamped to 21 bits
+   */
+  int64_t CellOf (double x) const;
+
+  /**
+   * \param x cell coordinate
+   * \param y cell coordinate
+   * \param z cell coordinate
+   * \return the key of the cell
+   */
+  static uint64_t MakeKey (int64_t x, int64_t y, int64_t z);
+
+  double m_cellSize;                                          //!< Cell edge (m)
+  std::unordered_map<uint64_t, std::vector<uint32_t> > m_cells; //!< Points of each cell
+  std::vector<Entry> m_entries;                               //!< Place of each id
+  uint32_t m_n;                                               //!< Number of points
+  int64_t m_min[3];                                           //!< Lowest occupied cell on each axis
+  int64_t m_max[3];                                           //!< Highest occupied cell on each axis
+};
+
+} // namespace ns3
+
+#endif /* SPATIAL_GRID_INDEX_H */
@@ -0,0 +1,226 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "tabulated-error-rate-model.h"
+#include "error-rate-batch.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TabulatedErrorRateModel");
+
+NS_OBJECT_ENSURE_REGISTERED (TabulatedErrorRateModel);
+
+TypeId
+TabulatedErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TabulatedErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<TabulatedErrorRateModel> ()
+    .AddAttribute ("Model",
+                   "The error-rate model to tabulate.",
+                   PointerValue (),
+                   MakePointerAccessor (&TabulatedErrorRateModel::SetModel,
+                                        &TabulatedErrorRateModel::GetModel),
+                   MakePointerChecker<ErrorRateModel> ())
+    .AddAttribute ("Resolution",
+                   "SNR step of the tables (dB).",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::SetResolution),
+                   MakeDoubleChecker<double> (1e-4))
+    .AddAttribute ("MinSnr",
+                   "Lowest SNR in the tables (dB); below, the wrapped model is used.",
+                   DoubleValue (-10),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::SetMinSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxSnr",
+                   "Highest SNR in the tables (dB); above, the wrapped model is used.",
+                   DoubleValue (60),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::SetMaxSnr),
+                   MakeDoubleChecker<double> ())
+  ;
+  return tid;
+}
+
+TabulatedErrorRateModel::TabulatedErrorRateModel ()
+  : m_resolution (0.01),
+    m_minSnr (-10),
+    m_maxSnr (60),
+    m_lastKey (0),
+    m_last (0),
+    m_fallbacks (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TabulatedErrorRateModel::~TabulatedErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TabulatedErrorRateModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_DEBUG (m_tables.size () << " tables, fallbacks " << m_fallbacks);
+  m_model = 0;
+  Flush ();
+  ErrorRateModel::DoDispose ();
+}
+
+void
+TabulatedErrorRateModel::SetModel (Ptr<ErrorRateModel> model)
+{
+  m_model = model;
+  Flush ();
+}
+
+Ptr<ErrorRateModel>
+TabulatedErrorRateModel::GetModel (void) const
+{
+  return m_model;
+}
+
+void
+TabulatedErrorRateModel::SetResolution (double resolution)
+{
+  m_resolution = resolution;
+  Flush ();
+}
+
+void
+TabulatedErrorRateModel::SetMinSnr (double snr)
+{
+  m_minSnr = snr;
+  Flush ();
+}
+
+void
+TabulatedErrorRateModel::SetMaxSnr (double snr)
+{
+  m_maxSnr = snr;
+  Flush ();
+}
+
+void
+TabulatedErrorRateModel::Flush (void)
+{
+  m_tables.clear ();
+  m_last = 0;
+}
+
+uint32_t
+TabulatedErrorRateModel::GetNTables (void) const
+{
+  return m_tables.size ();
+}
+
+uint64_t
+TabulatedErrorRateModel::GetFallbacks (void) const
+{
+  return m_fallbacks;
+}
+
+const std::vector<double> &
+TabulatedErrorRateModel::GetTable (WifiMode mode, const WifiTxVector &txVector) const
+{
+  uint32_t key = (static_cast<uint32_t> (mode.GetUid ()) << 24)
+    | ((static_cast<uint32_t> (txVector.GetChannelWidth ()) & 0xfff) << 12)
+    | ((static_cast<uint32_t> (txVector.GetNss ()) & 0xf) << 8)
+    | ((txVector.GetGuardInterval () / 100) & 0xff);
+  if (m_last != 0 && key == m_lastKey)
+    {
+      return *m_last;
+    }
+  std::vector<double> &table = m_tables[key];
+  if (table.empty ())
+    {
+      NS_ABORT_MSG_IF (m_maxSnr <= m_minSnr || m_resolution <= 0,
+                       "need MinSnr < MaxSnr and a positive Resolution");
+      uint32_t n = static_cast<uint32_t> (std::ceil ((m_maxSnr - m_minSnr) / m_resolution)) + 1;
+      // GetChunkSuccessRates () interpolates between t[k] and t[k + 1]
+      // with k at most n - 2.
+      NS_ABORT_MSG_IF (n < 2, "a table needs at least two points");
+      NS_LOG_DEBUG ("table for " << mode << ": " << n << " points");
+      table.resize (n);
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          double snr = std::pow (10.0, (m_minSnr + i * m_resolution) / 10.0);
+          double p = m_model->GetChunkSuccessRate (mode, txVector, snr, 1);
+          // A success rate of 0 would give -inf, and NaN once interpolated.
+          table[i] = std::log (std::max (p, std::numeric_limits<double>::min ()));
+        }
+    }
+  m_lastKey = key;
+  m_last = &table;
+  return table;
+}
+
+double
+TabulatedErrorRateModel::DoGetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  NS_ASSERT_MSG (m_model, "no model to tabulate");
+  double x = (10 * std::log10 (snr) - m_minSnr) / m_resolution;
+  if (!(x >= 0))   // also catches the NaN and -inf of snr <= 0
+    {
+      ++m_fallbacks;
+      return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  const std::vector<double> &table = GetTable (mode, txVector);
+  uint32_t i = static_cast<uint32_t> (std::min<double> (x, table.size ()));
+  if (i + 1 >= table.size ())
+    {
+      ++m_fallbacks;
+      return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  double frac = x - i;
+  double logp = table[i] + frac * (table[i + 1] - table[i]);
+  return std::exp (static_cast<double> (nbits) * logp);
+}
+
+void
+TabulatedErrorRateModel::GetChunkSuccessRates (WifiMode mode, const WifiTxVector &txVector,
+                                               const std::vector<double> &snrs, uint64_t nbits,
+                                               std::vector<double> &ps) const
+{
+  NS_ASSERT_MSG (m_model, "no model to tabulate");
+  const std::vector<double> &table = GetTable (mode, txVector);
+  NS_ASSERT (table.size () >= 2);
+  // Linear bounds, so that NaN, zero and negative SNRs fall outside too.
+  double last = table.size () - 1;
+  double minSnr = std::pow (10.0, m_minSnr / 10.0);
+  double maxSnr = std::pow (10.0, (m_minSnr + last * m_resolution) / 10.0);
+
+  ErrorRateBatch::ToDb (snrs, ps);
+  const double *in = snrs.data ();
+  const double *t = table.data ();
+  double *out = ps.data ();
+  double bits = static_cast<double> (nbits);
+  uint32_t n = snrs.size ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      bool inside = in[i] >= minSnr && in[i] < maxSnr;
+      double x = inside ? (out[i] - m_minSnr) / m_resolution : 0;
+      x = std::min (std::max (x, 0.0), last);
+      uint32_t k = std::min (static_cast<uint32_t> (x), static_cast<uint32_t> (last) - 1);
+      out[i] = bits * (t[k] + (x - k) * (t[k + 1] - t[k]));
+    }
+  ErrorRateBatch::Exp (ps);
+
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      if (!(in[i] >= minSnr && in[i] < maxSnr))
+        {
+          ++m_fallbacks;
+          out[i] = m_model->GetChunkSuccessRate (mode, txVector, in[i], nbits);
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef TABULATED_ERROR_RATE_MODEL_H
+#define TABULATED_ERROR_RATE_MODEL_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include "ns3/error-rate-model.h"
+
+namespace ns3 {
+
+/**
+ * \brief ErrorRateModel that interpolates the per-bit success rate of
+ * another one from a table.
+ *
+ * The chunk success rate of the Yans and Nist models is a per-bit success
+ * rate p raised to the number of bits, and p is a smooth function of the
+ * SNR in dB.  The first time a mode is used, this model samples log (p)
+ * of the wrapped model from MinSnr to MaxSnr every Resolution dB; after
+ * that a chunk costs a log10, a linear interpolation and an exp instead
+ * of erfc, binomial sums and powers.  SNRs outside of the table are
+ * handed to the wrapped model.
+ *
+ * With the default 0.01 dB resolution the frame success rate of 1500-byte
+ * frames stays within 1e-4 of the analytic one; the validation examples
+ * check it with --tabulated halfway between the table points, where the
+ * interpolation error peaks.  Tables are kept per mode, channel width,
+ * number of streams and guard interval, as CachedErrorRateModel keys its
+ * entries.
+ *
+ * GetChunkSuccessRates () computes a whole vector of chunks at once; it
+ * is what ErrorRateBatch uses for this model.
+ */
+class TabulatedErrorRateModel : public ErrorRateModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TabulatedErrorRateModel ();
+  virtual ~TabulatedErrorRateModel ();
+
+  /**
+   * \param model the model to tabulate
+   */
+  void SetModel (Ptr<ErrorRateModel> model);
+
+  /// \return the tabulated model
+  Ptr<ErrorRateModel> GetModel (void) const;
+
+  /**
+   * \brief Chunk success rates of many SNRs at once.
+   * \param mode the mode
+   * \param txVector the TXVECTOR
+   * \param snrs linear SNRs
+   * \param nbits bits per chunk
+   * \param ps output, the success rate of each chunk; not snrs
+   */
+  void GetChunkSuccessRates (WifiMode mode, const WifiTxVector &txVector,
+                             const std::vector<double> &snrs, uint64_t nbits,
+                             std::vector<double> &ps) const;
+
+  /// \return the number of tables built so far
+  uint32_t GetNTables (void) const;
+
+  /// \return the number of chunks handed to the wrapped model
+  uint64_t GetFallbacks (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual double DoGetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+
+  /**
+   * \param mode the mode
+   * \param txVector the TXVECTOR
+   * \return the table of that mode, built if needed
+   */
+  const std::vector<double> & GetTable (WifiMode mode, const WifiTxVector &txVector) const;
+
+  /**
+   * \param resolution step of the tables (dB)
+   */
+  void SetResolution (double resolution);
+  /**
+   * \param snr first SNR of the tables (dB)
+   */
+  void SetMinSnr (double snr);
+  /**
+   * \param snr last SNR of the tables (dB)
+   */
+  void SetMaxSnr (double snr);
+
+  /// Drop every table.
+  void Flush (void);
+
+  Ptr<ErrorRateModel> m_model;                                           //!< Tabulated model
+  double m_resolution;                                                   //!< Step of the tables (dB)
+  double m_minSnr;                                                       //!< First SNR of the tables (dB)
+  double m_maxSnr;                                                       //!< Last SNR of the tables (dB)
+  mutable std::unordered_map<uint32_t, std::vector<double> > m_tables;   //!< log (p) every step, per key
+  mutable uint32_t m_lastKey;                                            //!< Key of the last table used
+  mutable const std::vector<double> *m_last;                             //!< Last table used, or 0
+  mutable uint64_t m_fallbacks;                                          //!< Chunks outside of the tables
+};
+
+} // namespace ns3
+
+#endif /* TABULATED_ERROR_RATE_MODEL_H */
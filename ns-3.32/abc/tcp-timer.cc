@@ -1,36 +1,276 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 #include "tcp-timer.h"
 #include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("TcpTimer");
 
+NS_OBJECT_ENSURE_REGISTERED (TcpTimerTable);
+
+TypeId
+TcpTimerTable::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpTimerTable")
+    .SetParent<Object> ()
+    .AddConstructor<TcpTimerTable> ()
+    .AddAttribute ("InitialRto",
+                   "RTO of a connection before its first RTT sample.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&TcpTimerTable::m_initialRto),
+                   MakeTimeChecker ())
+    .AddAttribute ("MinRto",
+                   "Lower bound of the RTO.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&TcpTimerTable::m_minRto),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxRto",
+                   "Upper bound of the RTO, backoff included.",
+                   TimeValue (Seconds (60)),
+                   MakeTimeAccessor (&TcpTimerTable::m_maxRto),
+                   MakeTimeChecker ())
+    .AddAttribute ("ClockGranularity",
+                   "Clock granularity G of the RTO computation.",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&TcpTimerTable::m_granularity),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxBackoff",
+                   "Maximum number of RTO doublings.",
+                   UintegerValue (6),
+                   MakeUintegerAccessor (&TcpTimerTable::m_maxBackoff),
+                   MakeUintegerChecker<uint32_t> (0, 16))
+  ;
+  return tid;
+}
+
+TcpTimerTable::TcpTimerTable ()
+  : m_nScheduled (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TcpTimerTable::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_timeout = Callback<void, uint32_t> ();
+  Object::DoDispose ();
+}
+
+uint32_t
+TcpTimerTable::Add (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  uint32_t first = m_rto.size ();
+  m_srtt8.resize (first + n, 0);
+  m_rttVar4.resize (first + n, 0);
+  m_rto.resize (first + n, m_initialRto.GetTimeStep ());
+  m_deadline.resize (first + n, -1);
+  m_eventAt.resize (first + n, 0);
+  m_backoff.resize (first + n, 0);
+  m_flags.resize (first + n, 0);
+  return first;
+}
+
+uint32_t
+TcpTimerTable::GetNConnections (void) const
+{
+  return m_rto.size ();
+}
+
+void
+TcpTimerTable::SetTimeoutCallback (Callback<void, uint32_t> callback)
+{
+  m_timeout = callback;
+}
+
+void
+TcpTimerTable::UpdateRtt (uint32_t conn, Time rtt, bool retransmitted)
+{
+  NS_LOG_FUNCTION (this << conn << rtt << retransmitted);
+  if (retransmitted)
+    {
+      // Karn's rule: the ACK may be for any of the transmissions.
+      return;
+    }
+  int64_t r = rtt.GetTimeStep ();
+  if (m_flags[conn] & HAS_SAMPLE)
+    {
+      // RTTVAR <- 3/4 RTTVAR + 1/4 |SRTT - R|, then SRTT <- 7/8 SRTT + 1/8 R.
+      int64_t err = r - (m_srtt8[conn] >> 3);
+      m_srtt8[conn] += err;
+      m_rttVar4[conn] += (err < 0 ? -err : err) - (m_rttVar4[conn] >> 2);
+    }
+  else
+    {
+      // SRTT <- R, RTTVAR <- R/2.
+      m_srtt8[conn] = r << 3;
+      m_rttVar4[conn] = r << 1;
+      m_flags[conn] |= HAS_SAMPLE;
+    }
+  m_backoff[conn] = 0;
+  UpdateRto (conn);
+}
+
+void
+TcpTimerTable::UpdateRto (uint32_t conn)
+{
+  int64_t var = m_rttVar4[conn];
+  int64_t g = m_granularity.GetTimeStep ();
+  int64_t rto = (m_srtt8[conn] >> 3) + (var > g ? var : g);
+  int64_t lower = m_minRto.GetTimeStep ();
+  int64_t upper = m_maxRto.GetTimeStep ();
+  m_rto[conn] = rto < lower ? lower : (rto > upper ? upper : rto);
+}
+
+void
+TcpTimerTable::Start (uint32_t conn)
+{
+  NS_LOG_FUNCTION (this << conn);
+  m_deadline[conn] = Simulator::Now ().GetTimeStep () + GetRto (conn).GetTimeStep ();
+  // A pending event at or before the deadline is reused when it expires.
+  if (!(m_flags[conn] & PENDING) || m_eventAt[conn] > m_deadline[conn])
+    {
+      ScheduleEvent (conn);
+    }
+}
+
+void
+TcpTimerTable::Stop (uint32_t conn)
+{
+  NS_LOG_FUNCTION (this << conn);
+  // The pending event, if any, finds the timer stopped and is dropped.
+  m_deadline[conn] = -1;
+}
+
+bool
+TcpTimerTable::IsRunning (uint32_t conn) const
+{
+  return m_deadline[conn] >= 0;
+}
+
+void
+TcpTimerTable::ScheduleEvent (uint32_t conn)
+{
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  m_eventAt[conn] = m_deadline[conn];
+  m_flags[conn] |= PENDING;
+  ++m_nScheduled;
+  // The event holds a reference so that the table outlives it.
+  Simulator::Schedule (TimeStep (m_deadline[conn] - now), &TcpTimerTable::Expire,
+                       Ptr<TcpTimerTable> (this), conn);
+}
+
+void
+TcpTimerTable::Expire (uint32_t conn)
+{
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  if (!(m_flags[conn] & PENDING) || m_eventAt[conn] != now)
+    {
+      // Superseded by an earlier event.
+      return;
+    }
+  m_flags[conn] &= ~PENDING;
+  if (m_deadline[conn] < 0)
+    {
+      return;
+    }
+  if (m_deadline[conn] > now)
+    {
+      ScheduleEvent (conn);
+      return;
+    }
+  NS_LOG_LOGIC ("timeout of connection " << conn << " after " << GetRto (conn).As (Time::S));
+  m_deadline[conn] = -1;
+  if (m_backoff[conn] < m_maxBackoff)
+    {
+      ++m_backoff[conn];
+    }
+  if (!m_timeout.IsNull ())
+    {
+      m_timeout (conn);
+    }
+}
+
+Time
+TcpTimerTable::GetRto (uint32_t conn) const
+{
+  int64_t rto = m_rto[conn] << m_backoff[conn];
+  int64_t upper = m_maxRto.GetTimeStep ();
+  return TimeStep (rto > upper ? upper : rto);
+}
+
+Time
+TcpTimerTable::GetSrtt (uint32_t conn) const
+{
+  return TimeStep (m_srtt8[conn] >> 3);
+}
+
+Time
+TcpTimerTable::GetRttVar (uint32_t conn) const
+{
+  return TimeStep (m_rttVar4[conn] >> 2);
+}
+
+uint32_t
+TcpTimerTable::GetBackoffCount (uint32_t conn) const
+{
+  return m_backoff[conn];
+}
+
+uint64_t
+TcpTimerTable::GetNScheduled (void) const
+{
+  return m_nScheduled;
+}
+
 TcpTimer::TcpTimer(Time retransmissionTimeout)
-  : m_retransmissionTimeout(retransmissionTimeout) {
-  m_timer.SetFunction(&TcpTimer::Retransmit, this);
+  : m_table(CreateObject<TcpTimerTable> ()) {
+  m_table->SetAttribute("InitialRto", TimeValue(retransmissionTimeout));
+  m_table->Add();
+  m_table->SetTimeoutCallback(MakeCallback(&TcpTimer::Expired, this));
+}
+
+TcpTimer::~TcpTimer() {
+  // A pending event keeps the table alive; make sure it cannot call back.
+  m_table->Stop(0);
+  m_table->Dispose();
 }
 
 void TcpTimer::Start() {
-  m_timer.Schedule(m_retransmissionTimeout);
-  NS_LOG_INFO("TCP timer started for " << m_retransmissionTimeout.GetSeconds() << " seconds");
+  m_table->Start(0);
+  NS_LOG_INFO("TCP timer started for " << m_table->GetRto(0).GetSeconds() << " seconds");
 }
 
 void TcpTimer::Stop() {
-  if (m_timer.IsRunning()) {
-    m_timer.Cancel();
+  if (m_table->IsRunning(0)) {
+    m_table->Stop(0);
     NS_LOG_INFO("TCP timer stopped");
   }
 }
 
 bool TcpTimer::IsRunning() const {
-  return m_timer.IsRunning();
+  return m_table->IsRunning(0);
+}
+
+void TcpTimer::AckReceived(Time rtt, bool retransmitted) {
+  m_table->UpdateRtt(0, rtt, retransmitted);
+  NS_LOG_INFO("RTT " << rtt.GetSeconds() << " seconds, RTO now " << m_table->GetRto(0).GetSeconds() << " seconds");
+}
+
+Time TcpTimer::GetRto() const {
+  return m_table->GetRto(0);
+}
+
+void TcpTimer::Expired(uint32_t conn) {
+  Retransmit();
 }
 
 void TcpTimer::Retransmit() {
-  NS_LOG_INFO("TCP retransmission timeout occurred");
+  NS_LOG_INFO("TCP retransmission timeout occurred, RTO backed off to " << m_table->GetRto(0).GetSeconds() << " seconds");
   // Implement retransmission logic here
 }
 
 } // namespace ns3
-
@@ -2,25 +2,190 @@
 #ifndef TCP_TIMER_H
 #define TCP_TIMER_H
 
+#include <vector>
 #include "ns3/nstime.h"
-#include "ns3/timer.h"
+#include "ns3/object.h"
+#include "ns3/callback.h"
 
 namespace ns3 {
 
+/**
+ * \brief Retransmission timers and RTO estimators of many connections.
+ *
+ * The estimator follows RFC 6298: SRTT and RTTVAR are updated from each
+ * RTT sample (kept scaled by 8 and 4 so that the update is integer only),
+ * RTO = SRTT + max (G, 4 RTTVAR), clamped to [MinRto, MaxRto].  Samples
+ * of retransmitted segments are ignored (Karn's rule) and every timeout
+ * doubles the RTO, up to MaxBackoff doublings and MaxRto.
+ *
+ * The state is a struct of arrays indexed by connection, so the ACK path
+ * only touches the columns it needs and 1M connections take about 42 MB.
+ *
+ * Each connection has at most one event in the scheduler.  Restarting the
+ * timer only moves the deadline; when the event expires before the
+ * deadline it is rescheduled to it.  A new event is only scheduled when
+ * the deadline moves earlier than the pending event, and the superseded
+ * event is then ignored when it expires.
+ */
+class TcpTimerTable : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpTimerTable ();
+
+  /**
+   * \brief Add connections with a fresh estimator and a stopped timer.
+   * \param n number of connections to add
+   * \return the index of the first added connection
+   */
+  uint32_t Add (uint32_t n = 1);
+
+  /**
+   * \return the number of connections
+   */
+  uint32_t GetNConnections (void) const;
+
+  /**
+   * \brief Set the callback invoked with the connection index on timeout.
+   * \param callback the timeout callback
+   *
+   * The RTO is already backed off when the callback runs, so a callback
+   * which retransmits can just call Start () again.
+   */
+  void SetTimeoutCallback (Callback<void, uint32_t> callback);
+
+  /**
+   * \brief Feed the RTT sample carried by an ACK.
+   * \param conn connection index
+   * \param rtt measured round-trip time
+   * \param retransmitted whether the acked segment was retransmitted
+   *
+   * A valid sample also resets the backoff.
+   */
+  void UpdateRtt (uint32_t conn, Time rtt, bool retransmitted);
+
+  /**
+   * \brief (Re)arm the timer to expire one RTO from now.
+   * \param conn connection index
+   */
+  void Start (uint32_t conn);
+
+  /**
+   * \brief Stop the timer.
+   * \param conn connection index
+   */
+  void Stop (uint32_t conn);
+
+  /**
+   * \param conn connection index
+   * \return true if the timer is armed
+   */
+  bool IsRunning (uint32_t conn) const;
+
+  /**
+   * \param conn connection index
+   * \return the RTO, backoff included
+   */
+  Time GetRto (uint32_t conn) const;
+
+  /**
+   * \param conn connection index
+   * \return the smoothed RTT, zero before the first sample
+   */
+  Time GetSrtt (uint32_t conn) const;
+
+  /**
+   * \param conn connection index
+   * \return the RTT variation, zero before the first sample
+   */
+  Time GetRttVar (uint32_t conn) const;
+
+  /**
+   * \param conn connection index
+   * \return the number of timeouts since the last valid RTT sample
+   */
+  uint32_t GetBackoffCount (uint32_t conn) const;
+
+  /**
+   * \return the number of events scheduled so far
+   */
+  uint64_t GetNScheduled (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Handle the expiry of a connection event.
+   * \param conn connection index
+   */
+  void Expire (uint32_t conn);
+
+  /**
+   * \brief Schedule the event of a connection at its deadline.
+   * \param conn connection index
+   */
+  void ScheduleEvent (uint32_t conn);
+
+  /**
+   * \brief Recompute the RTO of a connection from its SRTT and RTTVAR.
+   * \param conn connection index
+   */
+  void UpdateRto (uint32_t conn);
+
+  /// Bits of m_flags.
+  enum
+  {
+    HAS_SAMPLE = 1, //!< SRTT and RTTVAR hold a sample
+    PENDING = 2     //!< An event is pending at m_eventAt
+  };
+
+  Time m_initialRto;  //!< RTO before the first sample
+  Time m_minRto;      //!< Lower bound of the RTO
+  Time m_maxRto;      //!< Upper bound of the RTO, backoff included
+  Time m_granularity; //!< Clock granularity G
+  uint32_t m_maxBackoff; //!< Maximum number of RTO doublings
+  Callback<void, uint32_t> m_timeout; //!< Timeout callback
+  uint64_t m_nScheduled; //!< Number of scheduled events
+
+  // One column per field, in time steps unless noted.
+  std::vector<int64_t> m_srtt8;    //!< 8 SRTT
+  std::vector<int64_t> m_rttVar4;  //!< 4 RTTVAR
+  std::vector<int64_t> m_rto;      //!< RTO without backoff
+  std::vector<int64_t> m_deadline; //!< Expiry time, -1 if stopped
+  std::vector<int64_t> m_eventAt;  //!< Expiry time of the pending event
+  std::vector<uint8_t> m_backoff;  //!< Number of RTO doublings
+  std::vector<uint8_t> m_flags;    //!< HAS_SAMPLE and PENDING bits
+};
+
+/**
+ * \brief Retransmission timer of a single connection.
+ *
+ * Owns a TcpTimerTable of one connection; simulations of many connections
+ * should use a single TcpTimerTable instead.
+ */
 class TcpTimer {
 public:
   TcpTimer(Time retransmissionTimeout);
+  ~TcpTimer();
   void Start();
   void Stop();
   bool IsRunning() const;
+  void AckReceived(Time rtt, bool retransmitted);
+  Time GetRto() const;
   void Retransmit();
 
 private:
-  Time m_retransmissionTimeout;
-  Timer m_timer;
+  void Expired(uint32_t conn);
+
+  Ptr<TcpTimerTable> m_table;
 };
 
 } // namespace ns3
 
 #endif /* TCP_TIMER_H */
-
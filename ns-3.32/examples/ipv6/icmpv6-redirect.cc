@@ -48,6 +48,7 @@
 #include "ns3/ipv6-static-routing-helper.h"
 
 #include "ns3/ipv6-routing-table-entry.h"
+#include "../../abc/ipv6-lpm-routing.h"
 
 using namespace ns3;
 
@@ -56,9 +57,11 @@ NS_LOG_COMPONENT_DEFINE ("Icmpv6RedirectExample");
 int main (int argc, char **argv)
 {
   bool verbose = false;
+  bool lpmRouting = false;
 
   CommandLine cmd (__FILE__);
   cmd.AddValue ("verbose", "turn on log components", verbose);
+  cmd.AddValue ("lpmRouting", "look routes up in a trie instead of scanning the routing tables", lpmRouting);
   cmd.Parse (argc, argv);
 
   if (verbose)
@@ -82,6 +85,13 @@ int main (int argc, char **argv)
   NodeContainer all (sta1, r1, r2, sta2);
 
   InternetStackHelper internetv6;
+  if (lpmRouting)
+    {
+      Ipv6LpmStaticRoutingHelper staticRouting;
+      Ipv6ListRoutingHelper listRouting;
+      listRouting.Add (staticRouting, 0);
+      internetv6.SetRoutingHelper (listRouting);
+    }
   internetv6.Install (all);
 
   NS_LOG_INFO ("Create channels.");
@@ -55,6 +55,7 @@
 #include "ns3/netanim-module.h"
 #include "ns3/assert.h"
 #include "ns3/ipv4-global-routing-helper.h"
+#include "../../abc/parallel-global-routing-helper.h"
 
 using namespace std;
 using namespace ns3;
@@ -99,7 +100,11 @@ int main (int argc, char *argv[])
   std::string adj_mat_file_name ("examples/matrix-topology/adjacency_matrix.txt");
   std::string node_coordinates_file_name ("examples/matrix-topology/node_coordinates.txt");
 
+  int32_t routingThreads = -1;
+
   CommandLine cmd (__FILE__);
+  cmd.AddValue ("routingThreads", "populate global routes with this many SPF threads "
+                "(0 for one per hardware thread, -1 for Ipv4GlobalRoutingHelper)", routingThreads);
   cmd.Parse (argc, argv);
   
   // ---------- End of Simulation Variables ----------------------------------
@@ -183,7 +188,14 @@ int main (int argc, char *argv[])
   NS_LOG_INFO ("Number of all nodes is: " << nodes.GetN ());
 
   NS_LOG_INFO ("Initialize Global Routing.");
-  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  if (routingThreads >= 0)
+    {
+      ParallelGlobalRoutingHelper::PopulateRoutingTables (routingThreads);
+    }
+  else
+    {
+      Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+    }
 
   // ---------- End of Network Set-up ----------------------------------------
 
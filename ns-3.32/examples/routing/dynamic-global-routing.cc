@@ -74,11 +74,33 @@
 #include "ns3/point-to-point-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/ipv4-global-routing-helper.h"
+#include "../../abc/parallel-global-routing-helper.h"
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("DynamicGlobalRoutingExample");
 
+/**
+ * Set an interface up or down, then update the routers it affects.
+ * \param ipv4 the IPv4 stack
+ * \param interface the interface
+ * \param up new state
+ */
+void
+SetInterface (Ptr<Ipv4> ipv4, uint32_t interface, bool up)
+{
+  if (up)
+    {
+      ipv4->SetUp (interface);
+    }
+  else
+    {
+      ipv4->SetDown (interface);
+    }
+  ParallelGlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_LOG_INFO ("Recomputed " << ParallelGlobalRoutingHelper::GetNRecomputed () << " routers");
+}
+
 int 
 main (int argc, char *argv[])
 {
@@ -88,8 +110,14 @@ main (int argc, char *argv[])
 
   // Allow the user to override any of the defaults and the above
   // Bind ()s at run-time, via command-line arguments
+  bool parallelRouting = false;
   CommandLine cmd (__FILE__);
+  cmd.AddValue ("parallelRouting", "use ParallelGlobalRoutingHelper and recompute incrementally", parallelRouting);
   cmd.Parse (argc, argv);
+  if (parallelRouting)
+    {
+      Config::SetDefault ("ns3::Ipv4GlobalRouting::RespondToInterfaceEvents", BooleanValue (false));
+    }
 
   NS_LOG_INFO ("Create nodes.");
   NodeContainer c;
@@ -143,7 +171,14 @@ main (int argc, char *argv[])
 
   // Create router nodes, initialize routing database and set up the routing
   // tables in the nodes.
-  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  if (parallelRouting)
+    {
+      ParallelGlobalRoutingHelper::PopulateRoutingTables ();
+    }
+  else
+    {
+      Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+    }
 
   // Create the OnOff application to send UDP datagrams of size
   // 210 bytes at a rate of 448 Kb/s
@@ -200,19 +235,30 @@ main (int argc, char *argv[])
   // then the next p2p is numbered 2
   uint32_t ipv4ifIndex1 = 2;
 
-  Simulator::Schedule (Seconds (2),&Ipv4::SetDown,ipv41, ipv4ifIndex1);
-  Simulator::Schedule (Seconds (4),&Ipv4::SetUp,ipv41, ipv4ifIndex1);
-
   Ptr<Node> n6 = c.Get (6);
   Ptr<Ipv4> ipv46 = n6->GetObject<Ipv4> ();
   // The first ifIndex is 0 for loopback, then the first p2p is numbered 1,
   // then the next p2p is numbered 2
   uint32_t ipv4ifIndex6 = 2;
-  Simulator::Schedule (Seconds (6),&Ipv4::SetDown,ipv46, ipv4ifIndex6);
-  Simulator::Schedule (Seconds (8),&Ipv4::SetUp,ipv46, ipv4ifIndex6);
 
-  Simulator::Schedule (Seconds (12),&Ipv4::SetDown,ipv41, ipv4ifIndex1);
-  Simulator::Schedule (Seconds (14),&Ipv4::SetUp,ipv41, ipv4ifIndex1);
+  if (parallelRouting)
+    {
+      Simulator::Schedule (Seconds (2), &SetInterface, ipv41, ipv4ifIndex1, false);
+      Simulator::Schedule (Seconds (4), &SetInterface, ipv41, ipv4ifIndex1, true);
+      Simulator::Schedule (Seconds (6), &SetInterface, ipv46, ipv4ifIndex6, false);
+      Simulator::Schedule (Seconds (8), &SetInterface, ipv46, ipv4ifIndex6, true);
+      Simulator::Schedule (Seconds (12), &SetInterface, ipv41, ipv4ifIndex1, false);
+      Simulator::Schedule (Seconds (14), &SetInterface, ipv41, ipv4ifIndex1, true);
+    }
+  else
+    {
+      Simulator::Schedule (Seconds (2),&Ipv4::SetDown,ipv41, ipv4ifIndex1);
+      Simulator::Schedule (Seconds (4),&Ipv4::SetUp,ipv41, ipv4ifIndex1);
+      Simulator::Schedule (Seconds (6),&Ipv4::SetDown,ipv46, ipv4ifIndex6);
+      Simulator::Schedule (Seconds (8),&Ipv4::SetUp,ipv46, ipv4ifIndex6);
+      Simulator::Schedule (Seconds (12),&Ipv4::SetDown,ipv41, ipv4ifIndex1);
+      Simulator::Schedule (Seconds (14),&Ipv4::SetUp,ipv41, ipv4ifIndex1);
+    }
 
   // Trace routing tables 
   Ipv4GlobalRoutingHelper g;
@@ -100,6 +100,8 @@
 #include "ns3/point-to-point-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/traffic-control-module.h"
+#include "../../abc/metrics-publisher.h"
+#include "../../abc/ipv4-lpm-routing.h"
 
 using namespace ns3;
 
@@ -122,6 +124,12 @@ PrintProgress (Time interval)
   Simulator::Schedule (interval, &PrintProgress, interval);
 }
 
+uint64_t
+GetQueueDiscPackets (Ptr<QueueDisc> queue)
+{
+  return queue->GetNPackets ();
+}
+
 void
 TraceS1R1Sink (std::size_t index, Ptr<const Packet> p, const Address& a)
 {
@@ -274,6 +282,8 @@ int main (int argc, char *argv[])
   Time measurementWindow = Seconds (1);
   bool enableSwitchEcn = true;
   Time progressInterval = MilliSeconds (100);
+  std::string metricsRing = "";
+  bool lpmRouting = false;
 
   CommandLine cmd (__FILE__);
   cmd.AddValue ("tcpTypeId", "ns-3 TCP TypeId", tcpTypeId);
@@ -281,8 +291,15 @@ int main (int argc, char *argv[])
   cmd.AddValue ("convergenceTime", "convergence time", convergenceTime);
   cmd.AddValue ("measurementWindow", "measurement window", measurementWindow);
   cmd.AddValue ("enableSwitchEcn", "enable ECN at switches", enableSwitchEcn);
+  cmd.AddValue ("metricsRing", "publish live metrics to this shared-memory ring instead of printing progress", metricsRing);
+  cmd.AddValue ("lpmRouting", "look routes up in a trie instead of scanning the routing tables", lpmRouting);
   cmd.Parse (argc, argv);
 
+  if (metricsRing != "")
+    {
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::MetricsSimulatorImpl"));
+    }
+
   Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::" + tcpTypeId));
 
   Time startTime = Seconds (0);
@@ -366,6 +383,16 @@ int main (int argc, char *argv[])
     }
 
   InternetStackHelper stack;
+  if (lpmRouting)
+    {
+      // Same protocols and priorities as the default list routing
+      Ipv4LpmStaticRoutingHelper staticRouting;
+      Ipv4LpmGlobalRoutingHelper globalRouting;
+      Ipv4ListRoutingHelper listRouting;
+      listRouting.Add (staticRouting, 0);
+      listRouting.Add (globalRouting, -10);
+      stack.SetRoutingHelper (listRouting);
+    }
   stack.InstallAll ();
 
   TrafficControlHelper tchRed10;
@@ -442,7 +469,7 @@ int main (int argc, char *argv[])
       address.NewNetwork ();
     }
 
-  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Ipv4LpmGlobalRoutingHelper::PopulateRoutingTables ();
 
   // Each sender in S2 sends to a receiver in R2
   std::vector<Ptr<PacketSink> > r2Sinks;
@@ -544,7 +571,17 @@ int main (int argc, char *argv[])
   Simulator::Schedule (flowStartupWindow + convergenceTime, &InitializeCounters);
   Simulator::Schedule (flowStartupWindow + convergenceTime + measurementWindow, &PrintThroughput, measurementWindow);
   Simulator::Schedule (flowStartupWindow + convergenceTime + measurementWindow, &PrintFairness, measurementWindow);
-  Simulator::Schedule (progressInterval, &PrintProgress, progressInterval);
+  MetricsPublisher metricsPublisher;
+  if (metricsRing != "")
+    {
+      metricsPublisher.AddCounter ("T1 queue", MakeBoundCallback (&GetQueueDiscPackets, queueDiscs1.Get (0)));
+      metricsPublisher.AddCounter ("T2 queue", MakeBoundCallback (&GetQueueDiscPackets, queueDiscs2.Get (0)));
+      metricsPublisher.Start (metricsRing, progressInterval);
+    }
+  else
+    {
+      Simulator::Schedule (progressInterval, &PrintProgress, progressInterval);
+    }
   Simulator::Schedule (flowStartupWindow + convergenceTime, &CheckT1QueueSize, queueDiscs1.Get (0));
   Simulator::Schedule (flowStartupWindow + convergenceTime, &CheckT2QueueSize, queueDiscs2.Get (0));
   Simulator::Stop (stopTime + TimeStep (1));
@@ -557,6 +594,7 @@ int main (int argc, char *argv[])
   fairnessIndex.close ();
   t1QueueLength.close ();
   t2QueueLength.close ();
+  metricsPublisher.Stop ();
   Simulator::Destroy ();
   return 0;
 }
@@ -0,0 +1,531 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Network topology
+//
+//       n0 -------------- n1
+//    RtoClient  p2p    RtoServer
+//
+// In-simulation version of scratch/tcp-server.cc.  Instead of one client
+// talking to a server thread over localhost sockets, RtoClient runs
+// nConnections stop-and-wait connections over one UDP socket: each sends a
+// packet, waits for the server ACK, and retransmits when its RTO expires.
+// The RTOs of all connections live in one TcpTimerTable
+// (abc/tcp-timer.h), with Karn's rule and exponential backoff.
+//
+// Losses come from a RateErrorModel on both ends of the link, so a run is
+// fully determined by the RNG seed and run number.
+//
+// At the end the program prints the metrics of scratch/tcp-server.cc;
+// throughput and overhead efficiency count acknowledged data bytes.  The
+// RTO evolution, sampled every rtoInterval, is written to
+// tcp-server-rto.dat as: time, mean, min and max RTO over the unfinished
+// connections, and RTO of connection 0, all in seconds.
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "../../abc/tcp-timer.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpServerRto");
+
+/**
+ * Connection index and sequence number of a data packet or its ACK.
+ */
+class RtoHeader : public Header
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  RtoHeader ()
+    : m_conn (0),
+      m_seq (0)
+  {
+  }
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+  uint32_t m_conn; //!< Connection index
+  uint32_t m_seq;  //!< Sequence number
+};
+
+NS_OBJECT_ENSURE_REGISTERED (RtoHeader);
+
+TypeId
+RtoHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RtoHeader")
+    .SetParent<Header> ()
+    .AddConstructor<RtoHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+RtoHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+RtoHeader::GetSerializedSize (void) const
+{
+  return 8;
+}
+
+void
+RtoHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU32 (m_conn);
+  start.WriteHtonU32 (m_seq);
+}
+
+uint32_t
+RtoHeader::Deserialize (Buffer::Iterator start)
+{
+  m_conn = start.ReadNtohU32 ();
+  m_seq = start.ReadNtohU32 ();
+  return 8;
+}
+
+void
+RtoHeader::Print (std::ostream &os) const
+{
+  os << "conn=" << m_conn << " seq=" << m_seq;
+}
+
+/**
+ * Answer every data packet with an ACK carrying its header.
+ */
+class RtoServer : public Application
+{
+public:
+  RtoServer ();
+
+  /**
+   * \param port UDP port to listen on
+   */
+  void Setup (uint16_t port);
+
+  uint64_t m_packetsReceived; //!< Data packets received, duplicates included
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * \param socket the receiving socket
+   */
+  void HandleRead (Ptr<Socket> socket);
+
+  uint16_t m_port;        //!< UDP port
+  Ptr<Socket> m_socket;   //!< Listening socket
+};
+
+RtoServer::RtoServer ()
+  : m_packetsReceived (0),
+    m_port (0)
+{
+}
+
+void
+RtoServer::Setup (uint16_t port)
+{
+  m_port = port;
+}
+
+void
+RtoServer::StartApplication (void)
+{
+  m_socket = Socket::CreateSocket (GetNode (), UdpSocketFactory::GetTypeId ());
+  m_socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), m_port));
+  m_socket->SetRecvCallback (MakeCallback (&RtoServer::HandleRead, this));
+}
+
+void
+RtoServer::StopApplication (void)
+{
+  if (m_socket)
+    {
+      m_socket->Close ();
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+}
+
+void
+RtoServer::HandleRead (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  Address from;
+  while ((packet = socket->RecvFrom (from)))
+    {
+      ++m_packetsReceived;
+      RtoHeader header;
+      packet->RemoveHeader (header);
+      Ptr<Packet> ack = Create<Packet> (3);   // "ACK"
+      ack->AddHeader (header);
+      socket->SendTo (ack, 0, from);
+    }
+}
+
+/**
+ * Many stop-and-wait connections sharing one socket and one
+ * TcpTimerTable.  Per-connection state is kept as a struct of arrays,
+ * like the table itself.
+ */
+class RtoClient : public Application
+{
+public:
+  RtoClient ();
+
+  /**
+   * \param peer server address
+   * \param nConnections number of connections
+   * \param nPackets packets to deliver per connection
+   * \param packetSize payload size of data packets
+   * \param startSpread connections start uniformly over [0, startSpread)
+   */
+  void Setup (Address peer, uint32_t nConnections, uint32_t nPackets,
+              uint32_t packetSize, Time startSpread);
+
+  /**
+   * \return the timer table of the connections
+   */
+  Ptr<TcpTimerTable> GetTimers (void) const;
+
+  /**
+   * \param conn connection index
+   * \return true once the connection has delivered all its packets
+   */
+  bool IsFinished (uint32_t conn) const;
+
+  uint64_t m_packetsSent;   //!< Data packets sent, retransmissions included
+  uint64_t m_packetsLost;   //!< Retransmission timeouts
+  uint64_t m_bytesSent;     //!< Data bytes sent
+  uint64_t m_bytesAcked;    //!< Data bytes acknowledged
+  uint64_t m_bytesReceived; //!< ACK bytes received
+  Time m_firstSend;         //!< Time of the first transmission
+  Time m_lastAck;           //!< Time of the last useful ACK
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * \brief Send the current packet of a connection and arm its timer.
+   * \param conn connection index
+   */
+  void Send (uint32_t conn);
+
+  /**
+   * \param conn connection index
+   */
+  void Timeout (uint32_t conn);
+
+  /**
+   * \param socket the receiving socket
+   */
+  void HandleRead (Ptr<Socket> socket);
+
+  Address m_peer;           //!< Server address
+  uint32_t m_nPackets;      //!< Packets per connection
+  uint32_t m_packetSize;    //!< Payload size
+  Time m_startSpread;       //!< Start time spread
+  uint32_t m_nFinished;     //!< Finished connections
+  Ptr<Socket> m_socket;     //!< Client socket
+  Ptr<TcpTimerTable> m_timers;       //!< RTO state of the connections
+  std::vector<uint32_t> m_seq;       //!< Outstanding sequence number
+  std::vector<uint8_t> m_txCount;    //!< Transmissions of the outstanding packet
+  std::vector<int64_t> m_sentAt;     //!< Last transmission time, in time steps
+};
+
+RtoClient::RtoClient ()
+  : m_packetsSent (0),
+    m_packetsLost (0),
+    m_bytesSent (0),
+    m_bytesAcked (0),
+    m_bytesReceived (0),
+    m_nPackets (0),
+    m_packetSize (0),
+    m_nFinished (0)
+{
+}
+
+void
+RtoClient::Setup (Address peer, uint32_t nConnections, uint32_t nPackets,
+                  uint32_t packetSize, Time startSpread)
+{
+  m_peer = peer;
+  m_nPackets = nPackets;
+  m_packetSize = packetSize;
+  m_startSpread = startSpread;
+  m_timers = CreateObject<TcpTimerTable> ();
+  m_timers->Add (nConnections);
+  m_timers->SetTimeoutCallback (MakeCallback (&RtoClient::Timeout, this));
+  m_seq.assign (nConnections, 0);
+  m_txCount.assign (nConnections, 0);
+  m_sentAt.assign (nConnections, 0);
+}
+
+Ptr<TcpTimerTable>
+RtoClient::GetTimers (void) const
+{
+  return m_timers;
+}
+
+bool
+RtoClient::IsFinished (uint32_t conn) const
+{
+  return m_seq[conn] >= m_nPackets;
+}
+
+void
+RtoClient::StartApplication (void)
+{
+  m_socket = Socket::CreateSocket (GetNode (), UdpSocketFactory::GetTypeId ());
+  m_socket->Bind ();
+  m_socket->Connect (m_peer);
+  m_socket->SetRecvCallback (MakeCallback (&RtoClient::HandleRead, this));
+  m_firstSend = Simulator::Now ();
+  uint32_t n = m_seq.size ();
+  for (uint32_t conn = 0; conn < n; ++conn)
+    {
+      Simulator::Schedule (TimeStep (m_startSpread.GetTimeStep () / n * conn),
+                           &RtoClient::Send, this, conn);
+    }
+}
+
+void
+RtoClient::StopApplication (void)
+{
+  for (uint32_t conn = 0; conn < m_seq.size (); ++conn)
+    {
+      m_timers->Stop (conn);
+    }
+  if (m_socket)
+    {
+      m_socket->Close ();
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+}
+
+void
+RtoClient::Send (uint32_t conn)
+{
+  RtoHeader header;
+  header.m_conn = conn;
+  header.m_seq = m_seq[conn];
+  Ptr<Packet> packet = Create<Packet> (m_packetSize);
+  packet->AddHeader (header);
+  m_socket->Send (packet);
+  ++m_packetsSent;
+  m_bytesSent += m_packetSize;
+  ++m_txCount[conn];
+  m_sentAt[conn] = Simulator::Now ().GetTimeStep ();
+  m_timers->Start (conn);
+}
+
+void
+RtoClient::Timeout (uint32_t conn)
+{
+  NS_LOG_LOGIC ("connection " << conn << " timed out, RTO " << m_timers->GetRto (conn).As (Time::S));
+  ++m_packetsLost;
+  Send (conn);
+}
+
+void
+RtoClient::HandleRead (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      RtoHeader header;
+      packet->RemoveHeader (header);
+      m_bytesReceived += packet->GetSize ();
+      uint32_t conn = header.m_conn;
+      if (conn >= m_seq.size () || header.m_seq != m_seq[conn])
+        {
+          // Duplicate ACK of a retransmitted packet.
+          continue;
+        }
+      Time rtt = Simulator::Now () - TimeStep (m_sentAt[conn]);
+      m_timers->UpdateRtt (conn, rtt, m_txCount[conn] > 1);
+      m_bytesAcked += m_packetSize;
+      m_lastAck = Simulator::Now ();
+      m_txCount[conn] = 0;
+      if (++m_seq[conn] < m_nPackets)
+        {
+          Send (conn);
+        }
+      else
+        {
+          m_timers->Stop (conn);
+          if (++m_nFinished == m_seq.size ())
+            {
+              Simulator::Stop ();
+            }
+        }
+    }
+}
+
+/**
+ * Write one line of RTO statistics and reschedule.
+ * \param stream output stream
+ * \param client the client application
+ * \param interval sampling interval
+ */
+void
+SampleRto (Ptr<OutputStreamWrapper> stream, Ptr<RtoClient> client, Time interval)
+{
+  Ptr<TcpTimerTable> timers = client->GetTimers ();
+  double sum = 0;
+  double lo = 0;
+  double hi = 0;
+  uint32_t n = 0;
+  for (uint32_t conn = 0; conn < timers->GetNConnections (); ++conn)
+    {
+      if (client->IsFinished (conn))
+        {
+          continue;
+        }
+      double rto = timers->GetRto (conn).GetSeconds ();
+      lo = n == 0 ? rto : std::min (lo, rto);
+      hi = n == 0 ? rto : std::max (hi, rto);
+      sum += rto;
+      ++n;
+    }
+  *stream->GetStream () << Simulator::Now ().GetSeconds () << " " << (n > 0 ? sum / n : 0)
+                        << " " << lo << " " << hi << " " << timers->GetRto (0).GetSeconds () << std::endl;
+  Simulator::Schedule (interval, &SampleRto, stream, client, interval);
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nConnections = 1000;
+  uint32_t nPackets = 1000;
+  uint32_t packetSize = 1024;
+  double errorRate = 0.01;
+  std::string dataRate = "100Mbps";
+  std::string delay = "5ms";
+  Time startSpread = Seconds (1);
+  Time rtoInterval = MilliSeconds (100);
+  Time minRto = MilliSeconds (200);
+  Time stopTime = Seconds (600);
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("nConnections", "number of stop-and-wait connections", nConnections);
+  cmd.AddValue ("nPackets", "packets to deliver per connection", nPackets);
+  cmd.AddValue ("packetSize", "payload size of data packets in bytes", packetSize);
+  cmd.AddValue ("errorRate", "packet error rate of the RateErrorModel on each end", errorRate);
+  cmd.AddValue ("dataRate", "link data rate", dataRate);
+  cmd.AddValue ("delay", "link delay", delay);
+  cmd.AddValue ("startSpread", "connections start uniformly over this time", startSpread);
+  cmd.AddValue ("rtoInterval", "sampling interval of the RTO evolution", rtoInterval);
+  cmd.AddValue ("minRto", "lower bound of the RTO", minRto);
+  cmd.AddValue ("stopTime", "simulation time limit", stopTime);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpTimerTable::MinRto", TimeValue (minRto));
+  // Every connection opens within startSpread: let ARP hold the first
+  // packet of each while an address resolves, instead of dropping all
+  // but three, so that Timeout () only counts error model losses.
+  Config::SetDefault ("ns3::ArpCache::PendingQueueSize", UintegerValue (nConnections + 1));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  // Queue up to one packet per connection, so that with the ARP queue
+  // above, losses only come from the error model.
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+  p2p.SetChannelAttribute ("Delay", StringValue (delay));
+  p2p.SetQueue ("ns3::DropTailQueue", "MaxSize",
+                QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, nConnections + 1)));
+  NetDeviceContainer devices = p2p.Install (nodes);
+
+  for (uint32_t i = 0; i < devices.GetN (); ++i)
+    {
+      Ptr<RateErrorModel> em = CreateObjectWithAttributes<RateErrorModel> (
+          "RanVar", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1.0]"),
+          "ErrorRate", DoubleValue (errorRate),
+          "ErrorUnit", EnumValue (RateErrorModel::ERROR_UNIT_PACKET));
+      devices.Get (i)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+    }
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  uint16_t port = 8082;
+  Ptr<RtoServer> server = CreateObject<RtoServer> ();
+  server->Setup (port);
+  nodes.Get (1)->AddApplication (server);
+  server->SetStartTime (Seconds (0));
+
+  Ptr<RtoClient> client = CreateObject<RtoClient> ();
+  client->Setup (InetSocketAddress (interfaces.GetAddress (1), port), nConnections,
+                 nPackets, packetSize, startSpread);
+  nodes.Get (0)->AddApplication (client);
+  client->SetStartTime (Seconds (0));
+
+  AsciiTraceHelper ascii;
+  Ptr<OutputStreamWrapper> rtoStream = ascii.CreateFileStream ("tcp-server-rto.dat");
+  Simulator::Schedule (Seconds (0), &SampleRto, rtoStream, client, rtoInterval);
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Stop (stopTime);
+  Simulator::Run ();
+  double wall = clock.End () / 1000.0;
+
+  double elapsed = (client->m_lastAck - client->m_firstSend).GetSeconds ();
+  double throughput = elapsed > 0 ? client->m_bytesAcked * 8 / (elapsed * 1e6) : 0;
+  double lossRatio = client->m_packetsSent > 0 ? static_cast<double> (client->m_packetsLost) / client->m_packetsSent : 0;
+  double efficiency = client->m_bytesSent > 0 ? 100.0 * client->m_bytesAcked / client->m_bytesSent : 0;
+  // Same arbitrary conversion factor as scratch/tcp-server.cc.
+  double energy = (client->m_bytesSent + client->m_bytesReceived) * 0.0001;
+
+  std::cout << "\n--- TCP Server Performance Metrics ---\n";
+  std::cout << "Connections: " << nConnections << "\n";
+  std::cout << "Total Packets Sent: " << client->m_packetsSent << "\n";
+  std::cout << "Total Packets Received: " << server->m_packetsReceived << "\n";
+  std::cout << "Total Packets Lost: " << client->m_packetsLost << "\n";
+  std::cout << "Packet Loss Ratio: " << lossRatio * 100 << " %\n";
+  std::cout << "Throughput: " << throughput << " Mbps\n";
+  std::cout << "Total Energy Consumed: " << energy << " J\n";
+  std::cout << "Overhead Efficiency: " << efficiency << " %\n";
+  std::cout << "Simulated Time: " << elapsed << " s\n";
+  std::cout << "Wall Clock Time: " << wall << " s\n";
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -36,6 +36,10 @@ cpp_examples = [
     ("wifi-ofdm-ht-validation", "True", "True"),
     ("wifi-ofdm-vht-validation", "True", "True"),
     ("wifi-ofdm-he-validation", "True", "True"),
+    ("wifi-ofdm-validation --tabulated=1", "True", "False"),
+    ("wifi-ofdm-ht-validation --tabulated=1", "True", "False"),
+    ("wifi-ofdm-vht-validation --tabulated=1", "True", "False"),
+    ("wifi-ofdm-he-validation --tabulated=1", "True", "False"),
     ("wifi-80211n-mimo --simulationTime=0.1 --step=10", "True", "True"),
     ("wifi-ht-network --simulationTime=0.2 --frequency=5 --useRts=0 --minExpectedThroughput=5 --maxExpectedThroughput=135", "True", "True"),
     ("wifi-ht-network --simulationTime=0.2 --frequency=5 --useRts=1 --minExpectedThroughput=5 --maxExpectedThroughput=131", "True", "True"),
@@ -24,6 +24,7 @@
 #include "ns3/boolean.h"
 #include "ns3/string.h"
 #include "ns3/log.h"
+#include "ns3/system-wall-clock-ms.h"
 #include "ns3/yans-wifi-helper.h"
 #include "ns3/ssid.h"
 #include "ns3/mobility-helper.h"
@@ -317,8 +318,14 @@ int main (int argc, char *argv[])
       phy.EnablePcap ("STA_D", staDeviceD.Get (0));
     }
 
+  SystemWallClockMs clock;
+  clock.Start ();
   Simulator::Stop (Seconds (simulationTime + 1));
   Simulator::Run ();
+  double wall = clock.End () / 1000.0;
+  uint64_t events = Simulator::GetEventCount ();
+  std::cout << "Events: " << events << " in " << wall << " s of wall clock ("
+            << (wall > 0 ? events / wall : 0) << " events/s)" << '\n';
 
   // Show results
   uint64_t totalPacketsThroughA = DynamicCast<UdpServer> (serverAppA.Get (0))->GetReceived ();
@@ -30,6 +30,11 @@
 #include "ns3/mobility-model.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/global-value.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "../../abc/resettable-simulator-impl.h"
 
 using namespace ns3;
 
@@ -42,7 +47,21 @@ public:
   Experiment (std::string name);
   uint32_t Run (const WifiHelper &wifi, const YansWifiPhyHelper &wifiPhy,
                 const WifiMacHelper &wifiMac, const YansWifiChannelHelper &wifiChannel);
+  /**
+   * Build the nodes once, on a channel whose RSS RunPoint () sets.
+   * Requires ns3::ResettableSimulatorImpl.
+   */
+  void Install (const WifiHelper &wifi, const YansWifiPhyHelper &wifiPhy,
+                const WifiMacHelper &wifiMac);
+  /**
+   * Run one point on the nodes built by Install ().
+   * \param mode the data, control and non-unicast mode
+   * \param rss the received signal strength (dBm)
+   * \return the number of packets received
+   */
+  uint32_t RunPoint (std::string mode, double rss);
 private:
+  void ResetPoint (void);
   void ReceivePacket (Ptr<Socket> socket);
   void SetPosition (Ptr<Node> node, Vector position);
   Vector GetPosition (Ptr<Node> node);
@@ -50,8 +69,13 @@ private:
   void GenerateTraffic (Ptr<Socket> socket, uint32_t pktSize,
                         uint32_t pktCount, Time pktInterval );
 
+  void StartTraffic (void);
+
   uint32_t m_pktsTotal;
   Gnuplot2dDataset m_output;
+  NodeContainer m_nodes;
+  Ptr<FixedRssLossModel> m_loss;
+  Ptr<Socket> m_source;
 };
 
 Experiment::Experiment ()
@@ -115,6 +139,83 @@ Experiment::GenerateTraffic (Ptr<Socket> socket, uint32_t pktSize,
     }
 }
 
+void
+Experiment::ResetPoint (void)
+{
+  m_pktsTotal = 0;
+  // The reset may have cancelled the GenerateTraffic that closes it.
+  if (m_source)
+    {
+      m_source->Close ();
+      m_source = 0;
+    }
+}
+
+void
+Experiment::StartTraffic (void)
+{
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  m_source = Socket::CreateSocket (m_nodes.Get (1), tid);
+  InetSocketAddress remote = InetSocketAddress (Ipv4Address ("255.255.255.255"), 80);
+  m_source->SetAllowBroadcast (true);
+  m_source->Connect (remote);
+  uint32_t packetSize = 1014;
+  uint32_t maxPacketCount = 200;
+  Time interPacketInterval = Seconds (1.);
+  Simulator::Schedule (Seconds (1.0), &Experiment::GenerateTraffic,
+                       this, m_source, packetSize, maxPacketCount,interPacketInterval);
+}
+
+void
+Experiment::Install (const WifiHelper &wifi, const YansWifiPhyHelper &wifiPhy,
+                     const WifiMacHelper &wifiMac)
+{
+  m_nodes.Create (2);
+
+  InternetStackHelper internet;
+  internet.Install (m_nodes);
+
+  m_loss = CreateObject<FixedRssLossModel> ();
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationLossModel (m_loss);
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  YansWifiPhyHelper phy = wifiPhy;
+  phy.SetChannel (channel);
+
+  WifiMacHelper mac = wifiMac;
+  NetDeviceContainer devices = wifi.Install (phy, mac, m_nodes);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (5.0, 0.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (m_nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (devices);
+
+  SetupPacketReceive (m_nodes.Get (0));
+  ResettableSimulatorImpl::Get ()->AddResetCallback (MakeCallback (&Experiment::ResetPoint, this));
+}
+
+uint32_t
+Experiment::RunPoint (std::string mode, double rss)
+{
+  // The previous point ended with its traffic, so the devices are idle.
+  ResettableSimulatorImpl::Get ()->Reset ();
+  m_loss->SetRss (rss);
+  std::string manager = "/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/RemoteStationManager/";
+  Config::Set (manager + "NonUnicastMode", StringValue (mode));
+  Config::Set (manager + "$ns3::ConstantRateWifiManager/DataMode", StringValue (mode));
+  Config::Set (manager + "$ns3::ConstantRateWifiManager/ControlMode", StringValue (mode));
+  StartTraffic ();
+  Simulator::Run ();
+  return m_pktsTotal;
+}
+
 uint32_t
 Experiment::Run (const WifiHelper &wifi, const YansWifiPhyHelper &wifiPhy,
                  const WifiMacHelper &wifiMac, const YansWifiChannelHelper &wifiChannel)
@@ -175,49 +276,89 @@ int main (int argc, char *argv[])
   modes.push_back ("DsssRate5_5Mbps");
   modes.push_back ("DsssRate11Mbps");
 
+  bool reuse = false;
+
   CommandLine cmd (__FILE__);
+  cmd.AddValue ("reuse", "Build the nodes once and reset the simulator between points "
+                "instead of rebuilding them for each point", reuse);
   cmd.Parse (argc, argv);
 
   Gnuplot gnuplot = Gnuplot ("clear-channel.eps");
+  SystemWallClockMs clock;
+  clock.Start ();
 
-  for (uint32_t i = 0; i < modes.size (); i++)
+  if (reuse)
     {
-      std::cout << modes[i] << std::endl;
-      Gnuplot2dDataset dataset (modes[i]);
-
-      for (double rss = -102.0; rss <= -80.0; rss += 0.5)
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::ResettableSimulatorImpl"));
+      WifiHelper wifi;
+      wifi.SetStandard (WIFI_STANDARD_80211b);
+      WifiMacHelper wifiMac;
+      wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                    "DataMode",StringValue (modes[0]),
+                                    "ControlMode",StringValue (modes[0]));
+      wifiMac.SetType ("ns3::AdhocWifiMac");
+      YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+      wifiPhy.Set ("TxPowerStart", DoubleValue (15.0) );
+      wifiPhy.Set ("TxPowerEnd", DoubleValue (15.0) );
+      wifiPhy.Set ("RxGain", DoubleValue (0) );
+      wifiPhy.Set ("RxNoiseFigure", DoubleValue (7) );
+      Experiment experiment;
+      experiment.Install (wifi, wifiPhy, wifiMac);
+      for (uint32_t i = 0; i < modes.size (); i++)
         {
-          Experiment experiment;
+          std::cout << modes[i] << std::endl;
+          Gnuplot2dDataset dataset (modes[i]);
           dataset.SetStyle (Gnuplot2dDataset::LINES);
-
-          WifiHelper wifi;
-          wifi.SetStandard (WIFI_STANDARD_80211b);
-          WifiMacHelper wifiMac;
-          Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode",
-                              StringValue (modes[i]));
-          wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
-                                        "DataMode",StringValue (modes[i]),
-                                        "ControlMode",StringValue (modes[i]));
-          wifiMac.SetType ("ns3::AdhocWifiMac");
-
-          YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
-          YansWifiChannelHelper wifiChannel;
-          wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
-          wifiChannel.AddPropagationLoss ("ns3::FixedRssLossModel","Rss",DoubleValue (rss));
-
-
-          NS_LOG_DEBUG (modes[i]);
-          experiment = Experiment (modes[i]);
-          wifiPhy.Set ("TxPowerStart", DoubleValue (15.0) );
-          wifiPhy.Set ("TxPowerEnd", DoubleValue (15.0) );
-          wifiPhy.Set ("RxGain", DoubleValue (0) );
-          wifiPhy.Set ("RxNoiseFigure", DoubleValue (7) );
-          uint32_t pktsRecvd = experiment.Run (wifi, wifiPhy, wifiMac, wifiChannel);
-          dataset.Add (rss, pktsRecvd);
+          for (double rss = -102.0; rss <= -80.0; rss += 0.5)
+            {
+              dataset.Add (rss, experiment.RunPoint (modes[i], rss));
+            }
+          gnuplot.AddDataset (dataset);
+        }
+      Simulator::Destroy ();
+    }
+  else
+    {
+      for (uint32_t i = 0; i < modes.size (); i++)
+        {
+          std::cout << modes[i] << std::endl;
+          Gnuplot2dDataset dataset (modes[i]);
+
+          for (double rss = -102.0; rss <= -80.0; rss += 0.5)
+            {
+              Experiment experiment;
+              dataset.SetStyle (Gnuplot2dDataset::LINES);
+
+              WifiHelper wifi;
+              wifi.SetStandard (WIFI_STANDARD_80211b);
+              WifiMacHelper wifiMac;
+              Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode",
+                                  StringValue (modes[i]));
+              wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                            "DataMode",StringValue (modes[i]),
+                                            "ControlMode",StringValue (modes[i]));
+              wifiMac.SetType ("ns3::AdhocWifiMac");
+
+              YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+              YansWifiChannelHelper wifiChannel;
+              wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+              wifiChannel.AddPropagationLoss ("ns3::FixedRssLossModel","Rss",DoubleValue (rss));
+
+
+              NS_LOG_DEBUG (modes[i]);
+              experiment = Experiment (modes[i]);
+              wifiPhy.Set ("TxPowerStart", DoubleValue (15.0) );
+              wifiPhy.Set ("TxPowerEnd", DoubleValue (15.0) );
+              wifiPhy.Set ("RxGain", DoubleValue (0) );
+              wifiPhy.Set ("RxNoiseFigure", DoubleValue (7) );
+              uint32_t pktsRecvd = experiment.Run (wifi, wifiPhy, wifiMac, wifiChannel);
+              dataset.Add (rss, pktsRecvd);
+            }
+
+          gnuplot.AddDataset (dataset);
         }
-
-      gnuplot.AddDataset (dataset);
     }
+  std::cout << "wall clock: " << clock.End () << " ms" << std::endl;
   gnuplot.SetTerminal ("postscript eps color enh \"Times-BoldItalic\"");
   gnuplot.SetLegend ("RSS(dBm)", "Number of packets received");
   gnuplot.SetExtra  ("set xrange [-102:-83]");
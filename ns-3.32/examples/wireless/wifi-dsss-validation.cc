@@ -28,6 +28,7 @@
 #include "ns3/yans-error-rate-model.h"
 #include "ns3/nist-error-rate-model.h"
 #include "ns3/wifi-tx-vector.h"
+#include "../../abc/error-rate-batch.h"
 
 using namespace ns3;
 
@@ -52,21 +53,35 @@ int main (int argc, char *argv[])
   Ptr <NistErrorRateModel> nist = CreateObject<NistErrorRateModel> ();
   WifiTxVector txVector;
 
+  // Every success rate of a mode is computed in one batch.
+  std::vector<double> snrDbs;
+  std::vector<double> snrs;
+  for (double snr = -10.0; snr <= 20.0; snr += 0.1)
+    {
+      snrDbs.push_back (snr);
+      snrs.push_back (std::pow (10.0,snr / 10.0));
+    }
+  std::vector<double> yansPs;
+  std::vector<double> nistPs;
+
   for (uint32_t i = 0; i < modes.size (); i++)
     {
       std::cout << modes[i] << std::endl;
       Gnuplot2dDataset dataset (modes[i]);
       txVector.SetMode (modes[i]);
 
-      for (double snr = -10.0; snr <= 20.0; snr += 0.1)
+      ErrorRateBatch::GetChunkSuccessRates (yans, WifiMode (modes[i]), txVector, snrs, FrameSize * 8, yansPs);
+      ErrorRateBatch::GetChunkSuccessRates (nist, WifiMode (modes[i]), txVector, snrs, FrameSize * 8, nistPs);
+
+      for (uint32_t j = 0; j < snrs.size (); j++)
         {
-          double psYans = yans->GetChunkSuccessRate (WifiMode (modes[i]), txVector, std::pow (10.0,snr / 10.0), FrameSize * 8);
+          double psYans = yansPs[j];
           if (psYans < 0.0 || psYans > 1.0)
             {
               //error
               exit (1);
             }
-          double psNist = nist->GetChunkSuccessRate (WifiMode (modes[i]), txVector, std::pow (10.0,snr / 10.0), FrameSize * 8);
+          double psNist = nistPs[j];
           if (psNist < 0.0 || psNist > 1.0)
             {
               std::cout<<psNist<<std::endl;
@@ -77,7 +92,7 @@ int main (int argc, char *argv[])
             {
               exit (1);
             }
-          dataset.Add (snr, psNist);
+          dataset.Add (snrDbs[j], psNist);
         }
 
       plot.AddDataset (dataset);
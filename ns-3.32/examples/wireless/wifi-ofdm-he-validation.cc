@@ -20,20 +20,31 @@
 //
 // It outputs plots of the Frame Success Rate versus the Signal-to-noise ratio for
 // both NIST and YANS error rate models and for every HE MCS value.
+//
+// With --tabulated, it also checks that TabulatedErrorRateModel stays within
+// maxError of both models halfway between the points of its tables, where the
+// interpolation is the furthest from them, and fails otherwise.
 
+#include <algorithm>
 #include <fstream>
 #include <cmath>
 #include "ns3/gnuplot.h"
 #include "ns3/command-line.h"
+#include "ns3/double.h"
 #include "ns3/yans-error-rate-model.h"
 #include "ns3/nist-error-rate-model.h"
 #include "ns3/wifi-tx-vector.h"
+#include "../../abc/error-rate-batch.h"
+#include "../../abc/tabulated-error-rate-model.h"
 
 using namespace ns3;
 
 int main (int argc, char *argv[])
 {
   uint32_t FrameSize = 1500; //bytes
+  bool tabulated = false;
+  double maxError = 1e-4;
+  double resolution = 0.01;
   std::ofstream yansfile ("yans-frame-success-rate-ax.plt");
   std::ofstream nistfile ("nist-frame-success-rate-ax.plt");
   std::vector <std::string> modes;
@@ -53,6 +64,9 @@ int main (int argc, char *argv[])
 
   CommandLine cmd (__FILE__);
   cmd.AddValue ("FrameSize", "The frame size", FrameSize);
+  cmd.AddValue ("tabulated", "Check the tabulated models against the analytic ones", tabulated);
+  cmd.AddValue ("maxError", "Largest frame success rate error of the tabulated models", maxError);
+  cmd.AddValue ("resolution", "SNR step of the tables of the tabulated models (dB)", resolution);
   cmd.Parse (argc, argv);
 
   Gnuplot yansplot = Gnuplot ("yans-frame-success-rate-ax.eps");
@@ -60,32 +74,80 @@ int main (int argc, char *argv[])
 
   Ptr <YansErrorRateModel> yans = CreateObject<YansErrorRateModel> ();
   Ptr <NistErrorRateModel> nist = CreateObject<NistErrorRateModel> ();
+  Ptr <TabulatedErrorRateModel> tabulatedYans = CreateObject<TabulatedErrorRateModel> ();
+  tabulatedYans->SetModel (yans);
+  tabulatedYans->SetAttribute ("Resolution", DoubleValue (resolution));
+  Ptr <TabulatedErrorRateModel> tabulatedNist = CreateObject<TabulatedErrorRateModel> ();
+  tabulatedNist->SetModel (nist);
+  tabulatedNist->SetAttribute ("Resolution", DoubleValue (resolution));
   WifiTxVector txVector;
 
+  // Every success rate of a mode is computed in one batch.
+  std::vector<double> snrDbs;
+  std::vector<double> snrs;
+  // The plotted SNRs fall on the table points (MinSnr is -10 dB), so the
+  // tabulated models are checked halfway between two points instead.
+  std::vector<double> checkSnrs;
+  for (double snr = -5.0; snr <= 40.0; snr += 0.1)
+    {
+      snrDbs.push_back (snr);
+      snrs.push_back (std::pow (10.0,snr / 10.0));
+      checkSnrs.push_back (std::pow (10.0,(snr + resolution / 2) / 10.0));
+    }
+  std::vector<double> yansPs;
+  std::vector<double> nistPs;
+  std::vector<double> checkYansPs;
+  std::vector<double> checkNistPs;
+  std::vector<double> tabulatedYansPs;
+  std::vector<double> tabulatedNistPs;
+
   for (uint32_t i = 0; i < modes.size (); i++)
     {
       std::cout << modes[i] << std::endl;
       Gnuplot2dDataset yansdataset (modes[i]);
       Gnuplot2dDataset nistdataset (modes[i]);
       txVector.SetMode (modes[i]);
+      ErrorRateBatch::GetChunkSuccessRates (yans, WifiMode (modes[i]), txVector, snrs, FrameSize * 8, yansPs);
+      ErrorRateBatch::GetChunkSuccessRates (nist, WifiMode (modes[i]), txVector, snrs, FrameSize * 8, nistPs);
 
-      for (double snr = -5.0; snr <= 40.0; snr += 0.1)
+      for (uint32_t j = 0; j < snrs.size (); j++)
         {
-          double ps = yans->GetChunkSuccessRate (WifiMode (modes[i]), txVector, std::pow (10.0,snr / 10.0), FrameSize * 8);
+          double ps = yansPs[j];
           if (ps < 0.0 || ps > 1.0)
             {
               //error
               exit (1);
             }
-          yansdataset.Add (snr, ps);
+          yansdataset.Add (snrDbs[j], ps);
 
-          ps = nist->GetChunkSuccessRate (WifiMode (modes[i]), txVector, std::pow (10.0,snr / 10.0), FrameSize * 8);
+          ps = nistPs[j];
           if (ps < 0.0 || ps > 1.0)
             {
               //error
               exit (1);
             }
-          nistdataset.Add (snr, ps);
+          nistdataset.Add (snrDbs[j], ps);
+        }
+
+      if (tabulated)
+        {
+          ErrorRateBatch::GetChunkSuccessRates (yans, WifiMode (modes[i]), txVector, checkSnrs, FrameSize * 8, checkYansPs);
+          ErrorRateBatch::GetChunkSuccessRates (nist, WifiMode (modes[i]), txVector, checkSnrs, FrameSize * 8, checkNistPs);
+          ErrorRateBatch::GetChunkSuccessRates (tabulatedYans, WifiMode (modes[i]), txVector, checkSnrs, FrameSize * 8, tabulatedYansPs);
+          ErrorRateBatch::GetChunkSuccessRates (tabulatedNist, WifiMode (modes[i]), txVector, checkSnrs, FrameSize * 8, tabulatedNistPs);
+          double yansError = 0;
+          double nistError = 0;
+          for (uint32_t j = 0; j < checkSnrs.size (); j++)
+            {
+              yansError = std::max (yansError, std::abs (tabulatedYansPs[j] - checkYansPs[j]));
+              nistError = std::max (nistError, std::abs (tabulatedNistPs[j] - checkNistPs[j]));
+            }
+          std::cout << "  tabulated error: yans " << yansError << " nist " << nistError << std::endl;
+          if (yansError > maxError || nistError > maxError)
+            {
+              //error
+              exit (1);
+            }
         }
 
       yansplot.AddDataset (yansdataset);
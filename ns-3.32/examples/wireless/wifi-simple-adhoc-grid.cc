@@ -68,6 +68,21 @@
 //
 // tcpdump -r wifi-simple-adhoc-grid-0-0.pcap -nn -tt
 //
+// Routing tables can also be dumped every 2 seconds in binary form, which
+// is much smaller and cheaper to write than the text dump of --tracing:
+// ./waf --run "wifi-simple-adhoc-grid --routingSnapshot=grid.rsnap"
+// ./waf --run "routing-snapshot-render --file=grid.rsnap"
+//
+// With --spatialIndex, the nodes use SpectrumWifiPhy on a GridSpectrumChannel
+// that only computes the signal of the nodes within the distance where it
+// falls 10 dB under the noise floor; the number of propagation loss
+// computations is printed at the end.  This pays off on large grids:
+// ./waf --run "wifi-simple-adhoc-grid --numNodes=400 --distance=100 --spatialIndex=1"
+//
+// The nodes do not move, so with --cachedLoss the propagation loss and
+// delay of each pair of nodes are computed once and then looked up:
+// ./waf --run "wifi-simple-adhoc-grid --numNodes=400 --distance=100 --cachedLoss=1"
+//
 
 #include "ns3/command-line.h"
 #include "ns3/config.h"
@@ -76,6 +91,9 @@
 #include "ns3/string.h"
 #include "ns3/log.h"
 #include "ns3/yans-wifi-helper.h"
+#include "ns3/spectrum-wifi-helper.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
 #include "ns3/mobility-helper.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/yans-wifi-channel.h"
@@ -84,6 +102,9 @@
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/ipv4-list-routing-helper.h"
 #include "ns3/internet-stack-helper.h"
+#include "../../abc/routing-snapshot-writer.h"
+#include "../../abc/grid-spectrum-channel.h"
+#include "../../abc/cached-propagation-model.h"
 
 using namespace ns3;
 
@@ -125,6 +146,9 @@ int main (int argc, char *argv[])
   double interval = 1.0; // seconds
   bool verbose = false;
   bool tracing = false;
+  std::string routingSnapshot = "";
+  bool spatialIndex = false;
+  bool cachedLoss = false;
 
   CommandLine cmd (__FILE__);
   cmd.AddValue ("phyMode", "Wifi Phy mode", phyMode);
@@ -137,6 +161,9 @@ int main (int argc, char *argv[])
   cmd.AddValue ("numNodes", "number of nodes", numNodes);
   cmd.AddValue ("sinkNode", "Receiver node number", sinkNode);
   cmd.AddValue ("sourceNode", "Sender node number", sourceNode);
+  cmd.AddValue ("routingSnapshot", "write binary routing snapshots to this file", routingSnapshot);
+  cmd.AddValue ("spatialIndex", "only compute the signal of nodes in range", spatialIndex);
+  cmd.AddValue ("cachedLoss", "compute the loss and delay of each pair of nodes once", cachedLoss);
   cmd.Parse (argc, argv);
   // Convert to time object
   Time interPacketInterval = Seconds (interval);
@@ -155,16 +182,48 @@ int main (int argc, char *argv[])
       wifi.EnableLogComponents ();  // Turn on all Wifi logging
     }
 
-  YansWifiPhyHelper wifiPhy =  YansWifiPhyHelper::Default ();
+  YansWifiPhyHelper yansPhy =  YansWifiPhyHelper::Default ();
+  SpectrumWifiPhyHelper spectrumPhy = SpectrumWifiPhyHelper::Default ();
+  WifiPhyHelper &wifiPhy = spatialIndex ? static_cast<WifiPhyHelper &> (spectrumPhy) : yansPhy;
   // set it to zero; otherwise, gain will be added
   wifiPhy.Set ("RxGain", DoubleValue (-10) );
   // ns-3 supports RadioTap and Prism tracing extensions for 802.11b
   wifiPhy.SetPcapDataLinkType (WifiPhyHelper::DLT_IEEE802_11_RADIO);
 
-  YansWifiChannelHelper wifiChannel;
-  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
-  wifiChannel.AddPropagationLoss ("ns3::FriisPropagationLossModel");
-  wifiPhy.SetChannel (wifiChannel.Create ());
+  Ptr<PropagationLossModel> loss = CreateObject<FriisPropagationLossModel> ();
+  Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel> ();
+  Ptr<PropagationLossModel> channelLoss = loss;
+  Ptr<CachedPropagationLossModel> lossCache;
+  if (cachedLoss)
+    {
+      lossCache = CreateObject<CachedPropagationLossModel> ();
+      lossCache->SetModel (loss);
+      channelLoss = lossCache;
+      Ptr<CachedPropagationDelayModel> delayCache = CreateObject<CachedPropagationDelayModel> ();
+      delayCache->SetModel (delay);
+      delay = delayCache;
+    }
+
+  Ptr<GridSpectrumChannel> gridChannel;
+  if (spatialIndex)
+    {
+      gridChannel = CreateObject<GridSpectrumChannel> ();
+      gridChannel->AddPropagationLossModel (channelLoss);
+      gridChannel->SetPropagationDelayModel (delay);
+      // Default TxPowerEnd plus the RxGain above, against 10 dB under the
+      // -94 dBm noise floor of a 22 MHz channel with a 7 dB noise figure.
+      double range = GridSpectrumChannel::GetCutoffRange (loss, 16.0206 - 10, -104, 100000);
+      NS_LOG_UNCOND ("Cut-off range " << range << " m");
+      gridChannel->SetRange (range);
+      spectrumPhy.SetChannel (gridChannel);
+    }
+  else
+    {
+      Ptr<YansWifiChannel> wifiChannel = CreateObject<YansWifiChannel> ();
+      wifiChannel->SetPropagationLossModel (channelLoss);
+      wifiChannel->SetPropagationDelayModel (delay);
+      yansPhy.SetChannel (wifiChannel);
+    }
 
   // Add an upper mac and disable rate control
   WifiMacHelper wifiMac;
@@ -228,6 +287,12 @@ int main (int argc, char *argv[])
       // To do-- enable an IP-level trace that shows forwarding events only
     }
 
+  if (!routingSnapshot.empty ())
+    {
+      Ptr<RoutingSnapshotWriter> writer = Create<RoutingSnapshotWriter> (routingSnapshot, 10);
+      RoutingSnapshotWriter::WriteAllEvery (Seconds (2), writer);
+    }
+
   // Give OLSR time to converge-- 30 seconds perhaps
   Simulator::Schedule (Seconds (30.0), &GenerateTraffic,
                        source, packetSize, numPackets, interPacketInterval);
@@ -237,6 +302,15 @@ int main (int argc, char *argv[])
 
   Simulator::Stop (Seconds (33.0));
   Simulator::Run ();
+  if (gridChannel)
+    {
+      NS_LOG_UNCOND ("Propagation loss computations: " << gridChannel->GetNLossComputations ());
+    }
+  if (lossCache)
+    {
+      NS_LOG_UNCOND ("Propagation loss cache: " << lossCache->GetHits () << " hits, "
+                     << lossCache->GetMisses () << " misses");
+    }
   Simulator::Destroy ();
 
   return 0;
@@ -40,6 +40,8 @@
 #include "ns3/yans-wifi-channel.h"
 #include "ns3/multi-model-spectrum-channel.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/pointer.h"
+#include "../../abc/cached-error-rate-model.h"
 #include "ns3/waveform-generator.h"
 #include "ns3/waveform-generator-helper.h"
 #include "ns3/non-communicating-net-device.h"
@@ -75,6 +77,7 @@
 //    --wifiType:        select ns3::SpectrumWifiPhy or ns3::YansWifiPhy [ns3::SpectrumWifiPhy]
 //    --errorModelType:  select ns3::NistErrorRateModel or ns3::YansErrorRateModel [ns3::NistErrorRateModel]
 //    --enablePcap:      enable pcap output [false]
+//    --cachedErrorRate: remember the error rate of each SNR (SpectrumWifiPhy) [false]
 //    --waveformPower:   Waveform power (linear W) [0]
 //
 // By default, the program will step through 32 index values, corresponding
@@ -146,6 +149,7 @@ int main (int argc, char *argv[])
   std::string wifiType = "ns3::SpectrumWifiPhy";
   std::string errorModelType = "ns3::NistErrorRateModel";
   bool enablePcap = false;
+  bool cachedErrorRate = false;
   const uint32_t tcpPacketSize = 1448;
   double waveformPower = 0;
 
@@ -157,6 +161,7 @@ int main (int argc, char *argv[])
   cmd.AddValue ("wifiType", "select ns3::SpectrumWifiPhy or ns3::YansWifiPhy", wifiType);
   cmd.AddValue ("errorModelType", "select ns3::NistErrorRateModel or ns3::YansErrorRateModel", errorModelType);
   cmd.AddValue ("enablePcap", "enable pcap output", enablePcap);
+  cmd.AddValue ("cachedErrorRate", "remember the error rate of each SNR", cachedErrorRate);
   cmd.AddValue ("waveformPower", "Waveform power (linear W)", waveformPower);
   cmd.Parse (argc,argv);
 
@@ -224,7 +229,16 @@ int main (int argc, char *argv[])
           spectrumChannel->SetPropagationDelayModel (delayModel);
 
           spectrumPhy.SetChannel (spectrumChannel);
-          spectrumPhy.SetErrorRateModel (errorModelType);
+          if (cachedErrorRate)
+            {
+              ObjectFactory errorModel (errorModelType);
+              spectrumPhy.SetErrorRateModel ("ns3::CachedErrorRateModel",
+                                             "Model", PointerValue (errorModel.Create<ErrorRateModel> ()));
+            }
+          else
+            {
+              spectrumPhy.SetErrorRateModel (errorModelType);
+            }
           spectrumPhy.Set ("Frequency", UintegerValue (5180)); // channel 36 at 20 MHz
         }
       else
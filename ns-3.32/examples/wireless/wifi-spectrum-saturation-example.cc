@@ -41,6 +41,8 @@
 #include "ns3/yans-wifi-channel.h"
 #include "ns3/multi-model-spectrum-channel.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/pointer.h"
+#include "../../abc/cached-error-rate-model.h"
 
 // This is a simple example of an IEEE 802.11n Wi-Fi network.
 //
@@ -65,6 +67,7 @@
 //    --wifiType:        select ns3::SpectrumWifiPhy or ns3::YansWifiPhy [ns3::SpectrumWifiPhy]
 //    --errorModelType:  select ns3::NistErrorRateModel or ns3::YansErrorRateModel [ns3::NistErrorRateModel]
 //    --enablePcap:      enable pcap output [false]
+//    --cachedErrorRate: remember the error rate of each SNR (SpectrumWifiPhy) [false]
 //
 // By default, the program will step through 64 index values, corresponding
 // to the following MCS, channel width, and guard interval combinations:
@@ -104,6 +107,7 @@ int main (int argc, char *argv[])
   std::string wifiType = "ns3::SpectrumWifiPhy";
   std::string errorModelType = "ns3::NistErrorRateModel";
   bool enablePcap = false;
+  bool cachedErrorRate = false;
 
   CommandLine cmd (__FILE__);
   cmd.AddValue ("simulationTime", "Simulation time in seconds", simulationTime);
@@ -112,6 +116,7 @@ int main (int argc, char *argv[])
   cmd.AddValue ("wifiType", "select ns3::SpectrumWifiPhy or ns3::YansWifiPhy", wifiType);
   cmd.AddValue ("errorModelType", "select ns3::NistErrorRateModel or ns3::YansErrorRateModel", errorModelType);
   cmd.AddValue ("enablePcap", "enable pcap output", enablePcap);
+  cmd.AddValue ("cachedErrorRate", "remember the error rate of each SNR", cachedErrorRate);
   cmd.Parse (argc,argv);
 
   uint16_t startIndex = 0;
@@ -189,7 +194,16 @@ int main (int argc, char *argv[])
           spectrumChannel->SetPropagationDelayModel (delayModel);
 
           spectrumPhy.SetChannel (spectrumChannel);
-          spectrumPhy.SetErrorRateModel (errorModelType);
+          if (cachedErrorRate)
+            {
+              ObjectFactory errorModel (errorModelType);
+              spectrumPhy.SetErrorRateModel ("ns3::CachedErrorRateModel",
+                                             "Model", PointerValue (errorModel.Create<ErrorRateModel> ()));
+            }
+          else
+            {
+              spectrumPhy.SetErrorRateModel (errorModelType);
+            }
           spectrumPhy.Set ("Frequency", UintegerValue (5180)); // channel 36 at 20 MHz
           spectrumPhy.Set ("TxPowerStart", DoubleValue (1));
           spectrumPhy.Set ("TxPowerEnd", DoubleValue (1));
@@ -8,6 +8,12 @@
 #include "backoff-modifed.h"
 #include <cmath>
 
+// Only INFO and above is compiled in, which leaves out the per-slot DEBUG
+// trace of the contention engine.  Build with
+// -DNS3_LOG_COMPILE_LEVEL=ns3::LOG_LEVEL_WARN to drop the rest as well.
+#define NS_LOG_COMPILE_LEVEL ns3::LOG_LEVEL_INFO
+#include "../abc/log-threshold.h"
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("BackoffExample");
@@ -28,34 +34,181 @@ void Backoff::SendHelloPacket (void)
   NS_LOG_INFO ("Sending Hello packet at " << Simulator::Now ().GetSeconds () << " seconds");
 }
 
-void CalculatePerformanceMetrics(const Backoff& backoff, uint32_t totalPacketsSent, uint32_t totalUAVs)
+ContentionEngine::ContentionEngine (uint32_t nStations, Time slotTime, uint32_t minSlots, uint32_t maxSlots, uint32_t ceiling, uint32_t maxRetries)
+  : m_slotTime (slotTime),
+    m_currentSlot (0),
+    m_attempts (0),
+    m_successes (0),
+    m_drops (0),
+    m_collisions (0),
+    m_collidedFrames (0),
+    m_busySlots (0)
+{
+  m_stations.reserve (nStations);
+  for (uint32_t i = 0; i < nStations; ++i)
+    {
+      m_stations.push_back (Backoff (slotTime, minSlots, maxSlots, ceiling, maxRetries));
+    }
+  // A backoff never exceeds maxSlots, so a wheel one slot longer than that
+  // never wraps onto a bucket that is still pending.
+  uint64_t size = 1;
+  while (size < static_cast<uint64_t> (maxSlots) + 2)
+    {
+      size <<= 1;
+    }
+  m_buckets.resize (size);
+  m_mask = size - 1;
+}
+
+void ContentionEngine::Start (void)
+{
+  m_currentSlot = 0;
+  for (uint32_t i = 0; i < m_stations.size (); ++i)
+    {
+      m_stations[i].ResetBackoffTime ();
+      Enqueue (i, 0);
+    }
+  ScheduleNextSlot ();
+}
+
+void ContentionEngine::Stop (void)
+{
+  Simulator::Cancel (m_event);
+}
+
+void ContentionEngine::Enqueue (uint32_t station, uint64_t fromSlot)
+{
+  uint64_t slots = m_stations[station].GetBackoffTime ().GetTimeStep () / m_slotTime.GetTimeStep ();
+  m_buckets[(fromSlot + slots) & m_mask].push_back (station);
+}
+
+void ContentionEngine::ScheduleNextSlot (void)
+{
+  if (m_stations.empty ())
+    {
+      return;
+    }
+  uint64_t next = m_currentSlot;
+  while (m_buckets[next & m_mask].empty ())
+    {
+      ++next;
+    }
+  m_event = Simulator::Schedule (TimeStep (m_slotTime.GetTimeStep () * (next - m_currentSlot)), &ContentionEngine::ProcessSlot, this);
+  m_currentSlot = next;
+}
+
+void ContentionEngine::ProcessSlot (void)
+{
+  m_transmitters.clear ();
+  m_transmitters.swap (m_buckets[m_currentSlot & m_mask]);
+  ++m_busySlots;
+  m_attempts += m_transmitters.size ();
+  bool collision = m_transmitters.size () > 1;
+  if (collision)
+    {
+      ++m_collisions;
+      m_collidedFrames += m_transmitters.size ();
+    }
+  NS_LOG_DEBUG ("slot " << m_currentSlot << ": " << m_transmitters.size () << " transmitter(s)");
+
+  // The transmission takes this slot; the next backoff counts from the
+  // following one.
+  for (std::vector<uint32_t>::const_iterator i = m_transmitters.begin (); i != m_transmitters.end (); ++i)
+    {
+      Backoff &backoff = m_stations[*i];
+      if (!collision)
+        {
+          ++m_successes;
+          backoff.ResetBackoffTime ();
+        }
+      else
+        {
+          backoff.IncrNumRetries ();
+          if (backoff.MaxRetriesReached ())
+            {
+              ++m_drops;
+              backoff.ResetBackoffTime ();
+            }
+        }
+      Enqueue (*i, m_currentSlot + 1);
+    }
+  ScheduleNextSlot ();
+}
+
+uint32_t ContentionEngine::GetNStations (void) const
+{
+  return m_stations.size ();
+}
+
+uint64_t ContentionEngine::GetAttempts (void) const
+{
+  return m_attempts;
+}
+
+uint64_t ContentionEngine::GetSuccesses (void) const
+{
+  return m_successes;
+}
+
+uint64_t ContentionEngine::GetDrops (void) const
+{
+  return m_drops;
+}
+
+uint64_t ContentionEngine::GetCollisions (void) const
 {
-  // Assume packet loss increases with congestion due to more UAVs.
-  uint32_t totalPacketsReceived = totalPacketsSent - (totalUAVs * std::min(50U, totalPacketsSent / totalUAVs));
-  
-  double simulationTime = Simulator::Now ().GetSeconds ();
-  double totalDataSent = 1024 * totalPacketsSent; 
-  double totalDataReceived = 1024 * totalPacketsReceived;
-  
-  // Simulate energy consumption scaling with the number of UAVs
-  double energyConsumed = 0.1 * totalPacketsSent * std::log(totalUAVs + 1);
+  return m_collisions;
+}
 
-  uint32_t packetsLost = totalPacketsSent - totalPacketsReceived;
-  double packetLossRatio = static_cast<double>(packetsLost) / totalPacketsSent;
+uint64_t ContentionEngine::GetCollidedFrames (void) const
+{
+  return m_collidedFrames;
+}
+
+uint64_t ContentionEngine::GetBusySlots (void) const
+{
+  return m_busySlots;
+}
+
+uint64_t ContentionEngine::GetElapsedSlots (void) const
+{
+  return m_currentSlot;
+}
+
+void CalculatePerformanceMetrics(const ContentionEngine& engine, Time simulationTime, uint32_t packetSize, double txEnergy)
+{
+  uint64_t totalPacketsSent = engine.GetAttempts ();
+  uint64_t totalPacketsReceived = engine.GetSuccesses ();
+  uint64_t packetsLost = engine.GetDrops ();
+
+  double totalDataSent = static_cast<double> (packetSize) * totalPacketsSent;
+  double totalDataReceived = static_cast<double> (packetSize) * totalPacketsReceived;
+  double energyConsumed = txEnergy * totalPacketsSent;
+
+  // A frame is lost when it is dropped after maxRetries collisions.
+  double packetLossRatio = 0.0;
+  if (totalPacketsReceived + packetsLost > 0)
+  {
+    packetLossRatio = static_cast<double>(packetsLost) / (totalPacketsReceived + packetsLost);
+  }
 
   double throughput = 0.0;
-  if (simulationTime > 0)
+  if (simulationTime.IsStrictlyPositive ())
   {
-    throughput = (totalDataReceived * 8) / (simulationTime * 1e6); 
+    throughput = (totalDataReceived * 8) / (simulationTime.GetSeconds () * 1e6);
   }
 
-  double overheadEfficiency = (totalDataReceived / totalDataSent) * 100.0;
+  double overheadEfficiency = totalDataSent > 0 ? (totalDataReceived / totalDataSent) * 100.0 : 0.0;
+  double collisionRatio = totalPacketsSent > 0 ? static_cast<double>(engine.GetCollidedFrames ()) / totalPacketsSent : 0.0;
 
-  std::cout << "\n--- Backoff Modified Performance Metrics for " << totalUAVs << " UAVs ---\n";
+  std::cout << "\n--- Backoff Modified Performance Metrics for " << engine.GetNStations () << " UAVs ---\n";
+  std::cout << "Slots: " << engine.GetElapsedSlots () << " (" << engine.GetBusySlots () << " busy, "
+            << engine.GetCollisions () << " collisions)\n";
   std::cout << "Total Packets Sent: " << totalPacketsSent << "\n";
   std::cout << "Total Packets Received: " << totalPacketsReceived << "\n";
   std::cout << "Total Packets Lost: " << packetsLost << "\n";
   std::cout << "Packet Loss Ratio: " << packetLossRatio * 100 << " %\n";
+  std::cout << "Collision Ratio: " << collisionRatio * 100 << " %\n";
   std::cout << "Throughput: " << throughput << " Mbps\n";
   std::cout << "Total Energy Consumed: " << energyConsumed << " J\n";
   std::cout << "Overhead Efficiency: " << overheadEfficiency << " %\n";
@@ -63,7 +216,7 @@ void CalculatePerformanceMetrics(const Backoff& backoff, uint32_t totalPacketsSe
 
 int main (int argc, char *argv[])
 {
-  LogComponentEnable ("BackoffExample", LOG_LEVEL_ALL);
+  LogComponentEnable ("BackoffExample", LOG_LEVEL_INFO);
 
   // Set default parameters for Backoff and UAVs
   Time slotTime = MicroSeconds (1);
@@ -71,13 +224,23 @@ int main (int argc, char *argv[])
   uint32_t maxSlots = 16;
   uint32_t ceiling = 10;
   uint32_t maxRetries = 5;
+  uint32_t packetSize = 1024;
+  double txEnergy = 0.001;
+  double simTime = 5.0;
 
   // Default UAV count
-  uint32_t numberOfUAVs = 5; 
+  uint32_t numberOfUAVs = 5;
 
   // Parse command-line arguments to allow changing UAV count
   CommandLine cmd;
   cmd.AddValue ("nUAV", "Number of UAVs", numberOfUAVs);
+  cmd.AddValue ("minSlots", "Minimum number of backoff slots", minSlots);
+  cmd.AddValue ("maxSlots", "Maximum number of backoff slots", maxSlots);
+  cmd.AddValue ("ceiling", "Cap to the exponential backoff", ceiling);
+  cmd.AddValue ("maxRetries", "Retries before a frame is dropped", maxRetries);
+  cmd.AddValue ("packetSize", "Frame size in bytes", packetSize);
+  cmd.AddValue ("txEnergy", "Energy per transmission attempt, J", txEnergy);
+  cmd.AddValue ("simTime", "Simulation time, s", simTime);
   cmd.Parse (argc, argv);
 
   // Create UAV nodes
@@ -89,33 +252,22 @@ int main (int argc, char *argv[])
   mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
   mobility.Install(uavNodes);
 
-  // Initialize Backoff and packets
-  Backoff customBackoff (slotTime, minSlots, maxSlots, ceiling, maxRetries);
-  uint32_t totalPacketsSent = 1000 * numberOfUAVs;  // More UAVs mean more packets
-
-  for (uint32_t i = 0; i < totalPacketsSent; ++i)
-  {
-    if (customBackoff.MaxRetriesReached ())
-    {
-      NS_LOG_INFO ("Max retries reached");
-      break;
-    }
-
-    Time backoffTime = customBackoff.GetBackoffTime ();
-    NS_LOG_INFO ("Backoff time: " << backoffTime.GetMicroSeconds () << " microseconds");
-    customBackoff.IncrNumRetries ();
-  }
+  // One saturated Backoff per UAV contending on a shared slotted channel
+  ContentionEngine engine (numberOfUAVs, slotTime, minSlots, maxSlots, ceiling, maxRetries);
+  engine.Start ();
 
   // Schedule TCP Timer and Hello Packet events (once for all UAVs)
+  Backoff customBackoff (slotTime, minSlots, maxSlots, ceiling, maxRetries);
   Simulator::Schedule (Seconds (1.0), &Backoff::StartTcpTimer, &customBackoff, Seconds (2.0));
   Simulator::Schedule (Seconds (1.0), &Backoff::SendHelloPacket, &customBackoff);
 
+  Simulator::Stop (Seconds (simTime));
   Simulator::Run ();
+  Time elapsed = Simulator::Now ();
+  engine.Stop ();
   Simulator::Destroy ();
 
-  // Calculate and display performance metrics once
-  CalculatePerformanceMetrics(customBackoff, totalPacketsSent, numberOfUAVs);
+  CalculatePerformanceMetrics (engine, elapsed, packetSize, txEnergy);
 
   return 0;
 }
-
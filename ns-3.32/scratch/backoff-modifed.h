@@ -2,7 +2,9 @@
 #ifndef BACKOFF_H
 #define BACKOFF_H
 
+#include <vector>
 #include "ns3/nstime.h"
+#include "ns3/event-id.h"
 #include "ns3/random-variable-stream.h"
 
 namespace ns3 {
@@ -30,6 +32,61 @@ private:
   Ptr<UniformRandomVariable> m_rng;
 };
 
+/**
+ * Slotted contention between stations that each run a Backoff.
+ *
+ * Every station always has a frame to send.  A station transmits when its
+ * backoff expires; a slot with one transmitter is a success, a slot with
+ * several is a collision for all of them.  Collided stations call
+ * IncrNumRetries and draw a new, larger backoff, until MaxRetriesReached
+ * makes them drop the frame.
+ *
+ * Pending transmissions are kept in a timing wheel with one bucket per
+ * slot, sized to the largest backoff, and the simulator only sees one
+ * event per busy slot.  The cost per slot is independent of the number
+ * of stations, which lets runs scale to 100k stations.
+ */
+class ContentionEngine {
+public:
+  ContentionEngine (uint32_t nStations, Time slotTime, uint32_t minSlots, uint32_t maxSlots, uint32_t ceiling, uint32_t maxRetries);
+
+  /// Draw the first backoff of every station and schedule the first busy slot.
+  void Start (void);
+  /// Cancel the pending slot event.
+  void Stop (void);
+
+  uint32_t GetNStations (void) const;
+  uint64_t GetAttempts (void) const;       ///< Transmissions, including collided ones
+  uint64_t GetSuccesses (void) const;      ///< Frames delivered
+  uint64_t GetDrops (void) const;          ///< Frames dropped after maxRetries
+  uint64_t GetCollisions (void) const;     ///< Slots with more than one transmitter
+  uint64_t GetCollidedFrames (void) const; ///< Transmissions lost to collisions
+  uint64_t GetBusySlots (void) const;      ///< Slots with at least one transmitter
+  uint64_t GetElapsedSlots (void) const;   ///< Slots elapsed since Start
+
+private:
+  /// Resolve the transmissions of the current slot.
+  void ProcessSlot (void);
+  /// Put a station in the bucket its next backoff expires in.
+  void Enqueue (uint32_t station, uint64_t fromSlot);
+  /// Schedule ProcessSlot at the next busy slot.
+  void ScheduleNextSlot (void);
+
+  std::vector<Backoff> m_stations;
+  std::vector<std::vector<uint32_t> > m_buckets; // timing wheel indexed by slot & m_mask
+  std::vector<uint32_t> m_transmitters;          // scratch list for the current slot
+  Time m_slotTime;
+  uint64_t m_mask;
+  uint64_t m_currentSlot;
+  EventId m_event;
+  uint64_t m_attempts;
+  uint64_t m_successes;
+  uint64_t m_drops;
+  uint64_t m_collisions;
+  uint64_t m_collidedFrames;
+  uint64_t m_busySlots;
+};
+
 } // namespace ns3
 
 #endif /* BACKOFF_H */
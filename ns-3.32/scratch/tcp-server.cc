@@ -1,3 +1,6 @@
+// Measures loss and RTO with real sockets on localhost.  For deterministic
+// runs of many connections, see examples/tcp/tcp-server-rto.cc.
+
 #include <iostream>
 #include <thread>
 #include <cstring>
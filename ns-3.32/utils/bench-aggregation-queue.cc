@@ -0,0 +1,206 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/mac48-address.h"
+#include "ns3/packet.h"
+#include "../abc/aggregation-queue.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 12;
+
+// Keeps results alive
+volatile uint32_t g_sink;
+
+/**
+ * The WifiMacQueue of the wifi module: one list of all MPDUs, searched
+ * from its head for a receiver and TID, and an aggregator that copies
+ * each MPDU with its delimiter and padding into the A-MPDU.
+ */
+class ListQueue
+{
+public:
+  /**
+   * \param packet the MPDU
+   * \param ra the receiver address
+   * \param tid the TID
+   */
+  void Enqueue (Ptr<Packet> packet, Mac48Address ra, uint8_t tid)
+  {
+    Entry entry = {packet, ra, tid};
+    m_entries.push_back (entry);
+  }
+
+  /**
+   * \param ra the receiver address
+   * \param tid the TID
+   * \param maxBytes maximum A-MPDU size
+   * \param maxMpdus maximum number of MPDUs
+   * \param nMpdus output, the number of MPDUs
+   * \return the A-MPDU
+   */
+  Ptr<Packet> BuildAmpdu (Mac48Address ra, uint8_t tid, uint32_t maxBytes,
+                          uint32_t maxMpdus, uint32_t &nMpdus)
+  {
+    Ptr<Packet> ampdu = Create<Packet> ();
+    nMpdus = 0;
+    while (nMpdus < maxMpdus)
+      {
+        std::list<Entry>::iterator it = m_entries.begin ();
+        while (it != m_entries.end () && (it->tid != tid || it->ra != ra))
+          {
+            ++it;
+          }
+        if (it == m_entries.end ())
+          {
+            break;
+          }
+        uint32_t padding = (4 - ampdu->GetSize () % 4) % 4;
+        if (nMpdus > 0 && ampdu->GetSize () + padding + 4 + it->packet->GetSize () > maxBytes)
+          {
+            break;
+          }
+        if (nMpdus > 0)
+          {
+            ampdu->AddPaddingAtEnd (padding);
+          }
+        Ptr<Packet> mpdu = it->packet->Copy ();
+        ampdu->AddAtEnd (Create<Packet> (4));
+        ampdu->AddAtEnd (mpdu);
+        m_entries.erase (it);
+        ++nMpdus;
+      }
+    return ampdu;
+  }
+
+private:
+  /// A queued MPDU.
+  struct Entry
+  {
+    Ptr<Packet> packet; //!< The MPDU
+    Mac48Address ra;    //!< Receiver address
+    uint8_t tid;        //!< TID
+  };
+
+  std::list<Entry> m_entries; //!< MPDUs of all flows
+};
+
+int main (int argc, char *argv[])
+{
+  uint32_t nTids = 4;
+  uint32_t depth = 64;
+  uint32_t mpduSize = 1500;
+  uint32_t maxMpdus = 64;
+  uint32_t maxBytes = 65535;
+  uint32_t nAmpdus = 2000;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark AggregationQueue against the single list of WifiMacQueue.\n"
+             "\n"
+             "Each (station, TID) flow is kept saturated with depth MPDUs.\n"
+             "The AP builds A-MPDUs for the flows in turn and refills them,\n"
+             "first from a list searched from its head, with a copy of each\n"
+             "MPDU in the A-MPDU, then from AggregationQueue.  The rate\n"
+             "columns are the MPDUs aggregated per second by each queue.");
+  cmd.AddValue ("tids", "TIDs per station", nTids);
+  cmd.AddValue ("depth", "MPDUs queued per flow", depth);
+  cmd.AddValue ("mpduSize", "bytes per MPDU", mpduSize);
+  cmd.AddValue ("maxMpdus", "MPDUs per A-MPDU", maxMpdus);
+  cmd.AddValue ("maxBytes", "bytes per A-MPDU", maxBytes);
+  cmd.AddValue ("ampdus", "A-MPDUs built per run", nAmpdus);
+  cmd.Parse (argc, argv);
+
+  LOG (std::setw (g_fwidth) << "stations" << std::setw (g_fwidth) << "flows"
+       << std::setw (g_fwidth) << "list (ns)" << std::setw (g_fwidth) << "queue (ns)"
+       << std::setw (g_fwidth) << "speedup" << std::setw (g_fwidth) << "list rate"
+       << std::setw (g_fwidth) << "queue rate");
+  for (uint32_t nStations = 1; nStations <= 256; nStations *= 4)
+    {
+      std::vector<Mac48Address> stations;
+      for (uint32_t i = 0; i < nStations; ++i)
+        {
+          stations.push_back (Mac48Address::Allocate ());
+        }
+      uint32_t nFlows = nStations * nTids;
+      Ptr<Packet> payload = Create<Packet> (mpduSize);
+
+      ListQueue list;
+      for (uint32_t k = 0; k < depth; ++k)
+        {
+          for (uint32_t f = 0; f < nFlows; ++f)
+            {
+              list.Enqueue (payload->Copy (), stations[f / nTids], f % nTids);
+            }
+        }
+      uint64_t listMpdus = 0;
+      SystemWallClockMs clock;
+      clock.Start ();
+      for (uint32_t a = 0; a < nAmpdus; ++a)
+        {
+          uint32_t f = a % nFlows;
+          uint32_t n;
+          Ptr<Packet> ampdu = list.BuildAmpdu (stations[f / nTids], f % nTids, maxBytes, maxMpdus, n);
+          g_sink = ampdu->GetSize ();
+          listMpdus += n;
+          for (uint32_t k = 0; k < n; ++k)
+            {
+              list.Enqueue (payload->Copy (), stations[f / nTids], f % nTids);
+            }
+        }
+      double listNs = 1e6 * clock.End () / nAmpdus;
+
+      AggregationQueue queue;
+      queue.SetMaxPackets (nFlows * depth);
+      for (uint32_t k = 0; k < depth; ++k)
+        {
+          for (uint32_t f = 0; f < nFlows; ++f)
+            {
+              queue.Enqueue (payload->Copy (), stations[f / nTids], f % nTids, 0);
+            }
+        }
+      uint64_t queueMpdus = 0;
+      AggregationQueue::Aggregate ampdu;
+      clock.Start ();
+      for (uint32_t a = 0; a < nAmpdus; ++a)
+        {
+          uint32_t f = a % nFlows;
+          uint32_t n = queue.BuildAmpdu (stations[f / nTids], f % nTids, a, maxBytes, maxMpdus, ampdu);
+          g_sink = ampdu.size;
+          queueMpdus += n;
+          for (uint32_t k = 0; k < n; ++k)
+            {
+              queue.Enqueue (payload->Copy (), stations[f / nTids], f % nTids, a);
+            }
+        }
+      double queueNs = 1e6 * clock.End () / nAmpdus;
+
+      LOG (std::setw (g_fwidth) << nStations << std::setw (g_fwidth) << nFlows
+           << std::setw (g_fwidth) << listNs << std::setw (g_fwidth) << queueNs
+           << std::setw (g_fwidth) << (queueNs > 0 ? listNs / queueNs : 0)
+           << std::setw (g_fwidth) << (listNs > 0 ? 1e9 * listMpdus / (listNs * nAmpdus) : 0)
+           << std::setw (g_fwidth) << (queueNs > 0 ? 1e9 * queueMpdus / (queueNs * nAmpdus) : 0));
+    }
+  return 0;
+}
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/backoff.h"
+#include "../abc/backoff-batch.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 14;
+
+/**
+ * Draw one backoff per station per round with one ns3::Backoff object
+ * per station, as scratch/backoff-modifed.cc does.
+ *
+ * \param stations number of stations
+ * \param rounds number of contention rounds
+ * \return elapsed wall-clock time in seconds
+ */
+double
+BenchBackoff (uint32_t stations, uint32_t rounds)
+{
+  std::vector<Backoff> backoff;
+  backoff.reserve (stations);
+  for (uint32_t i = 0; i < stations; ++i)
+    {
+      backoff.push_back (Backoff (MicroSeconds (1), 1, 1023, 10, 7));
+    }
+  uint64_t sum = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; ++r)
+    {
+      for (uint32_t i = 0; i < stations; ++i)
+        {
+          sum += backoff[i].GetBackoffTime ().GetMicroSeconds ();
+          backoff[i].IncrNumRetries ();
+          if (backoff[i].MaxRetriesReached ())
+            {
+              backoff[i].ResetBackoffTime ();
+            }
+        }
+    }
+  double elapsed = clock.End () / 1000.0;
+  LOG (std::setw (g_fwidth) << "Backoff" << std::setw (g_fwidth) << elapsed
+       << std::setw (g_fwidth) << stations * static_cast<double> (rounds) / elapsed
+       << std::setw (g_fwidth) << sum / (static_cast<double> (stations) * rounds));
+  return elapsed;
+}
+
+/**
+ * Same draws with one BackoffBatch for all stations.
+ *
+ * \param stations number of stations
+ * \param rounds number of contention rounds
+ * \return elapsed wall-clock time in seconds
+ */
+double
+BenchBackoffBatch (uint32_t stations, uint32_t rounds)
+{
+  BackoffBatch backoff (stations, MicroSeconds (1), 1, 1023, 10, 7);
+  std::vector<uint32_t> slots (stations);
+  std::vector<uint8_t> failed (stations, 1);
+  uint64_t sum = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; ++r)
+    {
+      backoff.GetBackoffSlots (&slots[0]);
+      for (uint32_t i = 0; i < stations; ++i)
+        {
+          sum += slots[i];
+        }
+      backoff.UpdateRetries (&failed[0]);
+    }
+  double elapsed = clock.End () / 1000.0;
+  LOG (std::setw (g_fwidth) << "BackoffBatch" << std::setw (g_fwidth) << elapsed
+       << std::setw (g_fwidth) << stations * static_cast<double> (rounds) / elapsed
+       << std::setw (g_fwidth) << sum / (static_cast<double> (stations) * rounds));
+  return elapsed;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t stations = 10000;
+  uint32_t rounds = 1000;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark per-station Backoff objects against BackoffBatch.\n"
+             "\n"
+             "Every station draws one backoff per round and then fails, so\n"
+             "the contention window grows until maxRetries as in\n"
+             "scratch/backoff-modifed.cc.");
+  cmd.AddValue ("stations", "number of stations (default 1E4)", stations);
+  cmd.AddValue ("rounds", "number of contention rounds (default 1E3)", rounds);
+  cmd.Parse (argc, argv);
+
+  LOG (std::setw (g_fwidth) << "model" << std::setw (g_fwidth) << "Time (s)"
+       << std::setw (g_fwidth) << "Rate (draw/s)" << std::setw (g_fwidth) << "Mean (slots)");
+  double scalar = BenchBackoff (stations, rounds);
+  double batch = BenchBackoffBatch (stations, rounds);
+  LOG ("speedup: " << scalar / batch);
+  return 0;
+}
@@ -0,0 +1,245 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "../abc/block-ack-scoreboard.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 12;
+
+// Keeps results alive
+volatile uint32_t g_sink;
+
+/**
+ * The scoreboards of the wifi module: the originator keeps the MPDUs in
+ * flight in a list and tests the bit of each one in the block ack; the
+ * recipient keeps a std::vector<bool> moved bit by bit.
+ */
+class ListScoreboard
+{
+public:
+  /**
+   * \param winSize window size
+   */
+  ListScoreboard (uint16_t winSize)
+    : m_winSize (winSize),
+      m_recipientStart (0),
+      m_received (winSize, false)
+  {
+  }
+
+  /**
+   * \param seq sequence number of an MPDU sent
+   */
+  void NotifySent (uint16_t seq)
+  {
+    m_inFlight.push_back (seq);
+  }
+
+  /**
+   * \param seq sequence number of an MPDU received
+   */
+  void NotifyReceived (uint16_t seq)
+  {
+    uint16_t d = (seq - m_recipientStart) & 0xfff;
+    if (d >= 2048)
+      {
+        return;
+      }
+    while (d >= m_winSize)
+      {
+        // Slide by one, as BlockAckCache does.
+        for (uint32_t i = 1; i < m_winSize; ++i)
+          {
+            m_received[i - 1] = m_received[i];
+          }
+        m_received[m_winSize - 1] = false;
+        m_recipientStart = (m_recipientStart + 1) & 0xfff;
+        --d;
+      }
+    m_received[d] = true;
+  }
+
+  /**
+   * \param bitmap output, the block ack bitmap
+   * \return its starting sequence number
+   */
+  uint16_t FillBitmap (std::vector<uint64_t> &bitmap) const
+  {
+    bitmap.assign ((m_winSize + 63) / 64, 0);
+    for (uint32_t i = 0; i < m_winSize; ++i)
+      {
+        if (m_received[i])
+          {
+            bitmap[i / 64] |= static_cast<uint64_t> (1) << (i % 64);
+          }
+      }
+    return m_recipientStart;
+  }
+
+  /**
+   * \param startingSeq starting sequence number of the block ack
+   * \param bitmap the bitmap
+   * \param retransmissions output, the MPDUs not acknowledged
+   * \return the number of MPDUs acknowledged
+   */
+  uint32_t NotifyBlockAck (uint16_t startingSeq, const std::vector<uint64_t> &bitmap,
+                           std::list<uint16_t> &retransmissions)
+  {
+    uint32_t acked = 0;
+    for (std::list<uint16_t>::iterator it = m_inFlight.begin (); it != m_inFlight.end (); )
+      {
+        uint16_t d = (*it - startingSeq) & 0xfff;
+        if (d < m_winSize && ((bitmap[d / 64] >> (d % 64)) & 1))
+          {
+            ++acked;
+          }
+        else
+          {
+            retransmissions.push_back (*it);
+          }
+        it = m_inFlight.erase (it);
+      }
+    return acked;
+  }
+
+private:
+  uint16_t m_winSize;                //!< Window size
+  std::list<uint16_t> m_inFlight;    //!< MPDUs in flight
+  uint16_t m_recipientStart;         //!< Recipient window start
+  std::vector<bool> m_received;      //!< Recipient bitmap
+};
+
+int main (int argc, char *argv[])
+{
+  uint32_t nRounds = 5000;
+  double loss = 0.1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark BlockAckOriginator and BlockAckRecipient against the\n"
+             "list and vector<bool> scoreboards of the wifi module.\n"
+             "\n"
+             "Each round sends the retransmissions and then new MPDUs up to\n"
+             "the window, loses each one with probability loss, and\n"
+             "processes the block ack.  The times are per round.");
+  cmd.AddValue ("rounds", "block acks per window size", nRounds);
+  cmd.AddValue ("loss", "MPDU loss probability", loss);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  LOG (std::setw (g_fwidth) << "window" << std::setw (g_fwidth) << "list (ns)"
+       << std::setw (g_fwidth) << "ring (ns)" << std::setw (g_fwidth) << "speedup"
+       << std::setw (g_fwidth) << "ring bytes" << std::setw (g_fwidth) << "acked");
+  uint16_t windows[] = {64, 256, 1024};
+  for (uint32_t w = 0; w < sizeof (windows) / sizeof (windows[0]); ++w)
+    {
+      uint16_t winSize = windows[w];
+      // Same losses for both scoreboards.
+      std::vector<bool> lost (nRounds * winSize);
+      for (uint32_t i = 0; i < lost.size (); ++i)
+        {
+          lost[i] = rng->GetValue () < loss;
+        }
+
+      ListScoreboard list (winSize);
+      std::list<uint16_t> retransmissions;
+      std::vector<uint64_t> bitmap;
+      uint16_t next = 0;
+      uint16_t oldest = 0;
+      uint64_t listAcked = 0;
+      uint32_t l = 0;
+      SystemWallClockMs clock;
+      clock.Start ();
+      for (uint32_t r = 0; r < nRounds; ++r)
+        {
+          std::list<uint16_t> resend;
+          resend.swap (retransmissions);
+          oldest = resend.empty () ? next : resend.front ();
+          for (std::list<uint16_t>::const_iterator it = resend.begin (); it != resend.end (); ++it)
+            {
+              list.NotifySent (*it);
+              if (!lost[l++])
+                {
+                  list.NotifyReceived (*it);
+                }
+            }
+          while (((next - oldest) & 0xfff) < winSize)
+            {
+              list.NotifySent (next);
+              if (!lost[l++])
+                {
+                  list.NotifyReceived (next);
+                }
+              next = (next + 1) & 0xfff;
+            }
+          uint16_t ssn = list.FillBitmap (bitmap);
+          listAcked += list.NotifyBlockAck (ssn, bitmap, retransmissions);
+          l %= lost.size () - winSize;
+        }
+      double listNs = 1e6 * clock.End () / nRounds;
+
+      BlockAckOriginator originator (0, winSize);
+      BlockAckRecipient recipient (0, winSize);
+      std::vector<uint16_t> resend;
+      next = 0;
+      uint64_t ringAcked = 0;
+      l = 0;
+      clock.Start ();
+      for (uint32_t r = 0; r < nRounds; ++r)
+        {
+          originator.GetRetransmissions (resend);
+          for (std::vector<uint16_t>::const_iterator it = resend.begin (); it != resend.end (); ++it)
+            {
+              if (!lost[l++])
+                {
+                  recipient.NotifyReceived (*it);
+                }
+            }
+          while (originator.IsInWindow (next))
+            {
+              originator.NotifySent (next);
+              if (!lost[l++])
+                {
+                  recipient.NotifyReceived (next);
+                }
+              next = (next + 1) & 0xfff;
+            }
+          uint16_t ssn = recipient.FillBitmap (bitmap);
+          ringAcked += originator.NotifyBlockAck (ssn, &bitmap[0], winSize);
+          l %= lost.size () - winSize;
+        }
+      double ringNs = 1e6 * clock.End () / nRounds;
+      g_sink = listAcked + ringAcked;
+
+      LOG (std::setw (g_fwidth) << winSize << std::setw (g_fwidth) << listNs
+           << std::setw (g_fwidth) << ringNs
+           << std::setw (g_fwidth) << (ringNs > 0 ? listNs / ringNs : 0)
+           << std::setw (g_fwidth) << sizeof (BlockAckOriginator) + sizeof (BlockAckRecipient)
+           << std::setw (g_fwidth) << ringAcked);
+    }
+  return 0;
+}
@@ -0,0 +1,259 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/yans-error-rate-model.h"
+#include "ns3/nist-error-rate-model.h"
+#include "ns3/wifi-tx-vector.h"
+#include "../abc/abstraction-error-rate-model.h"
+#include "../abc/error-rate-batch.h"
+#include "../abc/tabulated-error-rate-model.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 12;
+
+// Keeps results alive
+volatile double g_sink;
+
+/**
+ * Chunk success rates of a mode at the given SNRs.
+ * \param model the model
+ * \param mode the mode
+ * \param snrs linear SNRs
+ * \param nbits bits per chunk
+ * \param ps output, the success rate of each chunk
+ * \return ns per chunk
+ */
+double
+Measure (Ptr<ErrorRateModel> model, WifiMode mode, const std::vector<double> &snrs,
+         uint64_t nbits, std::vector<double> &ps)
+{
+  WifiTxVector txVector;
+  txVector.SetMode (mode);
+  ps.resize (snrs.size ());
+  double sum = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < snrs.size (); ++i)
+    {
+      ps[i] = model->GetChunkSuccessRate (mode, txVector, snrs[i], nbits);
+      sum += ps[i];
+    }
+  double ns = 1e6 * clock.End () / snrs.size ();
+  g_sink = sum;
+  return ns;
+}
+
+/**
+ * Chunk success rates of a mode at the given SNRs, in one batch.
+ * \param model the model
+ * \param mode the mode
+ * \param snrs linear SNRs
+ * \param nbits bits per chunk
+ * \param ps output, the success rate of each chunk
+ * \return ns per chunk
+ */
+double
+MeasureBatch (Ptr<ErrorRateModel> model, WifiMode mode, const std::vector<double> &snrs,
+              uint64_t nbits, std::vector<double> &ps)
+{
+  WifiTxVector txVector;
+  txVector.SetMode (mode);
+  SystemWallClockMs clock;
+  clock.Start ();
+  ErrorRateBatch::GetChunkSuccessRates (model, mode, txVector, snrs, nbits, ps);
+  double ns = 1e6 * clock.End () / snrs.size ();
+  g_sink = ps.back ();
+  return ns;
+}
+
+/**
+ * Success rates of frames cut into chunks at different SNRs, as the PHY
+ * computes them, against the effective SNR of the abstraction.
+ * \param model the reference model
+ * \param abstraction an AbstractionErrorRateModel fitted to it
+ * \param mode the mode
+ * \param snrs linear SNRs, consumed in order
+ * \param nbits bits per frame
+ * \param rng random cuts
+ * \param frameError output, largest error of the abstraction on a frame
+ * \param eesmError output, largest difference between the product of
+ * the chunk success rates of the abstraction and its success rate at the
+ * effective SNR
+ */
+void
+CheckFrames (Ptr<ErrorRateModel> model, Ptr<AbstractionErrorRateModel> abstraction, WifiMode mode,
+             const std::vector<double> &snrs, uint64_t nbits, Ptr<UniformRandomVariable> rng,
+             double &frameError, double &eesmError)
+{
+  WifiTxVector txVector;
+  txVector.SetMode (mode);
+  frameError = 0;
+  eesmError = 0;
+  std::vector<double> frameSnrs;
+  std::vector<double> bits;
+  std::vector<uint64_t> cuts;
+  uint32_t next = 0;
+  while (next + 8 <= snrs.size ())
+    {
+      // 1 to 8 chunks, cut at random bits.
+      uint32_t nChunks = rng->GetInteger (1, 8);
+      cuts.assign (1, 0);
+      for (uint32_t k = 1; k < nChunks; ++k)
+        {
+          cuts.push_back (rng->GetInteger (0, static_cast<uint32_t> (nbits)));
+        }
+      cuts.push_back (nbits);
+      std::sort (cuts.begin (), cuts.end ());
+      frameSnrs.clear ();
+      bits.clear ();
+      double exact = 1;
+      double product = 1;
+      for (uint32_t k = 0; k < nChunks; ++k)
+        {
+          uint64_t chunk = cuts[k + 1] - cuts[k];
+          double snr = snrs[next++];
+          exact *= model->GetChunkSuccessRate (mode, txVector, snr, chunk);
+          product *= abstraction->GetChunkSuccessRate (mode, txVector, snr, chunk);
+          frameSnrs.push_back (snr);
+          bits.push_back (static_cast<double> (chunk));
+        }
+      double effective = abstraction->GetEffectiveSnr (mode, txVector, frameSnrs, bits);
+      double fitted = abstraction->GetChunkSuccessRate (mode, txVector, effective, nbits);
+      frameError = std::max (frameError, std::abs (exact - product));
+      eesmError = std::max (eesmError, std::abs (product - fitted));
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nChunks = 200000;
+  uint32_t frameSize = 1500;
+  double minSnr = 0;
+  double maxSnr = 40;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark TabulatedErrorRateModel and AbstractionErrorRateModel\n"
+             "against the Yans and Nist error-rate models.\n"
+             "\n"
+             "For each model and mode, computes the success rate of chunks\n"
+             "of frameSize bytes at random SNRs, first with the model and\n"
+             "then with its tables, which are built by a first pass that is\n"
+             "timed separately, then with its tables through ErrorRateBatch.\n"
+             "Then the same chunks go through an AbstractionErrorRateModel\n"
+             "fitted to the model, whose error is reported separately,\n"
+             "and are grouped into frames of 1 to 8 chunks of random\n"
+             "lengths: frame error is the largest error of the abstraction\n"
+             "on a frame, and eesm error the largest difference between the\n"
+             "product of its chunk success rates and its success rate at\n"
+             "the effective SNR of the frame.\n"
+             "The points/s column is the batch throughput in SNR points\n"
+             "per second.");
+  cmd.AddValue ("chunks", "chunks per mode", nChunks);
+  cmd.AddValue ("frameSize", "bytes per chunk", frameSize);
+  cmd.AddValue ("minSnr", "lowest SNR (dB)", minSnr);
+  cmd.AddValue ("maxSnr", "highest SNR (dB)", maxSnr);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> modes;
+  modes.push_back ("OfdmRate6Mbps");
+  modes.push_back ("OfdmRate54Mbps");
+  modes.push_back ("HtMcs0");
+  modes.push_back ("HtMcs7");
+  modes.push_back ("VhtMcs8");
+  modes.push_back ("HeMcs0");
+  modes.push_back ("HeMcs11");
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  std::vector<double> snrs (nChunks);
+  for (uint32_t i = 0; i < nChunks; ++i)
+    {
+      snrs[i] = std::pow (10.0, rng->GetValue (minSnr, maxSnr) / 10.0);
+    }
+
+  std::vector<Ptr<ErrorRateModel> > models;
+  std::vector<std::string> names;
+  models.push_back (CreateObject<YansErrorRateModel> ());
+  names.push_back ("yans");
+  models.push_back (CreateObject<NistErrorRateModel> ());
+  names.push_back ("nist");
+
+  LOG (std::setw (g_fwidth) << "model" << std::setw (g_fwidth) << "mode"
+       << std::setw (g_fwidth) << "build (ms)" << std::setw (g_fwidth) << "model (ns)"
+       << std::setw (g_fwidth) << "table (ns)" << std::setw (g_fwidth) << "batch (ns)"
+       << std::setw (g_fwidth) << "speedup" << std::setw (g_fwidth) << "max error"
+       << std::setw (g_fwidth) << "points/s" << std::setw (g_fwidth) << "abst (ns)"
+       << std::setw (g_fwidth) << "abst error" << std::setw (g_fwidth) << "frame error"
+       << std::setw (g_fwidth) << "eesm error");
+  for (uint32_t m = 0; m < models.size (); ++m)
+    {
+      for (uint32_t i = 0; i < modes.size (); ++i)
+        {
+          WifiMode mode (modes[i]);
+          Ptr<TabulatedErrorRateModel> tabulated = CreateObject<TabulatedErrorRateModel> ();
+          tabulated->SetModel (models[m]);
+
+          std::vector<double> exact;
+          std::vector<double> interpolated;
+          double modelNs = Measure (models[m], mode, snrs, frameSize * 8, exact);
+          SystemWallClockMs clock;
+          clock.Start ();
+          Measure (tabulated, mode, std::vector<double> (1, snrs[0]), frameSize * 8, interpolated);
+          double buildMs = clock.End ();
+          double tableNs = Measure (tabulated, mode, snrs, frameSize * 8, interpolated);
+          std::vector<double> batched;
+          double batchNs = MeasureBatch (tabulated, mode, snrs, frameSize * 8, batched);
+          Ptr<AbstractionErrorRateModel> abstraction = CreateObject<AbstractionErrorRateModel> ();
+          abstraction->SetModel (models[m]);
+          std::vector<double> fitted;
+          Measure (abstraction, mode, std::vector<double> (1, snrs[0]), frameSize * 8, fitted);
+          double abstractionNs = Measure (abstraction, mode, snrs, frameSize * 8, fitted);
+
+          double maxError = 0;
+          double abstractionError = 0;
+          for (uint32_t k = 0; k < nChunks; ++k)
+            {
+              maxError = std::max (maxError, std::abs (exact[k] - interpolated[k]));
+              maxError = std::max (maxError, std::abs (exact[k] - batched[k]));
+              abstractionError = std::max (abstractionError, std::abs (exact[k] - fitted[k]));
+            }
+          double frameError;
+          double eesmError;
+          CheckFrames (models[m], abstraction, mode, snrs, frameSize * 8, rng, frameError, eesmError);
+          LOG (std::setw (g_fwidth) << names[m] << std::setw (g_fwidth) << modes[i]
+               << std::setw (g_fwidth) << buildMs << std::setw (g_fwidth) << modelNs
+               << std::setw (g_fwidth) << tableNs << std::setw (g_fwidth) << batchNs
+               << std::setw (g_fwidth) << (batchNs > 0 ? modelNs / batchNs : 0)
+               << std::setw (g_fwidth) << maxError
+               << std::setw (g_fwidth) << (batchNs > 0 ? 1e9 / batchNs : 0)
+               << std::setw (g_fwidth) << abstractionNs << std::setw (g_fwidth) << abstractionError
+               << std::setw (g_fwidth) << frameError << std::setw (g_fwidth) << eesmError);
+        }
+    }
+  return 0;
+}
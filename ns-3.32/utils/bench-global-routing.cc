@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "../abc/parallel-global-routing-helper.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 12;
+
+/// A fat tree.
+struct FatTree
+{
+  NodeContainer nodes;                       //!< Switches, then hosts
+  std::vector<NetDeviceContainer> fabric;    //!< Switch-to-switch links
+  uint32_t nSwitches;                        //!< Number of switches
+};
+
+/**
+ * Build a k-ary fat tree: (k/2)^2 core switches, k pods of k/2
+ * aggregation and k/2 edge switches, hosts on the edge switches.
+ * \param k switch port count, even
+ * \param hostsPerEdge hosts on each edge switch
+ * \param tree the tree
+ */
+void
+BuildFatTree (uint32_t k, uint32_t hostsPerEdge, FatTree &tree)
+{
+  uint32_t half = k / 2;
+  uint32_t nCore = half * half;
+  uint32_t nAgg = k * half;
+  uint32_t nEdge = k * half;
+  tree.nSwitches = nCore + nAgg + nEdge;
+  tree.nodes.Create (tree.nSwitches + nEdge * hostsPerEdge);
+
+  InternetStackHelper stack;
+  stack.Install (tree.nodes);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1us"));
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+
+  for (uint32_t pod = 0; pod < k; ++pod)
+    {
+      for (uint32_t a = 0; a < half; ++a)
+        {
+          Ptr<Node> agg = tree.nodes.Get (nCore + pod * half + a);
+          for (uint32_t c = 0; c < half; ++c)
+            {
+              NetDeviceContainer link = p2p.Install (tree.nodes.Get (a * half + c), agg);
+              address.Assign (link);
+              address.NewNetwork ();
+              tree.fabric.push_back (link);
+            }
+          for (uint32_t e = 0; e < half; ++e)
+            {
+              NetDeviceContainer link = p2p.Install (agg, tree.nodes.Get (nCore + nAgg + pod * half + e));
+              address.Assign (link);
+              address.NewNetwork ();
+              tree.fabric.push_back (link);
+            }
+        }
+    }
+  for (uint32_t e = 0; e < nEdge; ++e)
+    {
+      for (uint32_t h = 0; h < hostsPerEdge; ++h)
+        {
+          NetDeviceContainer link = p2p.Install (tree.nodes.Get (nCore + nAgg + e),
+                                                 tree.nodes.Get (tree.nSwitches + e * hostsPerEdge + h));
+          address.Assign (link);
+          address.NewNetwork ();
+        }
+    }
+}
+
+/**
+ * Collect the global routes of every node.
+ * \param nodes the nodes
+ * \return one "dest/mask gateway interface" line per route, sorted per node
+ */
+std::vector<std::vector<std::string> >
+CollectRoutes (NodeContainer nodes)
+{
+  std::vector<std::vector<std::string> > routes (nodes.GetN ());
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (nodes.Get (i)->GetObject<Ipv4> ()->GetRoutingProtocol ());
+      for (uint32_t p = 0; list && p < list->GetNRoutingProtocols (); ++p)
+        {
+          int16_t priority;
+          Ptr<Ipv4GlobalRouting> global = DynamicCast<Ipv4GlobalRouting> (list->GetRoutingProtocol (p, priority));
+          for (uint32_t r = 0; global && r < global->GetNRoutes (); ++r)
+            {
+              std::ostringstream oss;
+              oss << *global->GetRoute (r);
+              routes[i].push_back (oss.str ());
+            }
+        }
+      std::sort (routes[i].begin (), routes[i].end ());
+    }
+  return routes;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t minK = 4;
+  uint32_t maxK = 12;
+  uint32_t kStep = 4;
+  int32_t hostsPerEdge = -1;
+  uint32_t nThreads = 0;
+  uint32_t nChanges = 20;
+  bool reference = true;
+  bool verify = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark global routing setup on fat-tree topologies.\n"
+             "\n"
+             "Times Ipv4GlobalRoutingHelper::PopulateRoutingTables against\n"
+             "ParallelGlobalRoutingHelper with one and with several SPF\n"
+             "threads, then takes random fabric links down and up again,\n"
+             "timing the incremental RecomputeRoutingTables of each change.");
+  cmd.AddValue ("minK", "smallest fat-tree arity (even)", minK);
+  cmd.AddValue ("maxK", "largest fat-tree arity (even)", maxK);
+  cmd.AddValue ("kStep", "arity increment (even)", kStep);
+  cmd.AddValue ("hostsPerEdge", "hosts on each edge switch (-1 for k/2)", hostsPerEdge);
+  cmd.AddValue ("threads", "SPF threads (0 for one per hardware thread)", nThreads);
+  cmd.AddValue ("changes", "link changes per topology", nChanges);
+  cmd.AddValue ("reference", "also time Ipv4GlobalRoutingHelper", reference);
+  cmd.AddValue ("verify", "check that incremental and full recomputation agree", verify);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  LOG (std::setw (g_fwidth) << "k" << std::setw (g_fwidth) << "switches"
+       << std::setw (g_fwidth) << "nodes" << std::setw (g_fwidth) << "ref (ms)"
+       << std::setw (g_fwidth) << "1 thr (ms)" << std::setw (g_fwidth) << "N thr (ms)"
+       << std::setw (g_fwidth) << "incr (ms)" << std::setw (g_fwidth) << "roots/chg");
+  for (uint32_t k = minK; k <= maxK; k += kStep)
+    {
+      FatTree tree;
+      BuildFatTree (k, hostsPerEdge < 0 ? k / 2 : hostsPerEdge, tree);
+      SystemWallClockMs clock;
+
+      int64_t refMs = -1;
+      if (reference)
+        {
+          clock.Start ();
+          Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+          refMs = clock.End ();
+        }
+
+      clock.Start ();
+      ParallelGlobalRoutingHelper::PopulateRoutingTables (1);
+      int64_t serialMs = clock.End ();
+      clock.Start ();
+      ParallelGlobalRoutingHelper::PopulateRoutingTables (nThreads);
+      int64_t parallelMs = clock.End ();
+
+      // Each change is a fabric link going down, then up again.
+      uint64_t nRecomputed = 0;
+      clock.Start ();
+      for (uint32_t c = 0; c < nChanges; ++c)
+        {
+          NetDeviceContainer &link = tree.fabric[rng->GetInteger (0, tree.fabric.size () - 1)];
+          Ptr<Ipv4> ipv4 = link.Get (0)->GetNode ()->GetObject<Ipv4> ();
+          uint32_t interface = ipv4->GetInterfaceForDevice (link.Get (0));
+          ipv4->SetDown (interface);
+          ParallelGlobalRoutingHelper::RecomputeRoutingTables ();
+          nRecomputed += ParallelGlobalRoutingHelper::GetNRecomputed ();
+          ipv4->SetUp (interface);
+          ParallelGlobalRoutingHelper::RecomputeRoutingTables ();
+          nRecomputed += ParallelGlobalRoutingHelper::GetNRecomputed ();
+        }
+      double incrMs = nChanges > 0 ? static_cast<double> (clock.End ()) / (2 * nChanges) : 0;
+
+      LOG (std::setw (g_fwidth) << k << std::setw (g_fwidth) << tree.nSwitches
+           << std::setw (g_fwidth) << tree.nodes.GetN () << std::setw (g_fwidth) << refMs
+           << std::setw (g_fwidth) << serialMs << std::setw (g_fwidth) << parallelMs
+           << std::setw (g_fwidth) << incrMs
+           << std::setw (g_fwidth) << (nChanges > 0 ? nRecomputed / (2 * nChanges) : 0));
+
+      if (verify)
+        {
+          // Leave one link down, so that the tables differ from the start.
+          Ptr<Ipv4> ipv4 = tree.fabric[0].Get (0)->GetNode ()->GetObject<Ipv4> ();
+          ipv4->SetDown (ipv4->GetInterfaceForDevice (tree.fabric[0].Get (0)));
+          ParallelGlobalRoutingHelper::RecomputeRoutingTables ();
+          std::vector<std::vector<std::string> > incremental = CollectRoutes (tree.nodes);
+          ParallelGlobalRoutingHelper::PopulateRoutingTables (nThreads);
+          std::vector<std::vector<std::string> > full = CollectRoutes (tree.nodes);
+          uint32_t bad = 0;
+          for (uint32_t i = 0; i < full.size (); ++i)
+            {
+              bad += full[i] != incremental[i];
+            }
+          LOG ("  nodes with different routes: " << bad);
+        }
+
+      Simulator::Destroy ();
+      ParallelGlobalRoutingHelper::Reset ();
+    }
+  return 0;
+}
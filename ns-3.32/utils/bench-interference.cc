@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "../abc/interference-buffer.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 12;
+
+/// A signal on the receiver.
+struct Signal
+{
+  int64_t start;   //!< First ns
+  int64_t end;     //!< ns after the last one
+  double powerW;   //!< Received power
+};
+
+/**
+ * Per-bit success rate of coded BPSK, as the Yans model computes it.
+ * \param snr linear SNR
+ * \return the success rate of one bit
+ */
+double
+BitSuccessRate (double snr)
+{
+  double ber = 0.5 * std::erfc (std::sqrt (snr));
+  double pd = 0;
+  // Union bound over the first distances of the rate 1/2 code.
+  for (uint32_t d = 10; d <= 14; d += 2)
+    {
+      double sum = 0;
+      for (uint32_t k = d / 2 + 1; k <= d; ++k)
+        {
+          double c = std::exp (std::lgamma (d + 1.0) - std::lgamma (k + 1.0) - std::lgamma (d - k + 1.0));
+          sum += c * std::pow (ber, k) * std::pow (1 - ber, d - k);
+        }
+      pd += 36 * sum;
+    }
+  return 1 - std::min (pd, 1.0);
+}
+
+/**
+ * The InterferenceHelper of the wifi module: one change per signal start
+ * and end in a multimap, each with the total power after it.
+ */
+class NiChanges
+{
+public:
+  /**
+   * \param s the signal
+   */
+  void Add (const Signal &s)
+  {
+    double atStart = PowerAt (s.start);
+    double atEnd = PowerAt (s.end);
+    std::multimap<int64_t, double>::iterator first = m_changes.insert (std::make_pair (s.start, atStart));
+    std::multimap<int64_t, double>::iterator last = m_changes.insert (std::make_pair (s.end, atEnd));
+    for (std::multimap<int64_t, double>::iterator i = first; i != last; ++i)
+      {
+        i->second += s.powerW;
+      }
+  }
+
+  /**
+   * \param t a time
+   * \return the power at t, changes at t included
+   */
+  double PowerAt (int64_t t) const
+  {
+    std::multimap<int64_t, double>::const_iterator i = m_changes.upper_bound (t);
+    return i == m_changes.begin () ? 0 : (--i)->second;
+  }
+
+  /**
+   * \param s the received signal, added before
+   * \param noiseW thermal noise
+   * \param bitsPerNs bits per ns
+   * \return the success rate of the reception
+   */
+  double Receive (const Signal &s, double noiseW, double bitsPerNs) const
+  {
+    double psr = 1;
+    int64_t t = s.start;
+    double power = PowerAt (s.start) - s.powerW;
+    for (std::multimap<int64_t, double>::const_iterator i = m_changes.upper_bound (s.start);
+         i != m_changes.end () && i->first < s.end; ++i)
+      {
+        if (i->first > t)
+          {
+            psr *= std::pow (BitSuccessRate (s.powerW / (noiseW + std::max (power, 0.0))),
+                             static_cast<double> ((i->first - t) * bitsPerNs));
+          }
+        t = i->first;
+        power = i->second - s.powerW;
+      }
+    psr *= std::pow (BitSuccessRate (s.powerW / (noiseW + std::max (power, 0.0))),
+                     static_cast<double> ((s.end - t) * bitsPerNs));
+    return psr;
+  }
+
+  /**
+   * \param t oldest time still needed
+   */
+  void EraseBefore (int64_t t)
+  {
+    std::multimap<int64_t, double>::iterator i = m_changes.lower_bound (t);
+    if (i != m_changes.begin ())
+      {
+        // Keep the power in force at t.
+        double power = PowerAt (t);
+        m_changes.erase (m_changes.begin (), i);
+        m_changes.insert (std::make_pair (t, power));
+      }
+  }
+
+private:
+  std::multimap<int64_t, double> m_changes;  //!< Time and power after it
+};
+
+/// Per-bit success rates by exact SNR, as CachedErrorRateModel keeps them.
+std::unordered_map<uint64_t, double> g_cache;
+
+/**
+ * \param snr linear SNR
+ * \return BitSuccessRate (snr), from the cache if possible
+ */
+double
+CachedBitSuccessRate (double snr)
+{
+  uint64_t key;
+  std::memcpy (&key, &snr, sizeof (snr));
+  std::unordered_map<uint64_t, double>::const_iterator i = g_cache.find (key);
+  if (i != g_cache.end ())
+    {
+      return i->second;
+    }
+  double p = BitSuccessRate (snr);
+  g_cache[key] = p;
+  return p;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t minLoad = 1;
+  uint32_t maxLoad = 16;
+  uint32_t nSignals = 20000;
+  uint32_t levels = 8;
+  double bitsPerNs = 0.006;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark InterferenceBuffer and a success rate cache against\n"
+             "the multimap walk of the wifi InterferenceHelper.\n"
+             "\n"
+             "Signals of 100 to 1500 us arrive at random, load signals on\n"
+             "average at a time, with powers from a few levels as in a\n"
+             "static topology; each one is received and its success rate\n"
+             "computed over its chunks.  The load doubles from minLoad to\n"
+             "maxLoad.");
+  cmd.AddValue ("minLoad", "smallest average number of concurrent signals", minLoad);
+  cmd.AddValue ("maxLoad", "largest average number of concurrent signals", maxLoad);
+  cmd.AddValue ("signals", "signals per load", nSignals);
+  cmd.AddValue ("levels", "distinct received powers", levels);
+  cmd.AddValue ("bitsPerNs", "bit rate (bits per ns)", bitsPerNs);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  double noiseW = 4e-13;
+
+  LOG (std::setw (g_fwidth) << "load" << std::setw (g_fwidth) << "map (ns)"
+       << std::setw (g_fwidth) << "buffer (ns)" << std::setw (g_fwidth) << "speedup"
+       << std::setw (g_fwidth) << "changes" << std::setw (g_fwidth) << "hit rate"
+       << std::setw (g_fwidth) << "max diff");
+  for (uint32_t load = minLoad; load <= maxLoad; load *= 2)
+    {
+      std::vector<Signal> signals;
+      int64_t t = 0;
+      for (uint32_t i = 0; i < nSignals; ++i)
+        {
+          Signal s;
+          s.start = t;
+          s.end = t + rng->GetInteger (100000, 1500000);
+          s.powerW = 1e-10 * std::pow (10.0, rng->GetInteger (0, levels - 1) / 2.0);
+          signals.push_back (s);
+          t += rng->GetInteger (0, 1600000 / load);
+        }
+
+      // Each signal is received once it ended, with the changes of the
+      // signals that overlap it; older changes are dropped as it goes.
+      std::vector<double> mapPsr (nSignals);
+      std::vector<double> bufferPsr (nSignals);
+      SystemWallClockMs clock;
+      clock.Start ();
+      {
+        NiChanges changes;
+        uint32_t added = 0;
+        for (uint32_t i = 0; i < nSignals; ++i)
+          {
+            while (added < nSignals && signals[added].start < signals[i].end)
+              {
+                changes.Add (signals[added++]);
+              }
+            mapPsr[i] = changes.Receive (signals[i], noiseW, bitsPerNs);
+            changes.EraseBefore (i + 1 < nSignals ? signals[i + 1].start : signals[i].end);
+          }
+      }
+      double mapNs = 1e6 * clock.End () / nSignals;
+
+      g_cache.clear ();
+      uint64_t lookups = 0;
+      uint64_t maxChanges = 0;
+      std::vector<int64_t> boundaries;
+      std::vector<double> interference;
+      std::vector<double> snr;
+      clock.Start ();
+      {
+        InterferenceBuffer buffer;
+        uint32_t added = 0;
+        for (uint32_t i = 0; i < nSignals; ++i)
+          {
+            while (added < nSignals && signals[added].start < signals[i].end)
+              {
+                buffer.Add (signals[added].start, signals[added].end, signals[added].powerW);
+                ++added;
+              }
+            uint32_t n = buffer.GetChunks (signals[i].start, signals[i].end, signals[i].powerW,
+                                           boundaries, interference);
+            InterferenceBuffer::GetSnrs (signals[i].powerW, noiseW, interference, snr);
+            double psr = 1;
+            for (uint32_t k = 0; k < n; ++k)
+              {
+                psr *= std::pow (CachedBitSuccessRate (snr[k]),
+                                 static_cast<double> ((boundaries[k + 1] - boundaries[k]) * bitsPerNs));
+              }
+            lookups += n;
+            bufferPsr[i] = psr;
+            maxChanges = std::max<uint64_t> (maxChanges, buffer.GetNChanges ());
+            buffer.EraseBefore (i + 1 < nSignals ? signals[i + 1].start : signals[i].end);
+          }
+      }
+      double bufferNs = 1e6 * clock.End () / nSignals;
+
+      double maxDiff = 0;
+      for (uint32_t i = 0; i < nSignals; ++i)
+        {
+          maxDiff = std::max (maxDiff, std::abs (mapPsr[i] - bufferPsr[i]));
+        }
+      LOG (std::setw (g_fwidth) << load << std::setw (g_fwidth) << mapNs
+           << std::setw (g_fwidth) << bufferNs
+           << std::setw (g_fwidth) << (bufferNs > 0 ? mapNs / bufferNs : 0)
+           << std::setw (g_fwidth) << maxChanges
+           << std::setw (g_fwidth) << (lookups > 0 ? 1 - static_cast<double> (g_cache.size ()) / lookups : 0)
+           << std::setw (g_fwidth) << maxDiff);
+    }
+  return 0;
+}
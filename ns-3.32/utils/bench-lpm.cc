@@ -0,0 +1,252 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <utility>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "../abc/lpm-trie.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 12;
+
+// Keeps lookup results alive
+volatile uint64_t g_sink;
+
+/// A route of the linear table.
+struct Route
+{
+  LpmKey key;       //!< Destination network
+  uint8_t length;   //!< Prefix length
+  uint32_t metric;  //!< Metric
+};
+
+/**
+ * \param key an address
+ * \param length prefix length
+ * \return the address with the bits past the prefix cleared
+ */
+LpmKey
+Mask (LpmKey key, uint32_t length)
+{
+  key.hi = length == 0 ? 0 : length >= 64 ? key.hi : key.hi & ~(~static_cast<uint64_t> (0) >> length);
+  key.lo = length <= 64 ? 0 : length >= 128 ? key.lo : key.lo & ~(~static_cast<uint64_t> (0) >> (length - 64));
+  return key;
+}
+
+/**
+ * The Ipv4StaticRouting::LookupStatic scan: longest prefix, then lowest
+ * metric, over a linked list.
+ * \param routes the routes
+ * \param key destination
+ * \param width address width, 32 or 128
+ * \return the route, or 0
+ */
+const Route *
+LinearLookup (const std::list<Route> &routes, const LpmKey &key, uint32_t width)
+{
+  const Route *best = 0;
+  uint32_t longest = 0;
+  uint32_t shortestMetric = 0xffffffff;
+  for (std::list<Route>::const_iterator r = routes.begin (); r != routes.end (); ++r)
+    {
+      LpmKey masked = Mask (key, r->length);
+      if (masked.hi != r->key.hi || masked.lo != r->key.lo || r->length < longest)
+        {
+          continue;
+        }
+      if (r->length > longest)
+        {
+          shortestMetric = 0xffffffff;
+        }
+      longest = r->length;
+      if (r->metric > shortestMetric)
+        {
+          continue;
+        }
+      shortestMetric = r->metric;
+      best = &*r;
+      if (longest == width)
+        {
+          break;
+        }
+    }
+  return best;
+}
+
+/**
+ * Generate a data-center style table: mostly host routes, some subnets
+ * and a default route.
+ * \param n number of routes
+ * \param ipv6 IPv6 addresses instead of IPv4
+ * \param rng random numbers
+ * \return the routes
+ */
+std::list<Route>
+MakeRoutes (uint32_t n, bool ipv6, Ptr<UniformRandomVariable> rng)
+{
+  std::list<Route> routes;
+  uint32_t width = ipv6 ? 128 : 32;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Route r;
+      double u = rng->GetValue ();
+      r.length = i == 0 ? 0 : u < 0.7 ? width : ipv6 ? rng->GetInteger (48, 64) : rng->GetInteger (16, 30);
+      r.metric = rng->GetInteger (1, 3);
+      if (ipv6)
+        {
+          r.key.hi = (static_cast<uint64_t> (0x20010db8) << 32) | rng->GetInteger (0, 0xffff);
+          r.key.lo = rng->GetInteger (0, 0xfffff);
+        }
+      else
+        {
+          r.key = LpmKey::FromIpv4 ((10u << 24) | rng->GetInteger (0, 0xfffff));
+        }
+      r.key = Mask (r.key, r.length);
+      routes.push_back (r);
+    }
+  return routes;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t minRoutes = 1000;
+  uint32_t maxRoutes = 100000;
+  uint32_t nLookups = 1000000;
+  uint32_t nLinearLookups = 2000;
+  bool ipv6 = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark route lookups: the linear scan of Ipv4StaticRouting\n"
+             "against the LpmTrie of Ipv4LpmStaticRouting.\n"
+             "\n"
+             "Table sizes grow tenfold from minRoutes to maxRoutes; 70% of\n"
+             "the routes are host routes.  Both lookups are checked to\n"
+             "return the same route.");
+  cmd.AddValue ("minRoutes", "smallest table", minRoutes);
+  cmd.AddValue ("maxRoutes", "largest table", maxRoutes);
+  cmd.AddValue ("lookups", "trie lookups per table", nLookups);
+  cmd.AddValue ("linearLookups", "linear lookups per table", nLinearLookups);
+  cmd.AddValue ("ipv6", "IPv6 routes instead of IPv4", ipv6);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  uint32_t width = ipv6 ? 128 : 32;
+
+  LOG (std::setw (g_fwidth) << "routes" << std::setw (g_fwidth) << "build (ms)"
+       << std::setw (g_fwidth) << "trie (ns)" << std::setw (g_fwidth) << "linear (ns)"
+       << std::setw (g_fwidth) << "speedup" << std::setw (g_fwidth) << "nodes"
+       << std::setw (g_fwidth) << "size (KB)" << std::setw (g_fwidth) << "mismatches");
+  for (uint32_t n = minRoutes; n <= maxRoutes; n *= 10)
+    {
+      std::list<Route> routes = MakeRoutes (n, ipv6, rng);
+
+      // Same precedence as the scan, as Ipv4LpmStaticRouting sorts it.
+      std::vector<std::pair<const Route *, uint32_t> > order;
+      for (std::list<Route>::const_iterator r = routes.begin (); r != routes.end (); ++r)
+        {
+          order.push_back (std::make_pair (&*r, order.size ()));
+        }
+      std::sort (order.begin (), order.end (), [width] (const std::pair<const Route *, uint32_t> &a,
+                                                        const std::pair<const Route *, uint32_t> &b)
+      {
+        if (a.first->length != b.first->length)
+          {
+            return a.first->length > b.first->length;
+          }
+        if (a.first->length == width)
+          {
+            return a.second < b.second;
+          }
+        if (a.first->metric != b.first->metric)
+          {
+            return a.first->metric < b.first->metric;
+          }
+        return a.second > b.second;
+      });
+      std::vector<const Route *> sorted;
+      std::vector<LpmTrie::Prefix> prefixes;
+      for (uint32_t i = 0; i < order.size (); ++i)
+        {
+          sorted.push_back (order[i].first);
+          LpmTrie::Prefix prefix;
+          prefix.key = order[i].first->key;
+          prefix.length = order[i].first->length;
+          prefixes.push_back (prefix);
+        }
+
+      SystemWallClockMs clock;
+      clock.Start ();
+      LpmTrie trie;
+      trie.Build (prefixes);
+      int64_t buildMs = clock.End ();
+
+      // Destinations near the routes, so that most lookups hit one.
+      std::vector<LpmKey> keys;
+      for (uint32_t i = 0; i < std::max (nLookups, nLinearLookups); ++i)
+        {
+          LpmKey key = sorted[rng->GetInteger (0, n - 1)]->key;
+          if (ipv6)
+            {
+              key.lo ^= rng->GetInteger (0, 0xff);
+            }
+          else
+            {
+              key.hi ^= static_cast<uint64_t> (rng->GetInteger (0, 0xff)) << 32;
+            }
+          keys.push_back (key);
+        }
+
+      uint64_t sum = 0;
+      clock.Start ();
+      for (uint32_t i = 0; i < nLookups; ++i)
+        {
+          sum += trie.Lookup (keys[i]);
+        }
+      double trieNs = 1e6 * clock.End () / nLookups;
+
+      uint32_t mismatches = 0;
+      clock.Start ();
+      for (uint32_t i = 0; i < nLinearLookups; ++i)
+        {
+          sum += LinearLookup (routes, keys[i], width) != 0;
+        }
+      double linearNs = 1e6 * clock.End () / nLinearLookups;
+      for (uint32_t i = 0; i < nLinearLookups; ++i)
+        {
+          uint32_t t = trie.Lookup (keys[i]);
+          mismatches += LinearLookup (routes, keys[i], width) != (t == LpmTrie::NONE ? 0 : sorted[t]);
+        }
+
+      LOG (std::setw (g_fwidth) << n << std::setw (g_fwidth) << buildMs
+           << std::setw (g_fwidth) << trieNs << std::setw (g_fwidth) << linearNs
+           << std::setw (g_fwidth) << (trieNs > 0 ? linearNs / trieNs : 0)
+           << std::setw (g_fwidth) << trie.GetNNodes ()
+           << std::setw (g_fwidth) << trie.GetMemory () / 1024
+           << std::setw (g_fwidth) << mismatches);
+      g_sink = sum;
+    }
+  return 0;
+}
@@ -0,0 +1,371 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "../abc/minstrel-rate-table.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 12;
+
+/// The per-rate statistics of MinstrelWifiManager.
+struct RateInfo
+{
+  Time perfectTxTime;             //!< Duration of a reference frame
+  uint32_t retryCount;            //!< Retry limit
+  uint32_t adjustedRetryCount;    //!< Adjusted retry limit
+  uint32_t numRateAttempt;        //!< Attempts since the last update
+  uint32_t numRateSuccess;        //!< Successes since the last update
+  uint32_t prob;                  //!< Last success probability, percent
+  double ewmaProb;                //!< EWMA success probability
+  double throughput;              //!< Throughput
+  uint32_t prevNumRateAttempt;    //!< Attempts of the previous interval
+  uint32_t prevNumRateSuccess;    //!< Successes of the previous interval
+  uint64_t successHist;           //!< Successes since the start
+  uint64_t attemptHist;           //!< Attempts since the start
+  uint8_t numSamplesSkipped;      //!< Intervals without attempts
+  int sampleLimit;                //!< Sampling limit
+};
+
+/**
+ * A station of MinstrelWifiManager: allocated on its own, with its rate
+ * table, its own sample table and its own update event.
+ */
+struct MinstrelStation
+{
+  std::vector<RateInfo> table;                   //!< Rate statistics
+  std::vector<std::vector<uint8_t> > sampleTable; //!< Rate permutations
+  uint32_t packets;                              //!< Frames
+  uint32_t samples;                              //!< Of which sampled
+  uint8_t row;                                   //!< Next sample row
+  uint8_t column;                                //!< Next sample column
+  uint8_t best;                                  //!< Best throughput rate
+  uint8_t second;                                //!< Second best
+  uint8_t maxProb;                               //!< Highest probability
+  EventId update;                                //!< Next statistics update
+};
+
+/// Both implementations over the same stations.
+struct Bench
+{
+  uint8_t nRates;                          //!< Number of rates
+  std::vector<Time> txTimes;               //!< Reference frame duration per rate
+  std::vector<uint8_t> cutoff;             //!< Highest reliable rate of each station
+  Ptr<UniformRandomVariable> rng;          //!< Losses and sample tables
+  Time interval;                           //!< Update interval
+  Time packetInterval;                     //!< Time between frames of a station
+  std::vector<MinstrelStation *> stations; //!< MinstrelWifiManager stations
+  MinstrelRateTable *table;                //!< Rate table
+};
+
+/**
+ * \param bench the bench
+ * \param station a station
+ * \param rate a rate
+ * \return true if a frame at that rate gets through
+ */
+bool
+Succeeds (Bench &bench, uint32_t station, uint8_t rate)
+{
+  uint8_t c = bench.cutoff[station];
+  double p = rate < c ? 0.95 : (rate == c ? 0.6 : 0.05);
+  return bench.rng->GetValue () < p;
+}
+
+/**
+ * \param bench the bench
+ * \param station a station
+ * \return the rate with the best expected throughput
+ */
+uint8_t
+GetIdealRate (const Bench &bench, uint32_t station)
+{
+  uint8_t best = 0;
+  double bestTp = 0;
+  for (uint8_t r = 0; r < bench.nRates; ++r)
+    {
+      uint8_t c = bench.cutoff[station];
+      double p = r < c ? 0.95 : (r == c ? 0.6 : 0.05);
+      double tp = p / bench.txTimes[r].GetSeconds ();
+      if (tp > bestTp)
+        {
+          bestTp = tp;
+          best = r;
+        }
+    }
+  return best;
+}
+
+/**
+ * MinstrelWifiManager::UpdateStats, on the timer of the station.
+ * \param bench the bench
+ * \param st the station
+ */
+void
+UpdateStats (Bench *bench, MinstrelStation *st)
+{
+  for (uint8_t i = 0; i < bench->nRates; ++i)
+    {
+      RateInfo &ri = st->table[i];
+      if (ri.numRateAttempt > 0)
+        {
+          ri.numSamplesSkipped = 0;
+          double tempProb = static_cast<double> (ri.numRateSuccess) / ri.numRateAttempt;
+          ri.prob = static_cast<uint32_t> (tempProb * 100);
+          if (ri.successHist == 0)
+            {
+              ri.ewmaProb = tempProb;
+            }
+          else
+            {
+              ri.ewmaProb = (tempProb * 25 + ri.ewmaProb * 75) / 100;
+            }
+        }
+      else
+        {
+          ++ri.numSamplesSkipped;
+        }
+      ri.throughput = ri.ewmaProb < 0.1 ? 0 : ri.ewmaProb * (1e6 / ri.perfectTxTime.GetMicroSeconds ());
+      ri.successHist += ri.numRateSuccess;
+      ri.attemptHist += ri.numRateAttempt;
+      ri.prevNumRateSuccess = ri.numRateSuccess;
+      ri.prevNumRateAttempt = ri.numRateAttempt;
+      ri.numRateSuccess = 0;
+      ri.numRateAttempt = 0;
+    }
+  double maxTp = 0;
+  double maxProb = 0;
+  st->best = 0;
+  st->maxProb = 0;
+  for (uint8_t i = 0; i < bench->nRates; ++i)
+    {
+      if (st->table[i].throughput > maxTp)
+        {
+          maxTp = st->table[i].throughput;
+          st->best = i;
+        }
+      if (st->table[i].ewmaProb > maxProb)
+        {
+          maxProb = st->table[i].ewmaProb;
+          st->maxProb = i;
+        }
+    }
+  double secondTp = 0;
+  st->second = 0;
+  for (uint8_t i = 0; i < bench->nRates; ++i)
+    {
+      if (i != st->best && st->table[i].throughput > secondTp)
+        {
+          secondTp = st->table[i].throughput;
+          st->second = i;
+        }
+    }
+  st->update = Simulator::Schedule (bench->interval, &UpdateStats, bench, st);
+}
+
+/**
+ * One frame of every station, through MinstrelWifiManager.
+ * \param bench the bench
+ */
+void
+SendMinstrel (Bench *bench)
+{
+  for (uint32_t s = 0; s < bench->stations.size (); ++s)
+    {
+      MinstrelStation *st = bench->stations[s];
+      uint8_t rate = st->best;
+      ++st->packets;
+      if (st->samples * 100 < st->packets * 10)
+        {
+          uint8_t sample = st->sampleTable[st->row][st->column];
+          if (++st->row == bench->nRates)
+            {
+              st->row = 0;
+              st->column = (st->column + 1) % MinstrelRateTable::SAMPLE_COLUMNS;
+            }
+          if (sample != st->best)
+            {
+              ++st->samples;
+              rate = sample;
+            }
+        }
+      ++st->table[rate].numRateAttempt;
+      if (Succeeds (*bench, s, rate))
+        {
+          ++st->table[rate].numRateSuccess;
+        }
+    }
+  Simulator::Schedule (bench->packetInterval, &SendMinstrel, bench);
+}
+
+/**
+ * One frame of every station, through the rate table.
+ * \param bench the bench
+ */
+void
+SendTable (Bench *bench)
+{
+  uint32_t n = bench->table->GetNStations ();
+  for (uint32_t s = 0; s < n; ++s)
+    {
+      uint8_t rate = bench->table->FindRate (s);
+      bench->table->NotifyTx (s, rate, 1, Succeeds (*bench, s, rate) ? 1 : 0);
+    }
+  Simulator::Schedule (bench->packetInterval, &SendTable, bench);
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nStations = 1000;
+  uint32_t packetsPerInterval = 10;
+  double duration = 10;
+  double interval = 0.1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark MinstrelRateTable against the statistics of\n"
+             "MinstrelWifiManager, each station with its rate table, sample\n"
+             "table and update event.\n"
+             "\n"
+             "The stations of an AP each send packetsPerInterval frames per\n"
+             "update interval.  A station gets 95% of its frames through\n"
+             "below a random rate, 60% at that rate and 5% above; ideal is\n"
+             "the share of stations whose best rate is the one with the best\n"
+             "expected throughput at the end.");
+  cmd.AddValue ("stations", "stations per AP", nStations);
+  cmd.AddValue ("packets", "frames per station and update interval", packetsPerInterval);
+  cmd.AddValue ("duration", "simulated time (s)", duration);
+  cmd.AddValue ("interval", "update interval (s)", interval);
+  cmd.Parse (argc, argv);
+
+  LOG (std::setw (g_fwidth) << "rates" << std::setw (g_fwidth) << "ns3 (ms)"
+       << std::setw (g_fwidth) << "table (ms)" << std::setw (g_fwidth) << "speedup"
+       << std::setw (g_fwidth) << "ns3 B/sta" << std::setw (g_fwidth) << "table B/sta"
+       << std::setw (g_fwidth) << "ns3 ideal" << std::setw (g_fwidth) << "table ideal");
+  uint8_t rates[] = {8, 32, 128};
+  for (uint32_t k = 0; k < sizeof (rates) / sizeof (rates[0]); ++k)
+    {
+      Bench bench;
+      bench.nRates = rates[k];
+      bench.rng = CreateObject<UniformRandomVariable> ();
+      bench.rng->SetStream (1);
+      bench.interval = Seconds (interval);
+      bench.packetInterval = Seconds (interval / packetsPerInterval);
+      for (uint8_t r = 0; r < bench.nRates; ++r)
+        {
+          // 1500 bytes from 6.5 Mb/s up, plus preamble.
+          bench.txTimes.push_back (MicroSeconds (40 + 1846 / (r + 1)));
+        }
+      for (uint32_t s = 0; s < nStations; ++s)
+        {
+          bench.cutoff.push_back (bench.rng->GetInteger (0, bench.nRates - 1));
+        }
+
+      for (uint32_t s = 0; s < nStations; ++s)
+        {
+          MinstrelStation *st = new MinstrelStation ();
+          st->table.resize (bench.nRates);
+          for (uint8_t r = 0; r < bench.nRates; ++r)
+            {
+              RateInfo &ri = st->table[r];
+              ri = RateInfo ();
+              ri.perfectTxTime = bench.txTimes[r];
+            }
+          st->sampleTable.assign (bench.nRates, std::vector<uint8_t> (MinstrelRateTable::SAMPLE_COLUMNS, 0xff));
+          for (uint8_t col = 0; col < MinstrelRateTable::SAMPLE_COLUMNS; ++col)
+            {
+              for (uint8_t r = 0; r < bench.nRates; ++r)
+                {
+                  uint32_t row = bench.rng->GetInteger (0, bench.nRates - 1);
+                  while (st->sampleTable[row][col] != 0xff)
+                    {
+                      row = (row + 1) % bench.nRates;
+                    }
+                  st->sampleTable[row][col] = r;
+                }
+            }
+          st->packets = 0;
+          st->samples = 0;
+          st->row = bench.rng->GetInteger (0, bench.nRates - 1);
+          st->column = 0;
+          st->best = 0;
+          st->second = 0;
+          st->maxProb = 0;
+          // Stations come up at different times, so do their timers.
+          st->update = Simulator::Schedule (TimeStep (bench.interval.GetTimeStep () * (s + 1) / nStations),
+                                            &UpdateStats, &bench, st);
+          bench.stations.push_back (st);
+        }
+      Simulator::Schedule (Seconds (0), &SendMinstrel, &bench);
+      Simulator::Stop (Seconds (duration));
+      SystemWallClockMs clock;
+      clock.Start ();
+      Simulator::Run ();
+      int64_t minstrelMs = clock.End ();
+      uint32_t minstrelIdeal = 0;
+      for (uint32_t s = 0; s < nStations; ++s)
+        {
+          minstrelIdeal += bench.stations[s]->best == GetIdealRate (bench, s);
+        }
+      uint32_t minstrelBytes = sizeof (MinstrelStation)
+        + bench.nRates * (sizeof (RateInfo) + sizeof (std::vector<uint8_t>) + MinstrelRateTable::SAMPLE_COLUMNS);
+      Simulator::Destroy ();
+      for (uint32_t s = 0; s < nStations; ++s)
+        {
+          delete bench.stations[s];
+        }
+      bench.stations.clear ();
+
+      MinstrelRateTable table (bench.nRates);
+      table.AssignStreams (2);
+      for (uint8_t r = 0; r < bench.nRates; ++r)
+        {
+          table.SetTxTime (r, bench.txTimes[r]);
+        }
+      for (uint32_t s = 0; s < nStations; ++s)
+        {
+          table.AddStation ();
+        }
+      bench.table = &table;
+      table.Start (bench.interval);
+      Simulator::Schedule (Seconds (0), &SendTable, &bench);
+      Simulator::Stop (Seconds (duration));
+      clock.Start ();
+      Simulator::Run ();
+      int64_t tableMs = clock.End ();
+      table.Stop ();
+      Simulator::Destroy ();
+      uint32_t tableIdeal = 0;
+      for (uint32_t s = 0; s < nStations; ++s)
+        {
+          tableIdeal += table.GetBestRate (s) == GetIdealRate (bench, s);
+        }
+
+      LOG (std::setw (g_fwidth) << +bench.nRates << std::setw (g_fwidth) << minstrelMs
+           << std::setw (g_fwidth) << tableMs
+           << std::setw (g_fwidth) << (tableMs > 0 ? static_cast<double> (minstrelMs) / tableMs : 0)
+           << std::setw (g_fwidth) << minstrelBytes << std::setw (g_fwidth) << table.GetBytesPerStation ()
+           << std::setw (g_fwidth) << 100.0 * minstrelIdeal / nStations
+           << std::setw (g_fwidth) << 100.0 * tableIdeal / nStations);
+    }
+  return 0;
+}
@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "../abc/olsr-incremental.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 12;
+
+/// A link change: the link, and whether it is added.
+typedef std::pair<std::pair<uint32_t, uint32_t>, bool> Change;
+
+/**
+ * Apply the changes and time them.
+ * \param state OLSR state
+ * \param changes link changes
+ * \return wall-clock milliseconds per change
+ */
+double
+ApplyChanges (OlsrIncrementalState &state, const std::vector<Change> &changes)
+{
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (std::vector<Change>::const_iterator c = changes.begin (); c != changes.end (); ++c)
+    {
+      if (c->second)
+        {
+          state.AddLink (c->first.first, c->first.second);
+        }
+      else
+        {
+          state.RemoveLink (c->first.first, c->first.second);
+        }
+    }
+  return static_cast<double> (clock.End ()) / changes.size ();
+}
+
+/**
+ * Count the hop counts and MPR sets on which two states disagree.
+ * \param a first state
+ * \param b second state
+ * \return the number of mismatches
+ */
+uint64_t
+Compare (const OlsrIncrementalState &a, const OlsrIncrementalState &b)
+{
+  uint64_t bad = 0;
+  uint32_t n = a.GetNNodes ();
+  for (uint32_t src = 0; src < n; ++src)
+    {
+      bad += a.GetMprSet (src) != b.GetMprSet (src);
+      for (uint32_t dst = 0; dst < n; ++dst)
+        {
+          bad += a.GetDistance (src, dst) != b.GetDistance (src, dst);
+        }
+    }
+  return bad;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t minSide = 10;
+  uint32_t maxSide = 40;
+  uint32_t sideStep = 10;
+  uint32_t nChanges = 100;
+  bool verify = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark incremental OLSR MPR and routing table updates.\n"
+             "\n"
+             "Nodes form a square grid with links to their four\n"
+             "neighbours.  Each change flips a random grid link; OLSR\n"
+             "recomputes every MPR set and routing table, while\n"
+             "OlsrIncrementalState repairs the affected entries only.");
+  cmd.AddValue ("minSide", "smallest grid side", minSide);
+  cmd.AddValue ("maxSide", "largest grid side", maxSide);
+  cmd.AddValue ("sideStep", "grid side increment", sideStep);
+  cmd.AddValue ("changes", "link changes per grid size", nChanges);
+  cmd.AddValue ("verify", "check that both methods agree", verify);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  LOG (std::setw (g_fwidth) << "side" << std::setw (g_fwidth) << "nodes"
+       << std::setw (g_fwidth) << "full (ms)" << std::setw (g_fwidth) << "incr (ms)"
+       << std::setw (g_fwidth) << "speedup" << std::setw (g_fwidth) << "entries"
+       << std::setw (g_fwidth) << "mprs");
+  for (uint32_t side = minSide; side <= maxSide; side += sideStep)
+    {
+      uint32_t n = side * side;
+      std::vector<std::pair<uint32_t, uint32_t> > links;
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          if (i % side + 1 < side)
+            {
+              links.push_back (std::make_pair (i, i + 1));
+            }
+          if (i + side < n)
+            {
+              links.push_back (std::make_pair (i, i + side));
+            }
+        }
+
+      OlsrIncrementalState full (n);
+      OlsrIncrementalState incr (n);
+      for (uint32_t i = 0; i < links.size (); ++i)
+        {
+          full.AddLink (links[i].first, links[i].second);
+          incr.AddLink (links[i].first, links[i].second);
+        }
+      full.SetIncremental (false);
+
+      // Flip random links, so that the grid stays mostly connected.
+      std::vector<bool> up (links.size (), true);
+      std::vector<Change> changes;
+      for (uint32_t c = 0; c < nChanges; ++c)
+        {
+          uint32_t l = rng->GetInteger (0, links.size () - 1);
+          up[l] = !up[l];
+          changes.push_back (std::make_pair (links[l], static_cast<bool> (up[l])));
+        }
+
+      uint64_t entries = incr.GetNSptUpdates ();
+      uint64_t mprs = incr.GetNMprComputations ();
+      double fullMs = ApplyChanges (full, changes);
+      double incrMs = ApplyChanges (incr, changes);
+      LOG (std::setw (g_fwidth) << side << std::setw (g_fwidth) << n
+           << std::setw (g_fwidth) << fullMs << std::setw (g_fwidth) << incrMs
+           << std::setw (g_fwidth) << (incrMs > 0 ? fullMs / incrMs : 0)
+           << std::setw (g_fwidth) << (incr.GetNSptUpdates () - entries) / nChanges
+           << std::setw (g_fwidth) << (incr.GetNMprComputations () - mprs) / nChanges);
+      if (verify)
+        {
+          LOG ("  mismatches: " << Compare (full, incr));
+        }
+    }
+  return 0;
+}
@@ -0,0 +1,906 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "../abc/power-rate-station-store.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 12;
+
+// Rate and power changes seen by the trace sinks
+uint64_t g_changes = 0;
+
+// Rates of 802.11a, in bit/s
+const uint64_t g_rates[] = { 6000000, 9000000, 12000000, 18000000, 24000000, 36000000, 48000000, 54000000 };
+const uint8_t g_nRates = 8;
+
+// Frame and ack durations at those rates, in microseconds
+const int64_t g_txTimes[] = { 1900, 1300, 1000, 700, 560, 400, 320, 290 };
+
+// Power levels, from 0 to g_maxPower, g_powerStep dB apart
+const uint8_t g_maxPower = 17;
+const double g_minPowerDbm = 0;
+const double g_powerStep = 1;
+
+// Distance classes of the stations
+const uint32_t g_nClasses = 16;
+
+/**
+ * Rate or power change trace sink of PowerRateStationStore.
+ * \param station the station
+ * \param oldLevel previous level
+ * \param newLevel new level
+ */
+void
+LevelChange (uint32_t station, uint8_t oldLevel, uint8_t newLevel)
+{
+  ++g_changes;
+}
+
+/// WifiRemoteStationState, allocated on its own.
+struct LegacyState
+{
+  Mac48Address address;     //!< Address of the station
+  uint32_t aid;             //!< Association ID
+  bool qosSupported;        //!< QoS support
+  uint16_t channelWidth;    //!< Channel width
+  uint8_t guardInterval;    //!< Guard interval
+  uint8_t ness;             //!< Extension spatial streams
+  std::vector<uint8_t> operationalSet;  //!< Supported rates
+};
+
+/**
+ * The state of a station common to the ns-3 power control managers:
+ * WifiRemoteStation, allocated with the subclass of the manager, and its
+ * WifiRemoteStationState.
+ */
+struct LegacyStation
+{
+  virtual ~LegacyStation ()
+  {
+    delete state;
+  }
+  /// \return the bytes of the station, its allocations included
+  virtual uint32_t GetBytes (void) const = 0;
+
+  LegacyState *state;       //!< Address and capabilities
+  uint8_t tid;              //!< WifiRemoteStation::m_tid
+  uint8_t nSupported;       //!< Number of supported rates
+  bool initialized;         //!< Whether the station was set up
+  uint8_t rate;             //!< Current rate index
+  uint8_t prevRate;         //!< Rate of the previous frame
+  uint8_t power;            //!< Current power level
+  uint8_t prevPower;        //!< Power of the previous frame
+};
+
+/**
+ * Reports go through a virtual call to the station's manager, and the
+ * PowerChange and RateChange traces are fired with dBm, DataRate and the
+ * address at every frame whose power or rate changed, as
+ * DoGetDataTxVector does, connected or not.
+ */
+class LegacyManager
+{
+public:
+  virtual ~LegacyManager ()
+  {
+    for (std::vector<LegacyStation *>::iterator s = m_stations.begin (); s != m_stations.end (); ++s)
+      {
+        delete *s;
+      }
+  }
+
+  /**
+   * \param s a station
+   * \param rate its rate for the next frame
+   * \param power its power level for the next frame
+   */
+  void GetDataTxVector (uint32_t s, uint8_t &rate, uint8_t &power)
+  {
+    LegacyStation *st = m_stations[s];
+    if (st->prevPower != st->power)
+      {
+        m_powerChange (g_minPowerDbm + st->prevPower * g_powerStep,
+                       g_minPowerDbm + st->power * g_powerStep, st->state->address);
+        st->prevPower = st->power;
+      }
+    if (st->prevRate != st->rate)
+      {
+        m_rateChange (DataRate (g_rates[st->prevRate]), DataRate (g_rates[st->rate]), st->state->address);
+        st->prevRate = st->rate;
+      }
+    rate = st->rate;
+    power = st->power;
+  }
+
+  /// \param s a station whose frame got through
+  void ReportDataOk (uint32_t s)
+  {
+    DoReportDataOk (m_stations[s]);
+  }
+
+  /// \param s a station whose frame failed
+  void ReportDataFailed (uint32_t s)
+  {
+    DoReportDataFailed (m_stations[s]);
+  }
+
+  /// \return the bytes per station
+  uint32_t GetBytesPerStation (void) const
+  {
+    // 16 bytes of allocator overhead per block.
+    return m_stations[0]->GetBytes () + 16 + sizeof (LegacyState) + 16 + g_nRates + 16
+           + sizeof (LegacyStation *);
+  }
+
+protected:
+  /// \param st a station whose frame got through
+  virtual void DoReportDataOk (LegacyStation *st) = 0;
+  /// \param st a station whose frame failed
+  virtual void DoReportDataFailed (LegacyStation *st) = 0;
+
+  /**
+   * \param st a new station
+   * \param s its index
+   */
+  void Init (LegacyStation *st, uint32_t s)
+  {
+    uint8_t buffer[6] = { 0, 0, static_cast<uint8_t> (s >> 24), static_cast<uint8_t> (s >> 16),
+                          static_cast<uint8_t> (s >> 8), static_cast<uint8_t> (s) };
+    st->state = new LegacyState;
+    st->state->address.CopyFrom (buffer);
+    st->state->aid = s;
+    st->state->qosSupported = false;
+    st->state->channelWidth = 20;
+    st->state->guardInterval = 0;
+    st->state->ness = 0;
+    for (uint8_t i = 0; i < g_nRates; ++i)
+      {
+        st->state->operationalSet.push_back (i);
+      }
+    st->tid = 0;
+    st->nSupported = g_nRates;
+    st->initialized = true;
+    st->rate = 0;
+    st->prevRate = 0;
+    st->power = g_maxPower;
+    st->prevPower = g_maxPower;
+    m_stations.push_back (st);
+  }
+
+  std::vector<LegacyStation *> m_stations;                     //!< Stations
+  TracedCallback<double, double, Mac48Address> m_powerChange;     //!< PowerChange
+  TracedCallback<DataRate, DataRate, Mac48Address> m_rateChange;  //!< RateChange
+};
+
+/// ParfWifiRemoteStation.
+struct LegacyParfStation : public LegacyStation
+{
+  uint32_t nAttempt;        //!< Attempts
+  uint32_t nSuccess;        //!< Successes
+  uint32_t nFail;           //!< Failures
+  bool recoveryRate;        //!< Just raised the rate
+  bool recoveryPower;       //!< Just lowered the power
+  uint32_t nRetry;          //!< Consecutive failures
+
+  uint32_t GetBytes (void) const
+  {
+    return sizeof (*this);
+  }
+};
+
+/// ParfWifiManager.
+class LegacyParf : public LegacyManager
+{
+public:
+  /// \param n number of stations
+  LegacyParf (uint32_t n)
+  {
+    for (uint32_t s = 0; s < n; ++s)
+      {
+        LegacyParfStation *st = new LegacyParfStation;
+        Init (st, s);
+        st->nAttempt = 0;
+        st->nSuccess = 0;
+        st->nFail = 0;
+        st->recoveryRate = false;
+        st->recoveryPower = false;
+        st->nRetry = 0;
+      }
+  }
+
+private:
+  void DoReportDataOk (LegacyStation *station)
+  {
+    LegacyParfStation *st = static_cast<LegacyParfStation *> (station);
+    st->nAttempt++;
+    st->nSuccess++;
+    st->nFail = 0;
+    st->recoveryRate = false;
+    st->recoveryPower = false;
+    st->nRetry = 0;
+    if ((st->nSuccess == 10 || st->nAttempt == 15) && st->rate < st->nSupported - 1)
+      {
+        st->rate++;
+        st->nAttempt = 0;
+        st->nSuccess = 0;
+        st->recoveryRate = true;
+      }
+    else if (st->nSuccess == 10 || st->nAttempt == 15)
+      {
+        if (st->power != 0)
+          {
+            st->power--;
+          }
+        st->nAttempt = 0;
+        st->nSuccess = 0;
+        st->recoveryPower = true;
+      }
+  }
+
+  void DoReportDataFailed (LegacyStation *station)
+  {
+    LegacyParfStation *st = static_cast<LegacyParfStation *> (station);
+    st->nAttempt++;
+    st->nSuccess = 0;
+    st->nRetry++;
+    if (st->recoveryRate)
+      {
+        if (st->nRetry == 1)
+          {
+            if (st->rate != 0)
+              {
+                st->rate--;
+                st->recoveryRate = false;
+              }
+          }
+        st->nAttempt = 0;
+      }
+    else if (st->recoveryPower)
+      {
+        if (st->nRetry == 1)
+          {
+            if (st->power < g_maxPower)
+              {
+                st->power++;
+                st->recoveryPower = false;
+              }
+          }
+        st->nAttempt = 0;
+      }
+    else
+      {
+        if (((st->nRetry - 1) % 2) == 1)
+          {
+            if (st->power == g_maxPower)
+              {
+                if (st->rate != 0)
+                  {
+                    st->rate--;
+                  }
+              }
+            else
+              {
+                st->power++;
+              }
+          }
+        if (st->nRetry >= 2)
+          {
+            st->nAttempt = 0;
+          }
+      }
+  }
+};
+
+/// AparfWifiRemoteStation.
+struct LegacyAparfStation : public LegacyStation
+{
+  uint32_t nSuccess;        //!< Successes
+  uint32_t nFailed;         //!< Failures
+  uint32_t pCount;          //!< Power decreases at the critical rate
+  uint32_t successThreshold; //!< Current success threshold
+  uint8_t critRate;         //!< Critical rate
+  int state;                //!< High, Low or Spread
+
+  uint32_t GetBytes (void) const
+  {
+    return sizeof (*this);
+  }
+};
+
+/// AparfWifiManager.
+class LegacyAparf : public LegacyManager
+{
+public:
+  /// \param n number of stations
+  LegacyAparf (uint32_t n)
+  {
+    for (uint32_t s = 0; s < n; ++s)
+      {
+        LegacyAparfStation *st = new LegacyAparfStation;
+        Init (st, s);
+        st->nSuccess = 0;
+        st->nFailed = 0;
+        st->pCount = 0;
+        st->successThreshold = 3;
+        st->critRate = 0;
+        st->state = 0;
+      }
+  }
+
+private:
+  enum
+  {
+    HIGH, LOW, SPREAD
+  };
+
+  void DoReportDataFailed (LegacyStation *station)
+  {
+    LegacyAparfStation *st = static_cast<LegacyAparfStation *> (station);
+    st->nFailed++;
+    st->nSuccess = 0;
+    if (st->state == LOW)
+      {
+        st->state = HIGH;
+        st->successThreshold = 3;
+      }
+    else if (st->state == SPREAD)
+      {
+        st->state = LOW;
+        st->successThreshold = 10;
+      }
+    if (st->nFailed == 1)
+      {
+        st->nFailed = 0;
+        st->nSuccess = 0;
+        st->pCount = 0;
+        if (st->power == g_maxPower)
+          {
+            st->critRate = st->rate;
+            if (st->rate > 0)
+              {
+                st->rate--;
+              }
+          }
+        else
+          {
+            st->power++;
+          }
+      }
+  }
+
+  void DoReportDataOk (LegacyStation *station)
+  {
+    LegacyAparfStation *st = static_cast<LegacyAparfStation *> (station);
+    st->nSuccess++;
+    st->nFailed = 0;
+    if ((st->state == HIGH || st->state == LOW) && st->nSuccess >= st->successThreshold)
+      {
+        st->state = SPREAD;
+      }
+    else if (st->state == SPREAD)
+      {
+        st->state = HIGH;
+        st->successThreshold = 3;
+      }
+    if (st->nSuccess == st->successThreshold)
+      {
+        st->nSuccess = 0;
+        st->nFailed = 0;
+        if (st->rate == st->nSupported - 1)
+          {
+            if (st->power > 0)
+              {
+                st->power--;
+              }
+          }
+        else if (st->critRate == 0)
+          {
+            st->rate++;
+          }
+        else if (st->pCount == 10)
+          {
+            st->power = g_maxPower;
+            st->rate = st->critRate;
+            st->pCount = 0;
+            st->critRate = 0;
+          }
+        else if (st->power > 0)
+          {
+            st->power--;
+            st->pCount++;
+          }
+      }
+  }
+};
+
+/// RrpaaWifiManager's thresholds of a rate.
+struct RrpaaThresholds
+{
+  double ori;               //!< Opportunistic rate increase threshold
+  double mtl;               //!< Maximum tolerable loss threshold
+  uint32_t ewnd;            //!< Window
+};
+
+/// RrpaaWifiRemoteStation.
+struct LegacyRrpaaStation : public LegacyStation
+{
+  uint32_t counter;                              //!< Remaining window
+  uint32_t nFailed;                              //!< Failures in the window
+  uint32_t adaptiveRtsWnd;                       //!< Adaptive RTS window
+  uint32_t rtsCounter;                           //!< RTS counter
+  Time lastReset;                                //!< Time of the last reset
+  bool adaptiveRtsOn;                            //!< Adaptive RTS
+  bool lastFrameFail;                            //!< Whether the last frame failed
+  std::vector<RrpaaThresholds> thresholds;       //!< Thresholds, per rate
+  std::vector<std::vector<double> > pdTable;     //!< Probabilities, per rate and power
+
+  uint32_t GetBytes (void) const
+  {
+    return sizeof (*this) + thresholds.size () * sizeof (RrpaaThresholds) + 16
+           + pdTable.size () * (sizeof (std::vector<double>) + (g_maxPower + 1) * sizeof (double) + 16) + 16;
+  }
+};
+
+/// RrpaaWifiManager, without adaptive RTS.
+class LegacyRrpaa : public LegacyManager
+{
+public:
+  /// \param n number of stations
+  LegacyRrpaa (uint32_t n)
+    : m_rng (CreateObject<UniformRandomVariable> ())
+  {
+    for (uint32_t s = 0; s < n; ++s)
+      {
+        LegacyRrpaaStation *st = new LegacyRrpaaStation;
+        Init (st, s);
+        st->nFailed = 0;
+        st->adaptiveRtsWnd = 0;
+        st->rtsCounter = 0;
+        st->adaptiveRtsOn = false;
+        st->lastFrameFail = false;
+        st->thresholds.resize (g_nRates);
+        for (uint8_t i = 0; i < g_nRates; ++i)
+          {
+            double t = MicroSeconds (g_txTimes[i]).GetSeconds ();
+            st->thresholds[i].ori = i + 1 < g_nRates ?
+              1.25 * (1 - MicroSeconds (g_txTimes[i + 1]).GetSeconds () / t) / 2 : 0;
+            st->thresholds[i].mtl = i > 0 ? 1.25 * (1 - t / MicroSeconds (g_txTimes[i - 1]).GetSeconds ()) : 1;
+            st->thresholds[i].ewnd = static_cast<uint32_t> (std::ceil (0.015 / t));
+          }
+        st->pdTable.assign (g_nRates, std::vector<double> (g_maxPower + 1, 1));
+        ResetCounters (st);
+      }
+  }
+
+  /// \param stream random stream
+  void AssignStreams (int64_t stream)
+  {
+    m_rng->SetStream (stream);
+  }
+
+private:
+  /// \param st a station
+  void ResetCounters (LegacyRrpaaStation *st)
+  {
+    st->counter = st->thresholds[st->rate].ewnd;
+    st->nFailed = 0;
+    st->lastReset = Simulator::Now ();
+  }
+
+  /// \param st a station
+  void CheckTimeout (LegacyRrpaaStation *st)
+  {
+    if (st->counter == 0 || Simulator::Now ().GetTimeStep () - st->lastReset.GetTimeStep ()
+        > MilliSeconds (50).GetTimeStep ())
+      {
+        ResetCounters (st);
+      }
+  }
+
+  void DoReportDataOk (LegacyStation *station)
+  {
+    LegacyRrpaaStation *st = static_cast<LegacyRrpaaStation *> (station);
+    st->lastFrameFail = false;
+    CheckTimeout (st);
+    st->counter--;
+    RunBasicAlgorithm (st);
+  }
+
+  void DoReportDataFailed (LegacyStation *station)
+  {
+    LegacyRrpaaStation *st = static_cast<LegacyRrpaaStation *> (station);
+    st->lastFrameFail = true;
+    CheckTimeout (st);
+    st->counter--;
+    st->nFailed++;
+    RunBasicAlgorithm (st);
+  }
+
+  /// \param st a station
+  void RunBasicAlgorithm (LegacyRrpaaStation *st)
+  {
+    RrpaaThresholds thresholds = st->thresholds[st->rate];
+    double bploss = st->nFailed / static_cast<double> (thresholds.ewnd);
+    double wploss = (st->counter + st->nFailed) / static_cast<double> (thresholds.ewnd);
+    if (bploss >= thresholds.mtl)
+      {
+        if (st->power < g_maxPower)
+          {
+            st->pdTable[st->rate][st->power] /= 2;
+            st->power++;
+            ResetCounters (st);
+          }
+        else if (st->rate != 0)
+          {
+            st->pdTable[st->rate][st->power] /= 2;
+            st->rate--;
+            ResetCounters (st);
+          }
+      }
+    else if (wploss <= thresholds.ori)
+      {
+        if (st->rate < st->nSupported - 1)
+          {
+            for (uint8_t i = 0; i <= st->rate; i++)
+              {
+                st->pdTable[i][st->power] *= 1.0905;
+                if (st->pdTable[i][st->power] > 1)
+                  {
+                    st->pdTable[i][st->power] = 1;
+                  }
+              }
+            if (m_rng->GetValue (0, 1) < st->pdTable[st->rate + 1][st->power])
+              {
+                st->rate++;
+              }
+          }
+        else if (st->power > 0)
+          {
+            for (uint32_t i = g_maxPower; i > st->power; i--)
+              {
+                st->pdTable[st->rate][i] *= 1.0905;
+                if (st->pdTable[st->rate][i] > 1)
+                  {
+                    st->pdTable[st->rate][i] = 1;
+                  }
+              }
+            if (m_rng->GetValue (0, 1) < st->pdTable[st->rate][st->power - 1])
+              {
+                st->power--;
+              }
+          }
+        ResetCounters (st);
+      }
+    else if (bploss > thresholds.ori && wploss < thresholds.mtl)
+      {
+        if (st->power > 0)
+          {
+            for (uint32_t i = g_maxPower; i >= st->power; i--)
+              {
+                st->pdTable[st->rate][i] *= 1.0905;
+                if (st->pdTable[st->rate][i] > 1)
+                  {
+                    st->pdTable[st->rate][i] = 1;
+                  }
+              }
+            if (m_rng->GetValue (0, 1) < st->pdTable[st->rate][st->power - 1])
+              {
+                st->power--;
+              }
+            ResetCounters (st);
+          }
+      }
+    if (st->counter == 0)
+      {
+        ResetCounters (st);
+      }
+  }
+
+  Ptr<UniformRandomVariable> m_rng;  //!< Probability draws
+};
+
+/**
+ * The stations and their channel: each station is in a distance class,
+ * and a frame succeeds with a probability that drops with the rate and
+ * rises with the power.
+ */
+struct Scenario
+{
+  std::vector<uint8_t> classes;  //!< Distance class of each station
+  std::vector<uint32_t> order;   //!< Order in which the stations send
+  std::vector<float> success;    //!< Per class, rate and power
+  std::vector<float> draws;      //!< Per round and station
+
+  /**
+   * \param s a station
+   * \param round a round
+   * \param rate rate of the frame
+   * \param power power level of the frame
+   * \return whether the frame got through
+   */
+  bool Outcome (uint32_t s, uint32_t round, uint8_t rate, uint8_t power) const
+  {
+    uint32_t i = (classes[s] * g_nRates + rate) * (g_maxPower + 1) + power;
+    return draws[round * classes.size () + s] < success[i];
+  }
+};
+
+/// Result of a run.
+struct Result
+{
+  int64_t ms;                    //!< Wall clock time
+  uint32_t bytes;                //!< Bytes per station
+  std::vector<uint8_t> rate;     //!< Final rate of each station
+  std::vector<uint8_t> power;    //!< Final power of each station
+};
+
+/**
+ * Send one frame per station and round through an ns-3 style manager.
+ * \param manager the manager
+ * \param scenario the stations
+ * \param rounds rounds
+ * \return the run
+ */
+Result
+RunLegacy (LegacyManager &manager, const Scenario &scenario, uint32_t rounds)
+{
+  uint32_t n = scenario.classes.size ();
+  Result r;
+  r.rate.resize (n);
+  r.power.resize (n);
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t round = 0; round < rounds; ++round)
+    {
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          uint32_t s = scenario.order[i];
+          uint8_t rate;
+          uint8_t power;
+          manager.GetDataTxVector (s, rate, power);
+          if (scenario.Outcome (s, round, rate, power))
+            {
+              manager.ReportDataOk (s);
+            }
+          else
+            {
+              manager.ReportDataFailed (s);
+            }
+        }
+    }
+  r.ms = clock.End ();
+  for (uint32_t s = 0; s < n; ++s)
+    {
+      manager.GetDataTxVector (s, r.rate[s], r.power[s]);
+    }
+  r.bytes = manager.GetBytesPerStation ();
+  return r;
+}
+
+/**
+ * Send one frame per station and round through a store based algorithm.
+ * \param store the stations
+ * \param algo the algorithm
+ * \param scenario the stations
+ * \param rounds rounds
+ * \return the run
+ */
+template <typename T>
+Result
+RunStore (Ptr<PowerRateStationStore> store, T &algo, const Scenario &scenario, uint32_t rounds)
+{
+  uint32_t n = scenario.classes.size ();
+  for (uint32_t s = 0; s < n; ++s)
+    {
+      algo.AddStation ();
+    }
+  Result r;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t round = 0; round < rounds; ++round)
+    {
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          uint32_t s = scenario.order[i];
+          if (scenario.Outcome (s, round, store->GetRate (s), store->GetPower (s)))
+            {
+              algo.ReportDataOk (s);
+            }
+          else
+            {
+              algo.ReportDataFailed (s);
+            }
+        }
+    }
+  r.ms = clock.End ();
+  for (uint32_t s = 0; s < n; ++s)
+    {
+      r.rate.push_back (store->GetRate (s));
+      r.power.push_back (store->GetPower (s));
+    }
+  r.bytes = algo.GetBytesPerStation ();
+  return r;
+}
+
+/**
+ * \param sink whether to connect trace sinks to the store
+ * \return a new store
+ */
+Ptr<PowerRateStationStore>
+CreateStore (bool sink)
+{
+  Ptr<PowerRateStationStore> store = CreateObject<PowerRateStationStore> ();
+  if (sink)
+    {
+      store->TraceConnectWithoutContext ("RateChange", MakeCallback (&LevelChange));
+      store->TraceConnectWithoutContext ("PowerChange", MakeCallback (&LevelChange));
+    }
+  return store;
+}
+
+/**
+ * \param algo the algorithm
+ * \param sink whether to connect trace sinks to the store
+ * \param scenario the stations
+ * \param rounds rounds
+ * \return the run
+ */
+Result
+RunStore (const std::string &algo, bool sink, const Scenario &scenario, uint32_t rounds)
+{
+  Ptr<PowerRateStationStore> store = CreateStore (sink);
+  if (algo == "parf")
+    {
+      ParfPowerControl parf (store, g_nRates, 0, g_maxPower);
+      return RunStore (store, parf, scenario, rounds);
+    }
+  if (algo == "aparf")
+    {
+      AparfPowerControl aparf (store, g_nRates, 0, g_maxPower);
+      return RunStore (store, aparf, scenario, rounds);
+    }
+  std::vector<Time> txTimes;
+  for (uint8_t i = 0; i < g_nRates; ++i)
+    {
+      txTimes.push_back (MicroSeconds (g_txTimes[i]));
+    }
+  RrpaaPowerControl rrpaa (store, txTimes, 0, g_maxPower);
+  rrpaa.AssignStreams (1);
+  return RunStore (store, rrpaa, scenario, rounds);
+}
+
+/**
+ * \param algo the algorithm
+ * \param scenario the stations
+ * \param rounds rounds
+ * \return the run
+ */
+Result
+RunLegacy (const std::string &algo, const Scenario &scenario, uint32_t rounds)
+{
+  uint32_t n = scenario.classes.size ();
+  if (algo == "parf")
+    {
+      LegacyParf parf (n);
+      return RunLegacy (parf, scenario, rounds);
+    }
+  if (algo == "aparf")
+    {
+      LegacyAparf aparf (n);
+      return RunLegacy (aparf, scenario, rounds);
+    }
+  LegacyRrpaa rrpaa (n);
+  rrpaa.AssignStreams (1);
+  return RunLegacy (rrpaa, scenario, rounds);
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nStations = 5000;
+  uint32_t rounds = 500;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the PARF, APARF and RRPAA algorithms over\n"
+             "PowerRateStationStore against replicas of ParfWifiManager,\n"
+             "AparfWifiManager and RrpaaWifiManager.\n"
+             "\n"
+             "nStations stations at random distances send one frame each per\n"
+             "round, in a random order; a frame gets through with a\n"
+             "probability that drops with the rate and rises with the power.\n"
+             "The replicas transcribe the report handlers of the ns-3.32\n"
+             "managers, without the adaptive RTS of RRPAA, allocate each\n"
+             "station on its own and fire their traces with no sink; the\n"
+             "store is run without and with sinks (sink ms, changes).  same\n"
+             "is the share of stations that end at the same rate and power\n"
+             "every way, which checks the store against the replicas, not\n"
+             "against the managers themselves.");
+  cmd.AddValue ("nStations", "number of stations", nStations);
+  cmd.AddValue ("rounds", "frames per station", rounds);
+  cmd.Parse (argc, argv);
+
+  Scenario scenario;
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (2);
+  for (uint32_t s = 0; s < nStations; ++s)
+    {
+      scenario.classes.push_back (rng->GetInteger (0, g_nClasses - 1));
+      scenario.order.push_back (s);
+    }
+  // Stations send in no particular order, as in a simulation.
+  for (uint32_t s = nStations - 1; s > 0; --s)
+    {
+      std::swap (scenario.order[s], scenario.order[rng->GetInteger (0, s)]);
+    }
+  for (uint32_t c = 0; c < g_nClasses; ++c)
+    {
+      for (uint8_t rate = 0; rate < g_nRates; ++rate)
+        {
+          for (uint8_t power = 0; power <= g_maxPower; ++power)
+            {
+              // Margin in rate steps: the nearest class supports every
+              // rate at full power, 4 dB make up for one rate step.
+              double margin = g_nRates * (1 - c / static_cast<double> (g_nClasses))
+                - (g_maxPower - power) * g_powerStep / 4 - rate;
+              scenario.success.push_back (1 / (1 + std::exp (-2 * margin)));
+            }
+        }
+    }
+  for (uint32_t i = 0; i < nStations * rounds; ++i)
+    {
+      scenario.draws.push_back (rng->GetValue (0, 1));
+    }
+
+  LOG (std::setw (g_fwidth) << "algo" << std::setw (g_fwidth) << "ns3 ms"
+       << std::setw (g_fwidth) << "store ms" << std::setw (g_fwidth) << "speedup"
+       << std::setw (g_fwidth) << "sink ms" << std::setw (g_fwidth) << "ns3 B/sta"
+       << std::setw (g_fwidth) << "store B/sta" << std::setw (g_fwidth) << "same %"
+       << std::setw (g_fwidth) << "changes");
+  const char *algos[] = { "parf", "aparf", "rrpaa" };
+  for (uint32_t a = 0; a < 3; ++a)
+    {
+      Result legacy = RunLegacy (algos[a], scenario, rounds);
+      Result store = RunStore (algos[a], false, scenario, rounds);
+      g_changes = 0;
+      Result sink = RunStore (algos[a], true, scenario, rounds);
+      uint32_t same = 0;
+      for (uint32_t s = 0; s < nStations; ++s)
+        {
+          same += legacy.rate[s] == store.rate[s] && legacy.power[s] == store.power[s]
+            && sink.rate[s] == store.rate[s] && sink.power[s] == store.power[s];
+        }
+      LOG (std::setw (g_fwidth) << algos[a] << std::setw (g_fwidth) << legacy.ms
+           << std::setw (g_fwidth) << store.ms
+           << std::setw (g_fwidth) << (store.ms > 0 ? static_cast<double> (legacy.ms) / store.ms : 0)
+           << std::setw (g_fwidth) << sink.ms << std::setw (g_fwidth) << legacy.bytes
+           << std::setw (g_fwidth) << store.bytes
+           << std::setw (g_fwidth) << 100.0 * same / nStations
+           << std::setw (g_fwidth) << g_changes);
+    }
+  return 0;
+}
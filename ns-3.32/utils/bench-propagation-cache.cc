@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/propagation-module.h"
+#include "../abc/cached-propagation-model.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 12;
+
+// Keeps results alive
+volatile double g_sink;
+
+/**
+ * Received power of every ordered pair of nodes, a few times over, as a
+ * channel computes it for a round of broadcasts per node.
+ * \param loss the model
+ * \param nodes mobility models
+ * \param rounds rounds of broadcasts
+ * \param rx output, the received power of each pair in the last round
+ * \return ns per computation
+ */
+double
+Measure (Ptr<PropagationLossModel> loss, const std::vector<Ptr<MobilityModel> > &nodes,
+         uint32_t rounds, std::vector<double> &rx)
+{
+  rx.assign (nodes.size () * nodes.size (), 0);
+  double sum = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; ++r)
+    {
+      for (uint32_t i = 0; i < nodes.size (); ++i)
+        {
+          for (uint32_t j = 0; j < nodes.size (); ++j)
+            {
+              if (i != j)
+                {
+                  rx[i * nodes.size () + j] = loss->CalcRxPower (16.0206, nodes[i], nodes[j]);
+                }
+            }
+        }
+    }
+  int64_t ms = clock.End ();
+  for (uint32_t i = 0; i < rx.size (); ++i)
+    {
+      sum += rx[i];
+    }
+  g_sink = sum;
+  return 1e6 * ms / (static_cast<double> (rounds) * nodes.size () * (nodes.size () - 1));
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t minNodes = 50;
+  uint32_t maxNodes = 400;
+  uint32_t rounds = 20;
+  double moving = 0;
+  double step = 30;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark CachedPropagationLossModel over log-distance and\n"
+             "Friis loss, as a channel uses it: every node broadcasts, and\n"
+             "the received power of every other node is computed.\n"
+             "\n"
+             "Nodes sit on a grid; a fraction of them may move, which the\n"
+             "cache must not answer.  The node count doubles from minNodes\n"
+             "to maxNodes; 'max diff' is the largest difference in dB with\n"
+             "the uncached chain.");
+  cmd.AddValue ("minNodes", "smallest node count", minNodes);
+  cmd.AddValue ("maxNodes", "largest node count", maxNodes);
+  cmd.AddValue ("rounds", "broadcasts per node", rounds);
+  cmd.AddValue ("moving", "fraction of moving nodes", moving);
+  cmd.AddValue ("step", "distance between neighbors (m)", step);
+  cmd.Parse (argc, argv);
+
+  LOG (std::setw (g_fwidth) << "nodes" << std::setw (g_fwidth) << "plain (ns)"
+       << std::setw (g_fwidth) << "cached (ns)" << std::setw (g_fwidth) << "speedup"
+       << std::setw (g_fwidth) << "hits" << std::setw (g_fwidth) << "misses"
+       << std::setw (g_fwidth) << "max diff");
+  for (uint32_t n = minNodes; n <= maxNodes; n *= 2)
+    {
+      uint32_t side = std::ceil (std::sqrt (static_cast<double> (n)));
+      std::vector<Ptr<MobilityModel> > nodes;
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          Ptr<ConstantVelocityMobilityModel> m = CreateObject<ConstantVelocityMobilityModel> ();
+          m->SetPosition (Vector ((i % side) * step, (i / side) * step, 0));
+          if (i < moving * n)
+            {
+              m->SetVelocity (Vector (1, 0, 0));
+            }
+          nodes.push_back (m);
+        }
+
+      Ptr<LogDistancePropagationLossModel> plain = CreateObject<LogDistancePropagationLossModel> ();
+      plain->SetNext (CreateObject<FriisPropagationLossModel> ());
+      Ptr<CachedPropagationLossModel> cached = CreateObject<CachedPropagationLossModel> ();
+      cached->SetModel (plain);
+
+      std::vector<double> plainRx;
+      std::vector<double> cachedRx;
+      double plainNs = Measure (plain, nodes, rounds, plainRx);
+      double cachedNs = Measure (cached, nodes, rounds, cachedRx);
+      double maxDiff = 0;
+      for (uint32_t i = 0; i < plainRx.size (); ++i)
+        {
+          maxDiff = std::max (maxDiff, std::abs (plainRx[i] - cachedRx[i]));
+        }
+
+      LOG (std::setw (g_fwidth) << n << std::setw (g_fwidth) << plainNs
+           << std::setw (g_fwidth) << cachedNs
+           << std::setw (g_fwidth) << (cachedNs > 0 ? plainNs / cachedNs : 0)
+           << std::setw (g_fwidth) << cached->GetHits () << std::setw (g_fwidth) << cached->GetMisses ()
+           << std::setw (g_fwidth) << maxDiff);
+    }
+  return 0;
+}
@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/spectrum-value.h"
+#include "ns3/wifi-spectrum-value-helper.h"
+#include "../abc/psd-kernels.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 12;
+
+// Keeps results alive
+volatile double g_sink;
+
+/// Number of transmit power levels cycled through.
+static const uint32_t N_POWERS = 8;
+
+/**
+ * \param centerFrequency center frequency (MHz)
+ * \param channelWidth channel width (MHz)
+ * \param txPowerW transmit power (W)
+ * \param guardBandwidth guard bandwidth (MHz)
+ * \return the HE transmit PSD, with the default spectral mask
+ */
+Ptr<SpectrumValue>
+CreateHePsd (uint32_t centerFrequency, uint16_t channelWidth, double txPowerW, uint16_t guardBandwidth)
+{
+  return WifiSpectrumValueHelper::CreateHeOfdmTxPowerSpectralDensity (centerFrequency, channelWidth,
+                                                                       txPowerW, guardBandwidth);
+}
+
+/**
+ * \param i iteration
+ * \return the transmit power of that iteration (W)
+ */
+double
+GetPower (uint32_t i)
+{
+  return 0.01 * (1 + i % N_POWERS);
+}
+
+/**
+ * \param width channel width (MHz)
+ * \param op operation
+ * \param baseNs time of the SpectrumValue code (ns)
+ * \param kernelNs time of the kernel (ns)
+ */
+void
+Report (uint16_t width, std::string op, double baseNs, double kernelNs)
+{
+  LOG (std::setw (g_fwidth) << width << std::setw (g_fwidth) << op
+       << std::setw (g_fwidth) << baseNs << std::setw (g_fwidth) << kernelNs
+       << std::setw (g_fwidth) << (kernelNs > 0 ? baseNs / kernelNs : 0));
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nIterations = 100000;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark PsdKernels and TxPsdCache against the SpectrumValue\n"
+             "operators and WifiSpectrumValueHelper, on HE transmit PSDs.\n"
+             "\n"
+             "create: build the transmit PSD of a frame (helper, cache hit);\n"
+             "scale: the received PSD, copied and scaled by the path loss\n"
+             "(Copy and *=, ScaleTo into a PSD kept across frames);\n"
+             "add: sum into an interference PSD (+=, Add);\n"
+             "integral: power of the PSD (Integral, PsdKernels::Integral).\n"
+             "The times are per operation.");
+  cmd.AddValue ("iterations", "operations per measurement", nIterations);
+  cmd.Parse (argc, argv);
+
+  LOG (std::setw (g_fwidth) << "width" << std::setw (g_fwidth) << "op"
+       << std::setw (g_fwidth) << "ns3 (ns)" << std::setw (g_fwidth) << "kernel (ns)"
+       << std::setw (g_fwidth) << "speedup");
+  uint16_t widths[] = {20, 80, 160};
+  uint32_t frequencies[] = {5180, 5210, 5250};
+  double maxError = 0;
+  for (uint32_t w = 0; w < sizeof (widths) / sizeof (widths[0]); ++w)
+    {
+      uint16_t width = widths[w];
+      uint32_t frequency = frequencies[w];
+      uint16_t guard = 2;
+      SystemWallClockMs clock;
+      double sum = 0;
+
+      clock.Start ();
+      for (uint32_t i = 0; i < nIterations; ++i)
+        {
+          sum += (*CreateHePsd (frequency, width, GetPower (i), guard))[0];
+        }
+      double baseNs = 1e6 * clock.End () / nIterations;
+      TxPsdCache cache (MakeCallback (&CreateHePsd));
+      clock.Start ();
+      for (uint32_t i = 0; i < nIterations; ++i)
+        {
+          sum += (*cache.Get (frequency, width, GetPower (i), guard))[0];
+        }
+      Report (width, "create", baseNs, 1e6 * clock.End () / nIterations);
+
+      Ptr<SpectrumValue> tx = cache.Get (frequency, width, GetPower (0), guard);
+      clock.Start ();
+      for (uint32_t i = 0; i < nIterations; ++i)
+        {
+          Ptr<SpectrumValue> rx = tx->Copy ();
+          *rx *= 1e-9 * (1 + i % 16);
+          sum += (*rx)[0];
+        }
+      baseNs = 1e6 * clock.End () / nIterations;
+      Ptr<SpectrumValue> rx = tx->Copy ();
+      clock.Start ();
+      for (uint32_t i = 0; i < nIterations; ++i)
+        {
+          PsdKernels::ScaleTo (*rx, *tx, 1e-9 * (1 + i % 16));
+          sum += (*rx)[0];
+        }
+      Report (width, "scale", baseNs, 1e6 * clock.End () / nIterations);
+
+      Ptr<SpectrumValue> interference = Create<SpectrumValue> (tx->GetSpectrumModel ());
+      clock.Start ();
+      for (uint32_t i = 0; i < nIterations; ++i)
+        {
+          *interference += *rx;
+        }
+      baseNs = 1e6 * clock.End () / nIterations;
+      clock.Start ();
+      for (uint32_t i = 0; i < nIterations; ++i)
+        {
+          PsdKernels::Add (*interference, *rx);
+        }
+      Report (width, "add", baseNs, 1e6 * clock.End () / nIterations);
+      sum += (*interference)[0];
+
+      double power = 0;
+      clock.Start ();
+      for (uint32_t i = 0; i < nIterations; ++i)
+        {
+          power += Integral (*cache.Get (frequency, width, GetPower (i), guard));
+        }
+      baseNs = 1e6 * clock.End () / nIterations;
+      double kernelPower = 0;
+      std::vector<double> bandWidths;
+      PsdKernels::GetWidths (tx->GetSpectrumModel (), bandWidths);
+      clock.Start ();
+      for (uint32_t i = 0; i < nIterations; ++i)
+        {
+          kernelPower += PsdKernels::Integral (*cache.Get (frequency, width, GetPower (i), guard), bandWidths);
+        }
+      Report (width, "integral", baseNs, 1e6 * clock.End () / nIterations);
+      maxError = std::max (maxError, std::fabs (kernelPower - power) / power);
+      g_sink = sum + power + kernelPower;
+    }
+  LOG ("Integral relative error: " << maxError);
+  return 0;
+}
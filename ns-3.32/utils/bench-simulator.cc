@@ -25,9 +25,13 @@
 #include <string.h>
 
 #include "ns3/core-module.h"
+#include "../abc/log-ring.h"
+#include "../abc/log-threshold.h"
 
 using namespace ns3;
 
+NS_LOG_COMPONENT_DEFINE ("BenchSimulator");
+
 
 bool g_debug = false;
 
@@ -138,6 +142,8 @@ Bench::Cb (void)
       return;
     }
   DEB ("event at " << Simulator::Now ().GetSeconds () << "s");
+  NS_LOG_FUNCTION (this << m_count);
+  NS_LOG_DEBUG ("event at " << Simulator::Now ().GetSeconds () << "s");
 
   Time after = NanoSeconds (m_rand->GetValue ());
   Simulator::Schedule (after, &Bench::Cb, this);
@@ -214,6 +220,8 @@ int main (int argc, char *argv[])
   uint32_t runs  =       1;
   std::string filename = "";
   bool calRev = false;
+  bool log = false;
+  std::string logFile = "";
 
   CommandLine cmd (__FILE__);
   cmd.Usage ("Benchmark the simulator scheduler.\n"
@@ -236,6 +244,8 @@ int main (int argc, char *argv[])
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
+  cmd.AddValue ("log",   "enable the BenchSimulator log component", log);
+  cmd.AddValue ("logFile", "send log output through a LogRing to this file", logFile);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
@@ -261,6 +271,15 @@ int main (int argc, char *argv[])
       
   Simulator::SetScheduler (factory);
 
+  if (logFile != "")
+    {
+      LogRing::Install (logFile);
+    }
+  if (log)
+    {
+      LogComponentEnable ("BenchSimulator", LOG_LEVEL_ALL);
+    }
+
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
 
@@ -273,6 +292,9 @@ int main (int argc, char *argv[])
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
+  LOGME ("compiled log levels: 0x" << std::hex << g_logCompileLevel << std::dec
+         << (log ? ", enabled" : ", disabled") << " at runtime"
+         << (logFile != "" ? ", via LogRing to " + logFile : ""));
 
   Bench *bench = new Bench (pop, total);
   bench->SetRandomStream (GetRandomStream (filename));
@@ -317,5 +339,10 @@ int main (int argc, char *argv[])
   LOG ("");
   Simulator::Destroy ();
   delete bench;
+  if (logFile != "")
+    {
+      LOGME ("log ring stalls: " << LogRing::GetStalls ());
+      LogRing::Uninstall ();
+    }
   return 0;
 }
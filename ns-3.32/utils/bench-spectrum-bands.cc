@@ -0,0 +1,221 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/propagation-module.h"
+#include "ns3/spectrum-module.h"
+#include "ns3/wifi-module.h"
+#include "../abc/grid-spectrum-channel.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 12;
+
+// Frames decoded by any PHY
+uint64_t g_receptions = 0;
+
+/// Channel under test.
+enum ChannelType
+{
+  MULTI_MODEL,  //!< MultiModelSpectrumChannel
+  BANDS,        //!< GridSpectrumChannel without range
+  BANDS_CUT     //!< GridSpectrumChannel with a cut-off range
+};
+
+/// Result of a run.
+struct Result
+{
+  int64_t ms;           //!< Wall clock time of Simulator::Run
+  uint64_t visits;      //!< Receivers visited, GridSpectrumChannel only
+  uint64_t receptions;  //!< Frames decoded
+};
+
+/**
+ * PhyRxEnd trace sink.
+ * \param packet the frame
+ */
+void
+RxEnd (Ptr<const Packet> packet)
+{
+  ++g_receptions;
+}
+
+/**
+ * Broadcast a frame.
+ * \param device the sender
+ */
+void
+Send (Ptr<NetDevice> device)
+{
+  device->Send (Create<Packet> (100), device->GetBroadcast (), 0x0800);
+}
+
+/**
+ * Nodes on a grid, on channels assigned in turn, broadcast a few frames
+ * each, one at a time.
+ * \param nChannels number of channels
+ * \param perChannel nodes per channel
+ * \param spacing distance between channel center frequencies (MHz)
+ * \param step distance between neighbors (m)
+ * \param frames frames per node
+ * \param type channel under test
+ * \return the run
+ */
+Result
+Run (uint32_t nChannels, uint32_t perChannel, uint16_t spacing, double step,
+     uint32_t frames, ChannelType type)
+{
+  uint32_t n = nChannels * perChannel;
+  uint32_t side = static_cast<uint32_t> (std::ceil (std::sqrt (n)));
+  NodeContainer nodes;
+  nodes.Create (n);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (step),
+                                 "DeltaY", DoubleValue (step),
+                                 "GridWidth", UintegerValue (side),
+                                 "LayoutType", StringValue ("RowFirst"));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel> ();
+  Ptr<SpectrumChannel> channel;
+  Ptr<GridSpectrumChannel> grid;
+  if (type == MULTI_MODEL)
+    {
+      channel = CreateObject<MultiModelSpectrumChannel> ();
+    }
+  else
+    {
+      grid = CreateObject<GridSpectrumChannel> ();
+      if (type == BANDS_CUT)
+        {
+          // Default transmit power, against 10 dB under the noise floor
+          // of a 20 MHz channel with a 7 dB noise figure.
+          grid->SetRange (GridSpectrumChannel::GetCutoffRange (loss, 16.0206, -104, 100000));
+        }
+      channel = grid;
+    }
+  channel->AddPropagationLossModel (loss);
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices;
+  for (uint32_t c = 0; c < nChannels; ++c)
+    {
+      NodeContainer members;
+      for (uint32_t i = c; i < n; i += nChannels)
+        {
+          members.Add (nodes.Get (i));
+        }
+      SpectrumWifiPhyHelper phy = SpectrumWifiPhyHelper::Default ();
+      phy.SetChannel (channel);
+      phy.Set ("Frequency", UintegerValue (5180 + c * spacing));
+      devices.Add (wifi.Install (phy, mac, members));
+    }
+  wifi.AssignStreams (devices, 0);
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxEnd",
+                                 MakeCallback (&RxEnd));
+
+  for (uint32_t f = 0; f < frames; ++f)
+    {
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          Simulator::Schedule (Seconds (1) + MilliSeconds (f * n + i), &Send, devices.Get (i));
+        }
+    }
+
+  g_receptions = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  Result r;
+  r.ms = clock.End ();
+  r.visits = grid ? grid->GetNVisits () : 0;
+  r.receptions = g_receptions;
+  Simulator::Destroy ();
+  return r;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t minChannels = 4;
+  uint32_t maxChannels = 64;
+  uint32_t perChannel = 8;
+  uint16_t spacing = 80;
+  double step = 30;
+  uint32_t frames = 2;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark GridSpectrumChannel with coexisting channels against\n"
+             "MultiModelSpectrumChannel.\n"
+             "\n"
+             "perChannel wifi nodes per channel, on a grid with the channels\n"
+             "interleaved, broadcast a few frames each, one at a time.  The\n"
+             "channels are spacing MHz apart, enough for their spectrum models\n"
+             "not to overlap at the default 80; bands visits only the receivers\n"
+             "of the sender's channel, bands+cut those within the cut-off\n"
+             "range.  The frames decoded should be the same.  The number of\n"
+             "channels doubles from minChannels to maxChannels; the rates are\n"
+             "frames sent per second of wall clock.");
+  cmd.AddValue ("minChannels", "smallest number of channels", minChannels);
+  cmd.AddValue ("maxChannels", "largest number of channels", maxChannels);
+  cmd.AddValue ("perChannel", "nodes per channel", perChannel);
+  cmd.AddValue ("spacing", "distance between channel center frequencies (MHz)", spacing);
+  cmd.AddValue ("step", "distance between neighbors (m)", step);
+  cmd.AddValue ("frames", "frames per node", frames);
+  cmd.Parse (argc, argv);
+
+  LOG (std::setw (g_fwidth) << "channels" << std::setw (g_fwidth) << "nodes"
+       << std::setw (g_fwidth) << "multi fps" << std::setw (g_fwidth) << "bands fps"
+       << std::setw (g_fwidth) << "cut fps" << std::setw (g_fwidth) << "speedup"
+       << std::setw (g_fwidth) << "bands visit" << std::setw (g_fwidth) << "cut visit"
+       << std::setw (g_fwidth) << "multi rx" << std::setw (g_fwidth) << "bands rx"
+       << std::setw (g_fwidth) << "cut rx");
+  for (uint32_t nChannels = minChannels; nChannels <= maxChannels; nChannels *= 2)
+    {
+      double sent = nChannels * perChannel * frames;
+      Result multi = Run (nChannels, perChannel, spacing, step, frames, MULTI_MODEL);
+      Result bands = Run (nChannels, perChannel, spacing, step, frames, BANDS);
+      Result cut = Run (nChannels, perChannel, spacing, step, frames, BANDS_CUT);
+      double multiRate = multi.ms > 0 ? 1000 * sent / multi.ms : 0;
+      double bandsRate = bands.ms > 0 ? 1000 * sent / bands.ms : 0;
+      double cutRate = cut.ms > 0 ? 1000 * sent / cut.ms : 0;
+      LOG (std::setw (g_fwidth) << nChannels << std::setw (g_fwidth) << nChannels * perChannel
+           << std::setw (g_fwidth) << multiRate << std::setw (g_fwidth) << bandsRate
+           << std::setw (g_fwidth) << cutRate
+           << std::setw (g_fwidth) << (multiRate > 0 ? cutRate / multiRate : 0)
+           << std::setw (g_fwidth) << bands.visits / sent << std::setw (g_fwidth) << cut.visits / sent
+           << std::setw (g_fwidth) << multi.receptions << std::setw (g_fwidth) << bands.receptions
+           << std::setw (g_fwidth) << cut.receptions);
+    }
+  return 0;
+}
@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/propagation-module.h"
+#include "ns3/wifi-module.h"
+#include "../abc/grid-spectrum-channel.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 12;
+
+// Frames decoded by any PHY
+uint64_t g_receptions = 0;
+
+/// Result of a run.
+struct Result
+{
+  int64_t ms;           //!< Wall clock time of Simulator::Run
+  uint64_t losses;      //!< Propagation loss computations
+  uint64_t receptions;  //!< Frames decoded
+};
+
+/**
+ * PhyRxEnd trace sink.
+ * \param packet the frame
+ */
+void
+RxEnd (Ptr<const Packet> packet)
+{
+  ++g_receptions;
+}
+
+/**
+ * Broadcast a frame.
+ * \param device the sender
+ */
+void
+Send (Ptr<NetDevice> device)
+{
+  device->Send (Create<Packet> (100), device->GetBroadcast (), 0x0800);
+}
+
+/**
+ * Every node of a grid broadcasts a few frames, one at a time.
+ * \param side nodes per side
+ * \param step distance between neighbors (m)
+ * \param speed node speed (m/s), in random directions
+ * \param frames frames per node
+ * \param cut use a cut-off range
+ * \return the run
+ */
+Result
+Run (uint32_t side, double step, double speed, uint32_t frames, bool cut)
+{
+  uint32_t n = side * side;
+  NodeContainer nodes;
+  nodes.Create (n);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (step),
+                                 "DeltaY", DoubleValue (step),
+                                 "GridWidth", UintegerValue (side),
+                                 "LayoutType", StringValue ("RowFirst"));
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (nodes);
+  Ptr<UniformRandomVariable> angle = CreateObject<UniformRandomVariable> ();
+  angle->SetStream (1);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      double a = angle->GetValue (0, 2 * M_PI);
+      nodes.Get (i)->GetObject<ConstantVelocityMobilityModel> ()->SetVelocity (
+        Vector (speed * std::cos (a), speed * std::sin (a), 0));
+    }
+
+  Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel> ();
+  Ptr<GridSpectrumChannel> channel = CreateObject<GridSpectrumChannel> ();
+  channel->AddPropagationLossModel (loss);
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  if (cut)
+    {
+      // Default transmit power, against 10 dB under the noise floor of a
+      // 20 MHz channel with a 7 dB noise figure.
+      channel->SetRange (GridSpectrumChannel::GetCutoffRange (loss, 16.0206, -104, 100000));
+    }
+
+  SpectrumWifiPhyHelper phy = SpectrumWifiPhyHelper::Default ();
+  phy.SetChannel (channel);
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+  wifi.AssignStreams (devices, 0);
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxEnd",
+                                 MakeCallback (&RxEnd));
+
+  for (uint32_t f = 0; f < frames; ++f)
+    {
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          Simulator::Schedule (Seconds (1) + MilliSeconds (f * n + i), &Send, devices.Get (i));
+        }
+    }
+
+  g_receptions = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  Result r;
+  r.ms = clock.End ();
+  r.losses = channel->GetNLossComputations ();
+  r.receptions = g_receptions;
+  Simulator::Destroy ();
+  return r;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t minSide = 8;
+  uint32_t maxSide = 32;
+  double step = 30;
+  double speed = 0;
+  uint32_t frames = 2;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark GridSpectrumChannel with and without a cut-off range.\n"
+             "\n"
+             "side x side wifi nodes on a grid broadcast a few frames each,\n"
+             "one at a time, over log-distance loss.  The cut-off range is\n"
+             "where the signal falls 10 dB under the noise floor; the frames\n"
+             "decoded should be the same both ways.  The grid side doubles\n"
+             "from minSide to maxSide.");
+  cmd.AddValue ("minSide", "smallest grid side", minSide);
+  cmd.AddValue ("maxSide", "largest grid side", maxSide);
+  cmd.AddValue ("step", "distance between neighbors (m)", step);
+  cmd.AddValue ("speed", "node speed (m/s), in random directions", speed);
+  cmd.AddValue ("frames", "frames per node", frames);
+  cmd.Parse (argc, argv);
+
+  LOG (std::setw (g_fwidth) << "nodes" << std::setw (g_fwidth) << "full (ms)"
+       << std::setw (g_fwidth) << "cut (ms)" << std::setw (g_fwidth) << "speedup"
+       << std::setw (g_fwidth) << "full loss" << std::setw (g_fwidth) << "cut loss"
+       << std::setw (g_fwidth) << "full rx" << std::setw (g_fwidth) << "cut rx");
+  for (uint32_t side = minSide; side <= maxSide; side *= 2)
+    {
+      Result full = Run (side, step, speed, frames, false);
+      Result cut = Run (side, step, speed, frames, true);
+      LOG (std::setw (g_fwidth) << side * side << std::setw (g_fwidth) << full.ms
+           << std::setw (g_fwidth) << cut.ms
+           << std::setw (g_fwidth) << (cut.ms > 0 ? static_cast<double> (full.ms) / cut.ms : 0)
+           << std::setw (g_fwidth) << full.losses << std::setw (g_fwidth) << cut.losses
+           << std::setw (g_fwidth) << full.receptions << std::setw (g_fwidth) << cut.receptions);
+    }
+  return 0;
+}
@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "../abc/tcp-timer.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+
+// Output field width
+int g_fwidth = 14;
+
+/// Benchmark parameters and counters shared by both variants.
+struct Workload
+{
+  uint32_t connections; //!< Number of connections
+  uint32_t rounds;      //!< Number of ACK rounds
+  Time ackInterval;     //!< Time between ACK rounds
+  double lossProb;      //!< Probability that a connection misses an ACK
+  Ptr<UniformRandomVariable> rtt;  //!< RTT sample, in ms
+  Ptr<UniformRandomVariable> loss; //!< Loss draw
+  uint64_t acks;        //!< ACKs processed
+  uint64_t timeouts;    //!< Timeouts fired
+};
+
+/// Old TcpTimer behaviour: one Timer per connection, cancelled and
+/// rescheduled on every ACK.
+struct PerAckTimers
+{
+  Ptr<TcpTimerTable> estimator;  //!< RTO estimator only
+  std::vector<Timer> timers;     //!< Retransmission timer of each connection
+};
+
+/**
+ * Count a timeout.
+ * \param w workload
+ * \param conn connection index
+ */
+void
+Timeout (Workload *w, uint32_t conn)
+{
+  ++w->timeouts;
+}
+
+/**
+ * One ACK round with per-ACK cancel and schedule.
+ * \param w workload
+ * \param t timers
+ * \param round round number
+ */
+void
+PerAckRound (Workload *w, PerAckTimers *t, uint32_t round)
+{
+  for (uint32_t i = 0; i < w->connections; ++i)
+    {
+      if (w->loss->GetValue () < w->lossProb)
+        {
+          continue;
+        }
+      ++w->acks;
+      t->estimator->UpdateRtt (i, MilliSeconds (w->rtt->GetInteger ()), false);
+      t->timers[i].Cancel ();
+      t->timers[i].Schedule (t->estimator->GetRto (i));
+    }
+  if (round + 1 < w->rounds)
+    {
+      Simulator::Schedule (w->ackInterval, &PerAckRound, w, t, round + 1);
+    }
+}
+
+/**
+ * One ACK round on a TcpTimerTable.
+ * \param w workload
+ * \param table timer table
+ * \param round round number
+ */
+void
+TableRound (Workload *w, Ptr<TcpTimerTable> table, uint32_t round)
+{
+  for (uint32_t i = 0; i < w->connections; ++i)
+    {
+      if (w->loss->GetValue () < w->lossProb)
+        {
+          continue;
+        }
+      ++w->acks;
+      table->UpdateRtt (i, MilliSeconds (w->rtt->GetInteger ()), false);
+      table->Start (i);
+    }
+  if (round + 1 < w->rounds)
+    {
+      Simulator::Schedule (w->ackInterval, &TableRound, w, table, round + 1);
+    }
+}
+
+/**
+ * Print one result line.
+ * \param name variant name
+ * \param w workload
+ * \param elapsed wall-clock time in seconds
+ * \param scheduled number of timer events scheduled
+ */
+void
+Report (std::string name, const Workload &w, double elapsed, uint64_t scheduled)
+{
+  LOG (std::setw (g_fwidth) << name << std::setw (g_fwidth) << elapsed
+       << std::setw (g_fwidth) << w.acks / elapsed
+       << std::setw (g_fwidth) << scheduled
+       << std::setw (g_fwidth) << w.timeouts);
+}
+
+/**
+ * Reset the counters and random streams of the workload.
+ * \param w workload
+ */
+void
+Reset (Workload &w)
+{
+  w.acks = 0;
+  w.timeouts = 0;
+  w.rtt->SetStream (1);
+  w.loss->SetStream (2);
+}
+
+/**
+ * Run the per-ACK cancel and schedule variant.
+ * \param w workload
+ * \return elapsed wall-clock time in seconds
+ */
+double
+BenchPerAck (Workload &w)
+{
+  Reset (w);
+  PerAckTimers t;
+  t.estimator = CreateObject<TcpTimerTable> ();
+  t.estimator->Add (w.connections);
+  t.timers.reserve (w.connections);
+  for (uint32_t i = 0; i < w.connections; ++i)
+    {
+      t.timers.push_back (Timer (Timer::CANCEL_ON_DESTROY));
+      t.timers[i].SetFunction (&Timeout);
+      t.timers[i].SetArguments (&w, i);
+    }
+  Simulator::Schedule (Seconds (0), &PerAckRound, &w, &t, 0);
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  double elapsed = clock.End () / 1000.0;
+  Simulator::Destroy ();
+  Report ("Timer", w, elapsed, w.acks);
+  return elapsed;
+}
+
+/**
+ * Run the TcpTimerTable variant.
+ * \param w workload
+ * \return elapsed wall-clock time in seconds
+ */
+double
+BenchTable (Workload &w)
+{
+  Reset (w);
+  Ptr<TcpTimerTable> table = CreateObject<TcpTimerTable> ();
+  table->Add (w.connections);
+  table->SetTimeoutCallback (MakeBoundCallback (&Timeout, &w));
+  Simulator::Schedule (Seconds (0), &TableRound, &w, table, 0);
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  double elapsed = clock.End () / 1000.0;
+  Simulator::Destroy ();
+  Report ("TcpTimerTable", w, elapsed, table->GetNScheduled ());
+  return elapsed;
+}
+
+int main (int argc, char *argv[])
+{
+  Workload w;
+  w.connections = 1000000;
+  w.rounds = 20;
+  w.ackInterval = MilliSeconds (100);
+  w.lossProb = 0.01;
+  Time minRto = MilliSeconds (200);
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark TCP retransmission timers.\n"
+             "\n"
+             "Every round, each connection receives an ACK with a random\n"
+             "RTT in [10, 50] ms unless it is lost, and restarts its\n"
+             "retransmission timer.  The old TcpTimer way cancels and\n"
+             "schedules one event per ACK; TcpTimerTable reuses the\n"
+             "pending event of the connection.");
+  cmd.AddValue ("connections", "number of connections (default 1E6)", w.connections);
+  cmd.AddValue ("rounds", "number of ACK rounds (default 20)", w.rounds);
+  cmd.AddValue ("ackInterval", "time between ACK rounds", w.ackInterval);
+  cmd.AddValue ("lossProb", "probability that an ACK is lost", w.lossProb);
+  cmd.AddValue ("minRto", "lower bound of the RTO", minRto);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpTimerTable::MinRto", TimeValue (minRto));
+  w.rtt = CreateObject<UniformRandomVariable> ();
+  w.rtt->SetAttribute ("Min", DoubleValue (10));
+  w.rtt->SetAttribute ("Max", DoubleValue (50));
+  w.loss = CreateObject<UniformRandomVariable> ();
+
+  LOG (std::setw (g_fwidth) << "model" << std::setw (g_fwidth) << "Time (s)"
+       << std::setw (g_fwidth) << "Rate (ack/s)" << std::setw (g_fwidth) << "Events"
+       << std::setw (g_fwidth) << "Timeouts");
+  double perAck = BenchPerAck (w);
+  double table = BenchTable (w);
+  LOG ("speedup: " << perAck / table);
+  return 0;
+}
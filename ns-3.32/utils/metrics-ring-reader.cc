@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Prints the live metrics a running simulation publishes with
+// MetricsPublisher.  Runs in its own process and only maps the
+// shared-memory ring, so it can be started and stopped at any time:
+//
+//   ./waf --run "metrics-ring-reader --name=/ns3-metrics --period=500"
+
+#include <iomanip>
+#include <iostream>
+#include <unistd.h>
+
+#include "ns3/core-module.h"
+#include "../abc/metrics-ring.h"
+
+using namespace ns3;
+
+int
+main (int argc, char *argv[])
+{
+  std::string name = "/ns3-metrics";
+  uint32_t period = 1000;
+  bool once = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("name", "shared-memory object name", name);
+  cmd.AddValue ("period", "polling period in milliseconds", period);
+  cmd.AddValue ("once", "print the latest sample and exit", once);
+  cmd.Parse (argc, argv);
+
+  MetricsRing ring;
+  while (!ring.Open (name))
+    {
+      if (once)
+        {
+          std::cerr << "no metrics ring named " << name << std::endl;
+          return 1;
+        }
+      usleep (period * 1000);
+    }
+
+  std::cout << std::setw (14) << "sim time (s)"
+            << std::setw (12) << "wall (s)"
+            << std::setw (14) << "events"
+            << std::setw (14) << "events/s"
+            << std::setw (12) << "pending";
+  for (uint32_t i = 0; i < ring.GetNCounters (); ++i)
+    {
+      std::cout << std::setw (16) << ring.GetCounterName (i);
+    }
+  std::cout << std::endl;
+
+  uint64_t lastHead = 0;
+  for (;;)
+    {
+      MetricsRecord record;
+      uint64_t head = ring.GetHead ();
+      if (head != lastHead && ring.ReadLatest (record))
+        {
+          lastHead = head;
+          std::cout << std::fixed << std::setprecision (3)
+                    << std::setw (14) << record.m_simTimeNs / 1e9
+                    << std::setw (12) << record.m_wallTimeMs / 1e3
+                    << std::setw (14) << record.m_eventCount
+                    << std::setprecision (0)
+                    << std::setw (14) << record.m_eventsPerSecond
+                    << std::setw (12) << record.m_pendingEvents;
+          for (uint32_t i = 0; i < ring.GetNCounters (); ++i)
+            {
+              std::cout << std::setw (16) << record.m_counters[i];
+            }
+          std::cout << std::endl;
+        }
+      if (once || ring.IsClosed ())
+        {
+          break;
+        }
+      usleep (period * 1000);
+    }
+  return 0;
+}
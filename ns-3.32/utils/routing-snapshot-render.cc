@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "../abc/routing-snapshot.h"
+
+using namespace ns3;
+
+/**
+ * Print the routing tables of some nodes.
+ * \param table routes, sorted by key
+ * \param time snapshot time in ns
+ * \param nodes node ids, sorted; all nodes of the table if empty
+ * \param node only print this node, if not negative
+ */
+void
+PrintNodes (const std::vector<RoutingSnapshotRecord> &table, int64_t time,
+            std::vector<uint32_t> nodes, int64_t node)
+{
+  if (nodes.empty ())
+    {
+      for (std::vector<RoutingSnapshotRecord>::const_iterator r = table.begin (); r != table.end (); ++r)
+        {
+          if (nodes.empty () || nodes.back () != r->node)
+            {
+              nodes.push_back (r->node);
+            }
+        }
+    }
+  Time now = NanoSeconds (time);
+  std::vector<RoutingSnapshotRecord>::const_iterator first = table.begin ();
+  for (std::vector<uint32_t>::const_iterator n = nodes.begin (); n != nodes.end (); ++n)
+    {
+      while (first != table.end () && first->node < *n)
+        {
+          ++first;
+        }
+      std::vector<RoutingSnapshotRecord>::const_iterator last = first;
+      while (last != table.end () && last->node == *n)
+        {
+          ++last;
+        }
+      if (node < 0 || *n == node)
+        {
+          std::cout << "Node: " << *n << ", Time: " << now.As (Time::S) << ", Routing table" << std::endl;
+          RoutingSnapshotFormat::Print (std::cout, first, last);
+          std::cout << std::endl;
+        }
+      first = last;
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  std::string file = "olsr.rsnap";
+  int64_t node = -1;
+  double time = -1;
+  bool all = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Print a routing snapshot file as text.\n"
+             "\n"
+             "By default, every snapshot prints the tables of the nodes\n"
+             "it changed, in the layout of PrintRoutingTableAllAt.");
+  cmd.AddValue ("file", "routing snapshot file", file);
+  cmd.AddValue ("node", "only print this node (-1 for all)", node);
+  cmd.AddValue ("time", "only print every table as of this time, in s (-1 for every snapshot)", time);
+  cmd.AddValue ("all", "print every node at each snapshot, not only the changed ones", all);
+  cmd.Parse (argc, argv);
+
+  RoutingSnapshotReader reader;
+  if (!reader.Open (file))
+    {
+      std::cerr << file << " is not a routing snapshot file" << std::endl;
+      return 1;
+    }
+
+  if (time >= 0)
+    {
+      // Replay up to the last snapshot at or before the requested time.
+      std::vector<RoutingSnapshotRecord> table;
+      int64_t at = -1;
+      while (reader.ReadNext () && NanoSeconds (reader.GetTime ()) <= Seconds (time))
+        {
+          table = reader.GetTable ();
+          at = reader.GetTime ();
+        }
+      if (at >= 0)
+        {
+          PrintNodes (table, at, std::vector<uint32_t> (), node);
+        }
+      return 0;
+    }
+
+  while (reader.ReadNext ())
+    {
+      std::vector<uint32_t> nodes;
+      if (!all)
+        {
+          nodes = reader.GetChangedNodes ();
+          if (nodes.empty ())
+            {
+              continue;
+            }
+        }
+      PrintNodes (reader.GetTable (), reader.GetTime (), nodes, node);
+    }
+  return 0;
+}